@@ -57,7 +57,8 @@ void vw_opts::usage()
 "Usage: %s [options] input_file\n"
 "\n"
 "View a file in OFF format. If input file isn't given read from\n"
-"standard input\n"
+"standard input. A frame file (e.g. from jitterbug -N) is played as an\n"
+"animation\n"
 "\n"
 "Options\n"
 "%s"
@@ -119,7 +120,7 @@ void vw_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hv:e:iV:E:F:w:m:x:n:s:t:I:D:C:L:R:B:")) !=
+  while ((c = getopt(argc, argv, ":hv:e:iV:E:F:w:m:G:x:n:s:t:I:D:C:L:R:B:")) !=
          -1) {
     if (common_opts(c, optopt))
       continue;
@@ -89,7 +89,7 @@ void DisplayPoly_gl::gl_verts(const Scene &scen)
   for (unsigned int i = 0; i < verts.size(); i++) {
     Color col = disp_geom.colors(VERTS).get((int)i);
     if (col.is_index())
-      col = clrng(VERTS).get_col(col.get_index());
+      col = clrng(VERTS).lookup(col.get_index());
     if (!col.is_value())
       col = def_col(VERTS); // use default
     if (col.is_invisible())
@@ -132,7 +132,7 @@ void DisplayPoly_gl::gl_edges(const Scene &scen)
   for (unsigned int i = 0; i < edges.size(); i++) {
     Color col = disp_geom.colors(EDGES).get((int)i);
     if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
+      col = clrng(EDGES).lookup(col.get_index());
     if (!col.is_value())
       col = def_col(EDGES); // use default
     if (col.is_invisible())
@@ -157,7 +157,7 @@ void DisplayPoly_gl::gl_faces(const Scene &)
       continue;
     Color col = disp_geom.colors(FACES).get((int)i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
+      col = clrng(FACES).lookup(col.get_index());
     if (!col.is_value())
       col = def_col(FACES); // use default
     if (col.is_invisible())
@@ -78,9 +78,24 @@ void gl_writer::geometry_objects(const Scene &scen)
   vector<SceneGeometry>::const_iterator geo;
   for (geo = scen.get_geoms().begin(); geo != scen.get_geoms().end(); ++geo) {
     vector<GeometryDisplay *>::const_iterator disp;
-    for (disp = geo->get_disps().begin(); disp != geo->get_disps().end();
-         ++disp)
-      (*disp)->gl_geom(scen);
+    const vector<Trans3d> &insts = geo->get_instances();
+    if (insts.size()) {
+      // draw the displays once for each instance transformation
+      double inst_m[16];
+      for (const auto &trans : insts) {
+        glPushMatrix();
+        to_gl_matrix(inst_m, trans);
+        glMultMatrixd(inst_m);
+        for (disp = geo->get_disps().begin(); disp != geo->get_disps().end();
+             ++disp)
+          (*disp)->gl_geom(scen);
+        glPopMatrix();
+      }
+    }
+    else
+      for (disp = geo->get_disps().begin(); disp != geo->get_disps().end();
+           ++disp)
+        (*disp)->gl_geom(scen);
     if (geo->get_label())
       geo->get_label()->gl_geom(scen);
     if (geo->get_sym())
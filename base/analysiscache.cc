@@ -0,0 +1,362 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file analysiscache.cc
+   \brief An on-disk cache of the results of analysing geometries
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(HAVE_DIRENT_H) && defined(HAVE_SYS_STAT_H) && defined(HAVE_UNISTD_H)
+#define ANALYSIS_CACHE_FILES 1
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include "analysiscache.h"
+#include "utils.h"
+
+using std::string;
+using std::vector;
+
+namespace anti {
+
+/* Entry file layout, all values in native byte order
+     char[8]   magic "ANTIAC01"
+     uint64    data size in bytes
+     uint64    checksum of the data
+     data
+*/
+static const char entry_magic[8] = {'A', 'N', 'T', 'I', 'A', 'C', '0', '1'};
+static const size_t entry_header_sz = 24;
+static const char *entry_ext = ".ac";
+static const char *tmp_prefix = "tmp.";
+
+// Writes between directory scans, and the age in seconds of a temporary
+// file that is taken to be left by an interrupted write
+static const unsigned int scan_interval = 256;
+static const time_t stale_tmp_secs = 3600;
+
+void CacheBuffer::put_bytes(const void *data, size_t sz)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  buf.insert(buf.end(), p, p + sz);
+}
+
+bool CacheBuffer::get_bytes(void *data, size_t sz)
+{
+  if (!good || buf.size() - pos < sz)
+    return (good = false);
+  memcpy(data, buf.data() + pos, sz);
+  pos += sz;
+  return true;
+}
+
+namespace {
+
+// Hash state accumulating 128 bits as two independently seeded lanes
+class Hash128 {
+private:
+  uint64_t h[2];
+
+  static uint64_t mix(uint64_t x)
+  {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+public:
+  Hash128() : h{0x9e3779b97f4a7c15ULL, 0x6a09e667f3bcc909ULL} {}
+
+  void add(uint64_t val)
+  {
+    h[0] = mix(h[0] ^ val) + 0x632be59bd9b4e019ULL;
+    h[1] = mix(h[1] + val) ^ 0x85157af5ULL;
+  }
+
+  void add(double val)
+  {
+    if (val == 0.0)
+      val = 0.0; // same key for -0.0
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    add(bits);
+  }
+
+  void add(const string &str)
+  {
+    add(uint64_t(str.size()));
+    for (unsigned char c : str)
+      add(uint64_t(c));
+  }
+
+  string to_hex() const
+  {
+    char str[33];
+    snprintf(str, sizeof(str), "%016llx%016llx", (unsigned long long)h[0],
+             (unsigned long long)h[1]);
+    return str;
+  }
+};
+
+uint64_t checksum(const unsigned char *data, size_t sz)
+{
+  // FNV-1a
+  uint64_t sum = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < sz; i++) {
+    sum ^= data[i];
+    sum *= 0x100000001b3ULL;
+  }
+  return sum;
+}
+
+} // namespace
+
+AnalysisCache &AnalysisCache::get_cache()
+{
+  static AnalysisCache cache = []() {
+    string dir;
+    const char *env_dir = getenv("ANTIPRISM_CACHE_DIR");
+    if (env_dir)
+      dir = env_dir;
+    int size_mb = 0;
+    const char *env_size = getenv("ANTIPRISM_CACHE_SIZE");
+    if (!(env_size && read_int(env_size, &size_mb) && size_mb > 0))
+      size_mb = 64;
+    return AnalysisCache(dir, uint64_t(size_mb) * 1024 * 1024);
+  }();
+  return cache;
+}
+
+bool AnalysisCache::is_enabled() const
+{
+#ifdef ANALYSIS_CACHE_FILES
+  return !dir.empty();
+#else
+  return false;
+#endif
+}
+
+string AnalysisCache::geom_key(const Geometry &geom, const string &kind)
+{
+  Hash128 hash;
+  hash.add(kind);
+  hash.add(uint64_t(geom.verts().size()));
+  for (const auto &v : geom.verts())
+    for (int i = 0; i < 3; i++)
+      hash.add(v[i]);
+  hash.add(uint64_t(geom.edges().size()));
+  for (const auto &e : geom.edges()) {
+    hash.add(uint64_t(e.size()));
+    for (int idx : e)
+      hash.add(uint64_t(idx));
+  }
+  hash.add(uint64_t(geom.num_faces()));
+  for (int i = 0; i < (int)geom.num_faces(); i++) {
+    const auto face = geom.face_view(i);
+    hash.add(uint64_t(face.size()));
+    for (int idx : face)
+      hash.add(uint64_t(idx));
+  }
+  return hash.to_hex();
+}
+
+string AnalysisCache::entry_path(const string &key) const
+{
+  return dir + "/" + key + entry_ext;
+}
+
+bool AnalysisCache::read(const string &key, CacheBuffer &buf) const
+{
+  buf = CacheBuffer();
+  if (!is_enabled())
+    return false;
+
+  string path = entry_path(key);
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+
+  bool ok = false;
+  unsigned char hdr[entry_header_sz];
+  if (fread(hdr, 1, entry_header_sz, file) == entry_header_sz &&
+      memcmp(hdr, entry_magic, sizeof(entry_magic)) == 0) {
+    uint64_t sz, sum;
+    memcpy(&sz, hdr + 8, sizeof(sz));
+    memcpy(&sum, hdr + 16, sizeof(sum));
+    // a truncated or corrupt entry may give any size
+    long file_sz = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+      file_sz = ftell(file);
+    if (file_sz >= (long)entry_header_sz &&
+        sz == uint64_t(file_sz) - entry_header_sz &&
+        fseek(file, entry_header_sz, SEEK_SET) == 0) {
+      auto &data = buf.data();
+      data.resize(sz);
+      ok = fread(data.data(), 1, sz, file) == sz &&
+           checksum(data.data(), sz) == sum;
+    }
+  }
+  fclose(file);
+
+  if (!ok) {
+    buf = CacheBuffer();
+    return false;
+  }
+#ifdef ANALYSIS_CACHE_FILES
+  utime(path.c_str(), nullptr); // mark as recently used
+#endif
+  return true;
+}
+
+bool AnalysisCache::write(const string &key, const CacheBuffer &buf)
+{
+#ifdef ANALYSIS_CACHE_FILES
+  if (!is_enabled())
+    return false;
+
+  // Unique in this process and, by the pid, between processes
+  static std::atomic<unsigned long> tmp_cnt(0);
+  string tmp_path = dir + "/" + tmp_prefix + std::to_string((long)getpid()) +
+                    "." + std::to_string(tmp_cnt++);
+  FILE *file = fopen(tmp_path.c_str(), "wb");
+  if (!file)
+    return false;
+
+  const auto &data = buf.data();
+  unsigned char hdr[entry_header_sz];
+  uint64_t sz = data.size();
+  uint64_t sum = checksum(data.data(), data.size());
+  memcpy(hdr, entry_magic, sizeof(entry_magic));
+  memcpy(hdr + 8, &sz, sizeof(sz));
+  memcpy(hdr + 16, &sum, sizeof(sum));
+  bool ok = fwrite(hdr, 1, entry_header_sz, file) == entry_header_sz &&
+            fwrite(data.data(), 1, sz, file) == sz;
+  ok = (fclose(file) == 0) && ok;
+
+  // rename() replaces any existing entry atomically
+  if (!ok || rename(tmp_path.c_str(), entry_path(key).c_str()) != 0) {
+    remove(tmp_path.c_str());
+    return false;
+  }
+
+  trim(key, entry_header_sz + sz);
+  return true;
+#else
+  (void)key;
+  (void)buf;
+  return false;
+#endif
+}
+
+void AnalysisCache::trim(const string &keep_key, uint64_t added_bytes)
+{
+#ifdef ANALYSIS_CACHE_FILES
+  // Only one thread of a process trims at a time. Other processes may
+  // trim concurrently, in which case some removals just fail.
+  static std::mutex trim_mtx;
+  std::lock_guard<std::mutex> lock(trim_mtx);
+
+  known_bytes += added_bytes;
+  if (scanned && known_bytes <= max_bytes && ++num_writes < scan_interval)
+    return;
+  scanned = true;
+  num_writes = 0;
+
+  DIR *dp = opendir(dir.c_str());
+  if (!dp)
+    return;
+
+  // Times only have a resolution of a second, so the newest entry may
+  // not sort last, and is kept explicitly
+  string keep_path = entry_path(keep_key);
+  size_t ext_len = strlen(entry_ext);
+  size_t tmp_len = strlen(tmp_prefix);
+  time_t stale_time = time(nullptr) - stale_tmp_secs;
+  vector<std::pair<time_t, string>> entries; // (last use, path)
+  uint64_t tot_bytes = 0;
+  struct dirent *ent;
+  while ((ent = readdir(dp))) {
+    string name = ent->d_name;
+    bool is_tmp = name.compare(0, tmp_len, tmp_prefix) == 0;
+    if (!is_tmp &&
+        (name.size() <= ext_len ||
+         name.compare(name.size() - ext_len, ext_len, entry_ext) != 0))
+      continue;
+    string path = dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+      continue;
+    if (is_tmp) {
+      if (st.st_mtime < stale_time)
+        remove(path.c_str());
+      continue;
+    }
+    tot_bytes += st.st_size;
+    entries.push_back({st.st_mtime, path});
+  }
+  closedir(dp);
+
+  if (tot_bytes > max_bytes) {
+    std::sort(entries.begin(), entries.end());
+    for (const auto &entry : entries) {
+      if (tot_bytes <= max_bytes)
+        break;
+      if (entry.second == keep_path)
+        continue;
+      struct stat st;
+      if (stat(entry.second.c_str(), &st) == 0 &&
+          remove(entry.second.c_str()) == 0)
+        tot_bytes -= std::min<uint64_t>(tot_bytes, st.st_size);
+    }
+  }
+  known_bytes = tot_bytes;
+#else
+  (void)keep_key;
+  (void)added_bytes;
+#endif
+}
+
+} // namespace anti
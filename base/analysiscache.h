@@ -0,0 +1,174 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file analysiscache.h
+   \brief An on-disk cache of the results of analysing geometries
+*/
+
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+
+namespace anti {
+
+/// A buffer for the binary form of a cache entry
+/** Values are stored in the native byte order. When reading, a request
+ *  for more data than remains fails, and the buffer is marked as bad. */
+class CacheBuffer {
+private:
+  std::vector<unsigned char> buf;
+  size_t pos;
+  bool good;
+
+  bool get_bytes(void *data, size_t sz);
+
+public:
+  /// Constructor
+  CacheBuffer() : pos(0), good(true) {}
+
+  /// Add an integer
+  /**\param val the value to add. */
+  void put(uint64_t val) { put_bytes(&val, sizeof(val)); }
+
+  /// Add a floating point number
+  /**\param val the value to add, stored exactly. */
+  void put(double val) { put_bytes(&val, sizeof(val)); }
+
+  /// Add raw bytes
+  /**\param data the bytes to add.
+   * \param sz the number of bytes. */
+  void put_bytes(const void *data, size_t sz);
+
+  /// Read an integer
+  /**\param val to return the value.
+   * \return \c true if the value was read, otherwise \c false. */
+  bool get(uint64_t &val) { return get_bytes(&val, sizeof(val)); }
+
+  /// Read a floating point number
+  /**\param val to return the value.
+   * \return \c true if the value was read, otherwise \c false. */
+  bool get(double &val) { return get_bytes(&val, sizeof(val)); }
+
+  /// Check whether all reads succeeded
+  /**\return \c true if no read has failed, otherwise \c false. */
+  bool is_good() const { return good; }
+
+  /// Check whether all the data has been read
+  /**\return \c true if the read position is at the end of the data,
+   *  otherwise \c false. */
+  bool at_end() const { return pos == buf.size(); }
+
+  /// Get the data
+  /**\return The stored bytes. */
+  std::vector<unsigned char> &data() { return buf; }
+
+  /// Get the data
+  /**\return The stored bytes. */
+  const std::vector<unsigned char> &data() const { return buf; }
+
+  /// Set the read position to the start of the data
+  void rewind()
+  {
+    pos = 0;
+    good = true;
+  }
+};
+
+/// An on-disk cache of the results of analysing geometries
+/** Entries are files in a single directory, named by a hash of the
+ *  geometry content and the kind of result, so the same model analysed
+ *  by different programs shares its entries. An entry is written to a
+ *  temporary file and renamed into place, so other processes only see
+ *  whole entries, and an entry that fails its checksum is ignored. The
+ *  size of the entries is tracked as they are written, and the directory
+ *  is only scanned when the size limit is exceeded, or after a number of
+ *  writes to include entries from other processes. A scan removes the
+ *  least recently used entries until the size is within the limit, and
+ *  any temporary files left by interrupted writes.
+ *
+ *  The cache used by the library is disabled unless the environment
+ *  variable \c ANTIPRISM_CACHE_DIR is set to a directory. The size limit,
+ *  in megabytes, is taken from \c ANTIPRISM_CACHE_SIZE (default 64). */
+class AnalysisCache {
+private:
+  std::string dir;
+  uint64_t max_bytes;
+  uint64_t known_bytes;    // size of the entries, kept between scans
+  unsigned int num_writes; // writes since the last scan
+  bool scanned;
+
+  std::string entry_path(const std::string &key) const;
+  void trim(const std::string &keep_key, uint64_t added_bytes);
+
+public:
+  /// Constructor
+  /**\param cache_dir the cache directory, or \c "" to disable the cache.
+   * \param max_size the maximum total size of the entries, in bytes. */
+  AnalysisCache(const std::string &cache_dir = "",
+                uint64_t max_size = 64 * 1024 * 1024)
+      : dir(cache_dir), max_bytes(max_size), known_bytes(0), num_writes(0),
+        scanned(false)
+  {
+  }
+
+  /// Get the cache used by the library
+  /**\return The cache, set up from the environment. */
+  static AnalysisCache &get_cache();
+
+  /// Check whether the cache is in use
+  /**\return \c true if entries are read and written, otherwise \c false. */
+  bool is_enabled() const;
+
+  /// Get a key for a result of analysing a geometry
+  /** The key depends on the coordinates and the vertex index numbers of
+   *  the edges and faces, but not on colours or face storage.
+   * \param geom the geometry.
+   * \param kind a name for the kind of result, which should change if
+   *  the form of the stored result changes.
+   * \return The key. */
+  static std::string geom_key(const Geometry &geom, const std::string &kind);
+
+  /// Read an entry
+  /**\param key the key of the entry.
+   * \param buf to return the stored data.
+   * \return \c true if a valid entry was found, otherwise \c false. */
+  bool read(const std::string &key, CacheBuffer &buf) const;
+
+  /// Write an entry
+  /** A failure to write is not an error, the entry is just not cached.
+   * \param key the key of the entry.
+   * \param buf the data to store.
+   * \return \c true if the entry was written, otherwise \c false. */
+  bool write(const std::string &key, const CacheBuffer &buf);
+};
+
+} // namespace anti
+
+#endif // ANALYSISCACHE_H
@@ -46,6 +46,7 @@
 #ifndef ANTIPRISM_H
 #define ANTIPRISM_H
 
+#include "analysiscache.h"
 #include "boundbox.h"
 #include "color.h"
 #include "coloring.h"
@@ -53,26 +54,35 @@
 #include "const.h"
 #include "displaypoly.h"
 #include "elemprops.h"
+#include "faceview.h"
+#include "frames.h"
+#include "bvh.h"
 #include "geometry.h"
 #include "geometryinfo.h"
 #include "geometryutils.h"
 #include "getopt.h"
+#include "instances.h"
 #include "mathutils.h"
 #include "normal.h"
+#include "parallel.h"
 #include "planar.h"
 #include "polygon.h"
 #include "povwriter.h"
+#include "predicates.h"
 #include "random.h"
+#include "resourcepack.h"
 #include "scene.h"
 #include "status.h"
 #include "symmetry.h"
 #include "tiling.h"
 #include "timer.h"
+#include "trace.h"
 #include "trans3d.h"
 #include "trans4d.h"
 #include "utils.h"
 #include "vec3d.h"
 #include "vec4d.h"
+#include "vec_batch.h"
 #include "vec_utils.h"
 #include "vrmlwriter.h"
 
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "boundbox.h"
+#include "vec_batch.h"
 
 using std::vector;
 
@@ -46,17 +47,8 @@ BoundBox::BoundBox(const vector<Vec3d> &points, double cutoff)
 
 void BoundBox::add_points(const vector<Vec3d> &points, double cutoff)
 {
-  double cut_off2 = cutoff * cutoff;
-  for (const auto &point : points) {
-    for (int j = 0; j < 3; j++) {
-      if (cutoff < 0 || point.len2() < cut_off2) {
-        if (point[j] < min_coords[j])
-          min_coords[j] = point[j];
-        if (point[j] > max_coords[j])
-          max_coords[j] = point[j];
-      }
-    }
-  }
+  batch_bound_box(points.data(), points.size(), cutoff, min_coords,
+                  max_coords);
 }
 
 void BoundBox::add_b_box(const BoundBox &b_box)
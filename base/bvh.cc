@@ -0,0 +1,726 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file bvh.cc
+   \brief A bounding volume hierarchy of faces, and face intersection
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <utility>
+#include <vector>
+
+#include "bvh.h"
+#include "geometryutils.h"
+#include "normal.h"
+#include "parallel.h"
+#include "planar.h"
+#include "trace.h"
+#include "vec_utils.h"
+
+using std::pair;
+using std::vector;
+
+namespace anti {
+
+// --------------------------------------------------------------
+// FaceBVH
+
+namespace {
+
+const int bvh_leaf_faces = 4;
+
+// Check whether a line segment, from P0 to P0 + dir, meets a box
+bool segment_meets_box(const Vec3d &P0, const Vec3d &dir, const Vec3d &min,
+                       const Vec3d &max)
+{
+  double t_min = 0;
+  double t_max = 1;
+  for (int j = 0; j < 3; j++) {
+    if (dir[j] == 0) {
+      if (P0[j] < min[j] || P0[j] > max[j])
+        return false;
+      continue;
+    }
+    double t0 = (min[j] - P0[j]) / dir[j];
+    double t1 = (max[j] - P0[j]) / dir[j];
+    if (t0 > t1)
+      std::swap(t0, t1);
+    t_min = std::max(t_min, t0);
+    t_max = std::min(t_max, t1);
+    if (t_min > t_max)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+void FaceBVH::build(vector<Vec3d> &cents, int node_idx, int start, int num)
+{
+  Node node;
+  node.min = face_mins[order[start]];
+  node.max = face_maxs[order[start]];
+  Vec3d c_min = cents[order[start]];
+  Vec3d c_max = c_min;
+  for (int i = start + 1; i < start + num; i++) {
+    for (int j = 0; j < 3; j++) {
+      node.min[j] = std::min(node.min[j], face_mins[order[i]][j]);
+      node.max[j] = std::max(node.max[j], face_maxs[order[i]][j]);
+      c_min[j] = std::min(c_min[j], cents[order[i]][j]);
+      c_max[j] = std::max(c_max[j], cents[order[i]][j]);
+    }
+  }
+
+  if (num <= bvh_leaf_faces) {
+    node.child = -1;
+    node.start = start;
+    node.num = num;
+  }
+  else {
+    // split at the median of the centres along the longest side
+    Vec3d extent = c_max - c_min;
+    int axis = 0;
+    for (int j = 1; j < 3; j++)
+      if (extent[j] > extent[axis])
+        axis = j;
+    int half = num / 2;
+    std::nth_element(order.begin() + start, order.begin() + start + half,
+                     order.begin() + start + num, [&](int a, int b) {
+                       return cents[a][axis] < cents[b][axis];
+                     });
+    node.child = nodes.size();
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    node.start = start;
+    node.num = 0;
+    build(cents, node.child, start, half);
+    build(cents, node.child + 1, start + half, num - half);
+  }
+
+  nodes[node_idx] = node;
+}
+
+void FaceBVH::init(const Geometry &geom, double margin)
+{
+  vector<FaceView> faces(geom.num_faces());
+  for (unsigned int i = 0; i < faces.size(); i++)
+    faces[i] = geom.face_view(i);
+  init_elems(geom.verts(), faces, margin);
+}
+
+void FaceBVH::init(const vector<Vec3d> &verts,
+                   const vector<vector<int>> &elems, double margin)
+{
+  init_elems(verts, vector<FaceView>(elems.begin(), elems.end()), margin);
+}
+
+void FaceBVH::init_elems(const vector<Vec3d> &verts,
+                         const vector<FaceView> &faces, double margin)
+{
+  nodes.clear();
+  order.clear();
+  face_mins.resize(faces.size());
+  face_maxs.resize(faces.size());
+  vector<Vec3d> cents(faces.size());
+  for (unsigned int i = 0; i < faces.size(); i++) {
+    if (faces[i].empty())
+      continue;
+    Vec3d &min = face_mins[i];
+    Vec3d &max = face_maxs[i];
+    min = verts[faces[i][0]];
+    max = min;
+    for (int v_idx : faces[i])
+      for (int j = 0; j < 3; j++) {
+        min[j] = std::min(min[j], verts[v_idx][j]);
+        max[j] = std::max(max[j], verts[v_idx][j]);
+      }
+    min -= Vec3d(margin, margin, margin);
+    max += Vec3d(margin, margin, margin);
+    cents[i] = (min + max) / 2;
+    order.push_back(i);
+  }
+
+  if (order.size()) {
+    nodes.push_back(Node());
+    build(cents, 0, 0, order.size());
+  }
+}
+
+bool FaceBVH::overlap(const Node &node0, const Node &node1) const
+{
+  for (int j = 0; j < 3; j++)
+    if (node0.max[j] < node1.min[j] || node1.max[j] < node0.min[j])
+      return false;
+  return true;
+}
+
+bool FaceBVH::face_overlap(int f_idx0, int f_idx1) const
+{
+  for (int j = 0; j < 3; j++)
+    if (face_maxs[f_idx0][j] < face_mins[f_idx1][j] ||
+        face_maxs[f_idx1][j] < face_mins[f_idx0][j])
+      return false;
+  return true;
+}
+
+void FaceBVH::get_overlaps(const Vec3d &min, const Vec3d &max,
+                           vector<int> &f_idxs) const
+{
+  f_idxs.clear();
+  if (nodes.empty())
+    return;
+
+  Node box;
+  box.min = min;
+  box.max = max;
+  vector<int> todo(1, 0);
+  while (todo.size()) {
+    const Node &node = nodes[todo.back()];
+    todo.pop_back();
+    if (!overlap(node, box))
+      continue;
+    if (node.child >= 0) {
+      todo.push_back(node.child);
+      todo.push_back(node.child + 1);
+    }
+    else {
+      for (int i = node.start; i < node.start + node.num; i++) {
+        int f_idx = order[i];
+        bool f_over = true;
+        for (int j = 0; j < 3; j++)
+          if (face_maxs[f_idx][j] < min[j] || max[j] < face_mins[f_idx][j])
+            f_over = false;
+        if (f_over)
+          f_idxs.push_back(f_idx);
+      }
+    }
+  }
+}
+
+void FaceBVH::get_segment_overlaps(const Vec3d &P0, const Vec3d &P1,
+                                   vector<int> &f_idxs) const
+{
+  f_idxs.clear();
+  if (nodes.empty())
+    return;
+
+  Vec3d dir = P1 - P0;
+  vector<int> todo(1, 0);
+  while (todo.size()) {
+    const Node &node = nodes[todo.back()];
+    todo.pop_back();
+    if (!segment_meets_box(P0, dir, node.min, node.max))
+      continue;
+    if (node.child >= 0) {
+      todo.push_back(node.child);
+      todo.push_back(node.child + 1);
+    }
+    else {
+      for (int i = node.start; i < node.start + node.num; i++)
+        if (segment_meets_box(P0, dir, face_mins[order[i]],
+                              face_maxs[order[i]]))
+          f_idxs.push_back(order[i]);
+    }
+  }
+  std::sort(f_idxs.begin(), f_idxs.end());
+}
+
+void FaceBVH::get_cross_pairs(int node0, int node1,
+                              vector<pair<int, int>> &pairs) const
+{
+  const Node &n0 = nodes[node0];
+  const Node &n1 = nodes[node1];
+  if (!overlap(n0, n1))
+    return;
+
+  if (n0.child < 0 && n1.child < 0) {
+    for (int i = n0.start; i < n0.start + n0.num; i++)
+      for (int j = n1.start; j < n1.start + n1.num; j++)
+        if (face_overlap(order[i], order[j]))
+          pairs.push_back(std::minmax(order[i], order[j]));
+  }
+  else if (n0.child < 0 ||
+           (n1.child >= 0 && (n1.max - n1.min).len2() >
+                                 (n0.max - n0.min).len2())) {
+    get_cross_pairs(node0, n1.child, pairs);
+    get_cross_pairs(node0, n1.child + 1, pairs);
+  }
+  else {
+    get_cross_pairs(n0.child, node1, pairs);
+    get_cross_pairs(n0.child + 1, node1, pairs);
+  }
+}
+
+void FaceBVH::get_self_pairs(int node, vector<pair<int, int>> &pairs) const
+{
+  const Node &n = nodes[node];
+  if (n.child < 0) {
+    for (int i = n.start; i < n.start + n.num; i++)
+      for (int j = i + 1; j < n.start + n.num; j++)
+        if (face_overlap(order[i], order[j]))
+          pairs.push_back(std::minmax(order[i], order[j]));
+  }
+  else {
+    get_self_pairs(n.child, pairs);
+    get_self_pairs(n.child + 1, pairs);
+    get_cross_pairs(n.child, n.child + 1, pairs);
+  }
+}
+
+void FaceBVH::get_overlapping_pairs(vector<pair<int, int>> &pairs) const
+{
+  pairs.clear();
+  if (nodes.size())
+    get_self_pairs(0, pairs);
+}
+
+// --------------------------------------------------------------
+// Face tests
+
+namespace {
+
+// The plane of a face
+struct FacePlane {
+  Vec3d norm;    // unit normal
+  double offset; // distance of plane from origin along the normal
+  bool valid;    // false for faces with less than three vertices or no area
+};
+
+FacePlane get_face_plane(const Geometry &geom, int f_idx, double eps)
+{
+  FacePlane plane;
+  plane.valid = false;
+  FaceView face = geom.face_view(f_idx);
+  if (face.size() < 3)
+    return plane;
+
+  Vec3d norm = face_norm(geom.verts(), face, true);
+  if (norm.len() < eps * eps)
+    return plane;
+
+  Vec3d cent(0, 0, 0);
+  for (int v_idx : face)
+    cent += geom.verts(v_idx);
+  cent /= face.size();
+
+  plane.norm = norm.unit();
+  plane.offset = vdot(cent, plane.norm);
+  plane.valid = true;
+  return plane;
+}
+
+double dist2_to_segment(const Vec3d &P, const Vec3d &A, const Vec3d &B)
+{
+  Vec3d AB = B - A;
+  double len2 = AB.len2();
+  double t = (len2 > 0) ? vdot(P - A, AB) / len2 : 0;
+  t = std::max(0.0, std::min(1.0, t));
+  return (A + AB * t - P).len2();
+}
+
+bool is_on_boundary(const vector<Vec3d> &verts, FaceView face,
+                    const Vec3d &P, double eps)
+{
+  for (unsigned int i = 0; i < face.size(); i++)
+    if (dist2_to_segment(P, verts[face[i]],
+                         verts[face[(i + 1) % face.size()]]) < eps * eps)
+      return true;
+  return false;
+}
+
+// A crossing of a face boundary with a plane
+struct Crossing {
+  double t;    // position along the line of the section
+  Vec3d P;     // point of the crossing
+  int winding; // 1 if the boundary crosses to the positive side, else -1
+  bool operator<(const Crossing &cr) const { return t < cr.t; }
+};
+
+// Get the intervals along a line, of direction dir, where a face meets
+// a plane, as pairs of positions in ts. The inside of the face has a
+// non-zero winding number, so star polygons include their centre. A
+// vertex within eps of the plane is taken to be on the positive side, so
+// the crossings pair up, and intervals that lie along the face boundary
+// are not included.
+void get_sections(const vector<Vec3d> &verts, FaceView face,
+                  const FacePlane &plane, const Vec3d &dir, double eps,
+                  vector<Crossing> &crossings, vector<double> &ts)
+{
+  crossings.clear();
+  ts.clear();
+  size_t sz = face.size();
+  for (size_t i = 0; i < sz; i++) {
+    const Vec3d &P0 = verts[face[i]];
+    const Vec3d &P1 = verts[face[(i + 1) % sz]];
+    double d0 = vdot(P0, plane.norm) - plane.offset;
+    double d1 = vdot(P1, plane.norm) - plane.offset;
+    if ((d0 < -eps) == (d1 < -eps))
+      continue;
+    Crossing cr;
+    if (fabs(d0) <= eps)
+      cr.P = P0;
+    else if (fabs(d1) <= eps)
+      cr.P = P1;
+    else
+      cr.P = P0 + (P1 - P0) * (d0 / (d0 - d1));
+    cr.t = vdot(cr.P, dir);
+    cr.winding = (d0 < -eps) ? 1 : -1;
+    crossings.push_back(cr);
+  }
+
+  std::sort(crossings.begin(), crossings.end());
+  int winding = 0;
+  for (size_t i = 0; i + 1 < crossings.size(); i++) {
+    winding += crossings[i].winding;
+    if (winding == 0 || crossings[i + 1].t - crossings[i].t <= eps)
+      continue;
+    Vec3d mid = (crossings[i].P + crossings[i + 1].P) / 2;
+    if (is_on_boundary(verts, face, mid, eps))
+      continue;
+    if (ts.size() && ts.back() == crossings[i].t)
+      ts.back() = crossings[i + 1].t; // continues the last interval
+    else {
+      ts.push_back(crossings[i].t);
+      ts.push_back(crossings[i + 1].t);
+    }
+  }
+}
+
+// Check whether face points are all on one side of a plane
+bool is_separated(const vector<Vec3d> &verts, FaceView face,
+                  const FacePlane &plane, double eps, bool *coplanar)
+{
+  bool pos = false;
+  bool neg = false;
+  for (int v_idx : face) {
+    double d = vdot(verts[v_idx], plane.norm) - plane.offset;
+    if (d > eps)
+      pos = true;
+    else if (d < -eps)
+      neg = true;
+  }
+  *coplanar = !pos && !neg;
+  return pos != neg;
+}
+
+// Coordinates in the plane of a face, dropping the largest component of
+// the normal
+struct Proj2D {
+  int u;
+  int v;
+  Proj2D(const Vec3d &norm)
+  {
+    int drop = 0;
+    for (int i = 1; i < 3; i++)
+      if (fabs(norm[i]) > fabs(norm[drop]))
+        drop = i;
+    u = (drop + 1) % 3;
+    v = (drop + 2) % 3;
+  }
+  // signed distance of C from the line AB, in the projection
+  double side(const Vec3d &A, const Vec3d &B, const Vec3d &C) const
+  {
+    double ab_u = B[u] - A[u];
+    double ab_v = B[v] - A[v];
+    double len = sqrt(ab_u * ab_u + ab_v * ab_v);
+    if (len == 0)
+      return 0;
+    return (ab_u * (C[v] - A[v]) - ab_v * (C[u] - A[u])) / len;
+  }
+};
+
+// Get the winding number of a face around a point
+int get_winding(const vector<Vec3d> &verts, FaceView face,
+                const Vec3d &P, const Proj2D &proj)
+{
+  int winding = 0;
+  size_t sz = face.size();
+  for (size_t i = 0; i < sz; i++) {
+    const Vec3d &A = verts[face[i]];
+    const Vec3d &B = verts[face[(i + 1) % sz]];
+    if ((A[proj.v] > P[proj.v]) != (B[proj.v] > P[proj.v])) {
+      double u = A[proj.u] + (P[proj.v] - A[proj.v]) *
+                                 (B[proj.u] - A[proj.u]) /
+                                 (B[proj.v] - A[proj.v]);
+      if (P[proj.u] < u)
+        winding += (B[proj.v] > A[proj.v]) ? 1 : -1;
+    }
+  }
+  return winding;
+}
+
+// A point is inside a face if its winding number is not zero, and it is
+// not on the face boundary
+bool is_strictly_inside(const vector<Vec3d> &verts, FaceView face,
+                        const Vec3d &P, const Proj2D &proj, double eps)
+{
+  return !is_on_boundary(verts, face, P, eps) &&
+         get_winding(verts, face, P, proj) != 0;
+}
+
+// Faces in the same plane overlap if their edges cross, or a vertex or
+// centroid of one is inside the other
+bool coplanar_faces_overlap(const vector<Vec3d> &verts,
+                            FaceView face0, FaceView face1,
+                            const FacePlane &plane,
+                            double eps)
+{
+  Proj2D proj(plane.norm);
+  size_t sz0 = face0.size();
+  size_t sz1 = face1.size();
+  for (size_t i = 0; i < sz0; i++) {
+    const Vec3d &A = verts[face0[i]];
+    const Vec3d &B = verts[face0[(i + 1) % sz0]];
+    for (size_t j = 0; j < sz1; j++) {
+      const Vec3d &C = verts[face1[j]];
+      const Vec3d &D = verts[face1[(j + 1) % sz1]];
+      double s0 = proj.side(A, B, C);
+      double s1 = proj.side(A, B, D);
+      double s2 = proj.side(C, D, A);
+      double s3 = proj.side(C, D, B);
+      if (((s0 > eps && s1 < -eps) || (s0 < -eps && s1 > eps)) &&
+          ((s2 > eps && s3 < -eps) || (s2 < -eps && s3 > eps)))
+        return true;
+    }
+  }
+
+  Vec3d cent0(0, 0, 0);
+  for (int v_idx : face0) {
+    if (is_strictly_inside(verts, face1, verts[v_idx], proj, eps))
+      return true;
+    cent0 += verts[v_idx];
+  }
+  Vec3d cent1(0, 0, 0);
+  for (int v_idx : face1) {
+    if (is_strictly_inside(verts, face0, verts[v_idx], proj, eps))
+      return true;
+    cent1 += verts[v_idx];
+  }
+
+  return is_strictly_inside(verts, face1, cent0 / sz0, proj, eps) ||
+         is_strictly_inside(verts, face0, cent1 / sz1, proj, eps);
+}
+
+bool faces_intersect(const Geometry &geom, int f_idx0, int f_idx1,
+                     const FacePlane &plane0, const FacePlane &plane1,
+                     double eps)
+{
+  if (!plane0.valid || !plane1.valid)
+    return false;
+
+  const vector<Vec3d> &verts = geom.verts();
+  FaceView face0 = geom.face_view(f_idx0);
+  FaceView face1 = geom.face_view(f_idx1);
+
+  bool coplanar0, coplanar1;
+  if (is_separated(verts, face0, plane1, eps, &coplanar0) ||
+      is_separated(verts, face1, plane0, eps, &coplanar1))
+    return false;
+
+  Vec3d dir = vcross(plane0.norm, plane1.norm);
+  if ((coplanar0 && coplanar1) || dir.len() < eps)
+    return coplanar_faces_overlap(verts, face0, face1, plane0, eps);
+  dir.to_unit();
+
+  // Scratch space, kept between calls so a test does not allocate
+  thread_local vector<Crossing> crossings;
+  thread_local vector<double> ts0;
+  thread_local vector<double> ts1;
+  get_sections(verts, face0, plane1, dir, eps, crossings, ts0);
+  if (ts0.empty())
+    return false;
+  get_sections(verts, face1, plane0, dir, eps, crossings, ts1);
+
+  for (size_t i = 0; i < ts0.size(); i += 2)
+    for (size_t j = 0; j < ts1.size(); j += 2)
+      if (std::min(ts0[i + 1], ts1[j + 1]) - std::max(ts0[i], ts1[j]) > eps)
+        return true;
+
+  return false;
+}
+
+// Get the candidate pairs and the face planes
+void prepare_intersection(const Geometry &geom, vector<pair<int, int>> &pairs,
+                          vector<FacePlane> &planes, double eps,
+                          int num_threads)
+{
+  FaceBVH bvh(geom, eps);
+  bvh.get_overlapping_pairs(pairs);
+  static TraceSite count_site("prepare_intersection.candidates");
+  trace_count(count_site, pairs.size());
+
+  planes.resize(geom.num_faces());
+  parallel_for(planes.size(),
+               [&](size_t i) { planes[i] = get_face_plane(geom, i, eps); },
+               num_threads);
+}
+
+} // namespace
+
+// --------------------------------------------------------------
+// SegmentQuery
+
+SegmentQuery::SegmentQuery(const Geometry &geom, double eps)
+    : geom(geom), eps(eps)
+{
+  geom.get_impl_edges(edges);
+
+  vert_faces.resize(geom.verts().size());
+  vector<vector<int>> vert_elems(geom.verts().size());
+  for (unsigned int i = 0; i < vert_faces.size(); i++)
+    vert_elems[i].push_back(i);
+  for (unsigned int i = 0; i < geom.num_faces(); i++)
+    for (int v_idx : geom.face_view(i))
+      if (vert_faces[v_idx].empty() || vert_faces[v_idx].back() != (int)i)
+        vert_faces[v_idx].push_back(i);
+
+  // allow for the tolerances of the element tests
+  double margin = 4 * eps;
+  vert_bvh.init(geom.verts(), vert_elems, margin);
+  edge_bvh.init(geom.verts(), edges, margin);
+  face_bvh.init(geom, margin);
+}
+
+int SegmentQuery::find_vertex(const Vec3d &P0, const Vec3d &P1) const
+{
+  thread_local vector<int> idxs;
+  vert_bvh.get_segment_overlaps(P0, P1, idxs);
+  for (int v_idx : idxs)
+    if (point_in_segment(geom.verts(v_idx), P0, P1, eps).is_set())
+      return v_idx;
+  return -1;
+}
+
+int SegmentQuery::find_edge(const Vec3d &P0, const Vec3d &P1) const
+{
+  thread_local vector<int> idxs;
+  edge_bvh.get_segment_overlaps(P0, P1, idxs);
+  for (int e_idx : idxs)
+    if (segments_intersection(P0, P1, geom.verts(edges[e_idx][0]),
+                              geom.verts(edges[e_idx][1]), eps)
+            .is_set())
+      return e_idx;
+  return -1;
+}
+
+int SegmentQuery::find_face(const Vec3d &P0, const Vec3d &P1) const
+{
+  thread_local vector<int> idxs;
+  face_bvh.get_segment_overlaps(P0, P1, idxs);
+  for (int f_idx : idxs) {
+    Vec3d face_normal = geom.face_norm(f_idx).unit();
+    Vec3d face_centroid = geom.face_cent(f_idx);
+    // make sure face_normal points outward
+    if (vdot(face_normal, face_centroid) < 0)
+      face_normal *= -1.0;
+
+    int where = 0;
+    Vec3d P =
+        line_plane_intersect(face_centroid, face_normal, P0, P1, &where, eps);
+
+    // if point is on the segment, and has a non-zero winding number
+    if (point_in_segment(P, P0, P1, eps).is_set()) {
+      Geometry polygon = faces_to_geom(geom, vector<int>(1, f_idx));
+      Normal normal(polygon, face_normal, 0, P1, eps);
+      if (get_winding_number_polygon(polygon, vector<Vec3d>(1, P), normal,
+                                     true, eps))
+        return f_idx;
+    }
+  }
+  return -1;
+}
+
+vector<int> SegmentQuery::get_edge_faces(int e_idx) const
+{
+  vector<int> f_idxs;
+  for (int f_idx : vert_faces[edges[e_idx][0]])
+    if (edge_exists_in_face(geom.face_view(f_idx), edges[e_idx]))
+      f_idxs.push_back(f_idx);
+  return f_idxs;
+}
+
+// --------------------------------------------------------------
+// Face intersection
+
+bool faces_intersect(const Geometry &geom, int f_idx0, int f_idx1, double eps)
+{
+  return faces_intersect(geom, f_idx0, f_idx1,
+                         get_face_plane(geom, f_idx0, eps),
+                         get_face_plane(geom, f_idx1, eps), eps);
+}
+
+void find_face_intersections(const Geometry &geom,
+                             vector<pair<int, int>> &pairs, double eps,
+                             int num_threads)
+{
+  static TraceSite trace_site("find_face_intersections");
+  TraceZone zone(trace_site);
+  vector<pair<int, int>> cands;
+  vector<FacePlane> planes;
+  prepare_intersection(geom, cands, planes, eps, num_threads);
+
+  vector<char> hits(cands.size());
+  parallel_for(cands.size(),
+               [&](size_t i) {
+                 int f0 = cands[i].first;
+                 int f1 = cands[i].second;
+                 hits[i] = faces_intersect(geom, f0, f1, planes[f0],
+                                           planes[f1], eps);
+               },
+               num_threads);
+
+  pairs.clear();
+  for (size_t i = 0; i < cands.size(); i++)
+    if (hits[i])
+      pairs.push_back(cands[i]);
+  std::sort(pairs.begin(), pairs.end());
+}
+
+bool has_face_intersections(const Geometry &geom, double eps, int num_threads)
+{
+  static TraceSite trace_site("has_face_intersections");
+  TraceZone zone(trace_site);
+  vector<pair<int, int>> cands;
+  vector<FacePlane> planes;
+  prepare_intersection(geom, cands, planes, eps, num_threads);
+
+  std::atomic<bool> found(false);
+  parallel_for(cands.size(),
+               [&](size_t i) {
+                 if (found)
+                   return;
+                 int f0 = cands[i].first;
+                 int f1 = cands[i].second;
+                 if (faces_intersect(geom, f0, f1, planes[f0], planes[f1],
+                                     eps))
+                   found = true;
+               },
+               num_threads);
+
+  return found;
+}
+
+} // namespace anti
@@ -0,0 +1,220 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file bvh.h
+   \brief A bounding volume hierarchy of faces, and face intersection
+*/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+
+namespace anti {
+
+/// A bounding volume hierarchy of the faces of a model
+/** Each node has a box aligned with the coordinate planes that bounds
+ *  its faces. The faces are split between two child nodes at the median
+ *  of their centres along the longest side of the box, until a node
+ *  holds only a few faces. */
+class FaceBVH {
+private:
+  struct Node {
+    Vec3d min;
+    Vec3d max;
+    int child; // index of the first of two child nodes, or -1 for a leaf
+    int start; // leaf faces start at this position in order
+    int num;   // number of leaf faces
+  };
+
+  std::vector<Node> nodes;
+  std::vector<int> order;
+  std::vector<Vec3d> face_mins;
+  std::vector<Vec3d> face_maxs;
+
+  void build(std::vector<Vec3d> &cents, int node_idx, int start, int num);
+  void init_elems(const std::vector<Vec3d> &verts,
+                  const std::vector<FaceView> &elems, double margin);
+  bool overlap(const Node &node0, const Node &node1) const;
+  bool face_overlap(int f_idx0, int f_idx1) const;
+  void get_self_pairs(int node,
+                      std::vector<std::pair<int, int>> &pairs) const;
+  void get_cross_pairs(int node0, int node1,
+                       std::vector<std::pair<int, int>> &pairs) const;
+
+public:
+  /// Constructor
+  FaceBVH() {}
+
+  /// Constructor
+  /**\param geom the model with the faces.
+   * \param margin enlarge the box of each face by this distance. */
+  FaceBVH(const Geometry &geom, double margin = 0) { init(geom, margin); }
+
+  /// Build the hierarchy
+  /** Faces with no vertices are not included.
+   * \param geom the model with the faces.
+   * \param margin enlarge the box of each face by this distance. */
+  void init(const Geometry &geom, double margin = 0);
+
+  /// Build the hierarchy for any elements
+  /** The elements are lists of vertex index numbers, such as faces, edges
+   *  or single vertices, and are referred to as faces. Elements with no
+   *  vertices are not included.
+   * \param verts the vertex coordinates.
+   * \param elems the elements.
+   * \param margin enlarge the box of each element by this distance. */
+  void init(const std::vector<Vec3d> &verts,
+            const std::vector<std::vector<int>> &elems, double margin = 0);
+
+  /// Get the number of faces in the hierarchy
+  /**\return The number of faces. */
+  size_t size() const { return order.size(); }
+
+  /// Get the faces with boxes that overlap a box
+  /**\param min the minimum coordinates of the box.
+   * \param max the maximum coordinates of the box.
+   * \param f_idxs to return the face index numbers. */
+  void get_overlaps(const Vec3d &min, const Vec3d &max,
+                    std::vector<int> &f_idxs) const;
+
+  /// Get the faces with boxes that a line segment meets
+  /**\param P0 one end of the segment.
+   * \param P1 the other end of the segment.
+   * \param f_idxs to return the face index numbers, in sorted order. */
+  void get_segment_overlaps(const Vec3d &P0, const Vec3d &P1,
+                            std::vector<int> &f_idxs) const;
+
+  /// Get the pairs of faces with boxes that overlap
+  /**\param pairs to return the pairs of face index numbers, with the
+   *  lower index number first, in no particular order. */
+  void get_overlapping_pairs(std::vector<std::pair<int, int>> &pairs) const;
+};
+
+/// Find the elements of a model that a line segment meets
+/** The vertices, implicit edges and faces are each held in a \c FaceBVH,
+ *  so a query only tests the elements near the segment. The model must
+ *  not change while the query is in use. */
+class SegmentQuery {
+private:
+  const Geometry &geom;
+  double eps;
+  std::vector<std::vector<int>> edges;
+  std::vector<std::vector<int>> vert_faces;
+  FaceBVH vert_bvh;
+  FaceBVH edge_bvh;
+  FaceBVH face_bvh;
+
+public:
+  /// Constructor
+  /**\param geom the model.
+   * \param eps a small number, distances less than this are taken as zero. */
+  SegmentQuery(const Geometry &geom, double eps = epsilon);
+
+  /// Get the implicit edges
+  /**\return The implicit edges, in the order of \c get_impl_edges(), which
+   *  is the order used for edge index numbers. */
+  const std::vector<std::vector<int>> &get_edges() const { return edges; }
+
+  /// Find the first vertex on a segment
+  /**\param P0 one end of the segment.
+   * \param P1 the other end of the segment.
+   * \return The lowest index number of a vertex on the segment, or \c -1
+   *  if there is no vertex on the segment. */
+  int find_vertex(const Vec3d &P0, const Vec3d &P1) const;
+
+  /// Find the first implicit edge that a segment meets
+  /**\param P0 one end of the segment.
+   * \param P1 the other end of the segment.
+   * \return The lowest index number of an edge that the segment meets, or
+   *  \c -1 if the segment does not meet an edge. */
+  int find_edge(const Vec3d &P0, const Vec3d &P1) const;
+
+  /// Find the first face that a segment meets
+  /** The segment meets a face where the line through it crosses the face
+   *  plane at a point on the segment with a non-zero winding number, found
+   *  with \c get_winding_number_polygon(). The winding number normal is
+   *  set up with \a P1 as the centre.
+   * \param P0 one end of the segment.
+   * \param P1 the other end of the segment.
+   * \return The lowest index number of a face that the segment meets, or
+   *  \c -1 if the segment does not meet a face. */
+  int find_face(const Vec3d &P0, const Vec3d &P1) const;
+
+  /// Get the faces that include a vertex
+  /**\param v_idx the vertex index number.
+   * \return The face index numbers, in sorted order. */
+  const std::vector<int> &get_vertex_faces(int v_idx) const
+  {
+    return vert_faces[v_idx];
+  }
+
+  /// Get the faces that include an implicit edge
+  /**\param e_idx the edge index number.
+   * \return The face index numbers, in sorted order. */
+  std::vector<int> get_edge_faces(int e_idx) const;
+};
+
+/// Check whether two faces intersect
+/** Faces intersect if their interiors cross or, for faces in the same
+ *  plane, overlap. Faces that only touch at their boundaries, such as
+ *  neighbouring faces, do not intersect. Faces with less than three
+ *  vertices never intersect.
+ * \param geom the model with the faces.
+ * \param f_idx0 the index number of the first face.
+ * \param f_idx1 the index number of the second face.
+ * \param eps a small number, distances less than this are taken as zero.
+ * \return \c true if the faces intersect, otherwise \c false. */
+bool faces_intersect(const Geometry &geom, int f_idx0, int f_idx1,
+                     double eps = epsilon);
+
+/// Find the pairs of faces that intersect
+/** The candidate pairs are found with a \c FaceBVH, and are tested on
+ *  several threads.
+ * \param geom the model with the faces.
+ * \param pairs to return the pairs of face index numbers, with the
+ *  lower index number first, in sorted order.
+ * \param eps a small number, distances less than this are taken as zero.
+ * \param num_threads the number of threads, or if \c 0 then use
+ *  \c get_num_threads(). */
+void find_face_intersections(const Geometry &geom,
+                             std::vector<std::pair<int, int>> &pairs,
+                             double eps = epsilon, int num_threads = 0);
+
+/// Check whether any faces intersect
+/** Testing stops when the first intersection is found.
+ * \param geom the model with the faces.
+ * \param eps a small number, distances less than this are taken as zero.
+ * \param num_threads the number of threads, or if \c 0 then use
+ *  \c get_num_threads().
+ * \return \c true if any faces intersect, otherwise \c false. */
+bool has_face_intersections(const Geometry &geom, double eps = epsilon,
+                            int num_threads = 0);
+
+} // namespace anti
+
+#endif // BVH_H
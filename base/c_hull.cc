@@ -39,6 +39,8 @@
 #include "geometry.h"
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "predicates.h"
+#include "trace.h"
 #include "utils.h"
 
 #include "qhull/qhull_ra.h"
@@ -184,9 +186,167 @@ static bool make_hull(Geometry &geom, bool append, string qh_args, char *errmsg)
   return true;
 }
 
+// Read the facet merge angle from hull arguments that are empty or a
+// single A option, otherwise return false
+static bool simple_hull_args(const string &qh_args, double *max_cos)
+{
+  *max_cos = 1.0;
+  size_t start = qh_args.find_first_not_of(" \t");
+  if (start == string::npos)
+    return true;
+  size_t end = qh_args.find_last_not_of(" \t") + 1;
+  string arg = qh_args.substr(start, end - start);
+  if (arg[0] == '-')
+    arg = arg.substr(1);
+  if (arg.size() < 2 || arg[0] != 'A')
+    return false;
+  char *num_end;
+  *max_cos = strtod(arg.c_str() + 1, &num_end);
+  return *num_end == '\0' && *max_cos > 0.0 && *max_cos <= 1.0;
+}
+
+// If the faces of the geometry already make its convex hull then orient
+// them outwards, remove the edges and face colours, and return true.
+// All the checks are local, and any doubtful case returns false so that
+// qhull is used. The faces must use every vertex, make a connected
+// closed oriented surface with Euler characteristic 2, be planar and
+// strictly convex, meet at strictly convex edges whose face normals are
+// further apart than the merge angle, and have a face angle sum at each
+// vertex of less than 360 degrees. A surface like this is the boundary of
+// a convex polyhedron.
+static bool hull_from_convex_faces(Geometry &geom, const string &qh_args)
+{
+  static TraceSite trace_site("hull_from_convex_faces");
+  TraceZone zone(trace_site);
+  double max_cos;
+  if (!simple_hull_args(qh_args, &max_cos))
+    return false;
+
+  const vector<Vec3d> &verts = geom.verts();
+  int num_verts = verts.size();
+  int num_faces = geom.faces().size();
+  if (num_verts < 4 || num_faces < 4)
+    return false;
+
+  Vec3d cent = geom.centroid();
+  double scale = 0.0;
+  for (const auto &v : verts)
+    scale = std::max(scale, (v - cent).len());
+  if (scale == 0.0)
+    return false;
+  const double tol = 1e-10 * scale;
+
+  // Faces: planar and strictly convex
+  vector<Vec3d> f_norms(num_faces);
+  vector<Vec3d> f_cents(num_faces);
+  vector<double> v_ang_sums(num_verts, 0.0);
+  vector<pair<pair<int, int>, int>> edge_faces; // (directed edge, face)
+  for (int f = 0; f < num_faces; f++) {
+    FaceView face = geom.face_view(f);
+    int f_sz = face.size();
+    if (f_sz < 3)
+      return false;
+    Vec3d norm = face_norm(verts, face, true);
+    double area = norm.len();
+    if (area < tol * tol)
+      return false;
+    norm /= area;
+    Vec3d f_cent = centroid(verts, face);
+    double ang_sum = 0.0;
+    for (int i = 0; i < f_sz; i++) {
+      const Vec3d &v0 = verts[face[(i + f_sz - 1) % f_sz]];
+      const Vec3d &v1 = verts[face[i]];
+      const Vec3d &v2 = verts[face[(i + 1) % f_sz]];
+      if (fabs(vdot(v1 - f_cent, norm)) > tol)
+        return false;
+      Vec3d e0 = v1 - v0;
+      Vec3d e1 = v2 - v1;
+      double e0_len = e0.len();
+      double e1_len = e1.len();
+      if (e0_len < tol || e1_len < tol ||
+          vdot(vcross(e0, e1), norm) < tol * (e0_len + e1_len))
+        return false;
+      double ang = acos(safe_for_trig(vdot(-e0, e1) / (e0_len * e1_len)));
+      ang_sum += ang;
+      v_ang_sums[face[i]] += ang;
+      edge_faces.push_back({{face[i], face[(i + 1) % f_sz]}, f});
+    }
+    // A strictly convex polygon that winds once
+    if (fabs(ang_sum - (f_sz - 2) * M_PI) > 1e-8 * f_sz)
+      return false;
+    f_norms[f] = norm;
+    f_cents[f] = f_cent;
+  }
+
+  for (double ang_sum : v_ang_sums)
+    if (ang_sum == 0.0 || ang_sum > 2 * M_PI - 1e-8)
+      return false;
+
+  // Edges: each directed edge once, paired with its reverse
+  auto edge_less = [](const pair<pair<int, int>, int> &e0,
+                      const pair<pair<int, int>, int> &e1) {
+    pair<int, int> key0(std::min(e0.first.first, e0.first.second),
+                        std::max(e0.first.first, e0.first.second));
+    pair<int, int> key1(std::min(e1.first.first, e1.first.second),
+                        std::max(e1.first.first, e1.first.second));
+    return key0 < key1 || (key0 == key1 && e0.first < e1.first);
+  };
+  std::sort(edge_faces.begin(), edge_faces.end(), edge_less);
+  size_t num_dir_edges = edge_faces.size();
+  if (num_dir_edges % 2)
+    return false;
+  int num_edges = num_dir_edges / 2;
+  if (num_verts - num_edges + num_faces != 2)
+    return false;
+
+  vector<int> f_parent(num_faces); // union-find for connectivity
+  for (int f = 0; f < num_faces; f++)
+    f_parent[f] = f;
+  std::function<int(int)> find_root = [&](int f) {
+    while (f_parent[f] != f)
+      f = f_parent[f] = f_parent[f_parent[f]];
+    return f;
+  };
+
+  int orient = 0; // 1 if faces point outwards, -1 if inwards
+  for (size_t i = 0; i < num_dir_edges; i += 2) {
+    const auto &e0 = edge_faces[i];
+    const auto &e1 = edge_faces[i + 1];
+    if (e0.first.first != e1.first.second ||
+        e0.first.second != e1.first.first ||
+        (i + 2 < num_dir_edges && !edge_less(e1, edge_faces[i + 2])))
+      return false;
+    int f0 = e0.second;
+    int f1 = e1.second;
+    if (f0 == f1 || vdot(f_norms[f0], f_norms[f1]) >= max_cos)
+      return false;
+    double dist = vdot(f_cents[f1] - f_cents[f0], f_norms[f0]);
+    int side = (dist < -tol) ? 1 : (dist > tol) ? -1 : 0;
+    if (side == 0 || (orient && side != orient))
+      return false;
+    orient = side;
+    f_parent[find_root(f0)] = find_root(f1);
+  }
+
+  int root = find_root(0);
+  for (int f = 1; f < num_faces; f++)
+    if (find_root(f) != root)
+      return false;
+
+  if (orient < 0)
+    geom.orient_reverse();
+  geom.clear(EDGES);
+  geom.colors(FACES).clear();
+  return true;
+}
+
 static int dimension_safe_make_hull(Geometry &geom, bool append, string qh_args,
                                     char *errmsg)
 {
+  static TraceSite trace_site("dimension_safe_make_hull");
+  TraceZone zone(trace_site);
+  static TraceSite count_site("dimension_safe_make_hull.input_points");
+  trace_count(count_site, geom.verts().size());
   // an empty geom should be the only reason an error can occur
   if (!(geom.verts().size())) {
     if (errmsg)
@@ -360,6 +520,16 @@ Status set_hull(Geometry &geom, string qh_args, int *dim)
   return stat;
 }
 
+Status set_hull_from_faces(Geometry &geom, string qh_args, int *dim)
+{
+  if (hull_from_convex_faces(geom, qh_args)) {
+    if (dim)
+      *dim = 3;
+    return Status::ok();
+  }
+  return set_hull(geom, qh_args, dim);
+}
+
 Status get_delaunay_edges(const vector<Vec3d> &verts,
                           map<pair<int, int>, int> &edges, string qh_args)
 {
@@ -408,10 +578,9 @@ Status get_delaunay_edges(const vector<Vec3d> &verts,
       continue;
 
     bool coplanar = true;
-    Vec3d v1 = verts[tet[1]] - verts[tet[0]];
-    Vec3d v2 = verts[tet[2]] - verts[tet[0]];
     for (unsigned int i = 3; i < tet.size(); i++)
-      if (fabs(vtriple(v1, v2, verts[tet[i]] - verts[tet[0]])) > epsilon) {
+      if (orient3d_compare(verts[tet[0]], verts[tet[1]], verts[tet[2]],
+                           verts[tet[i]], epsilon)) {
         coplanar = false;
         break;
       }
@@ -31,6 +31,7 @@
    Project: Antiprism - http://www.antiprism.com
 */
 
+#include <algorithm>
 #include <float.h>
 #include <math.h>
 #include <stdlib.h>
@@ -38,10 +39,10 @@
 #include <string>
 #include <vector>
 
-#include "boundbox.h"
 #include "geometry.h"
 #include "geometryinfo.h"
 #include "planar.h"
+#include "trace.h"
 
 using std::map;
 using std::string;
@@ -49,17 +50,16 @@ using std::vector;
 
 namespace anti {
 
-// RK - find nearpoints radius, sets range minimum and maximum
-double edge_nearpoints_radius(const Geometry &geom, double &min, double &max,
-                              Vec3d &center)
+// nearpoints radius of the edges, near_pts is work space
+static double nearpoints_radius(const Geometry &geom,
+                                const vector<vector<int>> &edges,
+                                vector<Vec3d> &near_pts, double &min,
+                                double &max, Vec3d &center)
 {
   min = DBL_MAX;
   max = DBL_MIN;
 
-  vector<vector<int>> edges;
-  geom.get_impl_edges(edges);
-
-  vector<Vec3d> near_pts;
+  near_pts.clear();
 
   double nearpt_radius = 0;
   int e_sz = edges.size();
@@ -80,6 +80,16 @@ double edge_nearpoints_radius(const Geometry &geom, double &min, double &max,
   return nearpt_radius / double(e_sz);
 }
 
+// RK - find nearpoints radius, sets range minimum and maximum
+double edge_nearpoints_radius(const Geometry &geom, double &min, double &max,
+                              Vec3d &center)
+{
+  vector<vector<int>> edges;
+  geom.get_impl_edges(edges);
+  vector<Vec3d> near_pts;
+  return nearpoints_radius(geom, edges, near_pts, min, max, center);
+}
+
 // RK - wrapper
 double edge_nearpoints_radius(const Geometry &geom)
 {
@@ -96,20 +106,115 @@ void unitize_nearpoints_radius(Geometry &geom)
   geom.transform(Trans3d::scale(1 / avg));
 }
 
+// return true if the vertex distances from cent are radius_range_percent
+// apart, relative to their average
+static bool radius_range_exceeded(const vector<Vec3d> &verts, const Vec3d &cent,
+                                  const double radius_range_percent)
+{
+  double min = 1e100;
+  double max = -1e100;
+  for (const auto &vert : verts) {
+    double dist = (vert - cent).len();
+    if (dist < min)
+      min = dist;
+    if (dist > max)
+      max = dist;
+  }
+
+  // min and max should always be positive, max should always be larger
+  return (((max - min) / ((max + min) / 2.0)) > radius_range_percent) ? true
+                                                                      : false;
+}
+
 // return true if maximum vertex radius is radius_range_percent (0.0 to ...)
 // greater than minimum vertex radius (visible for canonical.cc)
 bool canonical_radius_range_test(const Geometry &geom,
                                  const double radius_range_percent)
 {
-  GeometryInfo rep(geom);
-  rep.set_center(geom.centroid());
+  return radius_range_exceeded(geom.verts(), geom.centroid(),
+                               radius_range_percent);
+}
 
-  double min = rep.vert_dist_lims().min;
-  double max = rep.vert_dist_lims().max;
+GeometryMetrics::GeometryMetrics(const Geometry &geom)
+    : geom(geom), max_diff2(0), cent(Vec3d(0, 0, 0)),
+      min_coords(Vec3d(1e100, 1e100, 1e100)),
+      max_coords(Vec3d(-1e100, -1e100, -1e100))
+{
+  geom.get_impl_edges(edges);
 
-  // min and max should always be positive, max should always be larger
-  return (((max - min) / ((max + min) / 2.0)) > radius_range_percent) ? true
-                                                                      : false;
+  // index each face side into the sorted implicit edges
+  const vector<vector<int>> &faces = geom.faces();
+  face_edges.resize(faces.size());
+  for (unsigned int f = 0; f < faces.size(); f++) {
+    const unsigned int f_sz = faces[f].size();
+    face_edges[f].resize(f_sz);
+    for (unsigned int v = 0; v < f_sz; v++) {
+      auto ei = lower_bound(edges.begin(), edges.end(),
+                            make_edge(faces[f][v], faces[f][(v + 1) % f_sz]));
+      face_edges[f][v] = ei - edges.begin();
+    }
+  }
+
+  verts_last.reserve(geom.verts().size());
+}
+
+Vec3d GeometryMetrics::edge_nearpts_centroid(Vec3d cent) const
+{
+  Vec3d e_cent(0, 0, 0);
+  for (const auto &edge : edges)
+    e_cent += geom.edge_nearpt(edge, cent);
+  return e_cent / double(edges.size());
+}
+
+double GeometryMetrics::edge_nearpts_radius(double &min, double &max,
+                                            Vec3d &center)
+{
+  return nearpoints_radius(geom, edges, near_pts, min, max, center);
+}
+
+void GeometryMetrics::save_verts()
+{
+  verts_last.assign(geom.verts().begin(), geom.verts().end());
+}
+
+// one pass over the vertices for the displacement, bounding box and centroid
+void GeometryMetrics::update_vert_metrics(const vector<Vec3d> *offsets)
+{
+  const vector<Vec3d> &verts = geom.verts();
+  max_diff2 = 0;
+  min_coords = Vec3d(1e100, 1e100, 1e100);
+  max_coords = Vec3d(-1e100, -1e100, -1e100);
+  Vec3d sum(0, 0, 0);
+  for (unsigned int i = 0; i < verts.size(); i++) {
+    const Vec3d &vert = verts[i];
+    // len2() for difference value to minimize internal sqrt() calls
+    double diff2 =
+        offsets ? (*offsets)[i].len2() : (vert - verts_last[i]).len2();
+    if (diff2 > max_diff2)
+      max_diff2 = diff2;
+
+    for (int j = 0; j < 3; j++) {
+      if (vert[j] < min_coords[j])
+        min_coords[j] = vert[j];
+      if (vert[j] > max_coords[j])
+        max_coords[j] = vert[j];
+    }
+    sum += vert;
+  }
+  sum /= verts.size();
+  cent = sum;
+}
+
+void GeometryMetrics::update() { update_vert_metrics(nullptr); }
+
+void GeometryMetrics::update(const vector<Vec3d> &offsets)
+{
+  update_vert_metrics(&offsets);
+}
+
+bool GeometryMetrics::radius_range_test(const double radius_range_percent) const
+{
+  return radius_range_exceeded(geom.verts(), cent, radius_range_percent);
 }
 
 // Implementation of George Hart's canonicalization algorithm
@@ -123,20 +228,27 @@ bool canonicalize_mm(Geometry &geom, const double edge_factor,
                      const bool alternate_loop, const bool planar_only,
                      const char normal_type, const double eps)
 {
+  static TraceSite trace_site("canonicalize_mm");
+  TraceZone zone(trace_site);
   bool completed = false;
 
   vector<Vec3d> &verts = geom.raw_verts();
 
-  vector<vector<int>> edges;
-  geom.get_impl_edges(edges);
+  GeometryMetrics metrics(geom);
+  const vector<vector<int>> &edges = metrics.get_impl_edges();
+
+  // work arrays kept between iterations
+  vector<Vec3d> near_pts;
+  near_pts.reserve(edges.size());
+  vector<Vec3d> vs(verts.size());
 
   double max_diff2 = 0;
   unsigned int cnt;
   for (cnt = 0; cnt < (unsigned int)num_iters;) {
-    vector<Vec3d> verts_last = verts;
+    metrics.save_verts();
 
     if (!planar_only) {
-      vector<Vec3d> near_pts;
+      near_pts.clear();
       if (!alternate_loop) {
         for (auto &edge : edges) {
           Vec3d P = geom.edge_nearpt(edge, Vec3d(0, 0, 0));
@@ -183,11 +295,10 @@ bool canonicalize_mm(Geometry &geom, const double edge_factor,
         verts[i] -= cent_near_pts;
     }
 
-    // Make a copy of verts into vs and zero out
+    // Zero out vs
     // Accumulate vertex changes instead of altering vertices in place
     // This can help relieve when a vertex is pushed towards one plane
     // and away from another
-    vector<Vec3d> vs = verts;
     for (auto &v : vs)
       v = Vec3d(0, 0, 0);
 
@@ -212,13 +323,8 @@ bool canonicalize_mm(Geometry &geom, const double edge_factor,
     for (unsigned int i = 0; i < vs.size(); i++)
       verts[i] += vs[i];
 
-    // len2() for difference value to minimize internal sqrt() calls
-    max_diff2 = 0;
-    for (unsigned int i = 0; i < verts.size(); i++) {
-      double diff2 = (verts[i] - verts_last[i]).len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+    metrics.update();
+    max_diff2 = metrics.get_max_diff2();
 
     // increment count here for reporting
     cnt++;
@@ -233,7 +339,7 @@ bool canonicalize_mm(Geometry &geom, const double edge_factor,
 
     // if minimum and maximum radius are differing, the polyhedron is crumpling
     if (radius_range_percent &&
-        canonical_radius_range_test(geom, radius_range_percent)) {
+        metrics.radius_range_test(radius_range_percent)) {
       fprintf(
           stderr,
           "\nbreaking out: radius range detected. try increasing percentage\n");
@@ -241,6 +347,9 @@ bool canonicalize_mm(Geometry &geom, const double edge_factor,
     }
   }
 
+  static TraceSite count_site("canonicalize_mm.iterations");
+  trace_count(count_site, cnt);
+
   if (rep_count > -1) {
     fprintf(stderr, "\n%-15d final max_diff=%.17g\n", cnt, sqrt(max_diff2));
     fprintf(stderr, "\n");
@@ -392,7 +501,7 @@ Vec3d face_norm_nonplanar_triangles(const Geometry &geom,
 // return the normal of all perimeter triangles
 Vec3d face_norm_nonplanar_triangles(const Geometry &geom, const int f_idx)
 {
-  vector<int> face = geom.faces(f_idx);
+  const vector<int> &face = geom.faces(f_idx);
   return face_norm_nonplanar_triangles(geom, face);
 }
 
@@ -418,7 +527,7 @@ Vec3d face_norm_nonplanar_quads(const Geometry &geom, const vector<int> &face)
 // return the normal of quads in polygon
 Vec3d face_norm_nonplanar_quads(const Geometry &geom, const int f_idx)
 {
-  vector<int> face = geom.faces(f_idx);
+  const vector<int> &face = geom.faces(f_idx);
   return face_norm_nonplanar_quads(geom, face);
 }
 
@@ -442,18 +551,21 @@ Vec3d face_normal_by_type(const Geometry &geom, const vector<int> &face,
 Vec3d face_normal_by_type(const Geometry &geom, const int f_idx,
                           const char normal_type)
 {
-  vector<int> face = geom.faces(f_idx);
+  const vector<int> &face = geom.faces(f_idx);
   return face_normal_by_type(geom, face, normal_type);
 }
 
 // reciprocalN() is from the Hart's Conway Notation web page
 // make array of vertices reciprocal to given planes (face normals)
 // RK - has accuracy issues and will have trouble with -l 16
-vector<Vec3d> reciprocalN(const Geometry &geom, const char normal_type)
+// normals is resized to the number of faces, and is usually the vertices of
+// the other geometry in the base/dual pair, so no storage is allocated
+void reciprocalN(const Geometry &geom, const char normal_type,
+                 vector<Vec3d> &normals)
 {
-  vector<Vec3d> normals;
-
-  for (const auto &face : geom.faces()) {
+  normals.resize(geom.faces().size());
+  for (unsigned int f = 0; f < geom.faces().size(); f++) {
+    const vector<int> &face = geom.faces(f);
     // RK - the algoritm was written to use triangles for measuring
     // non-planar faces. Now method can be chosen
     Vec3d face_normal = face_normal_by_type(geom, face, normal_type).unit();
@@ -487,30 +599,24 @@ vector<Vec3d> reciprocalN(const Geometry &geom, const char normal_type)
     // edge correction (of v based on all edges of the face)
     ans *= (1 + avgEdgeDist) / 2;
 
-    normals.push_back(ans);
+    normals[f] = ans;
   }
-
-  return normals;
 }
 
 // reciprocate on face centers dividing by magnitude squared
-vector<Vec3d> reciprocalC_len2(const Geometry &geom)
+void reciprocalC_len2(const Geometry &geom, vector<Vec3d> &centers)
 {
-  vector<Vec3d> centers;
   geom.face_cents(centers);
   for (auto &center : centers)
     center /= center.len2();
-  return centers;
 }
 
 // reciprocate on face centers dividing by magnitude
-vector<Vec3d> reciprocalC_len(const Geometry &geom)
+void reciprocalC_len(const Geometry &geom, vector<Vec3d> &centers)
 {
-  vector<Vec3d> centers;
   geom.face_cents(centers);
   for (auto &center : centers)
     center /= center.len();
-  return centers;
 }
 
 // Addition to algorithm by Adrian Rossiter
@@ -534,6 +640,8 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
                      const char centering, const char normal_type,
                      const double eps)
 {
+  static TraceSite trace_site("canonicalize_bd");
+  TraceZone zone(trace_site);
   bool completed = false;
 
   Geometry dual;
@@ -541,18 +649,20 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
   get_dual(dual, base, 1);
   dual.clear_cols();
 
+  GeometryMetrics metrics(base);
+
   double max_diff2 = 0;
   unsigned int cnt;
   for (cnt = 0; cnt < (unsigned int)num_iters;) {
-    vector<Vec3d> base_verts_last = base.verts();
+    metrics.save_verts();
 
     switch (canonical_method) {
     // base/dual canonicalize method
     case 'b': {
-      dual.raw_verts() = reciprocalN(base, normal_type);
-      base.raw_verts() = reciprocalN(dual, normal_type);
+      reciprocalN(base, normal_type, dual.raw_verts());
+      reciprocalN(dual, normal_type, base.raw_verts());
       if (centering != 'x') {
-        Vec3d e_cent = edge_nearpoints_centroid(base, Vec3d(0, 0, 0));
+        Vec3d e_cent = metrics.edge_nearpts_centroid(Vec3d(0, 0, 0));
         base.transform(Trans3d::translate(-0.1 * e_cent));
       }
       break;
@@ -561,18 +671,18 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
     // adjust vertices with side effect of planarization. len2() version
     case 'p':
       // move centroid to origin for balance
-      dual.raw_verts() = reciprocalC_len2(base);
+      reciprocalC_len2(base, dual.raw_verts());
       base.transform(Trans3d::translate(-centroid(dual.verts())));
-      base.raw_verts() = reciprocalC_len2(dual);
+      reciprocalC_len2(dual, base.raw_verts());
       base.transform(Trans3d::translate(-centroid(base.verts())));
       break;
 
     // adjust vertices with side effect of planarization. len() version
     case 'q':
       // move centroid to origin for balance
-      dual.raw_verts() = reciprocalC_len(base);
+      reciprocalC_len(base, dual.raw_verts());
       base.transform(Trans3d::translate(-centroid(dual.verts())));
-      base.raw_verts() = reciprocalC_len(dual);
+      reciprocalC_len(dual, base.raw_verts());
       base.transform(Trans3d::translate(-centroid(base.verts())));
       break;
 
@@ -583,13 +693,8 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
       break;
     }
 
-    // len2() for difference value to minimize internal sqrt() calls
-    max_diff2 = 0;
-    for (unsigned int i = 0; i < base.verts().size(); i++) {
-      double diff2 = (base.verts(i) - base_verts_last[i]).len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+    metrics.update();
+    max_diff2 = metrics.get_max_diff2();
 
     // increment count here for reporting
     cnt++;
@@ -604,7 +709,7 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
 
     // if minimum and maximum radius are differing, the polyhedron is crumpling
     if (radius_range_percent &&
-        canonical_radius_range_test(base, radius_range_percent)) {
+        metrics.radius_range_test(radius_range_percent)) {
       fprintf(
           stderr,
           "\nbreaking out: radius range detected. try increasing percentage\n");
@@ -612,6 +717,9 @@ bool canonicalize_bd(Geometry &base, const int num_iters,
     }
   }
 
+  static TraceSite count_site("canonicalize_bd.iterations");
+  trace_count(count_site, cnt);
+
   if (rep_count > -1) {
     fprintf(stderr, "\n%-15d final max_diff=%.17g\n", cnt, sqrt(max_diff2));
     fprintf(stderr, "\n");
@@ -652,6 +760,8 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
                         const int rep_count, const char normal_type,
                         const double eps)
 {
+  static TraceSite trace_site("minmax_unit_planar");
+  TraceZone zone(trace_site);
   bool completed = false;
 
   // do a scale to get edges close to 1
@@ -674,13 +784,18 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
     // fprintf(stderr, "{%d/%d} rad=%g\n", N, D, rads[f]);
   }
 
+  GeometryMetrics metrics(geom);
+  const vector<vector<int>> &edges = metrics.get_impl_edges();
+  const vector<vector<int>> &face_edges = metrics.get_face_edges();
+
+  // Vertx offsets for the iteration.
+  vector<Vec3d> offsets(verts.size());
+
   double max_diff2 = 0;
   unsigned int cnt = 0;
   for (cnt = 0; cnt < (unsigned int)num_iters;) {
-    vector<Vec3d> old_verts = verts;
-
-    // Vertx offsets for the iteration.
-    vector<Vec3d> offsets(verts.size(), Vec3d::zero);
+    for (auto &offset : offsets)
+      offset = Vec3d::zero;
     for (unsigned int ff = cnt; ff < faces.size() + cnt; ff++) {
       const unsigned int f = ff % faces.size();
       const vector<int> &face = faces[f];
@@ -694,7 +809,7 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
       for (unsigned int vv = cnt; vv < f_sz + cnt; vv++) {
         unsigned int v = vv % f_sz;
         // offset for unit edges
-        vector<int> edge = make_edge(face[v], face[(v + 1) % f_sz]);
+        const vector<int> &edge = edges[face_edges[f][v]];
         Vec3d offset =
             (1 - geom.edge_len(edge)) * shorten_factor * geom.edge_vec(edge);
         offsets[edge[0]] -= offset;
@@ -714,12 +829,8 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
     for (unsigned int i = 0; i < offsets.size(); i++)
       geom.raw_verts()[i] += offsets[i];
 
-    max_diff2 = 0;
-    for (auto &offset : offsets) {
-      double diff2 = offset.len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+    metrics.update(offsets);
+    max_diff2 = metrics.get_max_diff2();
 
     // increment count here for reporting
     cnt++;
@@ -727,7 +838,7 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
     if ((rep_count > -1) && (cnt % rep_count == 0))
       fprintf(stderr, "%-15d max_diff=%.17g\n", cnt, sqrt(max_diff2));
 
-    double width = BoundBox(verts).max_width();
+    double width = metrics.get_max_width();
     if (sqrt(max_diff2) / width < eps) {
       completed = true;
       break;
@@ -735,7 +846,7 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
 
     // if minimum and maximum radius are differing, the polyhedron is crumpling
     if (radius_range_percent &&
-        canonical_radius_range_test(geom, radius_range_percent)) {
+        metrics.radius_range_test(radius_range_percent)) {
       fprintf(
           stderr,
           "\nbreaking out: radius range detected. try increasing percentage\n");
@@ -743,6 +854,9 @@ bool minmax_unit_planar(Geometry &geom, const double shorten_factor,
     }
   }
 
+  static TraceSite count_site("minmax_unit_planar.iterations");
+  trace_count(count_site, cnt);
+
   if (rep_count > -1) {
     fprintf(stderr, "\n%-15d final max_diff=%.17g\n", cnt, sqrt(max_diff2));
     fprintf(stderr, "\n");
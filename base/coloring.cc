@@ -68,14 +68,21 @@ Coloring &Coloring::operator=(const Coloring &clrng)
   return *this;
 }
 
-void Coloring::cycle_map_cols() { set_shift(get_shift() + 1); }
+void Coloring::cycle_map_cols()
+{
+  bool baked = is_baked();
+  set_shift(get_shift() + 1);
+  if (baked)
+    rebake();
+}
 
 void Coloring::set_all_idx_to_val(map<int, Color> &cols)
 {
   map<int, Color>::iterator mi;
+  bake(cols);
   for (mi = cols.begin(); mi != cols.end(); mi++)
     if (mi->second.is_index())
-      mi->second = get_col(mi->second.get_index());
+      mi->second = lookup(mi->second.get_index());
 }
 
 inline double fract(double rng[], double frac)
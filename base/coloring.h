@@ -106,7 +106,8 @@ public:
 
   /// Cycle the map colours
   /** Each colour index number is mapped to the previous colour
-   *  value in the colour map. */
+   *  value in the colour map. Baked colour values are baked again
+   *  for the new mapping. */
   void cycle_map_cols();
 
   /// Set the time between colour map cycles
@@ -1032,6 +1032,7 @@ Status ColorMapMulti::init(const char *map_name)
   map_sz = -1;
   while (cmaps.size())
     del_cmap();
+  unbake();
 
   char names[MSG_SZ];
   strcpy_msg(names, map_name);
@@ -1069,6 +1070,11 @@ ColorMapMulti::ColorMapMulti(const ColorMapMulti &cmap) : ColorMap(cmap)
   max_eff_map_sz = cmap.max_eff_map_sz;
   for (auto i : cmap.cmaps)
     add_cmap(i->clone());
+  baked_cols = cmap.baked_cols;
+  baked_start = cmap.baked_start;
+  baked_shift = cmap.baked_shift;
+  baked_step = cmap.baked_step;
+  baked_wrap = cmap.baked_wrap;
 }
 
 ColorMapMulti &ColorMapMulti::operator=(const ColorMapMulti &cmap)
@@ -1081,6 +1087,11 @@ ColorMapMulti &ColorMapMulti::operator=(const ColorMapMulti &cmap)
       del_cmap();
     for (auto i : cmap.cmaps)
       add_cmap(i->clone());
+    baked_cols = cmap.baked_cols;
+    baked_start = cmap.baked_start;
+    baked_shift = cmap.baked_shift;
+    baked_step = cmap.baked_step;
+    baked_wrap = cmap.baked_wrap;
   }
   return *this;
 }
@@ -1104,6 +1115,7 @@ void ColorMapMulti::add_cmap(ColorMap *col_map, unsigned int pos)
   else
     mi = cmaps.begin() + pos;
   cmaps.insert(mi, col_map);
+  unbake();
   if (col_map->effective_size() > max_eff_map_sz)
     max_eff_map_sz = col_map->effective_size();
   if (col_map->get_wrap() != 0)
@@ -1121,6 +1133,7 @@ void ColorMapMulti::del_cmap(unsigned int pos)
     delete *mi;
     cmaps.erase(mi);
     set_max_eff_map_sz();
+    unbake();
   }
 }
 
@@ -1141,6 +1154,40 @@ Color ColorMapMulti::get_col(int idx) const
   return col.is_set() ? col : Color(idx);
 }
 
+void ColorMapMulti::bake(int start, int end)
+{
+  unbake();
+  if (end <= start || (long)end - start > max_baked_sz)
+    return;
+
+  baked_start = start;
+  baked_shift = get_shift();
+  baked_step = get_step();
+  baked_wrap = get_wrap();
+  baked_cols.resize(end - start);
+  for (int i = start; i < end; i++)
+    baked_cols[i - start] = get_col(i);
+}
+
+void ColorMapMulti::bake(const map<int, Color> &cols)
+{
+  int start = INT_MAX;
+  int last = INT_MIN;
+  for (const auto &kp : cols) {
+    if (kp.second.is_index()) {
+      start = std::min(start, kp.second.get_index());
+      last = std::max(last, kp.second.get_index());
+    }
+  }
+
+  // Don't resolve more colours than there are elements
+  if (start <= last && last < INT_MAX &&
+      (long)last - start < (long)cols.size())
+    bake(start, last + 1);
+  else
+    unbake();
+}
+
 //-----------------------------------------------------------------------
 
 static ColorMap *colormap_from_name_generated(const char *map_name,
@@ -243,9 +243,25 @@ private:
   // Set map_sz to the largest effective size
   void set_max_eff_map_sz();
 
+  // Colours baked for consecutive index numbers, starting at baked_start
+  std::vector<Color> baked_cols;
+  int baked_start;
+
+  // Map parameters when the colours were baked
+  int baked_shift;
+  int baked_step;
+  int baked_wrap;
+
 public:
+  /// Largest number of colours that will be baked
+  enum { max_baked_sz = 1 << 20 };
+
   /// Constructor
-  ColorMapMulti() : ColorMap(), max_eff_map_sz(0), map_sz(-1) {}
+  ColorMapMulti()
+      : ColorMap(), max_eff_map_sz(0), map_sz(-1), baked_start(0),
+        baked_shift(0), baked_step(1), baked_wrap(0)
+  {
+  }
 
   /// Copy Constructor
   /**\param cmap the multiple colour map to copy from. */
@@ -276,7 +292,11 @@ public:
 
   /// Set the map size
   /**\param sz the number of entries in the map. */
-  void set_map_sz(int sz) { map_sz = sz; }
+  void set_map_sz(int sz)
+  {
+    map_sz = sz;
+    unbake();
+  }
 
   /// The effective size of the map
   /** The effective size of a map is one greater than the highest
@@ -313,6 +333,53 @@ public:
   /**\param idx the index.
    * \return The colour. */
   virtual Color get_col(int idx) const;
+
+  /// Bake the colour values for a range of index numbers
+  /** The colours are resolved once, with the shift, step and wrap
+   *  applied, and stored in a table used by \c lookup(). The table is
+   *  cleared when maps are added, deleted or initialised, and is not used
+   *  after the shift, step or wrap are changed. Call \c unbake() after
+   *  changing a map returned by \c get_cmaps(). A range of more than
+   *  \c max_baked_sz index numbers is not baked.
+   * \param start the first index number.
+   * \param end one past the last index number. */
+  void bake(int start, int end);
+
+  /// Bake the colour values for the index numbers used by some elements
+  /** The range from the lowest to the highest index number is baked,
+   *  unless it is larger than the number of elements.
+   * \param cols the colours of the elements, by element index. */
+  void bake(const std::map<int, Color> &cols);
+
+  /// Bake the range of index numbers that was last baked again
+  /** This is used to refresh the table after the map parameters have
+   *  changed. */
+  void rebake() { bake(baked_start, baked_start + baked_cols.size()); }
+
+  /// Clear the table of baked colour values
+  void unbake() { baked_cols.clear(); }
+
+  /// Check whether the baked colour values can be used
+  /**\return \c true if colour values are baked for the current map
+   *  parameters, otherwise \c false. */
+  bool is_baked() const
+  {
+    return !baked_cols.empty() && baked_shift == get_shift() &&
+           baked_step == get_step() && baked_wrap == get_wrap();
+  }
+
+  /// Look up the colour value for an index number.
+  /** The value is taken from the baked table if it includes the index
+   *  number, otherwise it is found with \c get_col().
+   * \param idx the index.
+   * \return The colour. */
+  Color lookup(int idx) const
+  {
+    unsigned int pos = (unsigned int)idx - (unsigned int)baked_start;
+    if (pos < baked_cols.size() && is_baked())
+      return baked_cols[pos];
+    return get_col(idx);
+  }
 };
 
 /// Create a colour map from its name
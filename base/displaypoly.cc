@@ -28,6 +28,7 @@
 */
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string.h>
 #include <string>
@@ -58,7 +59,7 @@ Color DisplayPoly::def_col(int type)
 {
   Color col = elem(type).get_col();
   if (col.is_index())
-    col = clrng(type).get_col(col.get_index());
+    col = clrng(type).lookup(col.get_index());
 
   Color def_cols[]{Color(1.0, 0.5, 0.0), Color(0.8, 0.6, 0.8),
                    Color(0.8, 0.9, 0.9)};
@@ -89,6 +90,10 @@ void DisplayPoly::geom_changed()
         disp_geom.colors(FACES).set(f_idx, col);
     }
   }
+
+  // Resolve the colour index numbers used by the display geometry once
+  for (int i = 0; i < 3; i++)
+    clrngs[i].bake(disp_geom.colors(i).get_properties());
 }
 
 void DisplayPoly::set_triangulate(bool tri)
@@ -310,7 +315,7 @@ void DisplayPoly::vrml_verts(FILE *ofile, int sig_digits)
             vrml_vec(vs[i], sig_digits).c_str());
     Color col = disp_geom.colors(VERTS).get(i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
+      col = clrng(FACES).lookup(col.get_index());
     if (col.is_value())
       fprintf(ofile, "clr %s trn %.4f", vrml_col(col).c_str(),
               col.get_transparency_d());
@@ -364,7 +369,7 @@ void DisplayPoly::vrml_edges(FILE *ofile)
 
     Color col = disp_geom.colors(EDGES).get((int)i);
     if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
+      col = clrng(EDGES).lookup(col.get_index());
     if (col.is_value())
       fprintf(ofile, "clr %s trn %.4f", vrml_col(col).c_str(),
               col.get_transparency_d());
@@ -418,7 +423,7 @@ void DisplayPoly::vrml_faces(FILE *ofile)
 
     Color col = disp_geom.colors(FACES).get((int)i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
+      col = clrng(FACES).lookup(col.get_index());
     if (col.is_invisible())
       continue;
     if (col.is_value())
@@ -449,7 +454,7 @@ void DisplayPoly::vrml_faces(FILE *ofile)
           continue;
         Color col = disp_geom.colors(FACES).get((int)idx);
         if (col.is_index())
-          col = clrng(FACES).get_col(col.get_index());
+          col = clrng(FACES).lookup(col.get_index());
         fprintf(ofile, "%s, ", vrml_col(col).c_str());
         if (!((++f_cnt) % 3))
           fprintf(ofile, "\n\t");
@@ -463,14 +468,8 @@ void DisplayPoly::vrml_faces(FILE *ofile)
   fprintf(ofile, "\n\n\n");
 }
 
-void DisplayPoly::vrml_geom(FILE *ofile, const Scene &scen, int sig_digits)
+void DisplayPoly::vrml_elems(FILE *ofile, int sig_digits)
 {
-  if (disp_geom.verts().size() == 0) // Don't write out empty geometries
-    return;
-
-  vrml_protos(ofile);
-  vrml_translation_begin(ofile, scen);
-
   if (elem(FACES).get_show() || use_lines)
     vrml_coords(ofile, sig_digits);
   if (elem(VERTS).get_show()) {
@@ -487,7 +486,65 @@ void DisplayPoly::vrml_geom(FILE *ofile, const Scene &scen, int sig_digits)
   }
   if (elem(FACES).get_show())
     vrml_faces(ofile);
+}
+
+void DisplayPoly::vrml_instances(FILE *ofile, const vector<Trans3d> &insts,
+                                 int sig_digits)
+{
+  if (insts.empty()) {
+    vrml_elems(ofile, sig_digits);
+    return;
+  }
+
+  // The elements are written once, in the first instance, and used
+  // by the others
+  string inst_name = "Inst" + get_id_label() + "_" +
+                     dots2underscores(sc_geom->get_name());
+  for (unsigned int i = 0; i < insts.size(); i++) {
+    // A Transform has no general matrix, so an improper transformation
+    // is written as a rotation with a scale of -1
+    Trans3d rot = insts[i];
+    const bool improper = rot.det() < 0;
+    for (int r = 0; r < 3; r++) {
+      rot[r * 4 + 3] = 0.0;
+      if (improper)
+        for (int c = 0; c < 3; c++)
+          rot[r * 4 + c] *= -1;
+    }
+    Vec4d quat = rot.get_quaternion();
+    Vec3d axis(quat[0], quat[1], quat[2]);
+    double ang = 2 * atan2(axis.len(), quat[3]);
+    axis = (axis.len() > epsilon) ? axis.unit() : Vec3d(0, 0, 1);
+
+    fprintf(ofile,
+            "Transform {\n"
+            "   rotation %s %s\n"
+            "%s"
+            "   translation %s\n"
+            "   children [\n",
+            vrml_vec(axis, sig_digits).c_str(), dtostr(ang, sig_digits).c_str(),
+            (improper) ? "   scale -1 -1 -1\n" : "",
+            vrml_vec(insts[i][3], insts[i][7], insts[i][11], sig_digits)
+                .c_str());
+    if (i == 0) {
+      fprintf(ofile, "DEF %s Group {\n   children [\n", inst_name.c_str());
+      vrml_elems(ofile, sig_digits);
+      fprintf(ofile, "   ]\n}\n");
+    }
+    else
+      fprintf(ofile, "USE %s\n", inst_name.c_str());
+    fprintf(ofile, "   ]\n}\n");
+  }
+}
 
+void DisplayPoly::vrml_geom(FILE *ofile, const Scene &scen, int sig_digits)
+{
+  if (disp_geom.verts().size() == 0) // Don't write out empty geometries
+    return;
+
+  vrml_protos(ofile);
+  vrml_translation_begin(ofile, scen);
+  vrml_instances(ofile, sc_geom->get_instances(), sig_digits);
   vrml_translation_end(ofile);
 }
 
@@ -602,7 +659,7 @@ void DisplayPoly::pov_vert_arrays(FILE *ofile, int sig_digits)
   for (unsigned int i = 0; i < vs.size(); i++) {
     Color col = disp_geom.colors(VERTS).get((int)i);
     if (col.is_index())
-      col = clrng(VERTS).get_col(col.get_index());
+      col = clrng(VERTS).lookup(col.get_index());
     if (col.is_set())
       fprintf(ofile, "#declare v_cols[%d]=%s;\n", i, pov_col(col).c_str());
   }
@@ -631,7 +688,7 @@ void DisplayPoly::pov_edge_arrays(FILE *ofile)
   for (unsigned int i = 0; i < es.size(); i++) {
     Color col = disp_geom.colors(EDGES).get((int)i);
     if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
+      col = clrng(EDGES).lookup(col.get_index());
     if (col.is_set())
       fprintf(ofile, "#declare e_cols[%d]=%s;\n", i, pov_col(col).c_str());
   }
@@ -669,7 +726,7 @@ void DisplayPoly::pov_face_arrays(FILE *ofile)
   for (unsigned int i = 0; i < fs.size(); i++) {
     Color col = disp_geom.colors(FACES).get((int)i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
+      col = clrng(FACES).lookup(col.get_index());
     if (col.is_set())
       fprintf(ofile, "#declare f_cols[%d]=%s;\n", i, pov_col(col).c_str());
   }
@@ -1215,7 +1272,14 @@ void DisplaySymmetry::geom_changed() { disp_changed(); }
 void DisplaySymmetry::vrml_geom(FILE *ofile, const Scene &scen,
                                 int /*sig_dgts*/)
 {
-  DisplayPoly::vrml_geom(ofile, scen, 4);
+  if (disp_geom.verts().size() == 0) // Don't write out empty geometries
+    return;
+
+  // symmetry elements are not repeated by the geometry instances
+  vrml_protos(ofile);
+  vrml_translation_begin(ofile, scen);
+  vrml_elems(ofile, 4);
+  vrml_translation_end(ofile);
 }
 
 void DisplaySymmetry::pov_geom(FILE *ofile, const Scene &scen, int /*sig_dgts*/)
@@ -1233,6 +1297,30 @@ ViewOpts::ViewOpts(const char *name) : ProgramOpts(name)
   sym_defs = new DisplaySymmetry();
 }
 
+ViewOpts::ViewOpts(const ViewOpts &opts)
+    : ProgramOpts(opts), inst_trans(opts.inst_trans),
+      scen_defs(opts.scen_defs), cam_defs(opts.cam_defs), ifiles(opts.ifiles)
+{
+  geom_defs = dynamic_cast<DisplayPoly *>(opts.geom_defs->clone());
+  lab_defs = dynamic_cast<DisplayNumLabels *>(opts.lab_defs->clone());
+  sym_defs = dynamic_cast<DisplaySymmetry *>(opts.sym_defs->clone());
+}
+
+ViewOpts &ViewOpts::operator=(const ViewOpts &opts)
+{
+  if (this != &opts) {
+    ProgramOpts::operator=(opts);
+    set_geom_defs(*opts.geom_defs);
+    set_num_label_defs(*opts.lab_defs);
+    set_sym_defs(*opts.sym_defs);
+    inst_trans = opts.inst_trans;
+    scen_defs = opts.scen_defs;
+    cam_defs = opts.cam_defs;
+    ifiles = opts.ifiles;
+  }
+  return *this;
+}
+
 ViewOpts::~ViewOpts()
 {
   delete geom_defs;
@@ -1259,13 +1347,37 @@ void ViewOpts::set_sym_defs(const DisplaySymmetry &defs)
 }
 
 void ViewOpts::set_view_vals(Scene &scen)
+{
+  // A frame file is displayed as its model, and then its frames played
+  vector<Geometry> geoms(ifiles.size());
+  vector<std::shared_ptr<FrameReader>> frames(ifiles.size());
+  for (unsigned int i = 0; i < ifiles.size(); i++) {
+    if (ifiles[i] != "" && ifiles[i] != "-" &&
+        FrameReader::is_frame_file(ifiles[i])) {
+      frames[i] = std::make_shared<FrameReader>();
+      print_status_or_exit(frames[i]->open(ifiles[i]));
+      geoms[i] = frames[i]->get_topology();
+      print_status_or_exit(frames[i]->read_frame(geoms[i]));
+    }
+    else
+      read_or_error(geoms[i], ifiles[i]);
+  }
+
+  set_view_vals(scen, geoms, ifiles);
+
+  for (unsigned int i = 0; i < frames.size(); i++)
+    if (frames[i])
+      scen.get_geoms()[i].set_frames(frames[i]);
+}
+
+void ViewOpts::set_view_vals(Scene &scen, const vector<Geometry> &geoms,
+                             const vector<string> &names)
 {
   scen = scen_defs;
   scen.add_camera(cam_defs);
 
-  for (unsigned int i = 0; i < ifiles.size(); i++) {
-    Geometry geom;
-    read_or_error(geom, ifiles[i]);
+  for (unsigned int i = 0; i < geoms.size(); i++) {
+    Geometry geom = geoms[i];
 
     if ((get_geom_defs().elem(EDGES).get_col() != Color(0, 0, 0, 0)))
       geom.add_missing_impl_edges();
@@ -1276,9 +1388,11 @@ void ViewOpts::set_view_vals(Scene &scen)
     sc_geom.set_label(*lab_defs);
     sc_geom.set_sym(*sym_defs);
     sc_geom.set_geom(geom);
+    if (inst_trans.size())
+      sc_geom.set_instances(inst_trans);
 
-    if (ifiles[i] != "")
-      sc_geom.set_name(basename2(ifiles[i].c_str()));
+    if (i < names.size() && names[i] != "")
+      sc_geom.set_name(basename2(names[i].c_str()));
     else
       sc_geom.set_name("stdin");
 
@@ -1335,6 +1449,9 @@ const char *ViewOpts::help_view_text =
     "colour\n"
     "            indexes, a part consisting of letters from v, e, f, selects \n"
     "            the element types to apply the map list to (default 'vef').\n"
+    "  -G <sym>  display the model repeated by the transformations of a\n"
+    "            symmetry group, in Schoenflies notation (written once,\n"
+    "            with a transformation for each repeat)\n"
     "  -t <disp> select face parts to display according to winding number "
     "from:\n"
     "            odd, nonzero (default), positive, negative, no_triangulation\n"
@@ -1404,6 +1521,15 @@ Status ViewOpts::read_disp_option(char opt, char *optarg)
     stat = read_colorings(get_geom_defs().get_clrngs(), optarg);
     break;
 
+  case 'G': {
+    Symmetry sym;
+    if ((stat = sym.init(optarg))) {
+      Transformations ts = sym.get_trans();
+      inst_trans.assign(ts.begin(), ts.end());
+    }
+    break;
+  }
+
   case 'x':
     if (strspn(optarg, "vef") != strlen(optarg))
       stat.set_error(msg_str("elements to hide are '%s' must be "
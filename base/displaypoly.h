@@ -57,6 +57,9 @@ protected:
   void vrml_edges_l(FILE *ofile);
   void vrml_edges(FILE *ofile);
   void vrml_faces(FILE *ofile);
+  void vrml_elems(FILE *ofile, int sig_digits);
+  void vrml_instances(FILE *ofile, const std::vector<Trans3d> &insts,
+                      int sig_digits);
 
   void pov_default_vals(FILE *ofile);
   void pov_disp_macros(FILE *ofile);
@@ -72,7 +75,7 @@ public:
   DisplayPoly();
 
   Coloring *get_clrngs() { return clrngs; }
-  Coloring clrng(int type) { return clrngs[type]; }
+  const Coloring &clrng(int type) const { return clrngs[type]; }
   Color def_col(int type);
 
   void set_triangulate(bool tri);
@@ -166,6 +169,7 @@ private:
   DisplayPoly *geom_defs;
   DisplayNumLabels *lab_defs;
   DisplaySymmetry *sym_defs;
+  std::vector<Trans3d> inst_trans;
 
 public:
   Scene scen_defs;
@@ -179,10 +183,14 @@ public:
 
 public:
   ViewOpts(const char *name);
+  ViewOpts(const ViewOpts &opts);
+  ViewOpts &operator=(const ViewOpts &opts);
   ~ViewOpts();
 
   Status read_disp_option(char opt, char *optarg);
   void set_view_vals(Scene &scen);
+  void set_view_vals(Scene &scen, const std::vector<Geometry> &geoms,
+                     const std::vector<std::string> &names);
   void set_geom_defs(const DisplayPoly &defs);
   void set_num_label_defs(const DisplayNumLabels &defs);
   void set_sym_defs(const DisplaySymmetry &defs);
@@ -26,6 +26,7 @@
    Project: Antiprism - http://www.antiprism.com
 */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,11 +35,14 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "coloring.h"
 #include "geometryinfo.h"
+#include "instances.h"
 #include "mathutils.h"
+#include "parallel.h"
 #include "symmetry.h"
 #include "utils.h"
 
@@ -53,30 +57,10 @@ namespace anti {
 void sym_repeat(Geometry &geom, const Geometry &part, const Transformations &ts,
                 char col_part_elems, Coloring *clrngs)
 {
-  Coloring tmp_clrngs[3];
-  if (!clrngs)
-    clrngs = tmp_clrngs;
-
-  Geometry symmetry_unit = part;
-  geom.clear_all();
-  Transformations::const_iterator si;
-  int idx = 0;
-  for (si = ts.begin(); si != ts.end(); si++, idx++) {
-    Geometry sym_unit = symmetry_unit;
-    sym_unit.transform(*si);
-    for (int i = 0; i < 3; i++)
-      clrngs[i].set_geom(&sym_unit);
-
-    if (col_part_elems & ELEM_VERTS)
-      clrngs[VERTS].v_one_col(clrngs[0].get_col(idx));
-    if (col_part_elems & ELEM_EDGES) {
-      sym_unit.add_missing_impl_edges();
-      clrngs[1].e_one_col(clrngs[EDGES].get_col(idx));
-    }
-    if (col_part_elems & ELEM_FACES)
-      clrngs[2].f_one_col(clrngs[FACES].get_col(idx));
-    geom.append(sym_unit);
-  }
+  // part is copied, so it may also be geom
+  InstancedGeometry inst_geom;
+  inst_geom.init(part, ts, col_part_elems, clrngs);
+  inst_geom.expand(geom);
 }
 
 bool sym_repeat(Geometry &geom, const Geometry &part, const Symmetry &sym,
@@ -201,20 +185,27 @@ void get_pol_recip_verts(Geometry &dual, const Geometry &geom, double recip_rad,
   // const int r_sign = 1 - 2*(recip_rad<0); // -ve rad will reflect in centre
   const int r_sign = 1; // no reflection in centre
 
+  // the solvers call this on every iteration, so threads are only used for
+  // large models
+  const size_t min_parallel_faces = 10000;
+  const size_t num_faces = geom.num_faces();
+
   dual.clear(VERTS);
-  for (const auto &face : geom.faces()) {
-    if (recip_rad) {
-      auto f_norm = geom.face_norm(face);
-      auto f_cent = geom.face_cent(face);
-      double f_dist = vdot(f_norm, f_cent - centre);
-      double dist = r_sign * recip_rad * recip_rad / f_dist;
-      if (fabs(f_dist) < min_lim || fabs(dist) > inf)
-        dist = r_sign * inf * (1 - 2 * (f_dist < 0)) / f_norm.len();
-      dual.add_vert(f_norm * dist + centre);
-    }
-    else // all dual vertices = centre
-      dual.add_vert(centre);
-  }
+  vector<Vec3d> &d_verts = dual.raw_verts();
+  d_verts.resize(num_faces, centre); // all dual vertices = centre
+  if (recip_rad)
+    parallel_for(num_faces,
+                 [&](size_t i) {
+                   auto f_norm = geom.face_norm(i);
+                   auto f_cent = geom.face_cent(i);
+                   double f_dist = vdot(f_norm, f_cent - centre);
+                   double dist = r_sign * recip_rad * recip_rad / f_dist;
+                   if (fabs(f_dist) < min_lim || fabs(dist) > inf)
+                     dist = r_sign * inf * (1 - 2 * (f_dist < 0)) /
+                            f_norm.len();
+                   d_verts[i] = f_norm * dist + centre;
+                 },
+                 (num_faces < min_parallel_faces) ? 1 : 0);
 }
 
 class zero_sz {
@@ -222,78 +213,180 @@ public:
   bool operator()(const vector<int> &f) const { return f.size() == 0; }
 };
 
-void get_dual(Geometry &dual, const Geometry &geom, double recip_rad,
-              Vec3d centre, double inf)
+namespace {
+
+// An edge with the faces on either side, the faces are ordered so the
+// edge runs from v0 to v1 in the first face
+struct DualEdge {
+  int v0;
+  int v1;
+  int f0;
+  int f1;
+};
+
+// Get the face edges in order of vertex index numbers. Edges are stored
+// by their lower vertex index number, and only the few edges at a vertex
+// need sorting. If an edge is in more than two faces then the first face
+// is paired with the last, and their order is reversed each time the
+// edge runs from the higher to the lower index number.
+void get_dual_edges(const Geometry &geom, vector<DualEdge> &edges)
 {
-  get_pol_recip_verts(dual, geom, recip_rad, centre, inf);
-  vector<vector<int>> d_faces(geom.verts().size());
+  // One occurrence of an edge in a face
+  struct EdgeSide {
+    int v1;
+    int f_idx;
+    bool reversed;
+  };
 
   const vector<vector<int>> &faces = geom.faces();
-  map<pair<int, int>, pair<int, int>> edges;
-  map<pair<int, int>, pair<int, int>>::iterator mi;
-  pair<int, int> edge;
+  vector<int> offsets(geom.verts().size() + 1, 0);
+  for (const auto &face : faces)
+    for (unsigned int j = 0; j < face.size(); ++j)
+      offsets[std::min(face[j], face[(j + 1) % face.size()]) + 1]++;
+  for (unsigned int i = 1; i < offsets.size(); i++)
+    offsets[i] += offsets[i - 1];
+
+  // the sides of an edge are kept in the order they occur
+  vector<EdgeSide> sides(offsets.back());
+  vector<int> next(offsets.begin(), offsets.end() - 1);
   for (unsigned int i = 0; i < faces.size(); ++i) {
     for (unsigned int j = 0; j < faces[i].size(); ++j) {
-      edge.first = faces[i][j];
-      edge.second = faces[i][(j + 1) % faces[i].size()];
-      bool swap_idxs = (edge.first > edge.second);
-      if (swap_idxs)
-        swap(edge.first, edge.second);
-      mi = edges.find(edge);
-      if (mi != edges.end()) {
-        mi->second.second = i;
-        if (swap_idxs)
-          swap(mi->second.first, mi->second.second);
+      int v0 = faces[i][j];
+      int v1 = faces[i][(j + 1) % faces[i].size()];
+      bool reversed = (v0 > v1);
+      if (reversed)
+        swap(v0, v1);
+      sides[next[v0]++] = {v1, (int)i, reversed};
+    }
+  }
+
+  edges.clear();
+  for (unsigned int v0 = 0; v0 + 1 < offsets.size(); v0++) {
+    auto begin = sides.begin() + offsets[v0];
+    auto end = sides.begin() + offsets[v0 + 1];
+    std::stable_sort(begin, end, [](const EdgeSide &a, const EdgeSide &b) {
+      return a.v1 < b.v1;
+    });
+    for (auto si = begin; si != end; ++si) {
+      if (si == begin || si->v1 != (si - 1)->v1)
+        edges.push_back({(int)v0, si->v1, si->f_idx, 0});
+      else {
+        edges.back().f1 = si->f_idx;
+        if (si->reversed)
+          swap(edges.back().f0, edges.back().f1);
       }
-      else
-        edges[edge].first = i;
     }
   }
+}
 
-  for (mi = edges.begin(); mi != edges.end(); mi++) {
-    d_faces[mi->first.first].push_back(mi->second.first);
-    d_faces[mi->first.first].push_back(mi->second.second);
-    d_faces[mi->first.second].push_back(mi->second.second);
-    d_faces[mi->first.second].push_back(mi->second.first);
+// Order the pairs of face index numbers in a dual face so each pair
+// starts with the face that the previous pair ends with. Rather than
+// searching along the dual face, an index number is found from a list
+// of the positions it has moved to. The list for an index number starts
+// at head, which must be -1 for all the index numbers, and is reset.
+void order_dual_face(vector<int> &d_face, vector<int> &head,
+                     vector<int> &next_occ, vector<int> &occ_pos,
+                     vector<int> &pos_occ)
+{
+  int sz = d_face.size();
+  next_occ.resize(sz);
+  occ_pos.resize(sz);
+  pos_occ.resize(sz);
+  for (int i = 0; i < sz; i++) {
+    occ_pos[i] = i;
+    pos_occ[i] = i;
+    next_occ[i] = head[d_face[i]];
+    head[d_face[i]] = i;
   }
 
-  vector<int>::iterator vi;
-  for (auto &d_face : d_faces) {
-    for (unsigned int j = 0; j + 2 < d_face.size(); j += 2) {
-      vi = find(d_face.begin() + j + 3, d_face.end(), d_face[j + 1]);
-      if (vi == d_face.end())
-        continue;
+  auto swap_pos = [&](int p0, int p1) {
+    swap(d_face[p0], d_face[p1]);
+    swap(pos_occ[p0], pos_occ[p1]);
+    occ_pos[pos_occ[p0]] = p0;
+    occ_pos[pos_occ[p1]] = p1;
+  };
+
+  for (int j = 0; j + 2 < sz; j += 2) {
+    // find the next index number, skipping the start of the next pair
+    int pos = sz;
+    for (int occ = head[d_face[j + 1]]; occ >= 0; occ = next_occ[occ])
+      if (occ_pos[occ] >= j + 3 && occ_pos[occ] < pos)
+        pos = occ_pos[occ];
+    if (pos == sz)
+      continue;
 
-      if (vi - (d_face.begin() + j) != 3)
-        swap(*vi, d_face[j + 2]);
-      if (is_even(vi - d_face.begin()))
-        swap(*(vi + 1), d_face[j + 3]);
-      else
-        swap(*(vi - 1), d_face[j + 3]);
-    }
-    vi = unique(d_face.begin(), d_face.end());
+    // move its pair next, with it first
+    if (pos != j + 3)
+      swap_pos(pos, j + 2);
+    if (is_even(pos))
+      swap_pos(pos + 1, j + 3);
+    else
+      swap_pos(pos - 1, j + 3);
+  }
+
+  for (int f_idx : d_face)
+    head[f_idx] = -1;
+}
+
+// Key for an edge, with the vertex index numbers in order
+inline uint64_t edge_key(int v0, int v1)
+{
+  if (v0 > v1)
+    swap(v0, v1);
+  return (uint64_t)(uint32_t)v0 << 32 | (uint32_t)v1;
+}
+
+} // namespace
+
+void get_dual(Geometry &dual, const Geometry &geom, double recip_rad,
+              Vec3d centre, double inf)
+{
+  get_pol_recip_verts(dual, geom, recip_rad, centre, inf);
+
+  vector<DualEdge> edges;
+  get_dual_edges(geom, edges);
+
+  vector<vector<int>> d_faces(geom.verts().size());
+  for (const auto &edge : edges) {
+    d_faces[edge.v0].push_back(edge.f0);
+    d_faces[edge.v0].push_back(edge.f1);
+    d_faces[edge.v1].push_back(edge.f1);
+    d_faces[edge.v1].push_back(edge.f0);
+  }
+
+  vector<int> head(geom.faces().size(), -1);
+  vector<int> next_occ, occ_pos, pos_occ;
+  for (auto &d_face : d_faces) {
+    order_dual_face(d_face, head, next_occ, occ_pos, pos_occ);
+    auto vi = unique(d_face.begin(), d_face.end());
     if (vi != d_face.begin())
       d_face.erase(vi - 1, d_face.end());
   }
 
   dual.clear(EDGES);
-  const vector<vector<int>> &g_edges = geom.edges();
   dual.colors(FACES) = geom.colors(VERTS);
   dual.colors(VERTS) = geom.colors(FACES);
-  vector<int> g_edge(2);
-  vector<int> d_edge(2);
-  for (mi = edges.begin(); mi != edges.end(); mi++) {
-    g_edge[0] = mi->first.first;
-    g_edge[1] = mi->first.second;
-    d_edge[0] = mi->second.first;
-    d_edge[1] = mi->second.second;
-    int gidx, didx;
-    vector<vector<int>>::const_iterator ei;
-    ei = find(g_edges.begin(), g_edges.end(), g_edge);
-    if (ei != g_edges.end()) {
-      gidx = ei - g_edges.begin();
-      didx = dual.add_edge(d_edge);
-      dual.colors(EDGES).set(didx, geom.colors(EDGES).get(gidx));
+
+  // explicit edges carry their colour to the dual edge, the first of any
+  // repeated edges is used
+  const vector<vector<int>> &g_edges = geom.edges();
+  if (g_edges.size()) {
+    std::unordered_map<uint64_t, int> g_edge_idxs;
+    for (unsigned int i = 0; i < g_edges.size(); i++)
+      if (g_edges[i][0] <= g_edges[i][1])
+        g_edge_idxs.emplace(edge_key(g_edges[i][0], g_edges[i][1]), i);
+
+    std::unordered_map<uint64_t, int> d_edge_idxs;
+    for (const auto &edge : edges) {
+      auto ei = g_edge_idxs.find(edge_key(edge.v0, edge.v1));
+      if (ei == g_edge_idxs.end())
+        continue;
+      auto di = d_edge_idxs.emplace(edge_key(edge.f0, edge.f1),
+                                    dual.edges().size());
+      if (di.second)
+        dual.raw_edges().push_back(make_edge(edge.f0, edge.f1));
+      dual.colors(EDGES).set(di.first->second,
+                             geom.colors(EDGES).get(ei->second));
     }
   }
 
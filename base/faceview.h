@@ -0,0 +1,178 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file faceview.h
+   \brief Flat storage for face index lists, and a view of a single face
+*/
+
+#ifndef FACEVIEW_H
+#define FACEVIEW_H
+
+#include <vector>
+
+namespace anti {
+
+/// A read-only view of the vertex index numbers of a face
+/** The view does not own the index numbers, and is only valid while the
+ *  storage it refers to is not changed. */
+class FaceView {
+private:
+  const int *idxs;
+  unsigned int sz;
+
+public:
+  /// Constructor, for an empty face
+  FaceView() : idxs(nullptr), sz(0) {}
+
+  /// Constructor
+  /**\param idxs pointer to the first index number.
+   * \param sz the number of index numbers. */
+  FaceView(const int *idxs, unsigned int sz) : idxs(idxs), sz(sz) {}
+
+  /// Constructor
+  /**\param face a face stored as a vector. */
+  FaceView(const std::vector<int> &face) : idxs(face.data()), sz(face.size())
+  {
+  }
+
+  /// Get the number of vertices in the face
+  /**\return The number of vertices. */
+  unsigned int size() const { return sz; }
+
+  /// Check whether the face has no vertices
+  /**\return \c true if there are no vertices, otherwise \c false. */
+  bool empty() const { return sz == 0; }
+
+  /// Get a vertex index number
+  /**\param v_no the position the vertex appears in the face.
+   * \return The vertex index number. */
+  int operator[](unsigned int v_no) const { return idxs[v_no]; }
+
+  /// Get the first vertex index number
+  /**\return The vertex index number. */
+  int front() const { return idxs[0]; }
+
+  /// Get the last vertex index number
+  /**\return The vertex index number. */
+  int back() const { return idxs[sz - 1]; }
+
+  /// Iterator to the first vertex index number
+  /**\return The iterator. */
+  const int *begin() const { return idxs; }
+
+  /// Iterator to the end of the vertex index numbers
+  /**\return The iterator. */
+  const int *end() const { return idxs + sz; }
+
+  /// Copy the face into a vector
+  /**\return The vertex index numbers. */
+  std::vector<int> to_vector() const
+  {
+    return std::vector<int>(begin(), end());
+  }
+};
+
+/// Faces stored in a single index array, with the offset of each face
+class FlatFaces {
+private:
+  std::vector<int> idxs;
+  std::vector<unsigned int> offsets = std::vector<unsigned int>(1, 0);
+
+public:
+  /// Get the number of faces
+  /**\return The number of faces. */
+  unsigned int size() const { return offsets.size() - 1; }
+
+  /// Check whether there are no faces
+  /**\return \c true if there are no faces, otherwise \c false. */
+  bool empty() const { return size() == 0; }
+
+  /// Get a face
+  /**\param f_idx the face index number.
+   * \return A view of the face. */
+  FaceView operator[](unsigned int f_idx) const
+  {
+    return FaceView(idxs.data() + offsets[f_idx],
+                    offsets[f_idx + 1] - offsets[f_idx]);
+  }
+
+  /// Get the index array
+  /**\return The vertex index numbers of all the faces, in face order. */
+  const std::vector<int> &get_idxs() const { return idxs; }
+
+  /// Get the face offsets
+  /**\return The position in the index array where each face starts,
+   *  followed by the size of the index array. */
+  const std::vector<unsigned int> &get_offsets() const { return offsets; }
+
+  /// Reserve storage
+  /**\param num_faces the number of faces.
+   * \param num_idxs the total number of vertex index numbers. */
+  void reserve(unsigned int num_faces, unsigned int num_idxs)
+  {
+    offsets.reserve(num_faces + 1);
+    idxs.reserve(num_idxs);
+  }
+
+  /// Add a face
+  /**\param face the face to add. */
+  void push_back(FaceView face)
+  {
+    idxs.insert(idxs.end(), face.begin(), face.end());
+    offsets.push_back(idxs.size());
+  }
+
+  /// Remove all the faces
+  void clear()
+  {
+    idxs.clear();
+    offsets.assign(1, 0);
+  }
+
+  /// Set the faces from faces stored as nested vectors
+  /**\param faces the faces. */
+  void from_nested(const std::vector<std::vector<int>> &faces)
+  {
+    unsigned int num_idxs = 0;
+    for (const auto &face : faces)
+      num_idxs += face.size();
+    clear();
+    reserve(faces.size(), num_idxs);
+    for (const auto &face : faces)
+      push_back(face);
+  }
+
+  /// Get the faces as nested vectors
+  /**\param faces to return the faces. */
+  void to_nested(std::vector<std::vector<int>> &faces) const
+  {
+    faces.resize(size());
+    for (unsigned int i = 0; i < size(); i++)
+      faces[i].assign((*this)[i].begin(), (*this)[i].end());
+  }
+};
+
+} // namespace anti
+
+#endif // FACEVIEW_H
@@ -0,0 +1,497 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file frames.cc
+   \brief Animation frame files, a model with a sequence of coordinates
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "frames.h"
+#include "parallel.h"
+#include "utils.h"
+
+using std::string;
+using std::vector;
+
+namespace anti {
+
+/* Frame file layout, all values in native byte order
+
+   Header
+     char[8]   magic "ANTIFRMS"
+     uint32    byte order check 0x01020304
+     uint32    format version
+     uint32    flags, 1 for delta encoded coordinates
+     uint32    reserved, 0
+     uint64    number of frames, number of vertices, length of elements
+   Elements
+     the model in OFF format, with the coordinates of the first frame
+   Frames, one after another
+     uint64    length of frame data
+     frame data, either the coordinates as doubles, or delta encoded
+
+   Delta encoding: the coordinates are taken in order, x, y, z for each
+   vertex, and a value is predicted for each from the previous frames
+   (0 for the first frame, the previous value for the second frame, and
+   a linear extrapolation of the previous two values for later frames).
+   The bits of the coordinate are XORed with the bits of the prediction,
+   so a close prediction leaves the high bytes zero. The results are
+   written in pairs, a byte with the number of low bytes kept for the
+   first value in the high nibble and for the second value in the low
+   nibble, followed by those low bytes of the first value and then of
+   the second value, lowest byte first. An odd final value is paired
+   with a zero.
+*/
+
+namespace {
+
+const char frames_magic[8] = {'A', 'N', 'T', 'I', 'F', 'R', 'M', 'S'};
+const uint32_t frames_byte_order = 0x01020304;
+const uint32_t frames_format = 1;
+const uint32_t frames_flag_delta = 1;
+
+uint64_t to_bits(double val)
+{
+  uint64_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  return bits;
+}
+
+double from_bits(uint64_t bits)
+{
+  double val;
+  memcpy(&val, &bits, sizeof(val));
+  return val;
+}
+
+// Predicted bits of a coordinate, from its values in the previous frames
+uint64_t predict(const vector<uint64_t> *prev, size_t idx,
+                 unsigned long frame_no)
+{
+  if (frame_no == 0)
+    return 0;
+  else if (frame_no == 1)
+    return prev[0][idx];
+  else
+    return to_bits(2 * from_bits(prev[0][idx]) - from_bits(prev[1][idx]));
+}
+
+// Keep the values of this frame for predicting the next frame
+void shift_prev(vector<uint64_t> *prev, const vector<uint64_t> &vals)
+{
+  prev[1].swap(prev[0]);
+  prev[0] = vals;
+}
+
+// Number of low bytes needed to hold a value
+int num_low_bytes(uint64_t val)
+{
+  int num = 0;
+  while (val) {
+    num++;
+    val >>= 8;
+  }
+  return num;
+}
+
+void put_low_bytes(vector<unsigned char> &out, uint64_t val, int num)
+{
+  for (int i = 0; i < num; i++) {
+    out.push_back(val & 0xff);
+    val >>= 8;
+  }
+}
+
+void delta_encode(vector<unsigned char> &out, const vector<uint64_t> &vals,
+                  const vector<uint64_t> *prev, unsigned long frame_no)
+{
+  out.clear();
+  for (size_t i = 0; i < vals.size(); i += 2) {
+    uint64_t a = vals[i] ^ predict(prev, i, frame_no);
+    uint64_t b =
+        (i + 1 < vals.size()) ? vals[i + 1] ^ predict(prev, i + 1, frame_no)
+                              : 0;
+    int num_a = num_low_bytes(a);
+    int num_b = num_low_bytes(b);
+    out.push_back((num_a << 4) | num_b);
+    put_low_bytes(out, a, num_a);
+    put_low_bytes(out, b, num_b);
+  }
+}
+
+bool delta_decode(const vector<unsigned char> &in, vector<uint64_t> &vals,
+                  const vector<uint64_t> *prev, unsigned long frame_no)
+{
+  size_t pos = 0;
+  for (size_t i = 0; i < vals.size(); i += 2) {
+    if (pos >= in.size())
+      return false;
+    int nums[2] = {in[pos] >> 4, in[pos] & 0xf};
+    pos++;
+    for (int j = 0; j < 2; j++) {
+      if (nums[j] > 8 || in.size() - pos < (size_t)nums[j])
+        return false;
+      uint64_t val = 0;
+      for (int k = 0; k < nums[j]; k++)
+        val |= (uint64_t)in[pos++] << (8 * k);
+      if (i + j < vals.size())
+        vals[i + j] = val ^ predict(prev, i + j, frame_no);
+      else if (val)
+        return false;
+    }
+  }
+  return pos == in.size();
+}
+
+template <typename T> bool put(FILE *ofile, T val)
+{
+  return fwrite(&val, sizeof(T), 1, ofile) == 1;
+}
+
+template <typename T> bool get(FILE *ifile, T &val)
+{
+  return fread(&val, sizeof(T), 1, ifile) == 1;
+}
+
+} // namespace
+
+// --------------------------------------------------------------
+// FrameWriter
+
+Status FrameWriter::open(const string &fname, const Geometry &topology,
+                         unsigned long frames, bool delta_enc)
+{
+  close();
+
+  // Write the elements to a temporary file first, to find their length
+  FILE *tmp = tmpfile();
+  if (!tmp)
+    return Status::error("could not open temporary file");
+  topology.write(tmp);
+  long topo_len = ftell(tmp);
+  ::rewind(tmp);
+
+  file_name = (fname == "") ? "stdout" : fname;
+  ofile = (fname == "") ? stdout : fopen(fname.c_str(), "wb");
+  if (!ofile) {
+    fclose(tmp);
+    return Status::error(
+        msg_str("could not open output file '%s'", fname.c_str()));
+  }
+
+  delta = delta_enc;
+  num_verts = topology.verts().size();
+  num_frames = frames;
+  frames_written = 0;
+  prev[0].clear();
+  prev[1].clear();
+
+  bool ok = fwrite(frames_magic, 1, 8, ofile) == 8 &&
+            put<uint32_t>(ofile, frames_byte_order) &&
+            put<uint32_t>(ofile, frames_format) &&
+            put<uint32_t>(ofile, delta ? frames_flag_delta : 0) &&
+            put<uint32_t>(ofile, 0) && put<uint64_t>(ofile, num_frames) &&
+            put<uint64_t>(ofile, num_verts) && put<uint64_t>(ofile, topo_len);
+  char chunk[65536];
+  size_t num_read;
+  while (ok && (num_read = fread(chunk, 1, sizeof(chunk), tmp)) > 0)
+    ok = fwrite(chunk, 1, num_read, ofile) == num_read;
+  fclose(tmp);
+
+  if (!ok)
+    return Status::error(
+        msg_str("could not write to '%s'", file_name.c_str()));
+
+  return Status::ok();
+}
+
+Status FrameWriter::write_frame(const vector<Vec3d> &verts)
+{
+  if (!ofile)
+    return Status::error("frame file is not open");
+  if (verts.size() != num_verts)
+    return Status::error(msg_str("frame %lu has %lu vertices, %lu expected",
+                                 frames_written, (unsigned long)verts.size(),
+                                 (unsigned long)num_verts));
+  if (frames_written >= num_frames)
+    return Status::error(
+        msg_str("more than %lu frames written", num_frames));
+
+  vector<uint64_t> vals(3 * num_verts);
+  for (size_t i = 0; i < num_verts; i++)
+    for (int j = 0; j < 3; j++)
+      vals[3 * i + j] = to_bits(verts[i][j]);
+
+  bool ok;
+  if (delta) {
+    delta_encode(buf, vals, prev, frames_written);
+    shift_prev(prev, vals);
+    ok = put<uint64_t>(ofile, buf.size()) &&
+         fwrite(buf.data(), 1, buf.size(), ofile) == buf.size();
+  }
+  else
+    ok = put<uint64_t>(ofile, vals.size() * sizeof(uint64_t)) &&
+         fwrite(vals.data(), sizeof(uint64_t), vals.size(), ofile) ==
+             vals.size();
+
+  if (!ok)
+    return Status::error(
+        msg_str("could not write to '%s'", file_name.c_str()));
+
+  frames_written++;
+  return Status::ok();
+}
+
+Status FrameWriter::close()
+{
+  if (!ofile)
+    return Status::ok();
+
+  bool ok = (ofile == stdout) ? fflush(ofile) == 0 : fclose(ofile) == 0;
+  ofile = nullptr;
+  prev[0].clear();
+  prev[1].clear();
+  if (!ok)
+    return Status::error(
+        msg_str("could not write to '%s'", file_name.c_str()));
+  if (frames_written != num_frames)
+    return Status::error(msg_str("%lu frames written, %lu expected",
+                                 frames_written, num_frames));
+
+  return Status::ok();
+}
+
+// --------------------------------------------------------------
+// FrameReader
+
+void FrameReader::close()
+{
+  if (ifile)
+    fclose(ifile);
+  ifile = nullptr;
+  num_verts = 0;
+  num_frames = 0;
+  next_frame = 0;
+  topology.clear_all();
+  prev[0].clear();
+  prev[1].clear();
+}
+
+bool FrameReader::is_frame_file(const string &fname)
+{
+  FILE *ifile = fopen(fname.c_str(), "rb");
+  if (!ifile)
+    return false;
+  char magic[8];
+  bool is_frames =
+      fread(magic, 1, 8, ifile) == 8 && memcmp(magic, frames_magic, 8) == 0;
+  fclose(ifile);
+  return is_frames;
+}
+
+Status FrameReader::open(const string &fname)
+{
+  close();
+
+  file_name = fname;
+  ifile = fopen(fname.c_str(), "rb");
+  if (!ifile)
+    return Status::error(msg_str("could not open '%s'", fname.c_str()));
+
+  char magic[8];
+  uint32_t byte_order = 0, format = 0, flags = 0, reserved = 0;
+  uint64_t frames = 0, verts = 0, topo_len = 0;
+  bool valid = fread(magic, 1, 8, ifile) == 8 &&
+               memcmp(magic, frames_magic, 8) == 0 &&
+               get(ifile, byte_order) && byte_order == frames_byte_order &&
+               get(ifile, format) && format == frames_format &&
+               get(ifile, flags) && get(ifile, reserved) &&
+               get(ifile, frames) && get(ifile, verts) &&
+               get(ifile, topo_len);
+  if (!valid) {
+    close();
+    return Status::error(
+        msg_str("'%s' is not a frame file of this format", fname.c_str()));
+  }
+
+  // Read the elements through a temporary file, as the OFF reader
+  // expects to read to the end of the file
+  FILE *tmp = tmpfile();
+  if (!tmp) {
+    close();
+    return Status::error("could not open temporary file");
+  }
+  char chunk[65536];
+  uint64_t to_read = topo_len;
+  while (to_read) {
+    size_t num = std::min<uint64_t>(to_read, sizeof(chunk));
+    if (fread(chunk, 1, num, ifile) != num ||
+        fwrite(chunk, 1, num, tmp) != num)
+      break;
+    to_read -= num;
+  }
+  ::rewind(tmp);
+  Status stat;
+  if (to_read)
+    stat.set_error("file ended in the model elements");
+  else if (!(stat = topology.read(tmp)))
+    stat.set_error(msg_str("model elements: %s", stat.c_msg()));
+  else if (topology.verts().size() != verts)
+    stat.set_error(msg_str("model has %lu vertices, %lu expected",
+                           (unsigned long)topology.verts().size(),
+                           (unsigned long)verts));
+  fclose(tmp);
+  if (stat.is_error()) {
+    close();
+    return Status::error(msg_str("'%s': %s", fname.c_str(), stat.c_msg()));
+  }
+
+  delta = flags & frames_flag_delta;
+  num_verts = verts;
+  num_frames = frames;
+  data_start = ftell(ifile);
+
+  // Set the exact coordinates of the first frame
+  if (num_frames) {
+    if (!(stat = read_frame(topology)) || !(stat = rewind())) {
+      close();
+      return stat;
+    }
+  }
+
+  return Status::ok();
+}
+
+Status FrameReader::read_frame(Geometry &geom)
+{
+  if (!ifile)
+    return Status::error("frame file is not open");
+  if (next_frame >= num_frames)
+    return Status::error(msg_str("'%s': no frames left", file_name.c_str()));
+  if (geom.verts().size() != num_verts)
+    return Status::error(msg_str("model has %lu vertices, frames have %lu",
+                                 (unsigned long)geom.verts().size(),
+                                 (unsigned long)num_verts));
+
+  uint64_t len;
+  size_t raw_len = 3 * num_verts * sizeof(uint64_t);
+  size_t max_len = delta ? raw_len + (3 * num_verts + 1) / 2 : raw_len;
+  bool ok = get(ifile, len) && len <= max_len && (delta || len == raw_len);
+  if (ok) {
+    buf.resize(len);
+    ok = fread(buf.data(), 1, len, ifile) == len;
+  }
+
+  vector<uint64_t> vals(3 * num_verts);
+  if (ok) {
+    if (delta) {
+      ok = delta_decode(buf, vals, prev, next_frame);
+      shift_prev(prev, vals);
+    }
+    else
+      memcpy(vals.data(), buf.data(), raw_len);
+  }
+
+  if (!ok)
+    return Status::error(
+        msg_str("'%s': frame %lu is not valid", file_name.c_str(), next_frame));
+
+  vector<Vec3d> &g_verts = geom.raw_verts();
+  for (size_t i = 0; i < num_verts; i++)
+    for (int j = 0; j < 3; j++)
+      g_verts[i][j] = from_bits(vals[3 * i + j]);
+
+  next_frame++;
+  return Status::ok();
+}
+
+Status FrameReader::rewind()
+{
+  if (!ifile)
+    return Status::error("frame file is not open");
+  if (fseek(ifile, data_start, SEEK_SET) != 0)
+    return Status::error(
+        msg_str("'%s': could not go to the first frame", file_name.c_str()));
+  next_frame = 0;
+  prev[0].clear();
+  prev[1].clear();
+  return Status::ok();
+}
+
+// --------------------------------------------------------------
+// write_frames
+
+Status
+write_frames(const string &fname, unsigned long num_frames,
+             const std::function<void(unsigned long, Geometry &)> &make_frame,
+             bool delta_enc, int num_threads)
+{
+  if (num_frames == 0)
+    return Status::error("number of frames must be positive");
+
+  if (num_threads <= 0)
+    num_threads = get_num_threads();
+  unsigned long block_sz = std::min<unsigned long>(num_frames, 4 * num_threads);
+
+  FrameWriter writer;
+  Geometry first;
+  vector<Geometry> block(block_sz);
+  for (unsigned long start = 0; start < num_frames; start += block_sz) {
+    unsigned long num = std::min(block_sz, num_frames - start);
+    parallel_for(num,
+                 [&](size_t i) {
+                   block[i].clear_all();
+                   make_frame(start + i, block[i]);
+                 },
+                 num_threads, 1);
+
+    for (unsigned long i = 0; i < num; i++) {
+      Status stat;
+      if (start + i == 0) {
+        first = block[0];
+        if (!(stat = writer.open(fname, first, num_frames, delta_enc)))
+          return stat;
+      }
+      else if (block[i].verts().size() != first.verts().size() ||
+               block[i].edges() != first.edges() ||
+               block[i].faces() != first.faces())
+        return Status::error(msg_str(
+            "frame %lu: elements differ from the first frame", start + i));
+
+      if (!(stat = writer.write_frame(block[i].verts())))
+        return stat;
+    }
+  }
+
+  return writer.close();
+}
+
+} // namespace anti
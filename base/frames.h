@@ -0,0 +1,187 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file frames.h
+   \brief Animation frame files, a model with a sequence of coordinates
+*/
+
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#include <functional>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "status.h"
+
+namespace anti {
+
+/// Write a frame file
+/** A frame file holds the elements and colours of a model once, followed
+ *  by the vertex coordinates of each frame. The coordinates may be
+ *  delta encoded, which stores each coordinate as its difference from a
+ *  value predicted from the previous frames. This is lossless, and
+ *  smaller when the vertices move smoothly between frames. */
+class FrameWriter {
+private:
+  FILE *ofile;
+  std::string file_name;
+  bool delta;
+  size_t num_verts;
+  unsigned long num_frames;
+  unsigned long frames_written;
+  std::vector<uint64_t> prev[2];
+  std::vector<unsigned char> buf;
+
+public:
+  /// Constructor
+  FrameWriter()
+      : ofile(nullptr), delta(false), num_verts(0), num_frames(0),
+        frames_written(0)
+  {
+  }
+
+  FrameWriter(const FrameWriter &) = delete;
+  FrameWriter &operator=(const FrameWriter &) = delete;
+
+  /// Destructor
+  ~FrameWriter() { close(); }
+
+  /// Open a frame file and write the header and elements
+  /**\param fname the file name, or \c "" for standard output.
+   * \param topology the model, whose elements and colours are used for
+   *  every frame.
+   * \param frames the number of frames that will be written.
+   * \param delta_enc \c true to delta encode the coordinates.
+   * \return status, evaluates to \c true if the file was opened and
+   *  written to, otherwise \c false. */
+  Status open(const std::string &fname, const Geometry &topology,
+              unsigned long frames, bool delta_enc = true);
+
+  /// Write the coordinates of the next frame
+  /**\param verts the vertex coordinates, which must have the same number
+   *  of vertices as the model.
+   * \return status, evaluates to \c true if the frame was written,
+   *  otherwise \c false. */
+  Status write_frame(const std::vector<Vec3d> &verts);
+
+  /// Close the file
+  /**\return status, evaluates to \c true if all the frames were written,
+   *  otherwise \c false. */
+  Status close();
+};
+
+/// Read a frame file
+/** Frames are read in order, one at a time, so a long sequence does not
+ *  need to be held in memory. */
+class FrameReader {
+private:
+  FILE *ifile;
+  std::string file_name;
+  bool delta;
+  size_t num_verts;
+  unsigned long num_frames;
+  unsigned long next_frame;
+  long data_start;
+  Geometry topology;
+  std::vector<uint64_t> prev[2];
+  std::vector<unsigned char> buf;
+
+  void close();
+
+public:
+  /// Constructor
+  FrameReader()
+      : ifile(nullptr), delta(false), num_verts(0), num_frames(0),
+        next_frame(0), data_start(0)
+  {
+  }
+
+  FrameReader(const FrameReader &) = delete;
+  FrameReader &operator=(const FrameReader &) = delete;
+
+  /// Destructor
+  ~FrameReader() { close(); }
+
+  /// Check whether a file is a frame file
+  /**\param fname the file name.
+   * \return \c true if the file starts like a frame file,
+   *  otherwise \c false. */
+  static bool is_frame_file(const std::string &fname);
+
+  /// Open a frame file and read the header and elements
+  /**\param fname the file name.
+   * \return status, evaluates to \c true if the file was opened and
+   *  is a valid frame file, otherwise \c false. */
+  Status open(const std::string &fname);
+
+  /// Get the number of frames
+  /**\return The number of frames. */
+  unsigned long size() const { return num_frames; }
+
+  /// Get the index number of the next frame to be read
+  /**\return The index number of the next frame. */
+  unsigned long get_next_frame() const { return next_frame; }
+
+  /// Get the model
+  /**\return The model, with the vertex coordinates of the first frame. */
+  const Geometry &get_topology() const { return topology; }
+
+  /// Read the coordinates of the next frame
+  /**\param geom the model to set the vertex coordinates of, which must
+   *  have the same number of vertices as the frames.
+   * \return status, evaluates to \c true if a frame was read,
+   *  otherwise \c false. */
+  Status read_frame(Geometry &geom);
+
+  /// Go back to the first frame
+  /**\return status, evaluates to \c true if the file could be rewound,
+   *  otherwise \c false. */
+  Status rewind();
+};
+
+/// Make a sequence of frames and write them to a frame file
+/** Frames are made in blocks, with the frames of a block made at the
+ *  same time on several threads, and then written in order. Every frame
+ *  must have the same elements as the first frame.
+ * \param fname the file name, or \c "" for standard output.
+ * \param num_frames the number of frames.
+ * \param make_frame a function to make the model for a frame index
+ *  number, which may be called at the same time from several threads.
+ * \param delta_enc \c true to delta encode the coordinates.
+ * \param num_threads the number of threads, or if \c 0 then use
+ *  \c get_num_threads().
+ * \return status, evaluates to \c true if the frames were written,
+ *  otherwise \c false. */
+Status
+write_frames(const std::string &fname, unsigned long num_frames,
+             const std::function<void(unsigned long, Geometry &)> &make_frame,
+             bool delta_enc = true, int num_threads = 0);
+
+} // namespace anti
+
+#endif // FRAMES_H
@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "coloring.h"
@@ -112,10 +113,35 @@ int Geometry::add_edges(const vector<vector<int>> &edgs)
   return edges().size() - 1;
 }
 
+void Geometry::nested_faces_error() const
+{
+  fprintf(stderr, "error: nested face access through a const geometry with "
+                  "flat face storage\n");
+  abort();
+}
+
+void Geometry::set_face_storage(int storage)
+{
+  if (storage == face_storage)
+    return;
+  if (storage == FACES_FLAT) {
+    flat_face_elems.from_nested(face_elems);
+    vector<vector<int>>().swap(face_elems); // release the storage
+  }
+  else {
+    flat_face_elems.to_nested(face_elems);
+    flat_face_elems = FlatFaces(); // release the storage
+  }
+  face_storage = storage;
+}
+
 int Geometry::add_face(const std::vector<int> &face, Color col)
 {
-  int idx = faces().size();
-  raw_faces().push_back(face);
+  int idx = num_faces();
+  if (face_storage == FACES_FLAT)
+    flat_face_elems.push_back(face);
+  else
+    face_elems.push_back(face);
   if (col.is_set())
     colors(FACES).set(idx, col);
   return idx;
@@ -136,7 +162,7 @@ int Geometry::add_faces(const vector<vector<int>> &fces)
 {
   for (const auto &f : fces)
     add_face(f);
-  return faces().size() - 1;
+  return num_faces() - 1;
 }
 
 static void delete_verts(Geometry *geom, const vector<int> &v_nos,
@@ -273,17 +299,29 @@ void remap_shift(vector<vector<int>> &elems, int offset)
 
 void Geometry::append(const Geometry &geom)
 {
-  cols.append(geom.get_cols(), verts().size(), edges().size(), faces().size());
+  cols.append(geom.get_cols(), verts().size(), edges().size(), num_faces());
   vector<Vec3d> g_verts = geom.verts();
-  vector<vector<int>> g_faces = geom.faces();
   vector<vector<int>> g_edges = geom.edges();
 
   remap_shift(g_edges, verts().size());
-  remap_shift(g_faces, verts().size());
+
+  // faces are added one at a time, so either storage may be used by
+  // either geometry
+  const int offset = verts().size();
+  vector<int> face;
+  for (unsigned int i = 0; i < geom.num_faces(); i++) {
+    FaceView g_face = geom.face_view(i);
+    face.assign(g_face.begin(), g_face.end());
+    for (int &j : face)
+      j += offset;
+    if (face_storage == FACES_FLAT)
+      flat_face_elems.push_back(face);
+    else
+      face_elems.push_back(face);
+  }
 
   raw_verts().insert(raw_verts().end(), g_verts.begin(), g_verts.end());
   raw_edges().insert(raw_edges().end(), g_edges.begin(), g_edges.end());
-  raw_faces().insert(raw_faces().end(), g_faces.begin(), g_faces.end());
 }
 
 void Geometry::clear(int type)
@@ -292,8 +330,10 @@ void Geometry::clear(int type)
     raw_verts().clear();
   else if (type == EDGES)
     raw_edges().clear();
-  else if (type == FACES)
-    raw_faces().clear();
+  else if (type == FACES) {
+    face_elems.clear();
+    flat_face_elems.clear();
+  }
 
   colors(type).clear();
 }
@@ -308,9 +348,11 @@ void Geometry::clear_all()
 void Geometry::get_impl_edges(vector<vector<int>> &edgs) const
 {
   // edgs hasn't been cleared
-  for (unsigned int i = 0; i < faces().size(); ++i)
-    for (unsigned int j = 0; j < faces(i).size(); ++j)
-      edgs.push_back(make_edge(faces(i, j), faces_mod(i, j + 1)));
+  for (unsigned int i = 0; i < num_faces(); ++i) {
+    FaceView face = face_view(i);
+    for (unsigned int j = 0; j < face.size(); ++j)
+      edgs.push_back(make_edge(face[j], face[(j + 1) % face.size()]));
+  }
 
   // Clear duplicate edges (each edge appears in two faces)
   sort(edgs.begin(), edgs.end());
@@ -328,6 +370,11 @@ Status Geometry::set_hull(string qh_args, int *dim)
   return anti::set_hull(*this, qh_args, dim);
 }
 
+Status Geometry::set_hull_from_faces(string qh_args, int *dim)
+{
+  return anti::set_hull_from_faces(*this, qh_args, dim);
+}
+
 int Geometry::orient(vector<vector<int>> *parts)
 {
   return orient_geom(*this, parts);
@@ -464,8 +511,8 @@ bool Geometry::is_oriented() const
 {
   std::set<pair<int, int>> edgs;
   pair<int, int> edge;
-  for (unsigned int f = 0; f < faces().size(); f++)
-    for (unsigned int i = 0; i < faces(f).size(); i++) {
+  for (unsigned int f = 0; f < num_faces(); f++)
+    for (unsigned int i = 0; i < face_view(f).size(); i++) {
       edge = pair<int, int>(faces(f, i), faces_mod(f, i + 1));
       if (edgs.find(edge) != edgs.end())
         return false;
@@ -480,8 +527,8 @@ Geometry::get_edge_face_pairs(bool oriented) const
 {
   map<vector<int>, vector<int>> edge2facepr;
   vector<int> vrts(2);
-  for (unsigned int i = 0; i < faces().size(); ++i) {
-    for (unsigned int j = 0; j < faces(i).size(); ++j) {
+  for (unsigned int i = 0; i < num_faces(); ++i) {
+    for (unsigned int j = 0; j < face_view(i).size(); ++j) {
       vrts[0] = faces(i, j);
       vrts[1] = faces_mod(i, j + 1);
       int face_pos = 0;
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "elemprops.h"
+#include "faceview.h"
 #include "status.h"
 #include "trans3d.h"
 #include "vec_utils.h"
@@ -48,13 +49,35 @@ private:
   std::vector<Vec3d> vert_elems;
   std::vector<std::vector<int>> face_elems;
   std::vector<std::vector<int>> edge_elems;
+  FlatFaces flat_face_elems;
+  int face_storage = FACES_NESTED;
 
   GeomElemProps<Color> cols;
 
+  [[noreturn]] void nested_faces_error() const;
+
 public:
+  /// Ways of storing the faces
+  enum {
+    FACES_NESTED = 0, ///< each face is a separate vector (default)
+    FACES_FLAT = 1    ///< all faces share one index array (\c FlatFaces)
+  };
+
   /// Constructor
   Geometry() = default;
 
+  /// Constructor, setting how the faces are stored
+  /**Flat storage uses much less memory for models with many faces. It is
+   * used by functions that access faces through \c num_faces(),
+   * \c face_view(), \c faces(f_idx, v_no) and the face geometry
+   * functions. Write access to the faces as nested vectors, through
+   * \c raw_faces() or \c faces(f_idx), converts to nested storage. Read
+   * access through a const geometry can't convert, and ends the program
+   * if the storage is flat, so call \c set_face_storage(FACES_NESTED)
+   * before passing the geometry to functions that use it.
+   * \param storage \c FACES_NESTED or \c FACES_FLAT. */
+  explicit Geometry(int storage) : face_storage(storage) {}
+
   /// Copy Constructor
   /** Initialise from another geometry that implements \c Geometry
    * \param geom geometry to copy from.*/
@@ -122,20 +145,39 @@ public:
    */
   Vec3d edge_v(int e_idx, int v_no) const;
 
-  /// Read access to the faces.
+  /// Get how the faces are stored
+  /**\return \c FACES_NESTED or \c FACES_FLAT. */
+  int get_face_storage() const { return face_storage; }
+
+  /// Set how the faces are stored, converting any faces already stored
+  /** Any \c FaceView or reference to the faces is no longer valid after
+   *  a conversion.
+   * \param storage \c FACES_NESTED or \c FACES_FLAT. */
+  void set_face_storage(int storage);
+
+  /// Get the number of faces.
+  /**\return The number of faces, for either face storage. */
+  unsigned int num_faces() const;
+
+  /// Read access to a face, for either face storage.
+  /**\param f_idx index number of the face.
+   * \return A view of the face data, valid until the faces are changed. */
+  FaceView face_view(int f_idx) const;
+
+  /// Read access to the faces (nested face storage only).
   /**\return A reference to the face data. */
   virtual const std::vector<std::vector<int>> &faces() const;
 
-  /// Read/Write access to the faces.
+  /// Read/Write access to the faces (converts to nested face storage).
   /**\return A reference to the face data. */
   virtual std::vector<std::vector<int>> &raw_faces();
 
-  /// Read access to a face.
+  /// Read access to a face (nested face storage only).
   /**\param f_idx index number of the face.
    * \return A reference to the face data. */
   virtual const std::vector<int> &faces(int f_idx) const;
 
-  /// Read/Write access to a face.
+  /// Read/Write access to a face (converts to nested face storage).
   /**\param f_idx index number of the face.
    * \return A reference to the face data. */
   virtual std::vector<int> &faces(int f_idx);
@@ -320,6 +362,20 @@ public:
    *  to indicate an error. */
   Status set_hull(std::string qh_args = "", int *dim = nullptr);
 
+  /// Set the geometry to its convex hull, keeping faces that are convex.
+  /** If the faces already make a convex polyhedron, checked locally in
+   *  linear time, then they are kept as the hull and oriented outwards,
+   *  and the edges and face colours are removed. Otherwise the hull is
+   *  set as by \c set_hull(). The fast check is only made if \a qh_args
+   *  is empty or a single facet merge angle option (\c A or \c -A).
+   * \param qh_args additional arguments to pass to qhull (unsupported,
+   *  may not work, check output.)
+   * \param dim dimension of the hull 3, 2, 1 or 0.
+   * \return status, which evaluates to \c true if the hull could be
+   *  calculated (possibly with warnings), otherwise \c false
+   *  to indicate an error. */
+  Status set_hull_from_faces(std::string qh_args = "", int *dim = nullptr);
+
   /// Orient the geometry (if possible.)
   /**\param parts used to return the index numbers of the faces
    *  in each of the disconnected parts (if \a parts is not \c 0 .)
@@ -628,7 +684,7 @@ inline Vec3d Geometry::edge_v(int e_idx, int v_no) const
 
 inline int Geometry::faces_mod(int f_idx, int v_no) const
 {
-  unsigned int f_sz = faces(f_idx).size();
+  unsigned int f_sz = face_view(f_idx).size();
   if (v_no < 0)
     v_no = f_sz - ((-v_no) % f_sz);
   else
@@ -650,22 +706,22 @@ inline Vec3d Geometry::centroid() const { return anti::centroid(verts()); }
 
 inline void Geometry::face_cents(std::vector<Vec3d> &ctds) const
 {
-  ctds.resize(faces().size());
-  for (unsigned int i = 0; i < faces().size(); i++)
+  ctds.resize(num_faces());
+  for (unsigned int i = 0; i < num_faces(); i++)
     ctds[i] = face_cent(i);
 }
 
 inline void Geometry::face_norms(std::vector<Vec3d> &norms,
                                  bool allow_zero) const
 {
-  norms.resize(faces().size());
-  for (unsigned int i = 0; i < faces().size(); i++)
+  norms.resize(num_faces());
+  for (unsigned int i = 0; i < num_faces(); i++)
     norms[i] = face_norm(i, allow_zero).unit();
 }
 
 inline Vec3d Geometry::face_cent(int f_idx) const
 {
-  return face_cent(faces(f_idx));
+  return anti::centroid(verts(), face_view(f_idx));
 }
 
 inline Vec3d Geometry::face_cent(const std::vector<int> &face) const
@@ -675,7 +731,7 @@ inline Vec3d Geometry::face_cent(const std::vector<int> &face) const
 
 inline Vec3d Geometry::face_norm(int f_idx, bool allow_zero) const
 {
-  return face_norm(faces(f_idx), allow_zero);
+  return anti::face_norm(verts(), face_view(f_idx), allow_zero);
 }
 
 inline Vec3d Geometry::face_norm(const std::vector<int> &face,
@@ -696,7 +752,9 @@ inline double Geometry::face_area(const std::vector<int> &face) const
 
 inline Vec3d Geometry::face_nearpt(int f_idx, Vec3d P) const
 {
-  return face_nearpt(faces(f_idx), P);
+  if (face_storage == FACES_FLAT)
+    return face_nearpt(face_view(f_idx).to_vector(), P);
+  return face_nearpt(face_elems[f_idx], P);
 }
 
 inline Vec3d Geometry::face_nearpt(const std::vector<int> &face, Vec3d P) const
@@ -788,29 +846,47 @@ inline int Geometry::edges(int e_idx, int v_no) const
   return edge_elems[e_idx][v_no];
 }
 
+inline unsigned int Geometry::num_faces() const
+{
+  return (face_storage == FACES_FLAT) ? flat_face_elems.size()
+                                      : face_elems.size();
+}
+
+inline FaceView Geometry::face_view(int f_idx) const
+{
+  return (face_storage == FACES_FLAT) ? flat_face_elems[f_idx]
+                                      : FaceView(face_elems[f_idx]);
+}
+
+// Write access may change the storage, but read access through a const
+// geometry may not, so that is checked in all builds
 inline std::vector<std::vector<int>> &Geometry::raw_faces()
 {
+  if (face_storage == FACES_FLAT)
+    set_face_storage(FACES_NESTED);
   return face_elems;
 }
 
 inline const std::vector<std::vector<int>> &Geometry::faces() const
 {
+  if (face_storage == FACES_FLAT)
+    nested_faces_error();
   return face_elems;
 }
 
 inline const std::vector<int> &Geometry::faces(int f_idx) const
 {
-  return face_elems[f_idx];
+  return faces()[f_idx];
 }
 
 inline std::vector<int> &Geometry::faces(int f_idx)
 {
-  return face_elems[f_idx];
+  return raw_faces()[f_idx];
 }
 
 inline int Geometry::faces(int f_idx, int v_no) const
 {
-  return face_elems[f_idx][v_no];
+  return face_view(f_idx)[v_no];
 }
 
 inline const ElemProps<Color> &Geometry::colors(int type) const
@@ -29,7 +29,11 @@
 #include "geometryinfo.h"
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "parallel.h"
+#include "planar.h"
 #include "private_misc.h"
+#include "timer.h"
+#include "vec_batch.h"
 #include <algorithm>
 #include <map>
 #include <set>
@@ -119,6 +123,9 @@ void GeometryInfo::reset()
   genus_val = INT_MAX;
   dual.clear_all();
   sym = Symmetry();
+  found_impl_edges = false;
+  impl_edges.clear();
+  found_efpairs = false;
   efpairs.clear();
   edge_parts.clear();
   face_angles.clear();
@@ -129,15 +136,129 @@ void GeometryInfo::reset()
   vertex_angles.clear();
   f_areas.clear();
   f_perimeters.clear();
+  f_windings.clear();
   vert_cons.clear();
   vert_cons_orig.clear();
   face_cons.clear();
   vert_norms.clear();
   found_free_verts = false;
   free_verts.clear();
+  compute_times.clear();
   set_center(cent);
 }
 
+// Each group sets values that are not used by the other groups, except
+// for values found by compute() before the groups are started
+void GeometryInfo::compute_prop(int prop)
+{
+  switch (prop) {
+  case PROP_CONNECTIVITY:
+    is_known_connectivity();
+    genus(); // also orientability and parts
+    break;
+  case PROP_FACE_AREAS:
+    get_f_areas();
+    break;
+  case PROP_FACE_SHAPES:
+    get_f_perimeters();
+    get_f_max_nonplanars();
+    break;
+  case PROP_FACE_WINDINGS:
+    get_f_windings();
+    break;
+  case PROP_PLANE_ANGLES:
+    get_plane_angles();
+    break;
+  case PROP_EDGE_LENGTHS:
+    get_edge_lengths_by_size();
+    get_iedge_lengths_by_size();
+    break;
+  case PROP_DIHEDRAL_ANGLES:
+    get_dihedral_angles_by_size();
+    break;
+  case PROP_SOLID_ANGLES:
+    get_solid_angles_by_size();
+    break;
+  case PROP_VERT_FIGS:
+    get_vert_figs();
+    break;
+  case PROP_DISTANCES:
+    vert_dist_lims();
+    edge_dist_lims();
+    iedge_dist_lims();
+    face_dist_lims();
+    break;
+  case PROP_SYMMETRY:
+    get_symmetry_axes();
+    get_symmetry_subgroups();
+    break;
+  }
+}
+
+void GeometryInfo::compute(unsigned int props, int num_threads)
+{
+  // shared values, used by more than one group
+  is_oriented();
+  if (props & (PROP_CONNECTIVITY | PROP_DIHEDRAL_ANGLES))
+    get_edge_face_pairs();
+  if (props & (PROP_CONNECTIVITY | PROP_EDGE_LENGTHS))
+    get_impl_edges();
+
+  // slowest groups first, so they are not left until the end
+  const int prop_order[] = {PROP_SYMMETRY,        PROP_SOLID_ANGLES,
+                            PROP_VERT_FIGS,       PROP_FACE_WINDINGS,
+                            PROP_CONNECTIVITY,    PROP_DIHEDRAL_ANGLES,
+                            PROP_PLANE_ANGLES,    PROP_EDGE_LENGTHS,
+                            PROP_DISTANCES,       PROP_FACE_AREAS,
+                            PROP_FACE_SHAPES};
+  vector<int> todo;
+  for (int prop : prop_order)
+    if (props & prop)
+      todo.push_back(prop);
+
+  vector<double> times(todo.size());
+  parallel_for(todo.size(),
+               [&](size_t i) {
+                 Timer timer;
+                 compute_prop(todo[i]);
+                 times[i] = timer.elapsed();
+               },
+               num_threads, 1);
+
+  for (unsigned int i = 0; i < todo.size(); i++)
+    compute_times[todo[i]] = times[i];
+}
+
+const char *GeometryInfo::get_prop_name(int prop)
+{
+  switch (prop) {
+  case PROP_CONNECTIVITY:
+    return "connectivity";
+  case PROP_FACE_AREAS:
+    return "face_areas";
+  case PROP_FACE_SHAPES:
+    return "face_shapes";
+  case PROP_FACE_WINDINGS:
+    return "face_windings";
+  case PROP_PLANE_ANGLES:
+    return "plane_angles";
+  case PROP_EDGE_LENGTHS:
+    return "edge_lengths";
+  case PROP_DIHEDRAL_ANGLES:
+    return "dihedral_angles";
+  case PROP_SOLID_ANGLES:
+    return "solid_angles";
+  case PROP_VERT_FIGS:
+    return "vertex_figures";
+  case PROP_DISTANCES:
+    return "distances";
+  case PROP_SYMMETRY:
+    return "symmetry";
+  default:
+    return "";
+  }
+}
+
 void GeometryInfo::set_center(Vec3d center)
 {
   cent = center;
@@ -151,7 +272,11 @@ const Geometry &GeometryInfo::get_geom() const { return geom; }
 
 Vec3d GeometryInfo::get_center() const { return cent; }
 
-void GeometryInfo::find_impl_edges() { geom.get_impl_edges(impl_edges); }
+void GeometryInfo::find_impl_edges()
+{
+  geom.get_impl_edges(impl_edges);
+  found_impl_edges = true;
+}
 
 bool GeometryInfo::is_closed()
 {
@@ -190,7 +315,7 @@ int GeometryInfo::num_edges() const { return geom.edges().size(); }
 
 int GeometryInfo::num_iedges() { return get_impl_edges().size(); }
 
-int GeometryInfo::num_faces() const { return geom.faces().size(); }
+int GeometryInfo::num_faces() const { return geom.num_faces(); }
 
 int GeometryInfo::num_parts()
 {
@@ -358,7 +483,7 @@ const vector<int> &GeometryInfo::get_free_verts()
 // edges
 const map<vector<int>, vector<int>> &GeometryInfo::get_edge_face_pairs()
 {
-  if (!efpairs.size())
+  if (!found_efpairs)
     find_edge_face_pairs();
   return efpairs;
 }
@@ -396,7 +521,7 @@ GeometryInfo::get_edge_lengths_by_size()
 // implicit edges
 const vector<vector<int>> &GeometryInfo::get_impl_edges()
 {
-  if (!impl_edges.size())
+  if (!found_impl_edges)
     find_impl_edges();
   return impl_edges;
 }
@@ -439,6 +564,13 @@ const vector<double> &GeometryInfo::get_f_max_nonplanars()
   return f_max_nonplanars;
 }
 
+const vector<int> &GeometryInfo::get_f_windings()
+{
+  if (!f_windings.size())
+    find_f_windings();
+  return f_windings;
+}
+
 const Geometry &GeometryInfo::get_dual()
 {
   if (!dual.faces().size())
@@ -512,6 +644,7 @@ void GeometryInfo::find_edge_face_pairs()
     efpairs = geom.get_edge_face_pairs(true);
   else
     efpairs = geom.get_edge_face_pairs(false);
+  found_efpairs = true;
 }
 
 void GeometryInfo::find_connectivity()
@@ -520,7 +653,7 @@ void GeometryInfo::find_connectivity()
   map<vector<int>, vector<int>> tmp_efpairs;
   if (is_oriented())
     tmp_efpairs = geom.get_edge_face_pairs(false);
-  else if (efpairs.size() == 0)
+  else if (!found_efpairs)
     find_edge_face_pairs();
 
   const map<vector<int>, vector<int>> &pairs =
@@ -547,25 +680,9 @@ void GeometryInfo::find_connectivity()
 
 static double face_vol(const Geometry &geom, int f_no, Vec3d *face_vol_cent)
 {
-  double f_vol = 0;
-  Vec3d f_vol_cent = Vec3d(0, 0, 0);
   const vector<Vec3d> &verts = geom.verts();
-  const vector<int> &face = geom.faces(f_no);
-  Vec3d V = verts[0];
-  Vec3d v0 = verts[face[0]];
-  for (unsigned int i = 1; i < face.size() - 1; i++) {
-    const Vec3d &v1 = verts[face[i]];
-    const Vec3d &v2 = verts[face[i + 1]];
-    double tet_vol = vtriple(v0 - V, v1 - V, v2 - V);
-    f_vol_cent += tet_vol * (V + v0 + v1 + v2); // /4 deferred
-    f_vol += tet_vol;                           // /6 deferred
-  }
-  if (!double_eq(f_vol, 0))
-    *face_vol_cent = (f_vol_cent / 4) / f_vol;
-  else
-    *face_vol_cent = Vec3d(0, 0, 0);
-
-  return f_vol / 6;
+  return batch_cone_volume(verts.data(), geom.faces(f_no), verts[0],
+                           face_vol_cent);
 }
 
 void GeometryInfo::find_f_areas()
@@ -654,7 +771,7 @@ void GeometryInfo::find_face_angles()
 
 void GeometryInfo::find_dihedral_angles()
 {
-  if (efpairs.size() == 0)
+  if (!found_efpairs)
     find_edge_face_pairs();
   edge_dihedrals.resize(efpairs.size());
 
@@ -1126,6 +1243,13 @@ void GeometryInfo::find_f_max_nonplanars()
   }
 }
 
+void GeometryInfo::find_f_windings()
+{
+  f_windings.resize(geom.faces().size());
+  for (unsigned int f = 0; f < geom.faces().size(); f++)
+    f_windings[f] = find_polygon_denominator_signed(geom, f, epsilon);
+}
+
 void GeometryInfo::find_symmetry() { sym.init(geom); }
 
 int GeometryInfo::genus()
@@ -1155,8 +1279,11 @@ static void set_edge_dists(const Geometry &geom, Vec3d cent,
                            const vector<vector<int>> &edges, ElementLimits &lim)
 {
   lim.init();
-  for (const auto &edge : edges) {
-    double dist = (geom.edge_nearpt(edge, cent) - cent).len();
+  vector<Vec3d> near_pts(edges.size());
+  batch_edge_nearest_points(geom.verts().data(), edges, cent, near_pts.data());
+  for (unsigned int i = 0; i < edges.size(); i++) {
+    const vector<int> &edge = edges[i];
+    double dist = (near_pts[i] - cent).len();
     if (dist < lim.min) {
       lim.min = dist;
       lim.idx[ElementLimits::IDX_MIN] = edge[0];
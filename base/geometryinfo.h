@@ -140,7 +140,9 @@ private:
   ElementLimits f_dists;
 
   std::vector<std::vector<int>> impl_edges;
+  bool found_impl_edges;
   std::map<std::vector<int>, std::vector<int>> efpairs;
+  bool found_efpairs;
   std::vector<std::vector<int>> edge_parts;
   std::map<std::vector<double>, int, AngleVectLess> face_angles;
   std::map<std::vector<double>, int, AngleVectLess> vert_dihed;
@@ -155,6 +157,7 @@ private:
   std::vector<double> f_areas;
   std::vector<double> f_perimeters;
   std::vector<double> f_max_nonplanars;
+  std::vector<int> f_windings;
   std::vector<std::vector<int>> vert_cons;
   std::vector<std::vector<int>> vert_cons_orig;
   std::vector<std::vector<std::vector<int>>> face_cons;
@@ -165,6 +168,7 @@ private:
   bool found_free_verts;
   Geometry dual;
   Symmetry sym;
+  std::map<int, double> compute_times;
 
   void find_impl_edges();
   void find_edge_face_pairs();
@@ -185,25 +189,67 @@ private:
   void find_f_areas();
   void find_f_perimeters();
   void find_f_max_nonplanars();
+  void find_f_windings();
   void find_oriented();
   void find_v_dist_lims();
   void find_e_dist_lims();
   void find_ie_dist_lims();
   void find_f_dist_lims();
   void find_symmetry();
+  void compute_prop(int prop);
 
 protected:
   const Geometry &geom;
 
 public:
+  /// Groups of properties that can be found by compute()
+  enum {
+    PROP_CONNECTIVITY = 1 << 0,    ///< connectivity, orientability, genus
+    PROP_FACE_AREAS = 1 << 1,      ///< face areas, volume
+    PROP_FACE_SHAPES = 1 << 2,     ///< face perimeters and non-planarity
+    PROP_FACE_WINDINGS = 1 << 3,   ///< face winding numbers
+    PROP_PLANE_ANGLES = 1 << 4,    ///< plane angles
+    PROP_EDGE_LENGTHS = 1 << 5,    ///< explicit and implicit edge lengths
+    PROP_DIHEDRAL_ANGLES = 1 << 6, ///< dihedral angles
+    PROP_SOLID_ANGLES = 1 << 7,    ///< solid angles
+    PROP_VERT_FIGS = 1 << 8,       ///< vertex connections and figures
+    PROP_DISTANCES = 1 << 9,       ///< element distance limits from the centre
+    PROP_SYMMETRY = 1 << 10,       ///< symmetry group, axes and subgroups
+    PROP_ALL = (1 << 11) - 1       ///< all the property groups
+  };
+
   /// Constructor
-  /**\param geo geometry to get information about
+  /**\param geo geometry to get information about, with nested face storage
    * \param center used for any properties that are relative to a centre */
   GeometryInfo(const Geometry &geo, Vec3d center = Vec3d(0, 0, 0));
 
   /// Reset, clear all setting
   void reset();
 
+  /// Find groups of properties at the same time
+  /** The values that the groups share, like the edge face pairs and the
+   *  implicit edges, are found first, and then the groups are found
+   *  concurrently. Groups that have already been found are not found
+   *  again. The properties are then returned by the usual functions.
+   *  The geometry should not be changed while the groups are found.
+   * \param props the groups to find, PROP_ values combined with \c |
+   * \param num_threads the number of threads, or if \c 0 then use
+   *  \c get_num_threads(). */
+  void compute(unsigned int props, int num_threads = 0);
+
+  /// Get the time taken to find each group of properties
+  /**\return A map from a PROP_ value to the time, in seconds, taken to
+   *  find the group by the last call of compute() that found it.*/
+  const std::map<int, double> &get_compute_times() const
+  {
+    return compute_times;
+  }
+
+  /// Get the name of a group of properties
+  /**\param prop a single PROP_ value.
+   * \return The name, or an empty string if the value is not valid.*/
+  static const char *get_prop_name(int prop);
+
   /// Get the geometry being analysed
   /**\return The geometry.*/
   const Geometry &get_geom() const;
@@ -493,6 +539,11 @@ public:
    * \return The face non-planarity values.*/
   const std::vector<double> &get_f_max_nonplanars();
 
+  /// Get face winding numbers
+  /** The winding number is the signed denominator of the polygon.
+   * \return The face winding numbers.*/
+  const std::vector<int> &get_f_windings();
+
   /// Get face connections
   /**Get, for each face, the faces connected to it across an edge.
    * \return The faces connected to each face.*/
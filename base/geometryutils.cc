@@ -139,7 +139,7 @@ int find_vert_by_coords(const Geometry &geom, const Vec3d &coords, double eps)
 }
 
 // elem could be face or another edge
-bool edge_exists_in_elem(const vector<int> &elem, const vector<int> &edge)
+bool edge_exists_in_elem(FaceView elem, const vector<int> &edge)
 {
   vector<int> edge1 = make_edge(edge[0], edge[1]);
 
@@ -158,7 +158,7 @@ bool edge_exists_in_elem(const vector<int> &elem, const vector<int> &edge)
   return found;
 }
 
-bool edge_exists_in_face(const vector<int> &face, const vector<int> &edge)
+bool edge_exists_in_face(FaceView face, const vector<int> &edge)
 {
   return edge_exists_in_elem(face, edge);
 }
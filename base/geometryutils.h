@@ -345,6 +345,92 @@ Vec3d face_normal_by_type(const Geometry &geom, const int f_idx,
 bool canonical_radius_range_test(const Geometry &geom,
                                  const double radius_range_percent);
 
+/// Metrics of a geometry that is being adjusted by an iterative solver
+/**The implicit edges and the face edge indexes are found once, and the
+ * work arrays are kept between iterations, so measuring an iteration does
+ * not allocate. The vertex positions may change, but the faces must not
+ * change while the tracker is in use. */
+class GeometryMetrics {
+private:
+  const Geometry &geom;
+  std::vector<std::vector<int>> edges;
+  std::vector<std::vector<int>> face_edges;
+  std::vector<Vec3d> verts_last;
+  std::vector<Vec3d> near_pts;
+
+  double max_diff2;
+  Vec3d cent;
+  Vec3d min_coords;
+  Vec3d max_coords;
+
+  void update_vert_metrics(const std::vector<Vec3d> *offsets);
+
+public:
+  /// Constructor
+  /**\param geom the geometry to track. */
+  GeometryMetrics(const Geometry &geom);
+
+  /// Get the implicit edges
+  /**\return The implicit edges, as from \c Geometry::get_impl_edges() */
+  const std::vector<std::vector<int>> &get_impl_edges() const
+  {
+    return edges;
+  }
+
+  /// Get the face edge indexes
+  /**\return For each face, and each vertex position \c v in the face,
+   *  the index in the implicit edges of the edge from position \c v to
+   *  position \c v+1. */
+  const std::vector<std::vector<int>> &get_face_edges() const
+  {
+    return face_edges;
+  }
+
+  /// Find the centroid of the edge near points
+  /**\param cent the point to find the nearest edge points to.
+   * \return The centroid, as from \c edge_nearpoints_centroid() */
+  Vec3d edge_nearpts_centroid(Vec3d cent = Vec3d(0, 0, 0)) const;
+
+  /// Find the edge near points radius, using the cached edges
+  /**\param min returns the minimum nearpoints radius.
+   * \param max returns the maximum nearpoints radius.
+   * \param center returns the centre of the nearpoints.
+   * \return The average radius, as from \c edge_nearpoints_radius() */
+  double edge_nearpts_radius(double &min, double &max, Vec3d &center);
+
+  /// Save the current vertex positions
+  /**The next call to \c update() measures the change from these. */
+  void save_verts();
+
+  /// Measure the geometry after an iteration that moved the vertices
+  /**The displacements are measured from the vertex positions saved by
+   * \c save_verts(). */
+  void update();
+
+  /// Measure the geometry after an iteration that offset the vertices
+  /**\param offsets the offsets that have been added to the vertices, which
+   *  are used as the displacements. */
+  void update(const std::vector<Vec3d> &offsets);
+
+  /// Get the maximum displacement squared of a vertex in the last update
+  /**\return The maximum displacement squared. */
+  double get_max_diff2() const { return max_diff2; }
+
+  /// Get the centroid of the vertices at the last update
+  /**\return The centroid. */
+  Vec3d get_centroid() const { return cent; }
+
+  /// Get the width of the vertex bounding box at the last update
+  /**\return The length of the bounding box diagonal, as from
+   *  \c BoundBox::max_width() */
+  double get_max_width() const { return (max_coords - min_coords).len(); }
+
+  /// Test the vertex radius range at the last update
+  /**\param radius_range_percent limit to maximum radius over minimum radius
+   * \return The same result as \c canonical_radius_range_test() */
+  bool radius_range_test(const double radius_range_percent) const;
+};
+
 /// Canonicalize (George Hart "Mathematica" algorithm)
 /**See http://library.wolfram.com/infocenter/Articles/2012/
  * \param geom geometry to canonicalise.
@@ -518,8 +604,7 @@ int find_vert_by_coords(const Geometry &geom, const Vec3d &coords,
 /**\param face the face.
  * \param edge the edge to find.
  * \return \c true if the edge is part of the face, otherwise \c false. */
-bool edge_exists_in_face(const std::vector<int> &face,
-                         const std::vector<int> &edge);
+bool edge_exists_in_face(FaceView face, const std::vector<int> &edge);
 
 /// Find faces that include a particular edge
 /**\param faces the faces to searc.
@@ -0,0 +1,221 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file instances.cc
+   \brief A part repeated by a set of transformations
+*/
+
+#include <vector>
+
+#include "instances.h"
+#include "parallel.h"
+#include "private_off_file.h"
+#include "utils.h"
+#include "vec_utils.h"
+
+using std::string;
+using std::vector;
+
+namespace anti {
+
+void InstancedGeometry::init(const Geometry &prt, const Transformations &ts,
+                             char col_part_elems, Coloring *clrngs)
+{
+  Coloring tmp_clrngs[3];
+  if (!clrngs)
+    clrngs = tmp_clrngs;
+
+  part = prt;
+  col_elems = col_part_elems;
+  // the edges are the same for every instance, so only add them once
+  if (col_elems & ELEM_EDGES)
+    part.add_missing_impl_edges();
+
+  trans.assign(ts.begin(), ts.end());
+  for (int i = 0; i < 3; i++) {
+    inst_cols[i].clear();
+    if (has_inst_cols(i))
+      for (unsigned int idx = 0; idx < trans.size(); idx++)
+        inst_cols[i].push_back(clrngs[i].get_col(idx));
+  }
+}
+
+void InstancedGeometry::init(const Geometry &prt, const vector<Trans3d> &ts)
+{
+  part = prt;
+  trans = ts;
+  col_elems = ELEM_NONE;
+  for (auto &cols : inst_cols)
+    cols.clear();
+}
+
+Color InstancedGeometry::get_col(int type, unsigned int inst) const
+{
+  return has_inst_cols(type) ? inst_cols[type][inst] : Color();
+}
+
+Vec3d InstancedGeometry::centroid() const
+{
+  // transformations are affine, so the centroid of the instance centroids
+  // is the centroid of all the vertices
+  if (!size() || !part.verts().size())
+    return Vec3d(0, 0, 0);
+
+  const Vec3d part_cent = part.centroid();
+  Vec3d cent(0, 0, 0);
+  for (const auto &tr : trans)
+    cent += tr * part_cent;
+  return cent / size();
+}
+
+BoundSphere InstancedGeometry::get_bound_sphere() const
+{
+  // only the vertices of the instances are needed for the bound
+  const vector<Vec3d> &p_verts = part.verts();
+  vector<Vec3d> verts;
+  verts.reserve(num_verts());
+  for (const auto &tr : trans)
+    for (const auto &v : p_verts)
+      verts.push_back(tr * v);
+  return BoundSphere(verts);
+}
+
+void InstancedGeometry::get_instance(unsigned int inst, Geometry &geom) const
+{
+  geom = part;
+  geom.transform(trans[inst]);
+  for (int i = 0; i < 3; i++) {
+    if (has_inst_cols(i)) {
+      geom.colors(i).clear();
+      const Color &col = inst_cols[i][inst];
+      if (col.is_set()) {
+        const int num_elems[3] = {(int)geom.verts().size(),
+                                  (int)geom.edges().size(),
+                                  (int)geom.num_faces()};
+        for (int j = 0; j < num_elems[i]; j++)
+          geom.colors(i).set(j, col);
+      }
+    }
+  }
+}
+
+void InstancedGeometry::expand(Geometry &geom, int num_threads) const
+{
+  // each instance fills its own slots, use threads for large expansions
+  const size_t min_parallel_elems = 10000;
+
+  const size_t n_inst = size();
+  const vector<Vec3d> &p_verts = part.verts();
+  const vector<vector<int>> &p_edges = part.edges();
+  const size_t n_verts = p_verts.size();
+  const size_t n_edges = p_edges.size();
+  const size_t n_faces = part.num_faces();
+
+  geom.clear_all();
+  vector<Vec3d> &verts = geom.raw_verts();
+  vector<vector<int>> &edges = geom.raw_edges();
+  verts.resize(n_inst * n_verts);
+  edges.resize(n_inst * n_edges);
+  const bool flat = (geom.get_face_storage() == Geometry::FACES_FLAT);
+  vector<vector<int>> *faces = flat ? nullptr : &geom.raw_faces();
+  if (faces)
+    faces->resize(n_inst * n_faces);
+
+  if (n_inst * (n_verts + n_edges + n_faces) < min_parallel_elems)
+    num_threads = 1;
+  parallel_for(
+      n_inst,
+      [&](size_t i) {
+        const Trans3d &tr = trans[i];
+        const int offset = i * n_verts;
+        for (size_t j = 0; j < n_verts; j++)
+          verts[i * n_verts + j] = tr * p_verts[j];
+        for (size_t j = 0; j < n_edges; j++) {
+          vector<int> &edge = edges[i * n_edges + j];
+          edge = p_edges[j];
+          for (int &v_idx : edge)
+            v_idx += offset;
+        }
+        if (faces) {
+          for (size_t j = 0; j < n_faces; j++) {
+            FaceView p_face = part.face_view(j);
+            vector<int> &face = (*faces)[i * n_faces + j];
+            face.resize(p_face.size());
+            for (size_t k = 0; k < p_face.size(); k++)
+              face[k] = p_face[k] + offset;
+          }
+        }
+      },
+      num_threads, 1);
+
+  if (flat) {
+    vector<int> face;
+    for (size_t i = 0; i < n_inst; i++) {
+      const int offset = i * n_verts;
+      for (size_t j = 0; j < n_faces; j++) {
+        FaceView p_face = part.face_view(j);
+        face.assign(p_face.begin(), p_face.end());
+        for (int &v_idx : face)
+          v_idx += offset;
+        geom.add_face(face);
+      }
+    }
+  }
+
+  // index numbers increase through the instances, so the colours are
+  // always added at the end of the maps
+  const size_t n_elems[3] = {n_verts, n_edges, n_faces};
+  for (int t = 0; t < 3; t++) {
+    auto &col_map = geom.colors(t).get_properties();
+    const auto &p_col_map = part.colors(t).get_properties();
+    for (size_t i = 0; i < n_inst; i++) {
+      const int offset = i * n_elems[t];
+      if (has_inst_cols(t)) {
+        const Color &col = inst_cols[t][i];
+        if (col.is_set())
+          for (size_t j = 0; j < n_elems[t]; j++)
+            col_map.emplace_hint(col_map.end(), offset + j, col);
+      }
+      else
+        for (const auto &kp : p_col_map)
+          col_map.emplace_hint(col_map.end(), offset + kp.first, kp.second);
+    }
+  }
+}
+
+Status InstancedGeometry::write(string file_name, int sig_dgts) const
+{
+  Status stat;
+  char errmsg[MSG_SZ];
+  if (!off_file_write(file_name, *this, errmsg, sig_dgts))
+    stat.set_error(errmsg);
+  return stat;
+}
+
+void InstancedGeometry::write(FILE *file, int sig_dgts) const
+{
+  off_file_write(file, *this, sig_dgts);
+}
+
+} // namespace anti
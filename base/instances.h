@@ -0,0 +1,159 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file instances.h
+   \brief A part repeated by a set of transformations
+*/
+
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "boundbox.h"
+#include "coloring.h"
+#include "geometry.h"
+#include "symmetry.h"
+
+namespace anti {
+
+/// A part repeated by a set of transformations
+/** The part is stored once, with a transformation, and optionally a
+ *  colour, for each instance. Analysis and display can work on the
+ *  instances directly, and the model is only expanded into a single
+ *  geometry when that is needed. */
+class InstancedGeometry {
+private:
+  Geometry part;
+  std::vector<Trans3d> trans;
+  std::vector<Color> inst_cols[3];
+  char col_elems;
+
+public:
+  /// Constructor
+  InstancedGeometry() : col_elems(ELEM_NONE) {}
+
+  /// Initialise from a set of symmetry transformations
+  /** This follows \c sym_repeat(), and the instances are in the
+   *  order of the transformations in the set.
+   * \param prt the part to be repeated.
+   * \param ts the transformations to be used for the instances.
+   * \param col_part_elems element types, combining flags ELEM_VERTS,
+   *   ELEM_EDGES an ELEM_FACES, to be coloured, based on the
+   *   order position of the transformation that produced them.
+   * \param clrngs an array of three Colorings applied, correspondingly, to
+   *  the index coloured vertices, edges and faces. */
+  void init(const Geometry &prt, const Transformations &ts,
+            char col_part_elems = ELEM_NONE, Coloring *clrngs = nullptr);
+
+  /// Initialise from a list of transformations
+  /**\param prt the part to be repeated.
+   * \param ts the transformations to be used for the instances. */
+  void init(const Geometry &prt, const std::vector<Trans3d> &ts);
+
+  /// Get the part
+  /**\return The part. */
+  const Geometry &get_part() const { return part; }
+
+  /// Get the transformations
+  /**\return The transformation of each instance. */
+  const std::vector<Trans3d> &get_trans() const { return trans; }
+
+  /// Get the number of instances
+  /**\return The number of instances. */
+  unsigned int size() const { return trans.size(); }
+
+  /// Check whether instances set the colour of an element type
+  /**\param type the element type, from VERTS, EDGES, FACES.
+   * \return \c true if all the elements of the type in an instance take
+   *  the instance colour, otherwise \c false. */
+  bool has_inst_cols(int type) const
+  {
+    return col_elems & (1 << type);
+  }
+
+  /// Get the colour of an instance
+  /**\param type the element type, from VERTS, EDGES, FACES.
+   * \param inst the instance index number.
+   * \return The colour, which is unset if the instance does not set
+   *  the colour of this element type. */
+  Color get_col(int type, unsigned int inst) const;
+
+  /// Get the number of vertices of the expanded model
+  /**\return The number of vertices. */
+  unsigned int num_verts() const { return size() * part.verts().size(); }
+
+  /// Get the number of edges of the expanded model
+  /**\return The number of edges. */
+  unsigned int num_edges() const { return size() * part.edges().size(); }
+
+  /// Get the number of faces of the expanded model
+  /**\return The number of faces. */
+  unsigned int num_faces() const { return size() * part.num_faces(); }
+
+  /// Get the vertex centroid of the expanded model
+  /**\return The centroid. */
+  Vec3d centroid() const;
+
+  /// Get the bounding sphere of the expanded model
+  /**\return The bounding sphere. */
+  BoundSphere get_bound_sphere() const;
+
+  /// Get a single instance
+  /**\param inst the instance index number.
+   * \param geom to return the transformed and coloured part. */
+  void get_instance(unsigned int inst, Geometry &geom) const;
+
+  /// Expand into a single geometry
+  /** The elements of each instance follow those of the previous
+   *  instance, in the same order as the part.
+   * \param geom to return the expanded model.
+   * \param num_threads the number of threads, or if \c 0 then use
+   *  \c get_num_threads(). */
+  void expand(Geometry &geom, int num_threads = 0) const;
+
+  /// Write the expanded model to an OFF file
+  /** The output is the same as writing the model from \c expand(),
+   *  but the expanded model is never held in memory.
+   * \param file_name the file name ("" for standard output.)
+   * \param sig_dgts the number of significant digits to write,
+   *  or if negative then the number of digits after the decimal point.
+   * \return status, which evaluates to \c true if the file could be
+   *  written, otherwise \c false to indicate an error. */
+  Status write(std::string file_name = "",
+               int sig_dgts = DEF_SIG_DGTS) const;
+
+  /// Write the expanded model to an OFF file stream
+  /**\param file the file stream.
+   * \param sig_dgts the number of significant digits to write,
+   *  or if negative then the number of digits after the decimal point. */
+  void write(FILE *file, int sig_dgts = DEF_SIG_DGTS) const;
+};
+
+} // namespace anti
+
+#endif // INSTANCES_H
@@ -39,7 +39,7 @@ namespace anti {
 // face normal
 Normal::Normal(const Geometry &geom, const int face_idx, Vec3d C, double eps)
 {
-  const vector<int> &face = geom.faces()[face_idx];
+  FaceView face = geom.face_view(face_idx);
   const vector<Vec3d> &verts = geom.verts();
 
   normal = face_norm(verts, face);
@@ -80,7 +80,7 @@ void FaceNormals::refresh(const Geometry &geom, Vec3d cent, double eps)
     cent = centroid((*ngeom).verts());
 
   normals.clear();
-  for (unsigned int i = 0; i < geom.faces().size(); i++)
+  for (unsigned int i = 0; i < geom.num_faces(); i++)
     normals.push_back(Normal(*ngeom, i, cent, eps));
 }
 
@@ -37,6 +37,7 @@
 #include "polygon.h"
 #include "private_off_file.h"
 #include "private_std_polys.h"
+#include "trace.h"
 #include "utils.h"
 
 using std::string;
@@ -204,6 +205,8 @@ bool add_face(Geometry &geom, vector<char *> vals, char *errmsg,
 
 bool off_file_read(FILE *ifile, Geometry &geom, char *errmsg)
 {
+  static TraceSite trace_site("off_file_read");
+  TraceZone zone(trace_site);
   char errmsg2[MSG_SZ];
 
   int file_line_no = 0; // line number in the file
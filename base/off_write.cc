@@ -34,9 +34,9 @@
 #include <vector>
 
 #include "private_off_file.h"
+#include "trace.h"
 #include "utils.h"
 
-using std::map;
 using std::string;
 using std::vector;
 
@@ -60,12 +60,20 @@ void file_close_w(FILE *ofile)
     fclose(ofile);
 }
 
+// write the coordinates of one point, shared by the geometry and instanced
+// geometry writers
+static void crd_write(FILE *ofile, const Vec3d &v, const char *sep,
+                      int sig_dgts)
+{
+  char line[MSG_SZ];
+  fprintf(ofile, "%s\n", vtostr(line, v, sep, sig_dgts));
+}
+
 void crds_write(FILE *ofile, const Geometry &geom, const char *sep,
                 int sig_dgts)
 {
-  char line[MSG_SZ];
   for (unsigned int i = 0; i < geom.verts().size(); i++)
-    fprintf(ofile, "%s\n", vtostr(line, geom.verts(i), sep, sig_dgts));
+    crd_write(ofile, geom.verts(i), sep, sig_dgts);
 }
 
 bool crds_write(string file_name, const Geometry &geom, char *errmsg,
@@ -161,7 +169,7 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
   Color last_color = Color();
 
   // f entries
-  for (unsigned int i = 0; i < geom.faces().size(); i++) {
+  for (unsigned int i = 0; i < geom.num_faces(); i++) {
     // if materials, color logic
     if (mfile) {
       Color c = geom.colors(FACES).get(i);
@@ -180,8 +188,8 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
       last_color = c;
     }
     fprintf(ofile, "f");
-    for (unsigned int j = 0; j < geom.faces(i).size(); j++)
-      fprintf(ofile, " %d", geom.faces(i, j) + offset);
+    for (int v_idx : geom.face_view(i))
+      fprintf(ofile, " %d", v_idx + offset);
     fprintf(ofile, "\n");
   }
 
@@ -298,42 +306,57 @@ char *off_col(char *str, Color col)
   return str;
 }
 
-void off_polys_write(FILE *ofile, const Geometry &geom, int offset)
+// write OFF elements, shared by the geometry and instanced geometry writers,
+// the vertex indexes are increased by offset
+static void off_face_write(FILE *ofile, const FaceView &face, int offset,
+                           Color col)
 {
   char col_str[MSG_SZ];
-  for (unsigned int i = 0; i < geom.faces().size(); i++) {
-    fprintf(ofile, "%lu", (unsigned long)geom.faces(i).size());
-    for (unsigned int j = 0; j < geom.faces(i).size(); j++) {
-      fprintf(ofile, " %d", geom.faces(i, j) + offset);
-    }
-    fprintf(ofile, " %s", off_col(col_str, geom.colors(FACES).get(i)));
-    fprintf(ofile, "\n");
-  }
+  fprintf(ofile, "%lu", (unsigned long)face.size());
+  for (int v_idx : face)
+    fprintf(ofile, " %d", v_idx + offset);
+  fprintf(ofile, " %s\n", off_col(col_str, col));
+}
+
+static void off_edge_write(FILE *ofile, const vector<int> &edge, int offset,
+                           Color col)
+{
+  char col_str[MSG_SZ];
+  fprintf(ofile, "2 %d %d %s\n", edge[0] + offset, edge[1] + offset,
+          off_col(col_str, col));
+}
+
+static void off_vert_elem_write(FILE *ofile, int v_idx, int offset, Color col)
+{
+  char col_str[MSG_SZ];
+  fprintf(ofile, "1 %d %s\n", v_idx + offset, off_col(col_str, col));
+}
+
+void off_polys_write(FILE *ofile, const Geometry &geom, int offset)
+{
+  for (unsigned int i = 0; i < geom.num_faces(); i++)
+    off_face_write(ofile, geom.face_view(i), offset,
+                   geom.colors(FACES).get(i));
+
+  for (unsigned int i = 0; i < geom.edges().size(); i++)
+    off_edge_write(ofile, geom.edges(i), offset, geom.colors(EDGES).get(i));
 
-  for (unsigned int i = 0; i < geom.edges().size(); i++) {
-    fprintf(ofile, "2 %d %d", geom.edges(i, 0) + offset,
-            geom.edges(i, 1) + offset);
-    fprintf(ofile, " %s", off_col(col_str, geom.colors(EDGES).get(i)));
-    fprintf(ofile, "\n");
-  }
   // print coloured vertex elements
-  map<int, Color>::const_iterator mi;
-  for (mi = geom.colors(VERTS).get_properties().begin();
-       mi != geom.colors(VERTS).get_properties().end(); mi++) {
-    fprintf(ofile, "1 %d %s\n", (mi->first) + offset,
-            off_col(col_str, mi->second));
-  }
+  for (const auto &kp : geom.colors(VERTS).get_properties())
+    off_vert_elem_write(ofile, kp.first, offset, kp.second);
 }
 
 void off_file_write(FILE *ofile, const vector<const Geometry *> &geoms,
                     int sig_dgts)
 {
+  static TraceSite trace_site("off_file_write");
+  TraceZone zone(trace_site);
   int vert_cnt = 0, face_cnt = 0, edge_cnt = 0;
   for (auto geom : geoms) {
     int num_v_col_elems = geom->colors(VERTS).get_properties().size();
     vert_cnt += geom->verts().size();
     edge_cnt += geom->edges().size();
-    face_cnt += geom->faces().size() + num_v_col_elems + edge_cnt;
+    face_cnt += geom->num_faces() + num_v_col_elems + edge_cnt;
   }
 
   fprintf(ofile, "OFF\n%d %d 0\n", vert_cnt, face_cnt);
@@ -357,3 +380,70 @@ void off_file_write(FILE *ofile, const Geometry &geom, int sig_dgts)
   vg.push_back(&geom);
   off_file_write(ofile, vg, sig_dgts);
 }
+
+bool off_file_write(string file_name, const InstancedGeometry &inst_geom,
+                    char *errmsg, int sig_dgts)
+{
+  if (errmsg)
+    *errmsg = '\0';
+  FILE *ofile = file_open_w(file_name, errmsg);
+  if (!ofile)
+    return false;
+
+  off_file_write(ofile, inst_geom, sig_dgts);
+  file_close_w(ofile);
+  return true;
+}
+
+// The output is the same as for the expanded model, but the elements are
+// generated from the part as they are written
+void off_file_write(FILE *ofile, const InstancedGeometry &inst_geom,
+                    int sig_dgts)
+{
+  static TraceSite trace_site("off_file_write");
+  TraceZone zone(trace_site);
+  const Geometry &part = inst_geom.get_part();
+  const vector<Trans3d> &trans = inst_geom.get_trans();
+  const int n_verts = part.verts().size();
+
+  // Colour of element idx of an instance
+  auto inst_col = [&](int type, unsigned int inst, int idx) {
+    return inst_geom.has_inst_cols(type) ? inst_geom.get_col(type, inst)
+                                         : part.colors(type).get(idx);
+  };
+
+  int num_v_col_elems = 0;
+  for (unsigned int i = 0; i < inst_geom.size(); i++)
+    num_v_col_elems += !inst_geom.has_inst_cols(VERTS)
+                           ? part.colors(VERTS).get_properties().size()
+                           : inst_geom.get_col(VERTS, i).is_set() ? n_verts
+                                                                 : 0;
+  fprintf(ofile, "OFF\n%d %d 0\n", (int)inst_geom.num_verts(),
+          (int)(inst_geom.num_faces() + num_v_col_elems +
+                inst_geom.num_edges()));
+
+  for (const auto &tr : trans)
+    for (const auto &v : part.verts())
+      crd_write(ofile, tr * v, " ", sig_dgts);
+
+  for (unsigned int i = 0; i < trans.size(); i++)
+    for (unsigned int j = 0; j < part.num_faces(); j++)
+      off_face_write(ofile, part.face_view(j), i * n_verts,
+                     inst_col(FACES, i, j));
+
+  for (unsigned int i = 0; i < trans.size(); i++)
+    for (unsigned int j = 0; j < part.edges().size(); j++)
+      off_edge_write(ofile, part.edges(j), i * n_verts, inst_col(EDGES, i, j));
+
+  for (unsigned int i = 0; i < trans.size(); i++) {
+    const int offset = i * n_verts;
+    if (!inst_geom.has_inst_cols(VERTS)) {
+      for (const auto &kp : part.colors(VERTS).get_properties())
+        off_vert_elem_write(ofile, kp.first, offset, kp.second);
+    }
+    else if (inst_geom.get_col(VERTS, i).is_set()) {
+      for (int j = 0; j < n_verts; j++)
+        off_vert_elem_write(ofile, j, offset, inst_geom.get_col(VERTS, i));
+    }
+  }
+}
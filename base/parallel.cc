@@ -0,0 +1,162 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file parallel.cc
+   \brief Utilities for processing in parallel with several threads
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+
+#include "parallel.h"
+#include "utils.h"
+
+using std::function;
+using std::mutex;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+namespace anti {
+
+static std::atomic<int> num_threads_set(0);
+
+static int get_default_num_threads()
+{
+  int num = 0;
+  const char *env = getenv("ANTIPRISM_THREADS");
+  if (!(env && read_int(env, &num) && num > 0))
+    num = thread::hardware_concurrency();
+  return (num > 0) ? num : 1;
+}
+
+int get_num_threads()
+{
+  int num = num_threads_set;
+  if (num <= 0) {
+    num = get_default_num_threads();
+    num_threads_set = num;
+  }
+  return num;
+}
+
+void set_num_threads(int num) { num_threads_set = (num > 0) ? num : 0; }
+
+ThreadPool::ThreadPool(int num_threads) : num_busy(0), stopping(false)
+{
+  if (num_threads <= 0)
+    num_threads = get_num_threads();
+  for (int i = 0; i < num_threads; i++)
+    workers.push_back(thread(&ThreadPool::worker_loop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    unique_lock<mutex> lock(mtx);
+    stopping = true;
+  }
+  task_cond.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::worker_loop()
+{
+  while (true) {
+    function<void()> task;
+    {
+      unique_lock<mutex> lock(mtx);
+      task_cond.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) // only when stopping
+        return;
+      task = std::move(tasks.front());
+      tasks.pop_front();
+      num_busy++;
+    }
+
+    task();
+
+    {
+      unique_lock<mutex> lock(mtx);
+      num_busy--;
+      if (tasks.empty() && num_busy == 0)
+        done_cond.notify_all();
+    }
+  }
+}
+
+void ThreadPool::add_task(function<void()> task)
+{
+  {
+    unique_lock<mutex> lock(mtx);
+    tasks.push_back(std::move(task));
+  }
+  task_cond.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  unique_lock<mutex> lock(mtx);
+  done_cond.wait(lock, [this] { return tasks.empty() && num_busy == 0; });
+}
+
+void parallel_for(size_t num, const function<void(size_t)> &func,
+                  int num_threads, size_t chunk)
+{
+  if (num_threads <= 0)
+    num_threads = get_num_threads();
+  if ((size_t)num_threads > num)
+    num_threads = num;
+
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < num; i++)
+      func(i);
+    return;
+  }
+
+  // Aim for several chunks per thread, to balance the load
+  if (chunk == 0)
+    chunk = std::max(size_t(1), num / (8 * num_threads));
+
+  std::atomic<size_t> next(0);
+  auto run_chunks = [&]() {
+    size_t start;
+    while ((start = next.fetch_add(chunk)) < num) {
+      size_t end = std::min(start + chunk, num);
+      for (size_t i = start; i < end; i++)
+        func(i);
+    }
+  };
+
+  vector<thread> thrds;
+  for (int i = 0; i < num_threads - 1; i++)
+    thrds.push_back(thread(run_chunks));
+  run_chunks(); // the calling thread also does work
+  for (auto &thrd : thrds)
+    thrd.join();
+}
+
+} // namespace anti
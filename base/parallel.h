@@ -0,0 +1,107 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file parallel.h
+   \brief Utilities for processing in parallel with several threads
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace anti {
+
+/// Get the number of threads to use for parallel processing
+/** The default is taken from the environment variable \c ANTIPRISM_THREADS
+ *  if it is set to a positive integer, otherwise it is the number of
+ *  hardware threads.
+ * \return The number of threads. */
+int get_num_threads();
+
+/// Set the number of threads to use for parallel processing
+/**\param num the number of threads, or if \c 0 then restore the default. */
+void set_num_threads(int num);
+
+/// A fixed size pool of worker threads
+/** Tasks are run in the order they are added. A task should not
+ *  add further tasks and then wait for them. */
+class ThreadPool {
+private:
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mtx;
+  std::condition_variable task_cond;
+  std::condition_variable done_cond;
+  unsigned int num_busy;
+  bool stopping;
+
+  void worker_loop();
+
+public:
+  /// Constructor
+  /**\param num_threads the number of worker threads, or if \c 0 then
+   *  use \c get_num_threads(). */
+  ThreadPool(int num_threads = 0);
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// Destructor
+  /** Waits for all queued tasks to finish. */
+  ~ThreadPool();
+
+  /// Get the number of worker threads
+  /**\return The number of worker threads. */
+  int size() const { return workers.size(); }
+
+  /// Add a task
+  /**\param task the task to run. */
+  void add_task(std::function<void()> task);
+
+  /// Wait for all the tasks that have been added to finish
+  void wait();
+};
+
+/// Call a function for each index number in a range, using several threads
+/** Index numbers are handed out in chunks, in increasing order, to the
+ *  threads as they become free. With a single thread the function is
+ *  called for each index number in order in the calling thread.
+ * \param num the function is called for index numbers \c 0 to \c num-1
+ * \param func the function to call for an index number
+ * \param num_threads the number of threads, or if \c 0 then use
+ *  \c get_num_threads().
+ * \param chunk the number of consecutive index numbers handed to a thread
+ *  at one time, or if \c 0 then a size is chosen based on \a num. */
+void parallel_for(size_t num, const std::function<void(size_t)> &func,
+                  int num_threads = 0, size_t chunk = 0);
+
+} // namespace anti
+
+#endif // PARALLEL_H
@@ -37,6 +37,7 @@
 #include <vector>
 
 #include "planar.h"
+#include "predicates.h"
 
 using std::make_pair;
 using std::map;
@@ -87,7 +88,7 @@ Geometry faces_to_geom(const Geometry &geom, const vector<int> &face_idxs)
   fgeom.add_verts(geom.verts());
   fgeom.colors(VERTS) = geom.colors(VERTS);
   for (int j : face_idxs) {
-    fgeom.add_face(geom.faces()[j], geom.colors(FACES).get(j));
+    fgeom.add_face(geom.face_view(j).to_vector(), geom.colors(FACES).get(j));
   }
   fgeom.del(VERTS, fgeom.get_info().get_free_verts());
   return fgeom;
@@ -727,20 +728,13 @@ vector<vector<int>> lists_full(map<int, Geometry> &diagrams,
   return idx_lists_full;
 }
 
-// use diagrams and full lists and face color indexes to determine minimal
-// resolved faces
-vector<vector<int>> lists_resolved(const Geometry &geom,
-                                   const string &sym_string,
-                                   map<int, Geometry> &diagrams,
-                                   const vector<vector<int>> &idx_lists,
-                                   const vector<vector<int>> &idx_lists_full,
-                                   bool remove_multiples)
+// use chiral colored diagrams and full lists and face color indexes to
+// determine minimal resolved faces
+static vector<vector<int>>
+resolve_lists(const Geometry &geom, const map<int, const Geometry *> &diagrams,
+              const vector<vector<int>> &idx_lists,
+              const vector<vector<int>> &idx_lists_full, bool remove_multiples)
 {
-
-  // make chiral colored diagrams so left and right indexes are different
-  for (unsigned int i = 0; i < diagrams.size(); i++)
-    color_stellation_diagram(diagrams[i], geom, sym_string, true);
-
   map<pair<int, int>, int> resolved_faces;
   for (unsigned int i = 0; i < idx_lists_full.size(); i++) {
     // position 0 is stellation face index
@@ -750,11 +744,13 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     if (vdot(face_normal, geom.face_cent(0)) < 0)
       face_normal *= -1.0;
 
+    const Geometry &diagram = *diagrams.at(stellation_face_idx);
+
     // get angles of all faces relative to vertex 0 of stellation face
     vector<pair<double, int>> angle_list;
     for (unsigned int j = 1; j < idx_lists_full[i].size(); j++) {
       double angle = angle_around_axis(
-          diagrams[stellation_face_idx].face_cent(idx_lists_full[i][j]),
+          diagram.face_cent(idx_lists_full[i][j]),
           geom.verts(geom.faces(0)[0]), face_normal);
       angle_list.push_back(make_pair(rad2deg(angle), idx_lists_full[i][j]));
     }
@@ -765,8 +761,7 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     // map resolved faces by color map index, condense by color map indexes
     for (unsigned int j = 0; j < angle_list.size(); j++) {
       int k = angle_list[j].second;
-      int face_color_index =
-          diagrams[stellation_face_idx].colors(FACES).get(k).get_index();
+      int face_color_index = diagram.colors(FACES).get(k).get_index();
       pair<int, int> key = make_pair(stellation_face_idx, face_color_index);
       resolved_faces[key] = k;
     }
@@ -779,11 +774,10 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     vector<int> resolved_list;
     int stellation_face_idx = idx_lists[i][0];
     resolved_list.push_back(stellation_face_idx);
+    const Geometry &diagram = *diagrams.at(stellation_face_idx);
     for (unsigned int j = 1; j < idx_lists[i].size(); j++) {
-      int original_color_index = diagrams[stellation_face_idx]
-                                     .colors(FACES)
-                                     .get(idx_lists[i][j])
-                                     .get_index();
+      int original_color_index =
+          diagram.colors(FACES).get(idx_lists[i][j]).get_index();
       pair<int, int> key = make_pair(stellation_face_idx, original_color_index);
       int resolved_face = resolved_faces[key];
       // zero is a special case, check if really in the map
@@ -806,6 +800,28 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
       idx_lists_resolved.push_back(resolved_list);
   }
 
+  return idx_lists_resolved;
+}
+
+vector<vector<int>> lists_resolved(const Geometry &geom,
+                                   const string &sym_string,
+                                   map<int, Geometry> &diagrams,
+                                   const vector<vector<int>> &idx_lists,
+                                   const vector<vector<int>> &idx_lists_full,
+                                   bool remove_multiples)
+{
+
+  // make chiral colored diagrams so left and right indexes are different
+  for (unsigned int i = 0; i < diagrams.size(); i++)
+    color_stellation_diagram(diagrams[i], geom, sym_string, true);
+
+  map<int, const Geometry *> chiral_diagrams;
+  for (const auto &kp : diagrams)
+    chiral_diagrams[kp.first] = &kp.second;
+  vector<vector<int>> idx_lists_resolved =
+      resolve_lists(geom, chiral_diagrams, idx_lists, idx_lists_full,
+                    remove_multiples);
+
   // restore diagrams color
   for (unsigned int i = 0; i < diagrams.size(); i++)
     color_stellation_diagram(diagrams[i], geom, sym_string, false);
@@ -841,29 +857,21 @@ void rebuild_compound(Geometry &geom)
   }
 }
 
-// index lists contains stellation face number in position 0
-Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
-                         const vector<vector<int>> &idx_lists,
-                         const string &sym_string, bool merge_faces,
-                         bool remove_inline_verts, bool split_pinched,
-                         bool resolve_faces, bool remove_multiples,
-                         string map_string, double eps)
+// make the stellation from lists that are already resolved, if required
+static Geometry
+stellation_from_lists(const map<int, const Geometry *> &diagrams,
+                      const vector<vector<int>> &lists,
+                      const string &sym_string, bool merge_faces,
+                      bool remove_inline_verts, bool split_pinched,
+                      const string &map_string, double eps)
 {
   Geometry stellation_full;
 
-  vector<vector<int>> lists = idx_lists;
-  if (resolve_faces) {
-    vector<vector<int>> idx_lists_full =
-        lists_full(diagrams, idx_lists, remove_multiples);
-    lists = lists_resolved(geom, sym_string, diagrams, idx_lists,
-                           idx_lists_full, remove_multiples);
-  }
-
   for (unsigned int i = 0; i < lists.size(); i++) {
     int stellation_face_idx = lists[i][0];
+    const Geometry &diagram = *diagrams.at(stellation_face_idx);
 
-    Geometry stellation =
-        faces_to_geom_for_stel(diagrams[stellation_face_idx], lists[i]);
+    Geometry stellation = faces_to_geom_for_stel(diagram, lists[i]);
     stellation.colors(VERTS).clear();
 
     if (merge_faces) {
@@ -880,9 +888,7 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
       int planar_merge_type = 2;   // merge
       vector<int> nonconvex_faces; // dummy
       fill_in_faces(stellation, planar_merge_type, nonconvex_faces,
-                    face_norm(diagrams[stellation_face_idx].verts(),
-                              diagrams[stellation_face_idx].faces(0)),
-                    eps);
+                    face_norm(diagram.verts(), diagram.faces(0)), eps);
 
       // re-apply color map indexes (approximation)
       for (unsigned int j = 0; j < stellation.faces().size(); j++)
@@ -955,6 +961,185 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
   return stellation_full;
 }
 
+// index lists contains stellation face number in position 0
+Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
+                         const vector<vector<int>> &idx_lists,
+                         const string &sym_string, bool merge_faces,
+                         bool remove_inline_verts, bool split_pinched,
+                         bool resolve_faces, bool remove_multiples,
+                         string map_string, double eps)
+{
+  vector<vector<int>> lists = idx_lists;
+  if (resolve_faces) {
+    vector<vector<int>> idx_lists_full =
+        lists_full(diagrams, idx_lists, remove_multiples);
+    lists = lists_resolved(geom, sym_string, diagrams, idx_lists,
+                           idx_lists_full, remove_multiples);
+  }
+
+  map<int, const Geometry *> diagram_ptrs;
+  for (const auto &list : lists)
+    diagram_ptrs[list[0]] = &diagrams[list[0]];
+
+  return stellation_from_lists(diagram_ptrs, lists, sym_string, merge_faces,
+                               remove_inline_verts, split_pinched, map_string,
+                               eps);
+}
+
+StellationSession::StellationSession(const Geometry &geom,
+                                     const string &sym_string,
+                                     int projection_width, double eps)
+    : geom(geom), sym_string(sym_string), projection_width(projection_width),
+      eps(eps)
+{
+}
+
+const Geometry &StellationSession::get_diagram(int f_idx)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto di = diagrams.find(f_idx);
+    if (di != diagrams.end())
+      return di->second;
+  }
+
+  // make the diagram without holding the lock, so that different diagrams
+  // can be made at the same time
+  Geometry geom_copy = geom;
+  Geometry diagram = make_stellation_diagram(geom_copy, f_idx, sym_string,
+                                             projection_width, eps);
+  map<int, vector<int>> diagram_cells;
+  for (unsigned int i = 0; i < diagram.faces().size(); i++)
+    diagram_cells[diagram.colors(FACES).get(i).get_index()].push_back(i);
+
+  std::lock_guard<std::mutex> lock(mtx);
+  // if another thread made the diagram first then that one is kept
+  auto di = diagrams.insert(make_pair(f_idx, std::move(diagram))).first;
+  cells.insert(make_pair(f_idx, std::move(diagram_cells)));
+  return di->second;
+}
+
+map<int, Geometry>
+StellationSession::get_diagrams(const vector<vector<int>> &idx_lists)
+{
+  map<int, Geometry> diagram_copies;
+  for (const auto &idx_list : idx_lists) {
+    int stellation_face_idx = idx_list[0];
+    if (!diagram_copies.count(stellation_face_idx))
+      diagram_copies[stellation_face_idx] = get_diagram(stellation_face_idx);
+  }
+  return diagram_copies;
+}
+
+const map<int, vector<int>> &StellationSession::get_cells(int f_idx)
+{
+  get_diagram(f_idx);
+  std::lock_guard<std::mutex> lock(mtx);
+  return cells.find(f_idx)->second;
+}
+
+vector<vector<int>>
+StellationSession::lists_full(const vector<vector<int>> &idx_lists,
+                              bool remove_multiples)
+{
+  map<int, vector<int>> lists;
+  for (const auto &idx_list : idx_lists) {
+    // position 0 is stellation face index
+    int stellation_face_idx = idx_list[0];
+    const Geometry &diagram = get_diagram(stellation_face_idx);
+    const map<int, vector<int>> &diagram_cells = get_cells(stellation_face_idx);
+
+    // collect color map indexes of chosen faces
+    set<int> map_indexes;
+    for (unsigned int j = 1; j < idx_list.size(); j++)
+      map_indexes.insert(diagram.colors(FACES).get(idx_list[j]).get_index());
+
+    // if list is empty, add stellation face at position 0
+    vector<int> &list = lists[stellation_face_idx];
+    if (!list.size())
+      list.push_back(stellation_face_idx);
+
+    // add all faces with same color map indexes as those selected
+    for (int map_index : map_indexes) {
+      auto ci = diagram_cells.find(map_index);
+      if (ci != diagram_cells.end())
+        list.insert(list.end(), ci->second.begin(), ci->second.end());
+    }
+  }
+
+  vector<vector<int>> idx_lists_full;
+  for (auto &list : lists) {
+    sort(list.second.begin() + 1, list.second.end());
+
+    // faces with multiple entries are not included at all
+    if (remove_multiples) {
+      vector<int> single_list(1, list.first);
+      for (unsigned int j = 1; j < list.second.size(); j++) {
+        int face_no = list.second[j];
+        if ((j == 1 || list.second[j - 1] != face_no) &&
+            (j == list.second.size() - 1 || list.second[j + 1] != face_no))
+          single_list.push_back(face_no);
+      }
+      list.second = single_list;
+    }
+
+    idx_lists_full.push_back(list.second);
+  }
+
+  return idx_lists_full;
+}
+
+const Geometry &StellationSession::get_chiral_diagram(int f_idx)
+{
+  const Geometry &diagram = get_diagram(f_idx);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto di = chiral_diagrams.find(f_idx);
+    if (di != chiral_diagrams.end())
+      return di->second;
+  }
+
+  // make chiral colored diagram so left and right indexes are different
+  Geometry chiral_diagram = diagram;
+  color_stellation_diagram(chiral_diagram, geom, sym_string, true);
+
+  std::lock_guard<std::mutex> lock(mtx);
+  return chiral_diagrams.insert(make_pair(f_idx, std::move(chiral_diagram)))
+      .first->second;
+}
+
+vector<vector<int>>
+StellationSession::lists_resolved(const vector<vector<int>> &idx_lists,
+                                  const vector<vector<int>> &idx_lists_full,
+                                  bool remove_multiples)
+{
+  map<int, const Geometry *> chiral;
+  for (const auto &idx_list : idx_lists)
+    chiral[idx_list[0]] = &get_chiral_diagram(idx_list[0]);
+  return resolve_lists(geom, chiral, idx_lists, idx_lists_full,
+                       remove_multiples);
+}
+
+Geometry StellationSession::make_stellation(
+    const vector<vector<int>> &idx_lists, bool merge_faces,
+    bool remove_inline_verts, bool split_pinched, bool resolve_faces,
+    bool remove_multiples, string map_string)
+{
+  // the diagrams are only read, so the session's own are used
+  vector<vector<int>> lists = idx_lists;
+  if (resolve_faces)
+    lists = lists_resolved(idx_lists, lists_full(idx_lists, remove_multiples),
+                           remove_multiples);
+
+  map<int, const Geometry *> diagram_ptrs;
+  for (const auto &list : lists)
+    diagram_ptrs[list[0]] = &get_diagram(list[0]);
+
+  return stellation_from_lists(diagram_ptrs, lists, sym_string, merge_faces,
+                               remove_inline_verts, split_pinched, map_string,
+                               eps);
+}
+
 // RK - functions for winding number
 
 // Copyright 2001, softSurfer (www.softsurfer.com)
@@ -974,28 +1159,8 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
 //            <0 for P2 right of the line
 //    See: the January 2001 Algorithm "Area of 2D and 3D Triangles and Polygons"
 
-// inline int
-// isLeft( Point P0, Point P1, Point P2 )
-
-// RK - this works with wn_PnPoly better if a double is passed back
-
-static double isLeft(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
-                     const int idx)
-{
-  int idx1 = (idx + 1) % 3;
-  int idx2 = (idx + 2) % 3;
-
-  double P0_x = P0[idx1];
-  double P0_y = P0[idx2];
-
-  double P1_x = P1[idx1];
-  double P1_y = P1[idx2];
-
-  double P2_x = P2[idx1];
-  double P2_y = P2[idx2];
-
-  return ((P1_x - P0_x) * (P2_y - P0_y) - (P2_x - P0_x) * (P1_y - P0_y));
-}
+// isLeft() is evaluated exactly by orient2d_compare(), and compared with
+// zero considering epsilon
 
 //===================================================================
 
@@ -1068,7 +1233,6 @@ intersect
 
 // RK - try to use same variable names as original pnpoly
 // RK - there is proof that there are mistakes when epsilon is not considered
-// RK - wn is n time too large. winding_number = wn/n
 
 static bool wn_PnPoly(const Geometry &polygon, const Vec3d &P, const int idx,
                       int &winding_number, double eps)
@@ -1092,33 +1256,30 @@ static bool wn_PnPoly(const Geometry &polygon, const Vec3d &P, const int idx,
   for (int i = 0; i < n; i++) { // edge from face[i] to face[i+1]
     int j = (i + 1) % n;
 
-    Vec3d vert_i = verts[face[i]]; // V[i]
-    Vec3d vert_j = verts[face[j]]; // V[[i+1]
+    const Vec3d &vert_i = verts[face[i]]; // V[i]
+    const Vec3d &vert_j = verts[face[j]]; // V[[i+1]
 
     double verty_i = vert_i[idx2]; // V[i].y
     double verty_j = vert_j[idx2]; // V[i+1].y
 
-    for (int i = 0; i < n; i++) { // edge from face[i] to face[i+1]
-      // if (verty_i <= testy) {   // start y <= P.y
-      if (double_le(verty_i, testy, eps)) {
-        // if (verty_j > testy)     // an upward crossing
-        if (double_gt(verty_j, testy, eps))
-          // if (isLeft( vert_i, vert_j, P, idx ) > eps)  // P left of edge
-          if (double_gt(isLeft(vert_i, vert_j, P, idx), 0, eps))
-            ++wn; // have a valid up intersect
-      }
-      else { // start y > P.y (no test needed)
-        // if (verty_j <= testy)              // a downward crossing
-        if (double_le(verty_j, testy, eps))
-          // if (isLeft( vert_i, vert_j, P, idx ) < -eps)  // P right of edge
-          if (double_lt(isLeft(vert_i, vert_j, P, idx), 0, eps))
-            --wn; // have a valid down intersect
-      }
+    // if (verty_i <= testy) {   // start y <= P.y
+    if (double_le(verty_i, testy, eps)) {
+      // if (verty_j > testy)     // an upward crossing
+      if (double_gt(verty_j, testy, eps))
+        // if (isLeft( vert_i, vert_j, P, idx ) > eps)  // P left of edge
+        if (orient2d_compare(vert_i, vert_j, P, eps, idx) > 0)
+          ++wn; // have a valid up intersect
+    }
+    else { // start y > P.y (no test needed)
+      // if (verty_j <= testy)              // a downward crossing
+      if (double_le(verty_j, testy, eps))
+        // if (isLeft( vert_i, vert_j, P, idx ) < -eps)  // P right of edge
+        if (orient2d_compare(vert_i, vert_j, P, eps, idx) < 0)
+          --wn; // have a valid down intersect
     }
   }
 
-  if (n)
-    winding_number = wn / n;
+  winding_number = wn;
 
   return (wn ? true : false);
 }
@@ -31,6 +31,8 @@
 #ifndef PLANAR_H
 #define PLANAR_H
 
+#include <mutex>
+
 #include "geometry.h"
 #include "geometryinfo.h"
 #include "geometryutils.h"
@@ -172,6 +174,90 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
                          bool remove_multiples = false,
                          string map_string = "compound", double eps = epsilon);
 
+/// Stellation diagrams of a model, shared between stellations
+/**Each diagram is made once, when first needed, and its cells (facelets
+ * with the same symmetry colour index) are indexed. The member functions
+ * may be called from several threads at the same time. */
+class StellationSession {
+private:
+  Geometry geom;
+  string sym_string;
+  int projection_width;
+  double eps;
+
+  map<int, Geometry> diagrams;
+  map<int, map<int, vector<int>>> cells; // diagram, colour index, facelets
+  map<int, Geometry> chiral_diagrams;    // chiral coloured, for resolving
+  std::mutex mtx;
+
+  const Geometry &get_chiral_diagram(int f_idx);
+
+public:
+  /// Constructor
+  /**\param geom the geometry.
+   * \param sym_string is sub-symmetry of stellation.
+   * \param projection_width is length of line extents of diagrams.
+   * \param eps value for contolling the limit of precision. */
+  StellationSession(const Geometry &geom, const string &sym_string,
+                    int projection_width = 500, double eps = epsilon);
+
+  /// Get the model
+  /**\return The model being stellated. */
+  const Geometry &get_geom() const { return geom; }
+
+  /// Get the sub-symmetry of the stellations
+  /**\return The symmetry symbol. */
+  const string &get_sym_string() const { return sym_string; }
+
+  /// Get a stellation diagram, making it if necessary
+  /**\param f_idx the face of the diagram.
+   * \return The diagram. */
+  const Geometry &get_diagram(int f_idx);
+
+  /// Get copies of stellation diagrams, for functions that change them
+  /**\param idx_lists index lists with a face number in position 0.
+   * \return A map of the diagrams for those faces. */
+  map<int, Geometry> get_diagrams(const vector<vector<int>> &idx_lists);
+
+  /// Get the cells of a stellation diagram
+  /**\param f_idx the face of the diagram.
+   * \return A map from colour index to the facelets with that index. */
+  const map<int, vector<int>> &get_cells(int f_idx);
+
+  /// Return lists of index for full stellation diagram
+  /**The result is the same as the \c lists_full function, but is found
+   * from the cell index.
+   * \param idx_lists the partial lists.
+   * \param remove_multiples if true any duplicates in lists are removed
+   * \return The full lists. */
+  vector<vector<int>> lists_full(const vector<vector<int>> &idx_lists,
+                                 bool remove_multiples = true);
+
+  /// Return lists which have been standardized
+  /**The result is the same as the \c lists_resolved function, but the
+   * session's diagrams are not changed, as the chiral coloured diagrams are
+   * made once and kept.
+   * \param idx_lists the partial lists.
+   * \param idx_lists_full the full lists (from lists_full)
+   * \param remove_multiples if true any duplicates in lists are removed
+   * \return The resolved lists. */
+  vector<vector<int>> lists_resolved(const vector<vector<int>> &idx_lists,
+                                     const vector<vector<int>> &idx_lists_full,
+                                     bool remove_multiples = true);
+
+  /// Make a stellation
+  /**The parameters are the same as the \c make_stellation function. The
+   * session's diagrams, cell index and chiral coloured diagrams are used
+   * directly, without copying the diagrams. */
+  Geometry make_stellation(const vector<vector<int>> &idx_lists,
+                           bool merge_faces = true,
+                           bool remove_inline_verts = true,
+                           bool split_pinched = true,
+                           bool resolve_faces = false,
+                           bool remove_multiples = false,
+                           string map_string = "compound");
+};
+
 // RK - functions for winding number
 
 /// Get winding number of a point in a polygon
@@ -423,36 +423,51 @@ void PovWriter::geometry_objects(FILE *ofile, const Scene &scen, int sig_dgts)
   fprintf(ofile, "      // Objects\n"
                  "      union {\n");
   const vector<SceneGeometry> &sgeoms = scen.get_geoms();
-  for (const auto &sgeom : sgeoms) {
+  for (unsigned int g = 0; g < sgeoms.size(); g++) {
+    const SceneGeometry &sgeom = sgeoms[g];
+    FILE *gfile = ofile;
     if (o_type == 's' || o_type == 't') {
       string fname = dots2underscores(sgeom.get_name()) + ".inc";
       fprintf(ofile, "         #include \"%s\"\n", fname.c_str());
       if (o_type == 's') { // write geometries into their own files
-        FILE *gfile = fopen(fname.c_str(), "w");
+        gfile = fopen(fname.c_str(), "w");
         if (gfile == nullptr) {
           fprintf(stderr, "could not open geometry output file \'%s\'",
                   fname.c_str());
           exit(1);
         }
-        const vector<GeometryDisplay *> &disps = sgeom.get_disps();
-        for (auto disp : disps)
-          disp->pov_geom(gfile, scen, sig_dgts);
-        if (sgeom.get_label())
-          sgeom.get_label()->pov_geom(gfile, scen, sig_dgts);
-        if (sgeom.get_sym())
-          sgeom.get_sym()->pov_geom(gfile, scen, sig_dgts);
-        fclose(gfile);
       }
+      else
+        continue;
     }
-    else {
-      const vector<GeometryDisplay *> &disps = sgeom.get_disps();
-      for (auto disp : disps)
-        disp->pov_geom(ofile, scen, sig_dgts);
-      if (sgeom.get_label())
-        sgeom.get_label()->pov_geom(ofile, scen, sig_dgts);
-      if (sgeom.get_sym())
-        sgeom.get_sym()->pov_geom(ofile, scen, sig_dgts);
+
+    // instances share one declaration of the displayed part
+    const vector<Trans3d> &insts = sgeom.get_instances();
+    if (insts.size())
+      fprintf(gfile, "#declare InstPart%u = union {\n", g);
+    const vector<GeometryDisplay *> &disps = sgeom.get_disps();
+    for (auto disp : disps)
+      disp->pov_geom(gfile, scen, sig_dgts);
+    if (insts.size()) {
+      fprintf(gfile, "}\n");
+      for (const auto &trans : insts) {
+        // POV-Ray matrices are the transpose, without the last column
+        fprintf(gfile, "object { InstPart%u matrix <", g);
+        for (int i = 0; i < 4; i++)
+          fprintf(gfile, "%s%s", (i) ? ", " : "",
+                  vtostr(Vec3d(trans[i], trans[4 + i], trans[8 + i]), ", ",
+                         sig_dgts)
+                      .c_str());
+        fprintf(gfile, "> }\n");
+      }
     }
+    if (sgeom.get_label())
+      sgeom.get_label()->pov_geom(gfile, scen, sig_dgts);
+    if (sgeom.get_sym())
+      sgeom.get_sym()->pov_geom(gfile, scen, sig_dgts);
+
+    if (gfile != ofile)
+      fclose(gfile);
   }
 
   for (auto &obj_include : obj_includes)
@@ -0,0 +1,332 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file predicates.cc
+   \brief Exact orientation tests
+*/
+
+// The error-free transformations need every operation to be rounded
+// separately, so multiply-adds must not be fused
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <float.h>
+#include <math.h>
+
+#include <vector>
+
+#include "predicates.h"
+
+using std::vector;
+
+namespace anti {
+
+// Floating point filters and exact arithmetic after J. R. Shewchuk,
+// "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates", Discrete & Computational Geometry 18, 1997.
+//
+// An expansion is a sum of doubles, stored in order of increasing
+// magnitude, with no two overlapping and no zeros, so the sign of the
+// sum is the sign of the last element.
+
+namespace {
+
+const double half_eps = DBL_EPSILON / 2;
+const double splitter = 134217729.0; // 2^27 + 1
+const double o2d_err_bound = (3.0 + 16.0 * half_eps) * half_eps;
+const double o3d_err_bound = (7.0 + 56.0 * half_eps) * half_eps;
+
+typedef vector<double> Expansion;
+
+// x + y == a + b exactly, x == fl(a + b)
+inline void two_sum(double a, double b, double &x, double &y)
+{
+  x = a + b;
+  double b_virt = x - a;
+  double a_virt = x - b_virt;
+  y = (a - a_virt) + (b - b_virt);
+}
+
+// x + y == a - b exactly, x == fl(a - b)
+inline void two_diff(double a, double b, double &x, double &y)
+{
+  x = a - b;
+  double b_virt = a - x;
+  double a_virt = x + b_virt;
+  y = (a - a_virt) + (b_virt - b);
+}
+
+// hi + lo == a, with each part having at most 26 significant bits
+inline void split(double a, double &hi, double &lo)
+{
+  double c = splitter * a;
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+// x + y == a * b exactly, x == fl(a * b)
+inline void two_product(double a, double b, double &x, double &y)
+{
+  x = a * b;
+  double a_hi, a_lo, b_hi, b_lo;
+  split(a, a_hi, a_lo);
+  split(b, b_hi, b_lo);
+  double err = x - a_hi * b_hi - a_lo * b_hi - a_hi * b_lo;
+  y = a_lo * b_lo - err;
+}
+
+// Exact a - b
+Expansion diff_expansion(double a, double b)
+{
+  double x, y;
+  two_diff(a, b, x, y);
+  Expansion e;
+  if (y != 0.0)
+    e.push_back(y);
+  if (x != 0.0)
+    e.push_back(x);
+  return e;
+}
+
+// Exact e + b
+Expansion grow_expansion(const Expansion &e, double b)
+{
+  Expansion h;
+  double q = b;
+  for (double e_i : e) {
+    double sum, err;
+    two_sum(q, e_i, sum, err);
+    if (err != 0.0)
+      h.push_back(err);
+    q = sum;
+  }
+  if (q != 0.0 || h.empty())
+    h.push_back(q);
+  if (h.size() == 1 && h[0] == 0.0)
+    h.clear();
+  return h;
+}
+
+// Exact e + f
+Expansion add_expansions(const Expansion &e, const Expansion &f)
+{
+  Expansion h = e;
+  for (double f_i : f)
+    h = grow_expansion(h, f_i);
+  return h;
+}
+
+// Exact e * b
+Expansion scale_expansion(const Expansion &e, double b)
+{
+  Expansion h;
+  if (e.empty() || b == 0.0)
+    return h;
+  double q, err;
+  two_product(e[0], b, q, err);
+  if (err != 0.0)
+    h.push_back(err);
+  for (size_t i = 1; i < e.size(); i++) {
+    double prod_hi, prod_lo, sum;
+    two_product(e[i], b, prod_hi, prod_lo);
+    two_sum(q, prod_lo, sum, err);
+    if (err != 0.0)
+      h.push_back(err);
+    two_sum(prod_hi, sum, q, err);
+    if (err != 0.0)
+      h.push_back(err);
+  }
+  if (q != 0.0)
+    h.push_back(q);
+  return h;
+}
+
+// Exact e * f
+Expansion mult_expansions(const Expansion &e, const Expansion &f)
+{
+  Expansion h;
+  for (double f_i : f)
+    h = add_expansions(h, scale_expansion(e, f_i));
+  return h;
+}
+
+// Exact -e
+Expansion negate_expansion(Expansion e)
+{
+  for (double &e_i : e)
+    e_i = -e_i;
+  return e;
+}
+
+// Exact e_a * f_b - e_b * f_a
+Expansion cross_expansion(const Expansion &e_a, const Expansion &e_b,
+                          const Expansion &f_a, const Expansion &f_b)
+{
+  return add_expansions(mult_expansions(e_a, f_b),
+                        negate_expansion(mult_expansions(e_b, f_a)));
+}
+
+inline int expansion_sign(const Expansion &e)
+{
+  return e.empty() ? 0 : (e.back() > 0.0 ? 1 : -1);
+}
+
+// Compare an exact value with zero as double_compare() does
+int expansion_compare(const Expansion &det, double eps)
+{
+  if (expansion_sign(grow_expansion(det, -eps)) >= 0)
+    return 1;
+  return (expansion_sign(grow_expansion(det, eps)) > 0) ? 0 : -1;
+}
+
+// Result of the floating point filter when the error bound allows it,
+// otherwise 2
+inline int filter_compare(double det, double err_bound, double eps)
+{
+  if (det - eps > err_bound)
+    return 1;
+  if (det + eps < -err_bound)
+    return -1;
+  if (det - eps < -err_bound && det + eps > err_bound)
+    return 0;
+  return 2;
+}
+
+Expansion orient2d_exact(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                         int idx1, int idx2)
+{
+  return cross_expansion(diff_expansion(P1[idx1], P0[idx1]),
+                         diff_expansion(P1[idx2], P0[idx2]),
+                         diff_expansion(P2[idx1], P0[idx1]),
+                         diff_expansion(P2[idx2], P0[idx2]));
+}
+
+Expansion orient3d_exact(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                         const Vec3d &P3)
+{
+  Expansion u[3], v[3], w[3];
+  for (int i = 0; i < 3; i++) {
+    u[i] = diff_expansion(P1[i], P0[i]);
+    v[i] = diff_expansion(P2[i], P0[i]);
+    w[i] = diff_expansion(P3[i], P0[i]);
+  }
+  Expansion det;
+  for (int i = 0; i < 3; i++) {
+    int j = (i + 1) % 3;
+    int k = (i + 2) % 3;
+    det = add_expansions(det,
+                         mult_expansions(u[i], cross_expansion(v[j], v[k],
+                                                               w[j], w[k])));
+  }
+  return det;
+}
+
+// Floating point determinant for orient2d, and its error bound
+inline double orient2d_approx(const Vec3d &P0, const Vec3d &P1,
+                              const Vec3d &P2, int idx1, int idx2,
+                              double &err_bound)
+{
+  double det_l = (P1[idx1] - P0[idx1]) * (P2[idx2] - P0[idx2]);
+  double det_r = (P2[idx1] - P0[idx1]) * (P1[idx2] - P0[idx2]);
+  err_bound = o2d_err_bound * (fabs(det_l) + fabs(det_r));
+  return det_l - det_r;
+}
+
+// Floating point determinant for orient3d, and its error bound
+inline double orient3d_approx(const Vec3d &P0, const Vec3d &P1,
+                              const Vec3d &P2, const Vec3d &P3,
+                              double &err_bound)
+{
+  Vec3d u = P1 - P0;
+  Vec3d v = P2 - P0;
+  Vec3d w = P3 - P0;
+  double det = 0.0;
+  double permanent = 0.0;
+  for (int i = 0; i < 3; i++) {
+    int j = (i + 1) % 3;
+    int k = (i + 2) % 3;
+    double prod_l = v[j] * w[k];
+    double prod_r = v[k] * w[j];
+    det += u[i] * (prod_l - prod_r);
+    permanent += fabs(u[i]) * (fabs(prod_l) + fabs(prod_r));
+  }
+  err_bound = o3d_err_bound * permanent;
+  return det;
+}
+
+} // namespace
+
+int orient2d(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2, int idx)
+{
+  int idx1 = (idx + 1) % 3;
+  int idx2 = (idx + 2) % 3;
+  double err_bound;
+  double det = orient2d_approx(P0, P1, P2, idx1, idx2, err_bound);
+  if (det > err_bound)
+    return 1;
+  if (det < -err_bound)
+    return -1;
+  return expansion_sign(orient2d_exact(P0, P1, P2, idx1, idx2));
+}
+
+int orient2d_compare(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                     double eps, int idx)
+{
+  int idx1 = (idx + 1) % 3;
+  int idx2 = (idx + 2) % 3;
+  double err_bound;
+  double det = orient2d_approx(P0, P1, P2, idx1, idx2, err_bound);
+  int cmp = filter_compare(det, err_bound, eps);
+  if (cmp != 2)
+    return cmp;
+  return expansion_compare(orient2d_exact(P0, P1, P2, idx1, idx2), eps);
+}
+
+int orient3d(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+             const Vec3d &P3)
+{
+  double err_bound;
+  double det = orient3d_approx(P0, P1, P2, P3, err_bound);
+  if (det > err_bound)
+    return 1;
+  if (det < -err_bound)
+    return -1;
+  return expansion_sign(orient3d_exact(P0, P1, P2, P3));
+}
+
+int orient3d_compare(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                     const Vec3d &P3, double eps)
+{
+  double err_bound;
+  double det = orient3d_approx(P0, P1, P2, P3, err_bound);
+  int cmp = filter_compare(det, err_bound, eps);
+  if (cmp != 2)
+    return cmp;
+  return expansion_compare(orient3d_exact(P0, P1, P2, P3), eps);
+}
+
+} // namespace anti
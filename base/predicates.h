@@ -0,0 +1,96 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file predicates.h
+   \brief Exact orientation tests
+*/
+
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include "vec3d.h"
+
+namespace anti {
+
+// The tests find the sign of a determinant of point coordinates. It is
+// first evaluated in floating point, and the result is used if it is
+// larger than a bound on the rounding error. Otherwise the determinant
+// is evaluated exactly, so the sign is always correct for the input
+// coordinates. Near-degenerate input takes the slow path, other input
+// costs little more than evaluating the determinant.
+
+/// Orientation of three points in a coordinate plane
+/** The points are projected onto a coordinate plane by dropping one
+ *  coordinate, and the determinant is
+ *  (P1x-P0x)*(P2y-P0y) - (P2x-P0x)*(P1y-P0y), where x and y are the
+ *  coordinates following the dropped one.
+ * \param P0 the first point.
+ * \param P1 the second point.
+ * \param P2 the third point.
+ * \param idx the index of the coordinate to drop.
+ * \return 1 if \a P2 is to the left of the line from \a P0 to \a P1,
+ *  -1 if it is to the right, and 0 if it is on the line. */
+int orient2d(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2, int idx = 2);
+
+/// Orientation of three points in a coordinate plane, with a tolerance
+/** The exact determinant, as for \c orient2d(), is compared with zero
+ *  in the same way as \c double_compare().
+ * \param P0 the first point.
+ * \param P1 the second point.
+ * \param P2 the third point.
+ * \param eps the tolerance on the determinant.
+ * \param idx the index of the coordinate to drop.
+ * \return 1 if the determinant is not less than \a eps, -1 if it is not
+ *  greater than \a -eps, otherwise 0. */
+int orient2d_compare(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                     double eps, int idx = 2);
+
+/// Orientation of four points
+/** The determinant is \c vtriple(P1-P0, P2-P0, P3-P0).
+ * \param P0 the first point.
+ * \param P1 the second point.
+ * \param P2 the third point.
+ * \param P3 the fourth point.
+ * \return 1 if \a P3 is on the side of the plane through \a P0, \a P1
+ *  and \a P2 that sees them anticlockwise, -1 if it is on the other side,
+ *  and 0 if it is in the plane. */
+int orient3d(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+             const Vec3d &P3);
+
+/// Orientation of four points, with a tolerance
+/** The exact determinant, as for \c orient3d(), is compared with zero
+ *  in the same way as \c double_compare().
+ * \param P0 the first point.
+ * \param P1 the second point.
+ * \param P2 the third point.
+ * \param P3 the fourth point.
+ * \param eps the tolerance on the determinant.
+ * \return 1 if the determinant is not less than \a eps, -1 if it is not
+ *  greater than \a -eps, otherwise 0. */
+int orient3d_compare(const Vec3d &P0, const Vec3d &P1, const Vec3d &P2,
+                     const Vec3d &P3, double eps);
+
+} // namespace anti
+
+#endif // PREDICATES_H
@@ -48,6 +48,8 @@ void triangulate_basic(Geometry &geom, bool sq_diag = true, Color inv = Color(),
 
 Status add_hull(Geometry &geom, std::string qh_args = "", int *dim = nullptr);
 Status set_hull(Geometry &geom, std::string qh_args = "", int *dim = nullptr);
+Status set_hull_from_faces(Geometry &geom, std::string qh_args = "",
+                           int *dim = nullptr);
 
 /// Get Voronoi cells.
 /**Get all Voronoi cells of the vertex points which are finite polyhedra.
@@ -30,6 +30,7 @@
 #define PRIVATE_OFF_FILE_H
 
 #include "geometry.h"
+#include "instances.h"
 #include <stdio.h>
 
 using namespace anti;
@@ -70,4 +71,10 @@ void off_file_write(FILE *ofile,
                     const std::vector<const anti::Geometry *> &geoms,
                     int sig_dgts = DEF_SIG_DGTS);
 
+bool off_file_write(std::string file_name,
+                    const anti::InstancedGeometry &inst_geom,
+                    char *errmsg = nullptr, int sig_dgts = DEF_SIG_DGTS);
+void off_file_write(FILE *ofile, const anti::InstancedGeometry &inst_geom,
+                    int sig_dgts = DEF_SIG_DGTS);
+
 #endif // PRIVATE_OFF_FILE_H
@@ -14,6 +14,7 @@
 #define RANDOM_H
 
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -114,6 +115,147 @@ inline long unsigned int Random::nextrand()
   return (seed31 = (long)lo);
 }
 
+/// Counter-based psuedo-random number generator
+/** The numbers are the Philox4x32-10 function of a counter, keyed by
+ *  the seed, so any position in the sequence can be reached directly.
+ *  The counter also holds a stream number, and a separate stream can
+ *  be derived for each element of a calculation. The elements may then
+ *  be processed in any order, or on any number of threads, and the
+ *  results for a seed will be the same. The interface is the same as
+ *  \c Random, but the sequence of numbers is different. */
+class CounterRandom {
+private:
+  uint64_t key;
+  uint64_t stream;
+  uint64_t pos;      // position of the next 32-bit value
+  uint32_t block[4]; // values for the current counter
+  uint64_t block_num;
+
+  // Make the four 32-bit values for a counter
+  void make_block(uint64_t ctr);
+
+  uint32_t next32()
+  {
+    uint64_t ctr = pos / 4;
+    if (ctr != block_num)
+      make_block(ctr);
+    return block[pos++ % 4];
+  }
+
+  // 53 random bits
+  uint64_t next53()
+  {
+    uint64_t hi = next32();
+    return ((hi << 32) | next32()) >> 11;
+  }
+
+public:
+  /// Constructor
+  /**\param seedin the seed. */
+  CounterRandom(uint64_t seedin = 1) { seedi(seedin); }
+
+  /// Set the seed.
+  /** The generator is set to the start of stream \c 0.
+   * \param seedin the seed. */
+  void seedi(uint64_t seedin)
+  {
+    key = seedin;
+    stream = 0;
+    pos = 0;
+    block_num = (uint64_t)-1;
+  }
+
+  /// Set the seed with the current time.
+  void time_seed() { seedi(time(nullptr)); }
+
+  /// Jump ahead in the sequence
+  /**\param num the number of integers to skip, as returned by
+   *  \c ranlui(). Each floating point number uses two integers. */
+  void jump(uint64_t num) { pos += num; }
+
+  /// Get a stream for an element of a calculation
+  /** The streams for different index numbers do not overlap, and are
+   *  independent of the stream and position of this generator.
+   * \param idx the element index number.
+   * \return A generator with the same seed, at the start of the stream
+   *  for the element. */
+  CounterRandom get_stream(uint64_t idx) const
+  {
+    CounterRandom rnd(key);
+    rnd.stream = idx + 1;
+    return rnd;
+  }
+
+  /// Get a psuedo-random integer
+  /**\return a pseudo-random integer in the range 0 - 2^32-1. */
+  long unsigned int ranlui() { return next32(); }
+
+  /// Get a psuedo-random floating point number in range 0.0 <= num <= 1.0
+  /**\return a pseudo-random float in the range 0.0 - 1.0, including 1.0.*/
+  double ranf() { return next53() / 9007199254740991.0; }
+
+  /// Get a psuedo-random floating point number in range 0.0 <= num < 1.0
+  /**\return a pseudo-random float in the range 0.0 - 1.0, excluding 1.0.*/
+  double ranf_exclude_end() { return next53() / 9007199254740992.0; }
+
+  /// Get a psuedo-random floating point number in range low <= num <= high
+  /**\param low low end of the range
+   * \param high high end of the range
+   * \return a pseudo-random float in the range low - high, including
+   * high.*/
+  double ran_in_range(double low, double high)
+  {
+    return low + (high - low) * ranf();
+  }
+
+  /// Get a psuedo-random floating point number in range low <= num < high
+  /**\param low low end of the range
+   * \param high high end of the range
+   * \return a pseudo-random float in the range low - high,
+   * excluding high.*/
+  double ran_in_range_exclude_end(double low, double high)
+  {
+    return low + (high - low) * ranf_exclude_end();
+  }
+
+  /// Get a psuedo-random integer in range low <= num <=high
+  /**\param low low end of the range
+   * \param high high end of the range
+   * \return a pseudo-random integer in the range low - high, including
+   * high.*/
+  long ran_int_in_range(long low, long high)
+  {
+    return (long)floor(low + ((high + 1) - low) * ranf_exclude_end());
+  }
+
+  /// Get a psuedo-random integer in range 0 <= num <high
+  /**\param high high end of the range
+   * \return a pseudo-random integer in the range low - high,
+   * including high.*/
+  long operator()(long high) { return (long)floor(high * ranf_exclude_end()); }
+};
+
+inline void CounterRandom::make_block(uint64_t ctr)
+{
+  uint32_t c[4] = {(uint32_t)ctr, (uint32_t)(ctr >> 32), (uint32_t)stream,
+                   (uint32_t)(stream >> 32)};
+  uint32_t k[2] = {(uint32_t)key, (uint32_t)(key >> 32)};
+  for (int round = 0; round < 10; round++) {
+    uint64_t prod0 = (uint64_t)0xD2511F53 * c[0];
+    uint64_t prod1 = (uint64_t)0xCD9E8D57 * c[2];
+    uint32_t next[4] = {(uint32_t)(prod1 >> 32) ^ c[1] ^ k[0],
+                        (uint32_t)prod1, (uint32_t)(prod0 >> 32) ^ c[3] ^ k[1],
+                        (uint32_t)prod0};
+    for (int i = 0; i < 4; i++)
+      c[i] = next[i];
+    k[0] += 0x9E3779B9;
+    k[1] += 0xBB67AE85;
+  }
+  for (int i = 0; i < 4; i++)
+    block[i] = c[i];
+  block_num = ctr;
+}
+
 /// @cond ALL
 
 /*
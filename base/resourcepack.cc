@@ -0,0 +1,470 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file resourcepack.cc
+   \brief A pack of prebuilt resource models
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "res_pack_hash.h"
+#include "resourcepack.h"
+#include "utils.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace anti {
+
+/* Pack file layout, all values in native byte order
+
+   Header
+     char[8]   magic "ANTIPACK"
+     uint32    byte order check 0x01020304
+     uint32    format version
+     char[32]  library version, zero padded
+     char[32]  checksum of the library sources, zero padded
+     uint64    number of models
+   Index, sorted by name, one entry per model
+     uint64    name offset, name length, data offset, data length,
+               warning offset, warning length (zero if no warning)
+   Names and warnings from making the models
+   Model data, each starting on an 8 byte boundary
+     uint64    number of vertices, edges, edge indexes, faces, face indexes,
+               vertex colours, edge colours, face colours
+     double    vertex coordinates
+     int32     edge sizes, edge indexes, face sizes, face indexes
+     colours, for vertices then edges then faces, as
+     int32     element index, colour index (or -1 for a value, -2 unset)
+     uint8[4]  RGBA values
+*/
+
+namespace {
+
+const char pack_magic[8] = {'A', 'N', 'T', 'I', 'P', 'A', 'C', 'K'};
+const uint32_t pack_byte_order = 0x01020304;
+const uint32_t pack_format = 2;
+const size_t pack_lib_version_sz = 32;
+const size_t pack_header_sz = 8 + 4 + 4 + 2 * pack_lib_version_sz + 8;
+const size_t pack_index_entry_sz = 6 * 8;
+
+// The version and source checksum, so a development build whose version
+// is unchanged still rejects a pack made from different sources
+void get_lib_version(char *ver)
+{
+  memset(ver, 0, 2 * pack_lib_version_sz);
+#ifdef PACKAGE_VERSION
+  strncpy(ver, PACKAGE_VERSION, pack_lib_version_sz - 1);
+#endif
+  strncpy(ver + pack_lib_version_sz, RES_PACK_SRC_HASH,
+          pack_lib_version_sz - 1);
+}
+
+// Append values to a byte buffer
+template <typename T> void put(vector<char> &out, T val)
+{
+  const char *p = reinterpret_cast<const char *>(&val);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+void pad_to_8(vector<char> &out) { out.resize((out.size() + 7) / 8 * 8, 0); }
+
+// Read values from a byte range, failing if the range is too short
+class PackReader {
+private:
+  const char *pos;
+  const char *end;
+
+public:
+  PackReader(const char *start, size_t sz) : pos(start), end(start + sz) {}
+  template <typename T> bool get(T &val)
+  {
+    if ((size_t)(end - pos) < sizeof(T))
+      return false;
+    memcpy(&val, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }
+  // whether the rest of the range could hold num values of size elem_sz
+  bool has_room(uint64_t num, size_t elem_sz) const
+  {
+    return num <= (uint64_t)(end - pos) / elem_sz;
+  }
+};
+
+void put_idx_lists(vector<char> &out, const vector<vector<int>> &lists)
+{
+  for (const auto &list : lists)
+    put<int32_t>(out, list.size());
+  for (const auto &list : lists)
+    for (int idx : list)
+      put<int32_t>(out, idx);
+}
+
+// The counts come from the file, so they are checked against the bytes
+// left before anything is allocated, and the index numbers against the
+// number of vertices
+bool get_idx_lists(PackReader &in, vector<vector<int>> &lists,
+                   uint64_t num_lists, uint64_t num_idxs, size_t num_verts)
+{
+  if (!in.has_room(num_lists, sizeof(int32_t)) ||
+      !in.has_room(num_idxs, sizeof(int32_t)) ||
+      !in.has_room(num_lists + num_idxs, sizeof(int32_t)))
+    return false;
+  lists.resize(num_lists);
+  uint64_t tot = 0;
+  for (auto &list : lists) {
+    int32_t sz;
+    if (!in.get(sz) || sz < 0 || (tot += sz) > num_idxs)
+      return false;
+    list.resize(sz);
+  }
+  if (tot != num_idxs)
+    return false;
+  for (auto &list : lists)
+    for (auto &idx : list) {
+      int32_t val;
+      if (!in.get(val) || val < 0 || (size_t)val >= num_verts)
+        return false;
+      idx = val;
+    }
+  return true;
+}
+
+void put_model(vector<char> &out, const Geometry &geom)
+{
+  uint64_t num_e_idxs = 0;
+  for (const auto &edge : geom.edges())
+    num_e_idxs += edge.size();
+  uint64_t num_f_idxs = 0;
+  for (const auto &face : geom.faces())
+    num_f_idxs += face.size();
+
+  put<uint64_t>(out, geom.verts().size());
+  put<uint64_t>(out, geom.edges().size());
+  put<uint64_t>(out, num_e_idxs);
+  put<uint64_t>(out, geom.faces().size());
+  put<uint64_t>(out, num_f_idxs);
+  for (int i = 0; i < 3; i++)
+    put<uint64_t>(out, geom.colors(i).get_properties().size());
+
+  for (const auto &v : geom.verts())
+    for (int i = 0; i < 3; i++)
+      put<double>(out, v[i]);
+  put_idx_lists(out, geom.edges());
+  put_idx_lists(out, geom.faces());
+
+  for (int i = 0; i < 3; i++)
+    for (const auto &kp : geom.colors(i).get_properties()) {
+      const Color &col = kp.second;
+      put<int32_t>(out, kp.first);
+      put<int32_t>(out, col.is_index() ? col.get_index()
+                                       : col.is_value() ? -1 : -2);
+      for (int j = 0; j < 4; j++)
+        put<uint8_t>(out, col.is_value() ? col[j] : 0);
+    }
+}
+
+bool get_model(PackReader &in, Geometry &geom)
+{
+  uint64_t counts[8];
+  for (auto &cnt : counts)
+    if (!in.get(cnt))
+      return false;
+
+  if (!in.has_room(counts[0], 3 * sizeof(double)))
+    return false;
+  vector<Vec3d> &verts = geom.raw_verts();
+  verts.resize(counts[0]);
+  for (auto &v : verts)
+    for (int i = 0; i < 3; i++)
+      if (!in.get(v[i]))
+        return false;
+
+  if (!get_idx_lists(in, geom.raw_edges(), counts[1], counts[2],
+                     verts.size()) ||
+      !get_idx_lists(in, geom.raw_faces(), counts[3], counts[4],
+                     verts.size()))
+    return false;
+
+  for (int i = 0; i < 3; i++) {
+    map<int, Color> &cols = geom.colors(i).get_properties();
+    for (uint64_t c = 0; c < counts[5 + i]; c++) {
+      int32_t elem_idx, col_idx;
+      uint8_t rgba[4];
+      if (!in.get(elem_idx) || !in.get(col_idx))
+        return false;
+      for (auto &comp : rgba)
+        if (!in.get(comp))
+          return false;
+      if (col_idx >= 0)
+        cols[elem_idx] = Color(col_idx);
+      else if (col_idx == -1)
+        cols[elem_idx] = Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+      else
+        cols[elem_idx] = Color();
+    }
+  }
+
+  return true;
+}
+
+bool use_default_pack = true;
+
+} // namespace
+
+const char *ResourcePack::file_name = "resources.pack";
+
+void ResourcePack::close()
+{
+#ifdef HAVE_MMAP
+  if (mapped)
+    munmap(const_cast<char *>(data), data_sz);
+#endif
+  buf.clear();
+  buf.shrink_to_fit();
+  data = nullptr;
+  data_sz = 0;
+  mapped = false;
+  num_entries = 0;
+}
+
+Status ResourcePack::open(const string &fname)
+{
+  close();
+
+#ifdef HAVE_MMAP
+  int fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0)
+    return Status::error(msg_str("could not open '%s'", fname.c_str()));
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem != MAP_FAILED) {
+      data = static_cast<const char *>(mem);
+      data_sz = st.st_size;
+      mapped = true;
+    }
+  }
+  ::close(fd);
+  if (!mapped)
+    return Status::error(msg_str("could not map '%s'", fname.c_str()));
+#else
+  FILE *ifile = fopen(fname.c_str(), "rb");
+  if (!ifile)
+    return Status::error(msg_str("could not open '%s'", fname.c_str()));
+  char chunk[65536];
+  size_t num_read;
+  while ((num_read = fread(chunk, 1, sizeof(chunk), ifile)) > 0)
+    buf.insert(buf.end(), chunk, chunk + num_read);
+  fclose(ifile);
+  data = buf.data();
+  data_sz = buf.size();
+#endif
+
+  // Check the header, which must match this library
+  PackReader in(data, data_sz);
+  char magic[8];
+  uint32_t byte_order = 0, format = 0;
+  char lib_ver[2 * pack_lib_version_sz];
+  char this_ver[2 * pack_lib_version_sz];
+  uint64_t num = 0;
+  bool valid = in.get(magic) && memcmp(magic, pack_magic, 8) == 0 &&
+               in.get(byte_order) && byte_order == pack_byte_order &&
+               in.get(format) && format == pack_format && in.get(lib_ver) &&
+               in.get(num) &&
+               num <= (data_sz - pack_header_sz) / pack_index_entry_sz;
+  get_lib_version(this_ver);
+  if (!valid || memcmp(lib_ver, this_ver, sizeof(this_ver)) != 0) {
+    close();
+    return Status::error(msg_str("'%s' is not a resource pack for this "
+                                 "version of the library",
+                                 fname.c_str()));
+  }
+
+  num_entries = num;
+  return Status::ok();
+}
+
+bool ResourcePack::get(const string &name, Geometry &geom,
+                       string *warning) const
+{
+  if (warning)
+    warning->clear();
+  if (!data)
+    return false;
+
+  // Binary search of the index
+  const char *index = data + pack_header_sz;
+  unsigned long lo = 0;
+  unsigned long hi = num_entries;
+  while (lo < hi) {
+    unsigned long mid = lo + (hi - lo) / 2;
+    uint64_t entry[6];
+    memcpy(entry, index + mid * pack_index_entry_sz, sizeof(entry));
+    if (entry[0] > data_sz || entry[1] > data_sz - entry[0])
+      return false;
+    int cmp = name.compare(0, string::npos, data + entry[0], entry[1]);
+    if (cmp == 0) {
+      if (entry[2] > data_sz || entry[3] > data_sz - entry[2] ||
+          entry[4] > data_sz || entry[5] > data_sz - entry[4])
+        return false;
+      PackReader in(data + entry[2], entry[3]);
+      geom.clear_all();
+      if (!get_model(in, geom)) {
+        geom.clear_all();
+        return false;
+      }
+      if (warning)
+        warning->assign(data + entry[4], entry[5]);
+      return true;
+    }
+    else if (cmp < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return false;
+}
+
+Status ResourcePack::write(const string &fname, const vector<string> &names,
+                           int *num_written)
+{
+  bool use_default = get_use_default();
+  set_use_default(false);
+
+  map<string, vector<char>> models; // sorted by name
+  map<string, string> warnings;
+  for (const auto &name : names) {
+    if (models.count(name))
+      continue;
+    Geometry geom;
+    Status stat = geom.read_resource(name);
+    if (stat.is_error())
+      continue;
+    put_model(models[name], geom);
+    if (stat.is_warning())
+      warnings[name] = stat.msg();
+  }
+
+  set_use_default(use_default);
+  if (num_written)
+    *num_written = models.size();
+
+  // Lay out the names, warnings and data after the index
+  vector<char> names_data;
+  vector<uint64_t> name_offs;
+  vector<uint64_t> warn_offs;
+  uint64_t names_start = pack_header_sz + models.size() * pack_index_entry_sz;
+  for (const auto &kp : models) {
+    name_offs.push_back(names_start + names_data.size());
+    names_data.insert(names_data.end(), kp.first.begin(), kp.first.end());
+    const string &warn = warnings[kp.first];
+    warn_offs.push_back(names_start + names_data.size());
+    names_data.insert(names_data.end(), warn.begin(), warn.end());
+  }
+  pad_to_8(names_data);
+
+  vector<char> out;
+  out.insert(out.end(), pack_magic, pack_magic + 8);
+  put<uint32_t>(out, pack_byte_order);
+  put<uint32_t>(out, pack_format);
+  char lib_ver[2 * pack_lib_version_sz];
+  get_lib_version(lib_ver);
+  out.insert(out.end(), lib_ver, lib_ver + sizeof(lib_ver));
+  put<uint64_t>(out, models.size());
+
+  uint64_t data_off = names_start + names_data.size();
+  int i = 0;
+  for (const auto &kp : models) {
+    put<uint64_t>(out, name_offs[i]);
+    put<uint64_t>(out, kp.first.size());
+    put<uint64_t>(out, data_off);
+    put<uint64_t>(out, kp.second.size());
+    put<uint64_t>(out, warn_offs[i++]);
+    put<uint64_t>(out, warnings[kp.first].size());
+    data_off += (kp.second.size() + 7) / 8 * 8;
+  }
+  out.insert(out.end(), names_data.begin(), names_data.end());
+  for (const auto &kp : models) {
+    out.insert(out.end(), kp.second.begin(), kp.second.end());
+    pad_to_8(out);
+  }
+
+  FILE *ofile = fopen(fname.c_str(), "wb");
+  if (!ofile)
+    return Status::error(
+        msg_str("could not open output file '%s'", fname.c_str()));
+  bool ok = fwrite(out.data(), 1, out.size(), ofile) == out.size();
+  if (fclose(ofile) != 0)
+    ok = false;
+  if (!ok)
+    return Status::error(msg_str("could not write to '%s'", fname.c_str()));
+
+  return Status::ok();
+}
+
+const ResourcePack &ResourcePack::get_default()
+{
+  static ResourcePack pack;
+  static std::once_flag opened;
+  std::call_once(opened, []() {
+    const char *env_pack = getenv("ANTIPRISM_RES_PACK");
+    const char *sup_dir = getenv("ANTIPRISM_DATA");
+    if (env_pack)
+      pack.open(env_pack);
+    else if (!(sup_dir &&
+               pack.open(string(sup_dir) + "/" + file_name).is_ok()))
+      pack.open(string(SUPDIR) + "/" + file_name);
+  });
+  return pack;
+}
+
+void ResourcePack::set_use_default(bool use) { use_default_pack = use; }
+
+bool ResourcePack::get_use_default() { return use_default_pack; }
+
+} // namespace anti
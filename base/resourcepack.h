@@ -0,0 +1,127 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file resourcepack.h
+   \brief A pack of prebuilt resource models
+*/
+
+#ifndef RESOURCEPACK_H
+#define RESOURCEPACK_H
+
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "status.h"
+
+namespace anti {
+
+/// A file of prebuilt resource models, with an index of their names
+/** The file is mapped into memory (or read, if mapping is not available),
+ *  and a model is copied out of it when its name is looked up. The file
+ *  is only valid for the library version and sources that wrote it, and
+ *  is ignored otherwise. */
+class ResourcePack {
+private:
+  const char *data;
+  size_t data_sz;
+  bool mapped;
+  std::vector<char> buf;
+  unsigned long num_entries;
+
+  void close();
+
+public:
+  /// Name of the pack file in the data directory
+  static const char *file_name;
+
+  /// Constructor
+  ResourcePack() : data(nullptr), data_sz(0), mapped(false), num_entries(0)
+  {
+  }
+
+  ResourcePack(const ResourcePack &) = delete;
+  ResourcePack &operator=(const ResourcePack &) = delete;
+
+  /// Destructor
+  ~ResourcePack() { close(); }
+
+  /// Open a pack file
+  /**\param fname the file name.
+   * \return status, evaluates to \c true if the pack could be opened,
+   *  otherwise \c false. */
+  Status open(const std::string &fname);
+
+  /// Check whether a pack is open
+  /**\return \c true if a pack is open, otherwise \c false. */
+  bool is_open() const { return data != nullptr; }
+
+  /// Get the number of models
+  /**\return The number of models. */
+  unsigned long size() const { return num_entries; }
+
+  /// Get a model
+  /**\param name the resource name of the model.
+   * \param geom to return the model.
+   * \param warning to return any warning from making the model, or an
+   *  empty string.
+   * \return \c true if the model was in the pack, otherwise \c false. */
+  bool get(const std::string &name, Geometry &geom,
+           std::string *warning = nullptr) const;
+
+  /// Make resource models and write them to a pack file
+  /** Models are made with \c Geometry::read_resource() without using
+   *  the default pack, and names that are not valid resources are
+   *  skipped. A warning from making a model is stored with it.
+   * \param fname the file name.
+   * \param names the resource names of the models.
+   * \param num_written to return the number of models written.
+   * \return status, evaluates to \c true if the pack was written,
+   *  otherwise \c false. */
+  static Status write(const std::string &fname,
+                      const std::vector<std::string> &names,
+                      int *num_written = nullptr);
+
+  /// Get the default pack, which is opened on first use
+  /** The pack is the file named by the environment variable
+   *  \c ANTIPRISM_RES_PACK if it is set, otherwise the file
+   *  \c file_name in the data directory.
+   * \return The default pack, which is not open if no valid pack was
+   *  found or its use is disabled. */
+  static const ResourcePack &get_default();
+
+  /// Enable or disable the use of the default pack
+  /**\param use \c true to use the default pack when making resource
+   *  models, otherwise \c false. */
+  static void set_use_default(bool use);
+
+  /// Check whether the default pack is used
+  /**\return \c true if the default pack is used when making resource
+   *  models, otherwise \c false. */
+  static bool get_use_default();
+};
+
+} // namespace anti
+
+#endif // RESOURCEPACK_H
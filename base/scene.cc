@@ -107,7 +107,8 @@ Color GeometryDisplayLabel::get_label_col(Color col) const
 // --------------------------------------------------------------
 // SceneGeometry
 
-SceneGeometry::SceneGeometry(const Geometry &geo) : label(nullptr), sym(nullptr)
+SceneGeometry::SceneGeometry(const Geometry &geo)
+    : label(nullptr), sym(nullptr), frame_secs(0.04)
 {
   set_geom(geo);
 }
@@ -123,7 +124,8 @@ SceneGeometry::~SceneGeometry()
 SceneGeometry::SceneGeometry(const SceneGeometry &sc_geo)
     : SceneItem(sc_geo), bound_sph(sc_geo.bound_sph), width(sc_geo.width),
       centre(sc_geo.centre), v_ball_rad(sc_geo.v_ball_rad), geom(sc_geo.geom),
-      label(nullptr), sym(nullptr)
+      label(nullptr), sym(nullptr), frames(sc_geo.frames),
+      frame_secs(sc_geo.frame_secs), instances(sc_geo.instances)
 {
   for (auto disp : sc_geo.disps)
     add_disp(*disp);
@@ -157,13 +159,28 @@ SceneGeometry &SceneGeometry::operator=(const SceneGeometry &sc_geo)
       delete sym;
       sym = nullptr;
     }
+    frames = sc_geo.frames;
+    frame_secs = sc_geo.frame_secs;
+    instances = sc_geo.instances;
   }
   return *this;
 }
 
 void SceneGeometry::geom_changed()
 {
-  bound_sph = BoundSphere(geom.verts(), (scen) ? scen->get_inf_dist() : -1);
+  const double inf_dist = (scen) ? scen->get_inf_dist() : -1;
+  if (instances.size()) {
+    // only the vertices of the instances are needed for the bound
+    const auto &verts = geom.verts();
+    vector<Vec3d> inst_verts;
+    inst_verts.reserve(instances.size() * verts.size());
+    for (const auto &trans : instances)
+      for (const auto &v : verts)
+        inst_verts.push_back(trans * v);
+    bound_sph = BoundSphere(inst_verts, inf_dist);
+  }
+  else
+    bound_sph = BoundSphere(geom.verts(), inf_dist);
   width = 2 * bound_sph.get_radius();
   centre = bound_sph.get_centre();
   v_ball_rad = get_min_vert_to_vert_dist(geom.verts(), width / 1000) / 2.0;
@@ -241,11 +258,44 @@ Vec3d SceneGeometry::get_f_label_pos(int idx) const
     return geom.face_cent(idx);
 }
 
+void SceneGeometry::set_frames(const std::shared_ptr<FrameReader> &reader,
+                               double secs)
+{
+  frames = reader;
+  frame_secs = secs;
+  frame_tmr.set_timer(frame_secs);
+}
+
+void SceneGeometry::set_instances(const vector<Trans3d> &trans)
+{
+  instances = trans;
+  geom_changed();
+}
+
+Status SceneGeometry::next_frame()
+{
+  if (!frames)
+    return Status::error("no frame file to play");
+
+  Status stat;
+  if (frames->get_next_frame() >= frames->size() && !(stat = frames->rewind()))
+    return stat;
+  if (!(stat = frames->read_frame(geom)))
+    return stat;
+  geom_changed();
+  return Status::ok();
+}
+
 int SceneGeometry::animate()
 {
   int num_changes = 0;
   for (auto &disp : disps)
     num_changes += disp->animate();
+  if (frames && frame_tmr.finished()) {
+    if (next_frame())
+      num_changes++;
+    frame_tmr.inc_timer(frame_secs);
+  }
   return num_changes;
 }
 
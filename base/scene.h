@@ -31,9 +31,11 @@
 
 #include "boundbox.h"
 #include "coloring.h"
+#include "frames.h"
 #include "geometry.h"
 #include "symmetry.h"
 #include "timer.h"
+#include <memory>
 #include <string>
 
 namespace anti {
@@ -278,6 +280,12 @@ private:
   GeometryDisplayLabel *label;
   GeometryDisplay *sym;
 
+  std::shared_ptr<FrameReader> frames;
+  double frame_secs;
+  Timer frame_tmr;
+
+  std::vector<Trans3d> instances;
+
 public:
   /// Constructor
   /**\param geo the geometry to display in a scene. */
@@ -388,6 +396,33 @@ public:
   /**\param sy the symmetry element display to set. */
   void set_sym(const GeometryDisplay &sy);
 
+  /// Set a frame file to play
+  /**\param reader an open frame file with the same number of vertices
+   *  as the geometry, or \c nullptr to stop playing frames.
+   * \param secs the time to show each frame, in seconds. */
+  void set_frames(const std::shared_ptr<FrameReader> &reader,
+                  double secs = 0.04);
+
+  /// Get the frame file being played
+  /**\return The frame file, or \c nullptr if no file is played. */
+  FrameReader *get_frames() const { return frames.get(); }
+
+  /// Set transformations to display the geometry as several instances
+  /**\param trans the transformation of each instance, or none to
+   *  display the geometry once, untransformed. */
+  void set_instances(const std::vector<Trans3d> &trans);
+
+  /// Get the transformations of the displayed instances
+  /**\return The transformation of each instance, or none if the geometry
+   *  is displayed once, untransformed. */
+  const std::vector<Trans3d> &get_instances() const { return instances; }
+
+  /// Show the next frame of the frame file
+  /** After the last frame the file is played again from the first frame.
+   * \return status, evaluates to \c true if the frame was read,
+   *  otherwise \c false. */
+  Status next_frame();
+
   /// Update animated displays.
   /**\return The number of animation changes (\c 0 if no changes).*/
   int animate();
@@ -41,6 +41,7 @@
 #include "geometryinfo.h"
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "trace.h"
 
 using std::map;
 using std::set;
@@ -493,6 +494,8 @@ bool sort_merge_elems(Geometry &geom, const string &merge_elems,
                       vector<map<int, set<int>>> *equiv_elems,
                       bool chk_congruence, int blend_type, double eps)
 {
+  static TraceSite trace_site("sort_merge_elems");
+  TraceZone zone(trace_site);
   // an empty geom cannot be processed
   if (!geom.verts().size())
     return false;
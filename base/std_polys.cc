@@ -42,6 +42,7 @@
 #include "mathutils.h"
 #include "polygon.h"
 #include "private_std_polys.h"
+#include "resourcepack.h"
 #include "utils.h"
 
 using std::map;
@@ -1420,11 +1421,29 @@ bool make_resource_geom(Geometry &geom, string name, char *errmsg)
   if (errmsg)
     *errmsg = '\0';
 
+  // the models are made with nested faces, and converted afterwards
+  if (geom.get_face_storage() == Geometry::FACES_FLAT) {
+    Geometry nested;
+    bool geom_ok = make_resource_geom(nested, name, errmsg);
+    nested.set_face_storage(Geometry::FACES_FLAT);
+    geom = nested;
+    return geom_ok;
+  }
+
   geom.clear_all();
 
   if (!name.size())
     return false;
 
+  // Use the prebuilt model, if there is one
+  string pack_warn;
+  if (ResourcePack::get_use_default() &&
+      ResourcePack::get_default().get(name, geom, &pack_warn)) {
+    if (errmsg)
+      strcpy_msg(errmsg, pack_warn.c_str());
+    return true;
+  }
+
   bool make_dual = false;
   process_for_dual(name, make_dual);
 
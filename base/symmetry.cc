@@ -32,9 +32,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "analysiscache.h"
 #include "geometryinfo.h"
 #include "mathutils.h"
 #include "symmetry.h"
+#include "trace.h"
 #include "utils.h"
 
 using std::map;
@@ -1074,12 +1076,91 @@ Symmetry::Symmetry(const SymmetryAxis &sym_axis, const Vec3d &cent)
   init(sym_axis, cent);
 }
 
+// Cache entry: number of transformations, their matrices, then a flag
+// and, if set, the counts and members of the equivalence sets
+static void sym_cache_store(const Transformations &ts,
+                            const vector<vector<set<int>>> *equiv_sets,
+                            CacheBuffer &buf)
+{
+  buf.put(uint64_t(ts.size()));
+  for (const auto &tr : ts)
+    for (int i = 0; i < 16; i++)
+      buf.put(tr[i]);
+  buf.put(uint64_t(equiv_sets != nullptr));
+  if (equiv_sets) {
+    for (const auto &elem_sets : *equiv_sets) {
+      buf.put(uint64_t(elem_sets.size()));
+      for (const auto &equivs : elem_sets) {
+        buf.put(uint64_t(equivs.size()));
+        for (int idx : equivs)
+          buf.put(uint64_t(idx));
+      }
+    }
+  }
+}
+
+static bool sym_cache_load(CacheBuffer &buf, Transformations &ts,
+                           vector<vector<set<int>>> *equiv_sets)
+{
+  uint64_t num_ts;
+  if (!buf.get(num_ts))
+    return false;
+  for (uint64_t t = 0; t < num_ts; t++) {
+    Trans3d tr;
+    for (int i = 0; i < 16; i++)
+      buf.get(tr[i]);
+    ts.add(tr);
+  }
+  uint64_t has_equivs;
+  if (!buf.get(has_equivs) || (equiv_sets && !has_equivs))
+    return false;
+  if (equiv_sets) { // stored sets are not read if they are not needed
+    equiv_sets->clear();
+    equiv_sets->resize(3);
+    for (auto &elem_sets : *equiv_sets) {
+      uint64_t num_sets;
+      buf.get(num_sets);
+      for (uint64_t i = 0; i < num_sets && buf.is_good(); i++) {
+        elem_sets.push_back(set<int>());
+        uint64_t num_equivs;
+        buf.get(num_equivs);
+        for (uint64_t j = 0; j < num_equivs && buf.is_good(); j++) {
+          uint64_t idx;
+          if (buf.get(idx))
+            elem_sets.back().insert(idx);
+        }
+      }
+    }
+  }
+  return buf.is_good() && (!equiv_sets || buf.at_end());
+}
+
 Status Symmetry::init(const Geometry &geom,
                       vector<vector<set<int>>> *equiv_sets)
 {
+  static TraceSite trace_site("Symmetry::init");
+  TraceZone zone(trace_site);
   sym_type = unknown;
   Transformations ts;
-  find_syms(geom, ts, equiv_sets);
+
+  // An entry without equivalence sets is replaced by one with them
+  // when they are needed.
+  AnalysisCache &cache = AnalysisCache::get_cache();
+  string key;
+  CacheBuffer buf;
+  if (cache.is_enabled()) {
+    key = AnalysisCache::geom_key(geom, "symmetry-1");
+    if (!(cache.read(key, buf) && sym_cache_load(buf, ts, equiv_sets))) {
+      ts.clear();
+      buf = CacheBuffer();
+      find_syms(geom, ts, equiv_sets);
+      sym_cache_store(ts, equiv_sets, buf);
+      cache.write(key, buf);
+    }
+  }
+  else
+    find_syms(geom, ts, equiv_sets);
+
   *this = Symmetry(ts);
   return (sym_type != unknown)
              ? Status::ok()
@@ -83,6 +83,19 @@ public:
     return tv > end;
   }
 
+  /// Get the time since the %Timer finished.
+  /**For a %Timer set with an interval of \c 0 this is the time since
+   * it was set.
+   * \return The number of seconds since the %Timer finished, which is
+   * negative if the %Timer has not finished. */
+  double elapsed()
+  {
+    time_val tv;
+    get_time(&tv);
+    time_val diff = tv - end;
+    return diff.tv_sec + diff.tv_usec / 1000000.0;
+  }
+
   /// Sleep until finished.
   /**Pause program execution for the amount of time remaining
    * on the %timer. */
@@ -0,0 +1,247 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file trace.cc
+   \brief Timing of code zones and counting of events
+*/
+
+#include "trace.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace anti {
+
+// Totals for a zone or counter site. Times are held in nanoseconds so that
+// they can be added atomically.
+struct TraceSiteStats {
+  const char *name;
+  std::atomic<long> calls{0};
+  std::atomic<long long> total{0};
+  std::atomic<long long> max{0};
+  std::atomic<long> count{0};
+  std::atomic<bool> counted{false};
+};
+
+namespace {
+
+// Totals for the calls of a zone, merged over sites with the same name
+struct ZoneStats {
+  long calls = 0;
+  double total = 0.0;
+  double max = 0.0;
+};
+
+// A single call of a zone, for the Chrome trace
+struct ZoneEvent {
+  const char *name;
+  double start;
+  double dur;
+  int thread;
+};
+
+// Events beyond this number are counted in the totals but not stored
+const unsigned int max_events = 1000000;
+
+// The trace records. These are allocated once and never freed, so they
+// are still available when the report is made at exit. The mutex guards
+// the site list and the events, the site totals are atomic.
+struct TraceData {
+  bool to_json = false;
+  string file_name;
+  Timer clock;
+  std::mutex mtx;
+  vector<TraceSiteStats *> sites;
+  vector<ZoneEvent> events;
+  long dropped_events = 0;
+  std::atomic<int> num_threads{0};
+};
+
+TraceData *trace_data = nullptr;
+
+int thread_number(TraceData &data)
+{
+  thread_local int thread_num = data.num_threads++;
+  return thread_num;
+}
+
+void print_summary(const TraceData &data)
+{
+  map<string, ZoneStats> zone_map;
+  map<string, long> counts;
+  for (const auto *site : data.sites) {
+    if (site->calls) {
+      ZoneStats &st = zone_map[site->name];
+      st.calls += site->calls;
+      st.total += site->total * 1e-9;
+      st.max = std::max(st.max, site->max * 1e-9);
+    }
+    if (site->counted)
+      counts[site->name] += site->count;
+  }
+
+  vector<std::pair<string, ZoneStats>> zones(zone_map.begin(),
+                                             zone_map.end());
+  std::sort(zones.begin(), zones.end(),
+            [](const std::pair<string, ZoneStats> &a,
+               const std::pair<string, ZoneStats> &b) {
+              return a.second.total > b.second.total;
+            });
+
+  fprintf(stderr, "trace summary (times in milliseconds)\n");
+  fprintf(stderr, "%-32s %10s %12s %12s %12s\n", "zone", "calls", "total",
+          "mean", "max");
+  for (const auto &kp : zones) {
+    const ZoneStats &st = kp.second;
+    fprintf(stderr, "%-32s %10ld %12.3f %12.3f %12.3f\n", kp.first.c_str(),
+            st.calls, st.total * 1000, st.total * 1000 / st.calls,
+            st.max * 1000);
+  }
+  if (counts.size()) {
+    fprintf(stderr, "%-32s %10s\n", "counter", "count");
+    for (const auto &kp : counts)
+      fprintf(stderr, "%-32s %10ld\n", kp.first.c_str(), kp.second);
+  }
+}
+
+bool write_json(const TraceData &data)
+{
+  FILE *ofile = fopen(data.file_name.c_str(), "w");
+  if (!ofile)
+    return false;
+
+  map<string, long> counts;
+  for (const auto *site : data.sites)
+    if (site->counted)
+      counts[site->name] += site->count;
+
+  fprintf(ofile, "{\"traceEvents\":[\n");
+  const char *sep = "";
+  for (const auto &ev : data.events) {
+    fprintf(ofile,
+            "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            sep, ev.name, ev.thread, ev.start * 1e6, ev.dur * 1e6);
+    sep = ",\n";
+  }
+  for (const auto &kp : counts) {
+    fprintf(ofile,
+            "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":0,"
+            "\"ts\":0,\"args\":{\"count\":%ld}}",
+            sep, kp.first.c_str(), kp.second);
+    sep = ",\n";
+  }
+  fprintf(ofile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(ofile);
+  return true;
+}
+
+void trace_report()
+{
+  TraceData &data = *trace_data;
+  std::lock_guard<std::mutex> lock(data.mtx);
+  if (!data.to_json)
+    print_summary(data);
+  else {
+    if (!write_json(data))
+      fprintf(stderr, "trace: could not write to '%s'\n",
+              data.file_name.c_str());
+    if (data.dropped_events)
+      fprintf(stderr, "trace: %ld zone calls not written (limit %u)\n",
+              data.dropped_events, max_events);
+  }
+}
+
+} // namespace
+
+bool Trace::enabled = Trace::init();
+
+bool Trace::init()
+{
+  const char *env = getenv("ANTIPRISM_TRACE");
+  if (!env || !*env)
+    return false;
+
+  trace_data = new TraceData;
+  if (strncmp(env, "json", 4) == 0 && (env[4] == '\0' || env[4] == ':')) {
+    trace_data->to_json = true;
+    trace_data->file_name = (env[4] == ':') ? env + 5 : "antiprism_trace.json";
+  }
+  trace_data->clock.set_timer(0.0);
+  atexit(trace_report);
+  return true;
+}
+
+double Trace::now() { return trace_data->clock.elapsed(); }
+
+TraceSiteStats *Trace::add_site(const char *name)
+{
+  TraceData &data = *trace_data;
+  auto *stats = new TraceSiteStats;
+  stats->name = name;
+  std::lock_guard<std::mutex> lock(data.mtx);
+  data.sites.push_back(stats);
+  return stats;
+}
+
+void Trace::add_zone(TraceSiteStats *stats, double start)
+{
+  double dur = now() - start;
+  long long dur_ns = (long long)(dur * 1e9);
+  stats->calls++;
+  stats->total += dur_ns;
+  long long max = stats->max;
+  while (dur_ns > max && !stats->max.compare_exchange_weak(max, dur_ns))
+    ;
+
+  TraceData &data = *trace_data;
+  if (data.to_json) {
+    int thread = thread_number(data);
+    std::lock_guard<std::mutex> lock(data.mtx);
+    if (data.events.size() < max_events)
+      data.events.push_back({stats->name, start, dur, thread});
+    else
+      data.dropped_events++;
+  }
+}
+
+void Trace::add_count(TraceSiteStats *stats, long num)
+{
+  stats->count += num;
+  stats->counted = true;
+}
+
+} // namespace anti
@@ -0,0 +1,139 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file trace.h
+   \brief Timing of code zones and counting of events
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+namespace anti {
+
+struct TraceSiteStats;
+
+/// Record the time spent in zones of code, and counts of events
+/** Tracing is enabled by setting the environment variable
+ *  \c ANTIPRISM_TRACE, and the report is made when the program exits.
+ *  A value of \c json writes a Chrome trace (for chrome://tracing) to
+ *  \c antiprism_trace.json, \c json:file_name writes it to \c file_name,
+ *  and any other value prints a summary of the zones and counters to
+ *  standard error. When tracing is not enabled zones and counters only
+ *  test a pointer. The functions may be called from several threads.
+ *
+ *  Zones are named after the function they time, with the class for a
+ *  member function, and counters are named \c zone_name.quantity */
+class Trace {
+private:
+  static bool enabled;
+
+  // Read the environment, and set up the report if enabled
+  static bool init();
+
+public:
+  /// Check whether tracing is enabled
+  /**\return \c true if tracing is enabled, otherwise \c false. */
+  static bool is_enabled() { return enabled; }
+
+  /// Get the trace time
+  /**\return The number of seconds since tracing started. */
+  static double now();
+
+  /// Get the statistics for a site, for a new site
+  /**\param name the site name, which must remain valid until exit.
+   * \return The statistics, which are kept until exit. */
+  static TraceSiteStats *add_site(const char *name);
+
+  /// Record a zone
+  /**\param stats the statistics of the zone site.
+   * \param start the trace time the zone started. */
+  static void add_zone(TraceSiteStats *stats, double start);
+
+  /// Add to a counter
+  /**\param stats the statistics of the counter site.
+   * \param num the number to add. */
+  static void add_count(TraceSiteStats *stats, long num);
+};
+
+/// A place in the code where a zone is timed or events are counted
+/**Declare as a \c static variable at the site, so that its statistics are
+ * set up once, and each zone or count adds to them without a look up. */
+class TraceSite {
+private:
+  TraceSiteStats *stats;
+
+public:
+  /// Constructor
+  /**\param name the site name, which must remain valid until exit. */
+  TraceSite(const char *name)
+      : stats(Trace::is_enabled() ? Trace::add_site(name) : nullptr)
+  {
+  }
+
+  TraceSite(const TraceSite &) = delete;
+  TraceSite &operator=(const TraceSite &) = delete;
+
+  /// Get the statistics
+  /**\return The statistics, or \c nullptr if tracing is not enabled. */
+  TraceSiteStats *get_stats() const { return stats; }
+};
+
+/// Time a zone of code, from construction until leaving scope
+class TraceZone {
+private:
+  TraceSiteStats *stats;
+  double start;
+
+public:
+  /// Constructor
+  /**\param site the site of the zone. */
+  TraceZone(const TraceSite &site) : stats(site.get_stats()), start(0.0)
+  {
+    if (stats)
+      start = Trace::now();
+  }
+
+  TraceZone(const TraceZone &) = delete;
+  TraceZone &operator=(const TraceZone &) = delete;
+
+  /// Destructor
+  ~TraceZone()
+  {
+    if (stats)
+      Trace::add_zone(stats, start);
+  }
+};
+
+/// Add to a trace counter
+/**\param site the site of the counter.
+ * \param num the number to add. */
+inline void trace_count(const TraceSite &site, long num = 1)
+{
+  if (site.get_stats())
+    Trace::add_count(site.get_stats(), num);
+}
+
+} // namespace anti
+
+#endif // TRACE_H
@@ -31,6 +31,7 @@
 
 #include "mathutils.h"
 #include "trans3d.h"
+#include "vec_batch.h"
 
 using std::vector;
 
@@ -223,6 +224,11 @@ Vec3d operator*(const Trans3d &trans, const Vec3d &vec)
   return new_v;
 }
 
+void transform(std::vector<Vec3d> &vecs, const Trans3d &trans)
+{
+  batch_transform(vecs.data(), vecs.size(), trans);
+}
+
 Vec4d operator*(const Trans3d &trans, const Vec4d &vec)
 {
   auto new_v = Vec4d::zero;
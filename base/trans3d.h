@@ -398,12 +398,6 @@ inline bool operator==(const Trans3d &trans1, const Trans3d &trans2)
   return true;
 }
 
-inline void transform(std::vector<Vec3d> &vecs, const Trans3d &trans)
-{
-  for (auto &v : vecs)
-    v = trans * v;
-}
-
 } // namespace anti
 
 #endif // TRANS3D_H
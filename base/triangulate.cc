@@ -35,6 +35,7 @@
 
 #include "geometry.h"
 #include "tesselator/glu.h"
+#include "trace.h"
 
 using std::map;
 using std::vector;
@@ -212,6 +213,10 @@ bool anti_tesselator::set_winding_rule(unsigned int winding_rule)
 void triangulate(Geometry &geom, Color inv, unsigned int winding,
                  vector<int> *fmap)
 {
+  static TraceSite trace_site("triangulate");
+  TraceZone zone(trace_site);
+  static TraceSite count_site("triangulate.input_faces");
+  trace_count(count_site, geom.faces().size());
   anti_tesselator tess;
   tess.set_winding_rule(winding);
   vector<vector<int>> faces = geom.faces();
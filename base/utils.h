@@ -61,6 +61,25 @@ std::string dots2underscores(std::string str);
  *  was read, otherwise \c false.*/
 Status read_double(const char *str, double *f);
 
+/// Evaluate a mathematical expression for arrays of variable values.
+/** The expression is evaluated for the values at each position of the
+ *  arrays, and the positions are split into ranges which are evaluated
+ *  in parallel.
+ * \param expr the expression.
+ * \param var_names the names of the variables.
+ * \param var_vals the values of the variables, one array of \a num values
+ *  for each name, in the same order as the names.
+ * \param num the number of positions.
+ * \param results used to return the results, with space for \a num values.
+ * \param num_threads the number of threads, or if \c 0 then use
+ *  \c get_num_threads().
+ * \return status, evaluates to \c true if the expression was valid and
+ *  all the results were finite numbers, otherwise \c false.*/
+Status eval_expression_bulk(const char *expr,
+                            const std::vector<std::string> &var_names,
+                            const std::vector<const double *> &var_vals,
+                            size_t num, double *results, int num_threads = 0);
+
 /// Read a floating point number from a string.
 /** The string should only hold the floating point number, but may
  *  have leading and trailing whitespace.
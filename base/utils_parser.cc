@@ -36,8 +36,13 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "mathutils.h"
 #include "muparser/muParser.h"
+#include "parallel.h"
 #include "utils.h"
 
 // The muParser header includes <cmath> which conflicts with <math.h>
@@ -67,7 +72,9 @@ private:
   static int rt_tok(const char *tok, int *pos, double *val);
 
 public:
-  ExpParser();
+  /// Constructor
+  /**\param def_vars define the variables var0, var1, ... */
+  ExpParser(bool def_vars = true);
 };
 
 // Determine if a token is of form rt2.2, and set value to sqrt(2.2)
@@ -105,14 +112,15 @@ int ExpParser::rt_tok(const char *tok, int *pos, double *val)
   return true;
 }
 
-ExpParser::ExpParser() : Parser()
+ExpParser::ExpParser(bool def_vars) : Parser()
 {
   // Seperator for expressions and function arguments
   SetArgSep(';');
 
   for (int i = 0; i < num_vars; i++) {
     vars[i] = 0.0;
-    DefineVar(msg_str("var%d", i), &vars[i]);
+    if (def_vars)
+      DefineVar(msg_str("var%d", i), &vars[i]);
   }
 
   // Replacement functions
@@ -167,4 +175,78 @@ Status read_double(const char *str, double *f)
   return stat;
 }
 
+Status eval_expression_bulk(const char *expr, const vector<string> &var_names,
+                            const vector<const double *> &var_vals,
+                            size_t num, double *results, int num_threads)
+{
+  char msg_type[] = "maths expression";
+  if (num_threads <= 0)
+    num_threads = get_num_threads();
+
+  // In bulk mode muParser reads every variable at an offset of the
+  // position, so each range has its own parser with the variables set
+  // to the start of the range. The single values var0, var1, ... are not
+  // defined.
+  const size_t min_chunk = 4096;
+  size_t chunk = std::max(min_chunk, (num + num_threads - 1) / num_threads);
+  size_t num_chunks = (num + chunk - 1) / chunk;
+  vector<Status> stats(num_chunks);
+  parallel_for(
+      num_chunks,
+      [&](size_t c) {
+        size_t start = c * chunk;
+        size_t end = std::min(start + chunk, num);
+        try {
+          ExpParser p(false);
+          for (size_t i = 0; i < var_names.size(); i++)
+            p.DefineVar(var_names[i],
+                        const_cast<double *>(var_vals[i]) + start);
+          p.SetExpr(expr);
+          p.Eval(results + start, int(end - start));
+          if (p.GetNumResults() != 1) {
+            stats[c].set_error(
+                msg_str("%s: must be a single expression", msg_type));
+            return;
+          }
+        }
+        catch (Parser::exception_type &e) {
+          stats[c].set_error(msg_str("%s: %s", msg_type, e.GetMsg().c_str()));
+          return;
+        }
+        for (size_t i = start; i < end; i++) {
+          if (std::isnan(results[i]) || std::isinf(results[i])) {
+            stats[c].set_error(
+                msg_str("%s: result for position %lu is not a finite number",
+                        msg_type, (unsigned long)i));
+            return;
+          }
+        }
+      },
+      num_threads, 1);
+
+  for (const auto &stat : stats)
+    if (stat.is_error())
+      return stat;
+
+  // Check the expression when there are no positions
+  if (num == 0) {
+    try {
+      ExpParser p(false);
+      double dummy = 0.0;
+      for (const auto &name : var_names)
+        p.DefineVar(name, &dummy);
+      p.SetExpr(expr);
+      p.Eval();
+      if (p.GetNumResults() != 1)
+        return Status::error(
+            msg_str("%s: must be a single expression", msg_type));
+    }
+    catch (Parser::exception_type &e) {
+      return Status::error(msg_str("%s: %s", msg_type, e.GetMsg().c_str()));
+    }
+  }
+
+  return Status::ok();
+}
+
 } // namespace anti
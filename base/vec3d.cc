@@ -80,7 +80,4 @@ void Vec3d::dump(const char *var, FILE *file) const
   fprintf(file, "%s\n", str().c_str());
 }
 
-// make vector unusable
-void Vec3d::unset() { v[0] = NAN; }
-
 } // namespace anti
@@ -161,10 +161,10 @@ public:
   void unset();
 
   /// Get a random vector.
-  // Uses random numbers provided by the Random argument.
+  // Uses random numbers provided by the Random (or CounterRandom) argument.
   /**\param rnd to provide the random numbers
    * \return A random vector with length less then or equal to one. */
-  static Vec3d random(Random &rnd);
+  template <typename RAND> static Vec3d random(RAND &rnd);
 
   /// Check whether a vector has been set
   /**\return \c true if set, otherwise \c false */
@@ -280,7 +280,7 @@ inline Vec3d::Vec3d(float *vals)
   v[2] = vals[2];
 }
 
-inline Vec3d Vec3d::random(Random &rnd)
+template <typename RAND> inline Vec3d Vec3d::random(RAND &rnd)
 {
   Vec3d u;
   do {
@@ -291,6 +291,9 @@ inline Vec3d Vec3d::random(Random &rnd)
   return u;
 }
 
+// make vector unusable
+inline void Vec3d::unset() { v[0] = NAN; }
+
 inline Vec3d Vec3d::unit() const
 {
   Vec3d ret = *this;
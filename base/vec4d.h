@@ -144,10 +144,10 @@ public:
   void unset();
 
   /// Get a random vector.
-  // Uses random numbers provided by the Random argument.
+  // Uses random numbers provided by the Random (or CounterRandom) argument.
   /**\param rnd to provide the random numbers
    * \return A random vector with length less then or equal to one. */
-  static Vec4d random(Random &rnd);
+  template <typename RAND> static Vec4d random(RAND &rnd);
 
   /// Check whether a vector has been set
   /**\return \c true if set, otherwise \c false */
@@ -205,7 +205,7 @@ inline Vec4d::Vec4d(double x, double y, double z, double w)
   v[3] = w;
 }
 
-inline Vec4d Vec4d::random(Random &rnd)
+template <typename RAND> inline Vec4d Vec4d::random(RAND &rnd)
 {
   Vec4d u;
   do {
@@ -0,0 +1,217 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file vec_batch.cc
+   \brief Kernels for operations on arrays of vertex coordinates
+*/
+
+#include <math.h>
+#include <stdint.h>
+
+#include "vec_batch.h"
+
+using std::vector;
+
+// Build a kernel for AVX2 and the baseline, selected at load time. This
+// needs the GNU indirect function support of glibc on x86-64. AVX2 does
+// not include FMA, so the compiler cannot contract the arithmetic and
+// both versions give the same results.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GLIBC__) &&        \
+    defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define BATCH_CLONES __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#ifndef BATCH_CLONES
+#define BATCH_CLONES
+#endif
+
+namespace anti {
+
+// The kernels read and write the coordinates of consecutive Vec3d values
+// as a plain array
+static_assert(sizeof(Vec3d) == 3 * sizeof(double),
+              "Vec3d must hold only its three coordinates");
+
+static inline const double *coords(const Vec3d *pts)
+{
+  return reinterpret_cast<const double *>(pts);
+}
+
+static inline double *coords(Vec3d *pts)
+{
+  return reinterpret_cast<double *>(pts);
+}
+
+BATCH_CLONES
+void batch_transform(Vec3d *pts, size_t num, const Trans3d &trans)
+{
+  double m[12];
+  for (int i = 0; i < 12; i++)
+    m[i] = trans[i];
+
+  double *c = coords(pts);
+  for (size_t i = 0; i < num; i++, c += 3) {
+    const double x = c[0], y = c[1], z = c[2];
+    // sums start from zero, as for a single vector
+    c[0] = 0.0 + m[0] * x + m[1] * y + m[2] * z + m[3];
+    c[1] = 0.0 + m[4] * x + m[5] * y + m[6] * z + m[7];
+    c[2] = 0.0 + m[8] * x + m[9] * y + m[10] * z + m[11];
+  }
+}
+
+BATCH_CLONES
+Vec3d batch_centroid(const Vec3d *pts, size_t num)
+{
+  const double *c = coords(pts);
+  double sum[3] = {0.0, 0.0, 0.0};
+  for (size_t i = 0; i < num; i++, c += 3) {
+    sum[0] += c[0];
+    sum[1] += c[1];
+    sum[2] += c[2];
+  }
+  return Vec3d(sum[0], sum[1], sum[2]) /= num;
+}
+
+BATCH_CLONES
+Vec3d batch_centroid(const Vec3d *pts, const int *idxs, size_t num)
+{
+  const double *c = coords(pts);
+  double sum[3] = {0.0, 0.0, 0.0};
+  for (size_t i = 0; i < num; i++) {
+    const double *pt = c + 3 * idxs[i];
+    sum[0] += pt[0];
+    sum[1] += pt[1];
+    sum[2] += pt[2];
+  }
+  return Vec3d(sum[0], sum[1], sum[2]) /= num;
+}
+
+BATCH_CLONES
+Vec3d batch_newell_norm(const Vec3d *verts, FaceView face)
+{
+  // The three components are summed in one pass, each starting from the
+  // second vertex, as each was when summed on its own
+  const int sz = face.size();
+  if (sz < 3) // no area, and the index wrapping below needs three vertices
+    return Vec3d(0, 0, 0);
+
+  const double *c = coords(verts);
+  double sum[3] = {0.0, 0.0, 0.0};
+  const double *prev = c + 3 * face[0];
+  const double *cur = c + 3 * face[1 % sz];
+  for (int i = 1; i <= sz; i++) {
+    const double *next = c + 3 * face[(i + 1 < sz) ? i + 1 : i + 1 - sz];
+    sum[0] += cur[1] * (next[2] - prev[2]);
+    sum[1] += cur[2] * (next[0] - prev[0]);
+    sum[2] += cur[0] * (next[1] - prev[1]);
+    prev = cur;
+    cur = next;
+  }
+  return Vec3d(sum[0] / 2.0, sum[1] / 2.0, sum[2] / 2.0);
+}
+
+BATCH_CLONES
+double batch_cone_volume(const Vec3d *verts, FaceView face, Vec3d apex,
+                         Vec3d *vol_cent)
+{
+  double vol = 0;
+  Vec3d cent = Vec3d(0, 0, 0);
+  if (face.size()) {
+    const Vec3d v0 = verts[face[0]];
+    const Vec3d v0_rel = v0 - apex;
+    for (unsigned int i = 1; i + 1 < face.size(); i++) {
+      const Vec3d &v1 = verts[face[i]];
+      const Vec3d &v2 = verts[face[i + 1]];
+      double tet_vol = vtriple(v0_rel, v1 - apex, v2 - apex);
+      cent += tet_vol * (apex + v0 + v1 + v2); // /4 deferred
+      vol += tet_vol;                          // /6 deferred
+    }
+  }
+  if (!double_eq(vol, 0))
+    *vol_cent = (cent / 4) / vol;
+  else
+    *vol_cent = Vec3d(0, 0, 0);
+
+  return vol / 6;
+}
+
+BATCH_CLONES
+void batch_bound_box(const Vec3d *pts, size_t num, double cutoff,
+                     Vec3d &min_coords, Vec3d &max_coords)
+{
+  const double cut_off2 = cutoff * cutoff;
+  double mins[3] = {min_coords[0], min_coords[1], min_coords[2]};
+  double maxs[3] = {max_coords[0], max_coords[1], max_coords[2]};
+  const double *c = coords(pts);
+  for (size_t i = 0; i < num; i++, c += 3) {
+    if (cutoff < 0 || c[0] * c[0] + c[1] * c[1] + c[2] * c[2] < cut_off2) {
+      for (int j = 0; j < 3; j++) {
+        mins[j] = (c[j] < mins[j]) ? c[j] : mins[j];
+        maxs[j] = (c[j] > maxs[j]) ? c[j] : maxs[j];
+      }
+    }
+  }
+  min_coords = Vec3d(mins[0], mins[1], mins[2]);
+  max_coords = Vec3d(maxs[0], maxs[1], maxs[2]);
+}
+
+BATCH_CLONES
+void batch_edge_nearest_points(const Vec3d *verts,
+                               const vector<vector<int>> &edges, Vec3d P,
+                               Vec3d *near_pts, double eps)
+{
+  const double *c = coords(verts);
+  double *near_c = coords(near_pts);
+  const double eps2 = eps * eps;
+  for (size_t i = 0; i < edges.size(); i++, near_c += 3) {
+    const double *q0 = c + 3 * edges[i][0];
+    const double *q1 = c + 3 * edges[i][1];
+    double u[3] = {q1[0] - q0[0], q1[1] - q0[1], q1[2] - q0[2]};
+    const double len2 = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+    if (len2 <= eps2) {
+      for (int j = 0; j < 3; j++)
+        near_c[j] = q0[j];
+      continue;
+    }
+
+    const double len = sqrt(len2);
+    if (len > 1e-20) {
+      const double inv_len = 1 / len;
+      for (int j = 0; j < 3; j++)
+        u[j] *= inv_len;
+    }
+    else {
+      u[0] = 0;
+      u[1] = 0;
+      u[2] = 1;
+    }
+    const double dot = u[0] * (P[0] - q0[0]) + u[1] * (P[1] - q0[1]) +
+                       u[2] * (P[2] - q0[2]);
+    for (int j = 0; j < 3; j++)
+      near_c[j] = q0[j] + dot * u[j];
+  }
+}
+
+} // namespace anti
@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file vec_batch.h
+   \brief Kernels for operations on arrays of vertex coordinates
+*/
+
+#ifndef VEC_BATCH_H
+#define VEC_BATCH_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "faceview.h"
+#include "trans3d.h"
+#include "vec3d.h"
+
+namespace anti {
+
+// The kernels work on the coordinate arrays of existing vertex vectors.
+// Where the compiler supports it they are built for AVX2 and for the
+// baseline instruction set, and the version used is chosen when the
+// program starts. Sums are made in the same order as the single vector
+// operations, and fused multiply-add is not used, so the results do not
+// depend on the version.
+
+/// Transform points
+/**\param pts the points, transformed in place.
+ * \param num the number of points.
+ * \param trans the transformation. */
+void batch_transform(Vec3d *pts, size_t num, const Trans3d &trans);
+
+/// Get the centroid of points
+/**\param pts the points.
+ * \param num the number of points.
+ * \return The centroid. */
+Vec3d batch_centroid(const Vec3d *pts, size_t num);
+
+/// Get the centroid of points selected by index number
+/**\param pts the points.
+ * \param idxs the index numbers of the points to use.
+ * \param num the number of index numbers.
+ * \return The centroid. */
+Vec3d batch_centroid(const Vec3d *pts, const int *idxs, size_t num);
+
+/// Get the Newell normal of a face
+/** The length of the normal is the area of the face.
+ * \param verts the vertex coordinates.
+ * \param face the vertex index numbers of the face.
+ * \return The normal. */
+Vec3d batch_newell_norm(const Vec3d *verts, FaceView face);
+
+/// Get the signed volume of the cone from a point to a face
+/**\param verts the vertex coordinates.
+ * \param face the vertex index numbers of the face.
+ * \param apex the apex of the cone.
+ * \param vol_cent to return the centroid of the cone, or \c (0,0,0) if
+ *  the volume is zero.
+ * \return The volume. */
+double batch_cone_volume(const Vec3d *verts, FaceView face, Vec3d apex,
+                         Vec3d *vol_cent);
+
+/// Get the bounding box of points
+/**\param pts the points.
+ * \param num the number of points.
+ * \param cutoff points further than this from the origin are ignored,
+ *  or if negative then no points are ignored.
+ * \param min_coords the minimum coordinates, updated by the points.
+ * \param max_coords the maximum coordinates, updated by the points. */
+void batch_bound_box(const Vec3d *pts, size_t num, double cutoff,
+                     Vec3d &min_coords, Vec3d &max_coords);
+
+/// Get the nearest points on the lines of edges to a point
+/**\param verts the vertex coordinates.
+ * \param edges the edges, each with two vertex index numbers.
+ * \param P the point.
+ * \param near_pts to return the nearest point for each edge, or the first
+ *  vertex if the edge length is not greater than \a eps.
+ * \param eps a small number, coordinates that differ by less than this
+ *  are considered equal. */
+void batch_edge_nearest_points(const Vec3d *verts,
+                               const std::vector<std::vector<int>> &edges,
+                               Vec3d P, Vec3d *near_pts, double eps = epsilon);
+
+} // namespace anti
+
+#endif // VEC_BATCH_H
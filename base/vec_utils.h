@@ -29,6 +29,7 @@
 #ifndef VEC_UTILS_H
 #define VEC_UTILS_H
 
+#include "faceview.h"
 #include "vec3d.h"
 #include <vector>
 
@@ -42,6 +43,12 @@ namespace anti {
 Vec3d centroid(const std::vector<Vec3d> &pts,
                const std::vector<int> &idxs = std::vector<int>());
 
+/// Get the centroid of the vertices of a face
+/**\param pts the points
+ * \param face the index numbers of the points to use.
+ * \return The centroid. */
+Vec3d centroid(const std::vector<Vec3d> &pts, FaceView face);
+
 /// Get the point of intersection of a line and a plane.
 /**\param Q a point on the plane.
  * \param n the normal to the plane
@@ -205,6 +212,16 @@ Vec3d point_in_segment(const Vec3d &P, const Vec3d &Q0, const Vec3d &Q1,
 Vec3d face_norm(const std::vector<Vec3d> &verts, const std::vector<int> &face,
                 bool allow_zero = false);
 
+/// Get a face normal and face area
+/**\param verts a set of vertices
+ * \param face the index numbers of the vertices in \a verts that make the face.
+ * \param allow_zero if \c true then the length of the returned normal
+ *  is the area of the face, if \c false then this will not be true for
+ *  faces with a signed area close to zero.
+ * \return A normal to the face. */
+Vec3d face_norm(const std::vector<Vec3d> &verts, FaceView face,
+                bool allow_zero = false);
+
 /// Get the angle required to rotate one vector onto another around an axis
 /**\param v0 vector to rotate (perpendicular to axis)
  * \param v1 vector to rotate onto (perpendicular to axis)
@@ -28,19 +28,22 @@
    Project: Antiprism - http://www.antiprism.com
 */
 
+#include "vec_batch.h"
 #include "vec_utils.h"
 
 namespace anti {
 
 Vec3d centroid(const std::vector<Vec3d> &pts, const std::vector<int> &idxs)
 {
-  bool all_pts = (idxs.size() == 0);
-  int num_pts = all_pts ? pts.size() : idxs.size();
-  Vec3d centroid(0, 0, 0);
-  for (int i = 0; i < num_pts; i++)
-    centroid += pts[all_pts ? i : idxs[i]];
-  centroid /= num_pts;
-  return centroid;
+  if (idxs.size() == 0)
+    return batch_centroid(pts.data(), pts.size());
+  else
+    return batch_centroid(pts.data(), idxs.data(), idxs.size());
+}
+
+Vec3d centroid(const std::vector<Vec3d> &pts, FaceView face)
+{
+  return batch_centroid(pts.data(), face.begin(), face.size());
 }
 
 } // namespace anti
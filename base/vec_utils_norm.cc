@@ -26,6 +26,7 @@
    \brief Vector utilities, face normals
 */
 
+#include "vec_batch.h"
 #include "vec_utils.h"
 
 using std::vector;
@@ -42,7 +43,7 @@ inline Vec3d find_norm(Vec3d Q0, Vec3d Q1, Vec3d Q2)
   return vcross((Q0 - Q1).unit(), (-Q1 + Q2).unit());
 }
 
-Vec3d face_norm_largest(const vector<Vec3d> &verts, const vector<int> &face)
+static Vec3d face_norm_largest(const vector<Vec3d> &verts, FaceView face)
 {
   unsigned int sz = face.size();
   Vec3d norm = Vec3d(0, 0, 0);
@@ -60,26 +61,18 @@ Vec3d face_norm_largest(const vector<Vec3d> &verts, const vector<int> &face)
   return norm;
 }
 
-// adapted from http://jgt.akpeters.com/papers/Sunday02/
-double findArea(const vector<Vec3d> &verts, const vector<int> &face, int idx0,
-                int idx1)
+Vec3d face_norm(const vector<Vec3d> &verts, FaceView face, bool allow_zero)
 {
-  int sz = face.size();
-  double sum = 0.0;
-  for (int i = 1; i <= sz; i++)
-    sum += verts[face[i % sz]][idx0] * (verts[face[(i + 1) % sz]][idx1] -
-                                        verts[face[(i - 1 + sz) % sz]][idx1]);
-  return (sum / 2.0);
+  // Newell normal, adapted from http://jgt.akpeters.com/papers/Sunday02/
+  Vec3d norm = batch_newell_norm(verts.data(), face);
+  return (allow_zero || norm.len() > 1e-8) ? norm
+                                           : face_norm_largest(verts, face);
 }
 
 Vec3d face_norm(const vector<Vec3d> &verts, const vector<int> &face,
                 bool allow_zero)
 {
-  // Newell normal
-  Vec3d norm(findArea(verts, face, 1, 2), findArea(verts, face, 2, 0),
-             findArea(verts, face, 0, 1));
-  return (allow_zero || norm.len() > 1e-8) ? norm
-                                           : face_norm_largest(verts, face);
+  return face_norm(verts, FaceView(face), allow_zero);
 }
 
 } // namespace anti
@@ -33,6 +33,7 @@
 #include "geometryinfo.h"
 #include "symmetry.h"
 #include "tiling.h"
+#include "trace.h"
 #include "utils.h"
 
 #include "private_std_polys.h"
@@ -658,6 +659,8 @@ static void add_faces(Geometry &geom, Vec3d pt, int num, int denom,
 
 bool Wythoff::make_poly(Geometry &geom, char *errmsg)
 {
+  static TraceSite trace_site("Wythoff::make_poly");
+  TraceZone zone(trace_site);
   if (errmsg)
     *errmsg = '\0';
   geom.clear_all();
@@ -1568,6 +1571,8 @@ static void store_tri(map<vector<int>, pair<int, int>> &elem_to_tri,
 Status Tiling::make_tiling(Geometry &geom, ColoringType col_type,
                            vector<Tile::TileReport> *tile_reports) const
 {
+  static TraceSite trace_site("Tiling::make_tiling");
+  TraceZone zone(trace_site);
   geom.clear_all();
   if (tile_reports)
     tile_reports->resize(pat_paths.size());
@@ -342,8 +342,8 @@ Status make_polar_zonohedron(Geometry &geom, const vector<Vec3d> &star,
 
     geom.add_vert(Vec3d(0, 0, 0)); // initial point
     geom.add_vert(Vec3d(0, 0, 0)); // final point, set later
-    Vec3d A;                       // points along this spiral
-    Vec3d B;                       // points along following spiral
+    Vec3d A(0, 0, 0);              // points along this spiral
+    Vec3d B(0, 0, 0);              // points along following spiral
     for (int s = 0; s < P_num_spirals; s++) {
       A = Vec3d(0, 0, 0);
       for (int i = 0; i < P - P_spiral_step; i++) {
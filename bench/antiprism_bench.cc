@@ -0,0 +1,562 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: antiprism_bench.cc
+   Description: time library operations and programs on generated models
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+class bench_opts : public ProgramOpts {
+public:
+  int repeats;
+  int max_size;
+  string filter;
+  string tool_dir;
+  string ofile;
+  string baseline_file;
+  double tolerance;
+  bool list_only;
+  bool keep_files;
+
+  bench_opts()
+      : ProgramOpts("antiprism_bench"), repeats(5), max_size(2),
+        ofile("bench_results.json"), tolerance(10.0), list_only(false),
+        keep_files(false)
+  {
+  }
+  void process_command_line(int argc, char **argv);
+  void usage();
+};
+
+// clang-format off
+void bench_opts::usage()
+{
+   fprintf(stdout,
+"\n"
+"Usage: %s [options]\n"
+"\n"
+"Time core library operations, and optionally the programs, on generated\n"
+"models of several sizes: geodesic spheres, Bravais lattices, uniform\n"
+"compounds, Conway expansions and dense stellations. The median time of\n"
+"each benchmark is written to a file in JSON format, and may be compared\n"
+"with a previous results file. Before timing, each model is read and\n"
+"written with flat face storage, and the program exits with an error if\n"
+"the faces differ from those read with nested face storage.\n"
+"\n"
+"Options\n"
+"%s"
+"  -r <num>  number of timed runs of each benchmark (default: 5)\n"
+"  -s <num>  largest model size, 1 - small, 2 - medium, 3 - large\n"
+"            (default: 2)\n"
+"  -f <str>  only run benchmarks with names containing this string\n"
+"  -d <dir>  also time the programs, which are found in directory dir\n"
+"  -o <file> write results to file (default: bench_results.json)\n"
+"  -c <file> compare with results file, and exit with status 1 if any\n"
+"            benchmark is slower by more than the tolerance\n"
+"  -t <perc> tolerance for comparison, as a percentage (default: 10)\n"
+"  -l        list the benchmark names and exit\n"
+"  -k        keep the model files written for the programs\n"
+"\n"
+"\n", prog_name(), help_ver_text);
+}
+// clang-format on
+
+void bench_opts::process_command_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hr:s:f:d:o:c:t:lk")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'r':
+      print_status_or_exit(read_int(optarg, &repeats), c);
+      if (repeats < 1)
+        error("number of runs must be a positive integer", c);
+      break;
+
+    case 's':
+      print_status_or_exit(read_int(optarg, &max_size), c);
+      if (max_size < 1 || max_size > 3)
+        error("size must be 1, 2 or 3", c);
+      break;
+
+    case 'f':
+      filter = optarg;
+      break;
+
+    case 'd':
+      tool_dir = optarg;
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    case 'c':
+      baseline_file = optarg;
+      break;
+
+    case 't':
+      print_status_or_exit(read_double(optarg, &tolerance), c);
+      if (tolerance < 0)
+        error("tolerance cannot be negative", c);
+      break;
+
+    case 'l':
+      list_only = true;
+      break;
+
+    case 'k':
+      keep_files = true;
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 0)
+    error("too many arguments");
+}
+
+const char *size_names[] = {"small", "medium", "large"};
+
+// A model used as benchmark input
+struct BenchModel {
+  string type;
+  int size;
+  Geometry geom;
+
+  string name() const { return type + "/" + size_names[size]; }
+  string file_name() const { return "bench_" + type + "_" + size_names[size] +
+                                    ".off"; }
+};
+
+// File for the read and write benchmarks
+const char *tmp_file_name = "bench_tmp.off";
+
+// A benchmark, only the run function is timed
+struct Bench {
+  string name;
+  std::function<void()> setup;
+  std::function<void()> run;
+};
+
+// Give each face its own vertices, for merging
+Geometry explode_faces(const Geometry &geom)
+{
+  Geometry exploded;
+  for (const auto &face : geom.faces()) {
+    vector<int> new_face;
+    for (int v_idx : face)
+      new_face.push_back(exploded.add_vert(geom.verts(v_idx)));
+    exploded.add_face(new_face);
+  }
+  return exploded;
+}
+
+// Face-centred cubic lattice points within a cube
+Geometry make_fcc_lattice(int half_width)
+{
+  Geometry lat;
+  for (int x = -half_width; x <= half_width; x++)
+    for (int y = -half_width; y <= half_width; y++)
+      for (int z = -half_width; z <= half_width; z++)
+        if ((x + y + z) % 2 == 0)
+          lat.add_vert(Vec3d(x, y, z));
+  return lat;
+}
+
+// Stellation using every facelet of the stellation diagram of face 0
+Geometry make_dense_stellation(const Geometry &geom)
+{
+  StellationSession session(geom, Symmetry(geom).get_symbol());
+  vector<int> idx_list(1, 0);
+  int num_facelets = session.get_diagram(0).faces().size();
+  for (int i = 0; i < num_facelets; i++)
+    idx_list.push_back(i);
+  return session.make_stellation(vector<vector<int>>(1, idx_list));
+}
+
+void make_models(vector<BenchModel> &models, int max_size)
+{
+  const char *geo_names[] = {"geo_8", "geo_24", "geo_64"};
+  const char *compound_names[] = {"uc1", "uc40", "uc20"};
+  const char *conway_bases[] = {"geo_3", "geo_8", "geo_24"};
+  const char *stellation_bases[] = {"icosahedron", "u26", "u28"};
+  int lattice_widths[] = {4, 8, 14};
+
+  for (int sz = 0; sz < max_size; sz++) {
+    BenchModel model;
+    model.size = sz;
+
+    model.type = "geodesic";
+    model.geom.read_resource(geo_names[sz]);
+    models.push_back(model);
+
+    model.type = "lattice";
+    model.geom = make_fcc_lattice(lattice_widths[sz]);
+    models.push_back(model);
+
+    model.type = "compound";
+    model.geom.read_resource(compound_names[sz]);
+    models.push_back(model);
+
+    Geometry base;
+    base.read_resource(conway_bases[sz]);
+    model.type = "conway";
+    wythoff_make_tiling(model.geom, base, "e");
+    models.push_back(model);
+
+    base.read_resource(stellation_bases[sz]);
+    model.type = "stellation";
+    model.geom = make_dense_stellation(base);
+    models.push_back(model);
+  }
+}
+
+void add_library_benches(vector<Bench> &benches,
+                         const vector<BenchModel> &models)
+{
+  auto work = std::make_shared<Geometry>();
+  auto work2 = std::make_shared<Geometry>();
+
+  for (const auto &model : models) {
+    const Geometry *geom = &model.geom;
+    const string &type = model.type;
+    const string name = model.name();
+    auto set_work = [work, geom]() { *work = *geom; };
+
+    benches.push_back({"write/" + name, nullptr,
+                       [geom]() { geom->write(tmp_file_name); }});
+
+    benches.push_back({"read/" + name,
+                       [geom]() { geom->write(tmp_file_name); },
+                       [work]() { work->read(tmp_file_name); }});
+
+    auto flat = std::make_shared<Geometry>(*geom);
+    flat->set_face_storage(Geometry::FACES_FLAT);
+    benches.push_back({"write_flat/" + name, nullptr,
+                       [flat]() { flat->write(tmp_file_name); }});
+
+    benches.push_back({"read_flat/" + name,
+                       [geom, work]() {
+                         geom->write(tmp_file_name);
+                         *work = Geometry(Geometry::FACES_FLAT);
+                       },
+                       [work]() { work->read(tmp_file_name); }});
+
+    if (type != "lattice") {
+      auto exploded = std::make_shared<Geometry>(explode_faces(*geom));
+      benches.push_back({"merge/" + name,
+                         [work, exploded]() { *work = *exploded; },
+                         [work]() { merge_coincident_elements(*work, "vef"); }});
+    }
+
+    if (type == "lattice" || type == "geodesic")
+      benches.push_back({"hull/" + name, set_work,
+                         [work]() { work->set_hull(); }});
+
+    if (type == "compound" || type == "stellation")
+      benches.push_back({"symmetry/" + name, nullptr,
+                         [geom]() { Symmetry sym(*geom); }});
+
+    if (type == "compound" || type == "conway" || type == "stellation")
+      benches.push_back({"triangulate/" + name, set_work,
+                         [work]() { work->triangulate(Color::invisible); }});
+
+    if (type == "geodesic" || type == "conway" || type == "compound")
+      benches.push_back({"dual/" + name, nullptr, [geom, work]() {
+                           get_dual(*work, *geom, 1);
+                         }});
+
+    if (type == "conway")
+      benches.push_back({"canonicalize/" + name, set_work,
+                         [work]() { canonicalize_mm(*work, 50); }});
+
+    if (type == "geodesic")
+      benches.push_back({"make_tiling/" + name, nullptr, [geom, work2]() {
+                           wythoff_make_tiling(*work2, *geom, "t");
+                         }});
+  }
+}
+
+// Check that a model read and written with flat face storage has the same
+// faces and face colours as with nested face storage
+Status check_flat_faces(const BenchModel &model)
+{
+  Status stat;
+  Geometry nested;
+  Geometry flat(Geometry::FACES_FLAT);
+  Geometry flat_written;
+  if (!(stat = model.geom.write(tmp_file_name)) ||
+      !(stat = nested.read(tmp_file_name)) ||
+      !(stat = flat.read(tmp_file_name)) ||
+      !(stat = flat.write(tmp_file_name)) ||
+      !(stat = flat_written.read(tmp_file_name)))
+    return stat;
+
+  if (flat.get_face_storage() != Geometry::FACES_FLAT)
+    return Status::error("faces were not read into flat storage");
+
+  const Geometry *geoms[] = {&flat, &flat_written};
+  for (const Geometry *geom : geoms) {
+    if (geom->num_faces() != nested.num_faces())
+      return Status::error("the number of faces differs");
+    for (unsigned int i = 0; i < nested.num_faces(); i++) {
+      FaceView face = geom->face_view(i);
+      if (face.to_vector() != nested.faces(i) ||
+          geom->colors(FACES).get(i) != nested.colors(FACES).get(i))
+        return Status::error(msg_str("face %u differs", i));
+    }
+  }
+
+  return Status::ok();
+}
+
+// Programs, with arguments, the type of model to read, and exit status
+struct ToolBench {
+  const char *name;
+  const char *command;
+  const char *model_type;
+  int exit_status;
+};
+
+void add_tool_benches(vector<Bench> &benches, const vector<BenchModel> &models,
+                      const string &tool_dir)
+{
+  ToolBench tools[] = {
+      {"off_util_read_write", "off_util", "geodesic", 0},
+      {"off_util_merge", "off_util -M a", "conway", 0},
+      {"conv_hull", "conv_hull", "lattice", 3}, // returns the dimension
+      {"off_trans_rotate", "off_trans -R 0,0,45 -C", "geodesic", 0},
+      {"off_trans_sym_align", "off_trans -y full", "compound", 0},
+      {"off_util_triangulate", "off_util -t odd", "stellation", 0},
+      {"pol_recip", "pol_recip", "conway", 0},
+      {"canonical", "canonical -n 50", "conway", 0},
+      {"wythoff", "wythoff -c t", "geodesic", 0},
+      {"planar_merge", "planar -d 2", "compound", 0},
+  };
+
+  for (const auto &model : models) {
+    for (const auto &tool : tools) {
+      if (model.type != tool.model_type)
+        continue;
+      string cmd = tool_dir + "/" + tool.command + " " + model.file_name() +
+                   " > /dev/null 2>&1";
+      string name = "program/" + string(tool.name) + "/" + model.name();
+      int status = tool.exit_status;
+      benches.push_back({name, nullptr, [cmd, name, status]() {
+                           int ret = system(cmd.c_str());
+                           if (ret == -1 || WEXITSTATUS(ret) != status)
+                             fprintf(stderr, "warning: %s: command failed: "
+                                             "%s\n",
+                                     name.c_str(), cmd.c_str());
+                         }});
+    }
+  }
+}
+
+// Benchmark timings
+struct BenchResult {
+  string name;
+  double median;
+  double min;
+};
+
+BenchResult run_bench(const Bench &bench, int repeats)
+{
+  vector<double> times;
+  for (int i = 0; i < repeats; i++) {
+    if (bench.setup)
+      bench.setup();
+    Timer timer;
+    bench.run();
+    times.push_back(timer.elapsed());
+  }
+  sort(times.begin(), times.end());
+  int mid = times.size() / 2;
+  double median = (times.size() % 2) ? times[mid]
+                                     : (times[mid - 1] + times[mid]) / 2;
+  return {bench.name, median, times[0]};
+}
+
+Status write_results(const string &file_name,
+                     const vector<BenchResult> &results, int repeats)
+{
+  FILE *ofile = fopen(file_name.c_str(), "w");
+  if (!ofile)
+    return Status::error(
+        msg_str("could not open output file '%s'", file_name.c_str()));
+
+  fprintf(ofile, "{\n\"repeats\": %d,\n\"benchmarks\": [\n", repeats);
+  for (unsigned int i = 0; i < results.size(); i++)
+    fprintf(ofile, "{\"name\": \"%s\", \"median\": %.6e, \"min\": %.6e}%s\n",
+            results[i].name.c_str(), results[i].median, results[i].min,
+            (i < results.size() - 1) ? "," : "");
+  fprintf(ofile, "]\n}\n");
+  fclose(ofile);
+  return Status::ok();
+}
+
+// Read the median times from a results file written by write_results
+Status read_results(const string &file_name, map<string, double> &medians)
+{
+  FILE *ifile = fopen(file_name.c_str(), "r");
+  if (!ifile)
+    return Status::error(
+        msg_str("could not open results file '%s'", file_name.c_str()));
+
+  char line[MSG_SZ];
+  char name[MSG_SZ];
+  double median;
+  while (fgets(line, MSG_SZ, ifile))
+    if (sscanf(line, " {\"name\": \"%[^\"]\", \"median\": %lf", name,
+               &median) == 2)
+      medians[name] = median;
+  fclose(ifile);
+
+  if (medians.empty())
+    return Status::error(
+        msg_str("no benchmark results in '%s'", file_name.c_str()));
+  return Status::ok();
+}
+
+// Print a comparison, and return the number of regressions
+int compare_results(const vector<BenchResult> &results,
+                    const map<string, double> &base_medians, double tolerance)
+{
+  // changes of less than this many seconds are not considered
+  const double min_change = 1e-4;
+
+  int regressions = 0;
+  fprintf(stdout, "\n%-50s %12s %12s %9s\n", "benchmark", "base (ms)",
+          "now (ms)", "change");
+  for (const auto &res : results) {
+    auto mi = base_medians.find(res.name);
+    if (mi == base_medians.end()) {
+      fprintf(stdout, "%-50s %12s %12.3f\n", res.name.c_str(), "-",
+              res.median * 1000);
+      continue;
+    }
+    double base = mi->second;
+    double change = (base > 0) ? 100 * (res.median - base) / base : 0.0;
+    bool regressed = change > tolerance && res.median - base > min_change;
+    if (regressed)
+      regressions++;
+    fprintf(stdout, "%-50s %12.3f %12.3f %+8.1f%%%s\n", res.name.c_str(),
+            base * 1000, res.median * 1000, change,
+            regressed ? "  REGRESSION" : "");
+  }
+  fprintf(stdout, "\n%d benchmark(s) slower than the tolerance of %g%%\n",
+          regressions, tolerance);
+  return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+  bench_opts opts;
+  opts.process_command_line(argc, argv);
+
+  map<string, double> base_medians;
+  if (opts.baseline_file != "")
+    opts.print_status_or_exit(read_results(opts.baseline_file, base_medians),
+                              'c');
+
+  vector<BenchModel> models;
+  make_models(models, opts.max_size);
+
+  if (!opts.list_only)
+    for (const auto &model : models) {
+      Status stat = check_flat_faces(model);
+      if (stat.is_error())
+        opts.error(msg_str("flat face storage check for %s: %s",
+                           model.name().c_str(), stat.c_msg()));
+    }
+
+  vector<Bench> benches;
+  add_library_benches(benches, models);
+  if (opts.tool_dir != "") {
+    for (const auto &model : models)
+      opts.write_or_error(model.geom, model.file_name());
+    add_tool_benches(benches, models, opts.tool_dir);
+  }
+
+  vector<BenchResult> results;
+  for (const auto &bench : benches) {
+    if (bench.name.find(opts.filter) == string::npos)
+      continue;
+    if (opts.list_only) {
+      fprintf(stdout, "%s\n", bench.name.c_str());
+      continue;
+    }
+    results.push_back(run_bench(bench, opts.repeats));
+    fprintf(stdout, "%-50s %12.3f ms\n", results.back().name.c_str(),
+            results.back().median * 1000);
+    fflush(stdout);
+  }
+
+  remove(tmp_file_name);
+  if (opts.tool_dir != "" && !opts.keep_files)
+    for (const auto &model : models)
+      remove(model.file_name().c_str());
+
+  if (opts.list_only)
+    return 0;
+
+  opts.print_status_or_exit(
+      write_results(opts.ofile, results, opts.repeats), 'o');
+
+  if (base_medians.size() &&
+      compare_results(results, base_medians, opts.tolerance) > 0)
+    return 1;
+
+  return 0;
+}
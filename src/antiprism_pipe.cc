@@ -0,0 +1,405 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: antiprism_pipe.cc
+   Description: run a chain of operations on a model held in memory
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+#include "batch.h"
+#include "canonical.h"
+#include "conv_hull.h"
+#include "conway.h"
+#include "geodesic.h"
+#include "off2pov.h"
+#include "off_color.h"
+#include "off_trans.h"
+#include "off_util.h"
+
+using std::mutex;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+using namespace anti;
+
+//------------------------------------------------------------------
+// Pipeline stages
+
+// A stage is an Antiprism program, which takes all of the program options
+// except those for input and output files, and processes a geometry in
+// place. Option errors are reported when the stage arguments are read,
+// processing errors are returned as a status.
+class pipe_stage {
+public:
+  virtual ~pipe_stage() = default;
+
+  // Name of the program
+  virtual const char *get_name() const = 0;
+
+  // Read the stage arguments, the first is the program name
+  virtual void process_command_line(int argc, char **argv) = 0;
+
+  // Process the geometry
+  virtual Status apply(Geometry &geom) = 0;
+
+  // A writer stage must be last, and writes the output in place of OFF
+  virtual bool is_writer() const { return false; }
+  virtual Status write(const Geometry & /*geom*/, const string & /*name*/,
+                       const string & /*ofile*/)
+  {
+    return Status::ok();
+  }
+
+  // Copy of the stage, with its options, for a job
+  virtual pipe_stage *clone() const = 0;
+};
+
+// A stage that uses the option class and processing of a program
+template <class OPTS> class tool_stage : public pipe_stage {
+protected:
+  OPTS opts;
+
+  // Files are read and written by the pipeline
+  void check_files() const
+  {
+    if (opts.ifile != "" || opts.ofile != "")
+      opts.error("input and output files cannot be given in a stage");
+  }
+
+public:
+  const char *get_name() const { return opts.prog_name(); }
+  void process_command_line(int argc, char **argv)
+  {
+    opts.process_command_line(argc, argv);
+    check_files();
+  }
+  Status apply(Geometry &geom) { return opts.process_geom(geom); }
+  pipe_stage *clone() const { return new tool_stage(*this); }
+};
+
+template <> void tool_stage<cn_opts>::check_files() const
+{
+  if (opts.ifile != "" || opts.ofile != "")
+    opts.error("input and output files cannot be given in a stage");
+  if (opts.batch_strings.size())
+    opts.error("batch mode cannot be used in a stage", 'B');
+}
+
+template <> void tool_stage<pr_opts>::check_files() const
+{
+  if (opts.ifiles.size() != 1 || opts.ifiles[0] != "" || opts.ofile != "")
+    opts.error("input and output files cannot be given in a stage");
+  if (opts.batch.enabled)
+    opts.error("batch mode cannot be used in a stage");
+}
+
+template <> Status tool_stage<pr_opts>::apply(Geometry &geom)
+{
+  vector<string> warnings;
+  Status stat = opts.process_geom(geom, warnings);
+  for (const auto &warning : warnings)
+    opts.warning(warning);
+  return stat;
+}
+
+template <> void tool_stage<o2p_opts>::check_files() const
+{
+  for (const auto &ifile : opts.ifiles)
+    if (ifile != "")
+      opts.error("input and output files cannot be given in a stage");
+  if (opts.ofile != "")
+    opts.error("input and output files cannot be given in a stage");
+}
+
+// The model is only written, by pov_writer_stage
+template <> Status tool_stage<o2p_opts>::apply(Geometry & /*geom*/)
+{
+  return Status::ok();
+}
+
+// Writes the model to a POV file, with the off2pov options
+class pov_writer_stage : public tool_stage<o2p_opts> {
+public:
+  bool is_writer() const { return true; }
+  Status write(const Geometry &geom, const string &name, const string &ofile)
+  {
+    return opts.write_geom(geom, name, ofile);
+  }
+  pipe_stage *clone() const { return new pov_writer_stage(*this); }
+};
+
+// Make a stage from its arguments, which are separated by whitespace
+unique_ptr<pipe_stage> make_stage(const string &stage_args,
+                                  const ProgramOpts &opts)
+{
+  vector<char *> parts;
+  // A working copy, which will be split
+  vector<char> arg_str(stage_args.begin(), stage_args.end());
+  arg_str.push_back('\0');
+  split_line(arg_str.data(), parts);
+  if (parts.empty())
+    opts.error("empty stage");
+
+  string name = parts[0];
+  unique_ptr<pipe_stage> stage;
+  if (name == "geodesic")
+    stage.reset(new tool_stage<geo_opts>);
+  else if (name == "canonical")
+    stage.reset(new tool_stage<canon_opts>);
+  else if (name == "conway")
+    stage.reset(new tool_stage<cn_opts>);
+  else if (name == "off_util")
+    stage.reset(new tool_stage<pr_opts>);
+  else if (name == "off_trans")
+    stage.reset(new tool_stage<trans_opts>);
+  else if (name == "off_color")
+    stage.reset(new tool_stage<o_col_opts>);
+  else if (name == "conv_hull")
+    stage.reset(new tool_stage<ch_opts>);
+  else if (name == "off2pov")
+    stage.reset(new pov_writer_stage);
+  else
+    opts.error(msg_str("unknown stage '%s'", name.c_str()));
+
+  stage->process_command_line(parts.size(), parts.data());
+  return stage;
+}
+
+//------------------------------------------------------------------
+// Program options
+
+class pipe_opts : public ProgramOpts {
+public:
+  vector<unique_ptr<pipe_stage>> stages;
+  vector<string> ifiles;
+  string ofile;
+  int sig_digits;
+  bool print_times;
+  int num_threads;
+
+  pipe_opts()
+      : ProgramOpts("antiprism_pipe"), sig_digits(DEF_SIG_DGTS),
+        print_times(false), num_threads(0)
+  {
+  }
+  void process_command_line(int argc, char **argv);
+  void usage();
+};
+
+// clang-format off
+void pipe_opts::usage()
+{
+   fprintf(stdout,
+"\n"
+"Usage: %s [options] stage [stage ...]\n"
+"\n"
+"Read a file in OFF format and process it with a chain of stages, each of\n"
+"which works like an Antiprism program in a pipeline, but the model is kept\n"
+"in memory between the stages. A stage is given as a single argument, the\n"
+"program name followed by its options, e.g. 'conway -p m dk'. The model is\n"
+"written in OFF format unless the final stage is a writer. If no input\n"
+"files are given the program reads from standard input.\n"
+"\n"
+"Stages are geodesic, canonical, conway, off_util, off_trans, off_color,\n"
+"conv_hull, and the writer off2pov. A stage takes all of the options of its\n"
+"program, except for input files, output files and batch mode.\n"
+"\n"
+"Options\n"
+"%s"
+"  -i <file> input file, may be given more than once. Each input file is\n"
+"            processed separately (default: standard input)\n"
+"  -I <file> file containing a list of input files, one per line\n"
+"  -j <num>  number of input files to process at the same time (default:\n"
+"            number of hardware threads, or $ANTIPRISM_THREADS if set)\n"
+"  -T        print the time taken by each stage (to standard error)\n"
+"  -d <dgts> number of significant digits (default %d) or if negative\n"
+"            then the number of digits after the decimal point\n"
+"  -o <file> write output to file (default: write to standard output).\n"
+"            With several input files this must contain %%s, which is\n"
+"            replaced by the input file name without its extension\n"
+"\n"
+"\n", prog_name(), help_ver_text, DEF_SIG_DGTS);
+}
+// clang-format on
+
+void pipe_opts::process_command_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hi:I:j:Td:o:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'i':
+      ifiles.push_back(optarg);
+      break;
+
+    case 'I':
+      print_status_or_exit(read_file_list(optarg, ifiles), c);
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
+    case 'T':
+      print_times = true;
+      break;
+
+    case 'd':
+      print_status_or_exit(read_int(optarg, &sig_digits), c);
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  // Errors in the stage options are reported now, rather than in the jobs
+  while (argc - optind)
+    stages.push_back(make_stage(argv[optind++], *this));
+
+  if (!stages.size())
+    error("no stages given");
+
+  if (!ifiles.size())
+    ifiles.push_back("");
+
+  if (ifiles.size() > 1 && ofile.find("%s") == string::npos)
+    error("with several input files the output file name must contain %s",
+          'o');
+
+  for (unsigned int i = 0; i < stages.size() - 1; i++)
+    if (stages[i]->is_writer())
+      error(msg_str("writer stage '%s' must be the final stage",
+                    stages[i]->get_name()));
+}
+
+// Messages from jobs running at the same time are not interleaved
+static mutex msg_mutex;
+
+void print_job_status(const pipe_opts &opts, const string &ifile,
+                      const string &stage_name, const Status &stat)
+{
+  if (stat.is_ok() && stat.msg() == "")
+    return;
+  std::lock_guard<mutex> lock(msg_mutex);
+  string where = (ifile != "") ? ifile : "stdin";
+  if (stage_name != "")
+    where += ": " + stage_name;
+  if (stat.is_error())
+    opts.message(stat.msg(), "error", where);
+  else if (stat.is_warning())
+    opts.warning(stat.msg(), where);
+  else
+    opts.message(stat.msg(), nullptr, where);
+}
+
+// Process one input file through the stages. Each job has its own copy of
+// the stages, so it can run at the same time as other jobs.
+bool run_pipeline(const pipe_opts &opts, const string &ifile)
+{
+  vector<unique_ptr<pipe_stage>> stages;
+  for (const auto &stage : opts.stages)
+    stages.push_back(unique_ptr<pipe_stage>(stage->clone()));
+
+  vector<double> times(stages.size() + 2);
+  Timer timer;
+
+  timer.set_timer(0.0);
+  Geometry geom;
+  Status stat = geom.read(ifile);
+  times[0] = timer.elapsed();
+  print_job_status(opts, ifile, "", stat);
+  if (stat.is_error())
+    return false;
+
+  for (unsigned int i = 0; i < stages.size(); i++) {
+    timer.set_timer(0.0);
+    stat = stages[i]->apply(geom);
+    times[i + 1] = timer.elapsed();
+    print_job_status(opts, ifile, stages[i]->get_name(), stat);
+    if (stat.is_error())
+      return false;
+  }
+
+  timer.set_timer(0.0);
+  string ofile = batch_output_name(opts.ofile, ifile);
+  if (stages.back()->is_writer())
+    stat = stages.back()->write(geom, ifile, ofile);
+  else
+    stat = geom.write(ofile, opts.sig_digits);
+  times.back() = timer.elapsed();
+  print_job_status(opts, ifile, "", stat);
+
+  if (opts.print_times) {
+    std::lock_guard<mutex> lock(msg_mutex);
+    fprintf(stderr, "%s:\n", (ifile != "") ? ifile.c_str() : "stdin");
+    fprintf(stderr, "  %-12s %10.6fs\n", "read", times[0]);
+    for (unsigned int i = 0; i < stages.size(); i++)
+      fprintf(stderr, "  %-12s %10.6fs\n", stages[i]->get_name(),
+              times[i + 1]);
+    fprintf(stderr, "  %-12s %10.6fs\n", "write", times.back());
+  }
+
+  return !stat.is_error();
+}
+
+int main(int argc, char *argv[])
+{
+  pipe_opts opts;
+  opts.process_command_line(argc, argv);
+
+  vector<char> job_ok(opts.ifiles.size());
+  parallel_for(opts.ifiles.size(),
+               [&](size_t i) { job_ok[i] = run_pipeline(opts, opts.ifiles[i]); },
+               opts.num_threads, 1);
+
+  for (char ok : job_ok)
+    if (!ok)
+      return 1;
+
+  return 0;
+}
@@ -0,0 +1,389 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: batch.cc
+   Description: process several input files, with a record for each file
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include "batch.h"
+
+#include <ctype.h>
+#include <map>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_GLOB_H
+#include <glob.h>
+#endif
+
+using std::map;
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+// clang-format off
+const char *batch_help_text =
+"  -b <fmt>  batch mode, process each input file separately and write a\n"
+"            record for each file, in input order, in format json (JSON\n"
+"            Lines, default) or csv\n"
+"  -L <file> batch mode, file containing a list of input files, one per\n"
+"            line (- to read the list from standard input)\n"
+"  -G <pat>  batch mode, input files matching a pattern (quote it to stop\n"
+"            the shell expanding it) which may include *, ? and [...]\n";
+// clang-format on
+
+Status BatchOpts::read_format(const char *fmt)
+{
+  if (strcmp(fmt, "json") == 0)
+    format = 'j';
+  else if (strcmp(fmt, "csv") == 0)
+    format = 'c';
+  else
+    return Status::error(
+        msg_str("invalid record format '%s', must be json or csv", fmt));
+
+  enabled = true;
+  return Status::ok();
+}
+
+Status BatchOpts::add_list(const char *fname)
+{
+  enabled = true;
+  return read_file_list(fname, ifiles);
+}
+
+Status BatchOpts::add_glob(const char *pattern)
+{
+  enabled = true;
+#ifdef HAVE_GLOB_H
+  glob_t glob_res;
+  int ret = glob(pattern, 0, nullptr, &glob_res);
+  if (ret == GLOB_NOMATCH)
+    return Status::warning(msg_str("no files match '%s'", pattern));
+  else if (ret != 0)
+    return Status::error(msg_str("could not match files to '%s'", pattern));
+
+  for (size_t i = 0; i < glob_res.gl_pathc; i++)
+    ifiles.push_back(glob_res.gl_pathv[i]);
+  globfree(&glob_res);
+  return Status::ok();
+#else
+  return Status::error(
+      msg_str("cannot match files to '%s', file name patterns are not "
+              "supported on this system",
+              pattern));
+#endif
+}
+
+string opt_msg(char opt, const string &msg)
+{
+  return msg_str("option -%c: ", opt) + msg;
+}
+
+Status read_file_list(const char *fname, vector<string> &fnames)
+{
+  bool from_stdin = (strcmp(fname, "-") == 0);
+  FILE *lfile = (from_stdin) ? stdin : fopen(fname, "r");
+  if (!lfile)
+    return Status::error(msg_str("could not open input file list '%s'", fname));
+
+  char *line = nullptr;
+  while (read_line(lfile, &line) == 0) {
+    clear_extra_whitespace(line);
+    if (*line)
+      fnames.push_back(line);
+    free(line);
+    line = nullptr;
+  }
+
+  if (!from_stdin)
+    fclose(lfile);
+  return Status::ok();
+}
+
+string batch_output_name(const string &ofile, const string &ifile)
+{
+  size_t pos = ofile.find("%s");
+  if (pos == string::npos)
+    return ofile;
+
+  string base = (ifile != "") ? basename2(ifile.c_str()) : "stdin";
+  size_t dot = base.rfind('.');
+  if (dot != string::npos && dot > 0)
+    base = base.substr(0, dot);
+
+  return ofile.substr(0, pos) + base + ofile.substr(pos + 2);
+}
+
+namespace {
+
+// Quoted JSON string
+string json_str(const string &str)
+{
+  string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      quoted += string("\\") + c;
+    else if (c == '\n')
+      quoted += "\\n";
+    else if (c == '\t')
+      quoted += "\\t";
+    else if ((unsigned char)c < 0x20)
+      quoted += msg_str("\\u%04x", c);
+    else
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+// Whether a string can be written as a JSON number
+bool is_json_number(const string &str)
+{
+  const char *p = str.c_str();
+  if (*p == '-')
+    p++;
+  if (*p == '0')
+    p++;
+  else if (isdigit(*p))
+    p += strspn(p, "0123456789");
+  else
+    return false;
+  if (*p == '.') {
+    p++;
+    if (!isdigit(*p))
+      return false;
+    p += strspn(p, "0123456789");
+  }
+  if (*p == 'e' || *p == 'E') {
+    p++;
+    if (*p == '+' || *p == '-')
+      p++;
+    if (!isdigit(*p))
+      return false;
+    p += strspn(p, "0123456789");
+  }
+  return *p == '\0';
+}
+
+// JSON value, a number if possible, otherwise a string
+string json_val(const string &str)
+{
+  return is_json_number(str) ? str : json_str(str);
+}
+
+// CSV field, quoted if necessary
+string csv_field(const string &str)
+{
+  if (str.find_first_of(",\"\n\r") == string::npos &&
+      (str.empty() || (str.front() != ' ' && str.back() != ' ')))
+    return str;
+
+  string quoted = "\"";
+  for (char c : str) {
+    if (c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+// Write records in order, as JSON Lines or CSV
+class RecordWriter {
+private:
+  FILE *ofile;
+  char format;
+  bool have_cols;
+  vector<string> cols;
+  map<string, int> col_idxs;
+  vector<string> held_rows; // failed files before the columns are known
+  int num_dropped;
+
+  void write_json(const string &ifile, const BatchRecord &rec);
+  void write_csv(const string &ifile, const BatchRecord &rec);
+  void write_csv_header();
+
+public:
+  RecordWriter(FILE *file, char fmt, const vector<string> &csv_cols)
+      : ofile(file), format(fmt), have_cols(false), cols(csv_cols),
+        num_dropped(0)
+  {
+    for (unsigned int i = 0; i < cols.size(); i++)
+      col_idxs[cols[i]] = i;
+  }
+
+  void write(const string &ifile, const BatchRecord &rec)
+  {
+    if (format == 'c')
+      write_csv(ifile, rec);
+    else
+      write_json(ifile, rec);
+  }
+
+  // Write anything held back, and return the number of records that
+  // had values without a CSV column
+  int finish();
+};
+
+void RecordWriter::write_json(const string &ifile, const BatchRecord &rec)
+{
+  string line = "{\"file\":" + json_str(ifile) + ",\"status\":" +
+                json_str(rec.stat.is_error() ? "error" : "ok");
+  if (rec.stat.is_error())
+    line += ",\"message\":" + json_str(rec.stat.msg());
+  if (rec.warnings.size()) {
+    line += ",\"warnings\":[";
+    for (unsigned int i = 0; i < rec.warnings.size(); i++)
+      line += (i ? "," : "") + json_str(rec.warnings[i]);
+    line += "]";
+  }
+  if (!rec.stat.is_error()) {
+    line += ",\"values\":{";
+    for (unsigned int i = 0; i < rec.values.size(); i++)
+      line += (i ? "," : "") + json_str(rec.values[i].first) + ":" +
+              json_val(rec.values[i].second);
+    line += "}";
+  }
+  fprintf(ofile, "%s}\n", line.c_str());
+}
+
+void RecordWriter::write_csv_header()
+{
+  string line = "file,status,message";
+  for (const auto &col : cols)
+    line += "," + csv_field(col);
+  fprintf(ofile, "%s\n", line.c_str());
+  for (const auto &row : held_rows)
+    fprintf(ofile, "%s%s\n", row.c_str(), string(cols.size(), ',').c_str());
+  held_rows.clear();
+  have_cols = true;
+}
+
+void RecordWriter::write_csv(const string &ifile, const BatchRecord &rec)
+{
+  string msg;
+  if (rec.stat.is_error())
+    msg = rec.stat.msg();
+  else
+    for (unsigned int i = 0; i < rec.warnings.size(); i++)
+      msg += (i ? "; " : "") + rec.warnings[i];
+
+  string row = csv_field(ifile) + "," +
+               (rec.stat.is_error() ? "error" : "ok") + "," + csv_field(msg);
+  if (!have_cols && cols.empty()) {
+    if (rec.stat.is_error()) {
+      held_rows.push_back(row);
+      return;
+    }
+    for (const auto &kv : rec.values)
+      if (col_idxs.insert(std::make_pair(kv.first, (int)cols.size())).second)
+        cols.push_back(kv.first);
+    write_csv_header();
+  }
+  else if (!have_cols)
+    write_csv_header();
+
+  vector<string> fields(cols.size());
+  bool dropped = false;
+  if (!rec.stat.is_error()) {
+    for (const auto &kv : rec.values) {
+      auto mi = col_idxs.find(kv.first);
+      if (mi != col_idxs.end())
+        fields[mi->second] = kv.second;
+      else
+        dropped = true;
+    }
+  }
+  num_dropped += dropped;
+
+  for (const auto &field : fields)
+    row += "," + csv_field(field);
+  fprintf(ofile, "%s\n", row.c_str());
+}
+
+int RecordWriter::finish()
+{
+  if (format == 'c' && !have_cols)
+    write_csv_header();
+  fflush(ofile);
+  return num_dropped;
+}
+
+} // namespace
+
+int run_batch(
+    const ProgramOpts &opts, const BatchOpts &bopts, FILE *ofile,
+    const std::function<void(const string &, BatchRecord &)> &process)
+{
+  const vector<string> &ifiles = bopts.ifiles;
+  RecordWriter writer(ofile, bopts.format, bopts.csv_cols);
+  map<size_t, BatchRecord> finished; // waiting for earlier files
+  size_t next = 0;
+  int num_failed = 0;
+  std::mutex mtx;
+
+  parallel_for(ifiles.size(),
+               [&](size_t i) {
+                 BatchRecord rec;
+                 try {
+                   process(ifiles[i], rec);
+                 } catch (const std::exception &e) {
+                   rec.stat.set_error(
+                       msg_str("could not process file: %s", e.what()));
+                 }
+
+                 std::lock_guard<std::mutex> lock(mtx);
+                 finished[i] = std::move(rec);
+                 bool written = false;
+                 auto mi = finished.begin();
+                 while (mi != finished.end() && mi->first == next) {
+                   writer.write(ifiles[next], mi->second);
+                   num_failed += mi->second.stat.is_error();
+                   mi = finished.erase(mi);
+                   next++;
+                   written = true;
+                 }
+                 if (written)
+                   fflush(ofile);
+               },
+               bopts.num_threads, 1);
+
+  int num_dropped = writer.finish();
+  if (num_dropped)
+    opts.warning(msg_str("%d records had values with no CSV column, these "
+                         "values were not written (use JSON format to "
+                         "write all values)",
+                         num_dropped));
+
+  return num_failed;
+}
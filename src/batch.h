@@ -0,0 +1,141 @@
+/*
+   Copyright (c) 2019, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: batch.h
+   Description: process several input files, with a record for each file
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+/// Help text for the batch mode options -b, -L and -G
+extern const char *batch_help_text;
+
+/// The results of processing one input file
+class BatchRecord {
+public:
+  /// Error if the file could not be processed
+  anti::Status stat;
+  /// Warnings from processing the file
+  std::vector<std::string> warnings;
+  /// Named values, in the order they are written
+  std::vector<std::pair<std::string, std::string>> values;
+
+  /// Add a value
+  /**\param key the name of the value.
+   * \param val the value. */
+  void add(const std::string &key, const std::string &val)
+  {
+    values.push_back(std::make_pair(key, val));
+  }
+};
+
+/// Input files and record format for batch mode
+class BatchOpts {
+public:
+  /// Process each input file separately and write a record for each
+  bool enabled;
+  /// Record format, \c j - JSON Lines, \c c - CSV
+  char format;
+  /// Number of files to process at the same time, or \c 0 for the default
+  int num_threads;
+  /// Input files
+  std::vector<std::string> ifiles;
+  /// CSV columns, or if empty they are taken from the first successful
+  /// record
+  std::vector<std::string> csv_cols;
+
+  /// Constructor
+  BatchOpts() : enabled(false), format('j'), num_threads(0) {}
+
+  /// Read the record format and enable batch mode
+  /**\param fmt the format, \c json or \c csv.
+   * \return status, evaluates to \c true if the format is valid,
+   *  otherwise \c false. */
+  anti::Status read_format(const char *fmt);
+
+  /// Add input files from a list and enable batch mode
+  /**\param fname the name of a file containing input file names, one
+   *  per line, or \c - to read the names from standard input.
+   * \return status, evaluates to \c true if the list was read,
+   *  otherwise \c false. */
+  anti::Status add_list(const char *fname);
+
+  /// Add input files matching a pattern and enable batch mode
+  /**\param pattern a file name pattern, which may include the wildcards
+   *  \c *, \c ? and \c [...].
+   * \return status, evaluates to \c true if the pattern was valid,
+   *  otherwise \c false. A warning is set if no files matched. */
+  anti::Status add_glob(const char *pattern);
+};
+
+/// Prefix a message with an option letter, in the form used by ProgramOpts
+/**\param opt the option letter.
+ * \param msg the message.
+ * \return The message with the prefix. */
+std::string opt_msg(char opt, const std::string &msg);
+
+/// Read a list of file names, one per line
+/**\param fname the name of the list file, or \c - for standard input.
+ * \param fnames to add the names to. Blank lines are skipped.
+ * \return status, evaluates to \c true if the list was read,
+ *  otherwise \c false. */
+anti::Status read_file_list(const char *fname,
+                            std::vector<std::string> &fnames);
+
+/// Get the output file name for an input file
+/**\param ofile the output file name, an occurrence of \c %s is replaced
+ *  by the input file name without its directory or extension.
+ * \param ifile the input file name, or empty for standard input.
+ * \return The output file name. */
+std::string batch_output_name(const std::string &ofile,
+                              const std::string &ifile);
+
+/// Process input files at the same time, writing a record for each file
+/** Records are written as each file finishes, but in the order of the
+ *  input files. In CSV format the columns are \c bopts.csv_cols, or if
+ *  these are not set then they are taken from the first successful
+ *  record. Values without a column are not written.
+ * \param opts the program options, for messages.
+ * \param bopts the input files, record format and number of threads.
+ * \param ofile the file to write the records to.
+ * \param process processes one input file and sets its record. It
+ *  may be called from several threads at once, and should set an error
+ *  in the record rather than exit.
+ * \return The number of input files that could not be processed. */
+int run_batch(
+    const anti::ProgramOpts &opts, const BatchOpts &bopts, FILE *ofile,
+    const std::function<void(const std::string &, BatchRecord &)> &process);
+
+#endif // BATCH_H
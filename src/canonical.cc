@@ -42,63 +42,15 @@
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "canonical.h"
 
 using std::string;
 using std::vector;
 
 using namespace anti;
 
-class cn_opts : public ProgramOpts {
-public:
-  string ifile;
-  string ofile;
-
-  char centering;
-  char initial_radius;
-  char edge_distribution;
-  char planarize_method;
-  int num_iters_planar;
-  char canonical_method;
-  int num_iters_canonical;
-  double mm_edge_factor;
-  double mm_plane_factor;
-  bool alternate_algorithm;
-  int rep_count;
-  double radius_range_percent;
-  string output_parts;
-  int face_opacity;
-  double offset;
-  int roundness;
-  char normal_type;
-
-  double epsilon;
-
-  Color ipoints_col;
-  Color base_nearpts_col;
-  Color dual_nearpts_col;
-  Color base_edge_col;
-  Color dual_edge_col;
-  Color sphere_col;
-
-  cn_opts()
-      : ProgramOpts("canonical"), centering('e'), initial_radius('e'),
-        edge_distribution('\0'), planarize_method('\0'), num_iters_planar(-1),
-        canonical_method('m'), num_iters_canonical(-1), mm_edge_factor(50),
-        mm_plane_factor(20), alternate_algorithm(false), rep_count(1000),
-        radius_range_percent(80), output_parts("b"), face_opacity(-1),
-        offset(0), roundness(8), normal_type('n'), epsilon(0),
-        ipoints_col(Color(255, 255, 0)), base_nearpts_col(Color(255, 0, 0)),
-        dual_nearpts_col(Color(0.0, 0.39216, 0.0)), base_edge_col(Color()),
-        dual_edge_col(Color()), sphere_col(Color(255, 255, 255))
-  {
-  }
-
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
-void cn_opts::usage()
+void canon_opts::usage()
 {
    fprintf(stdout,
 "\n"
@@ -169,7 +121,7 @@ void cn_opts::usage()
 }
 // clang-format on 
 
-void cn_opts::process_command_line(int argc, char **argv)
+void canon_opts::process_command_line(int argc, char **argv)
 {
   opterr = 0;
   int c;
@@ -355,7 +307,7 @@ void cn_opts::process_command_line(int argc, char **argv)
 }
 
 // RK - average radius rather than maximum has more reliability than max
-void unitize_vertex_radius(Geometry &geom)
+static void unitize_vertex_radius(Geometry &geom)
 {
   GeometryInfo info(geom);
   info.set_center(geom.centroid());
@@ -412,15 +364,15 @@ bool canonicalize_unit(Geometry &geom, const int num_iters, const double radius_
 {
   bool completed = false;
 
-  vector<vector<int>> edges;
-  geom.get_impl_edges(edges);
+  GeometryMetrics metrics(geom);
+  const vector<vector<int>> &edges = metrics.get_impl_edges();
 
   vector<Vec3d> &verts = geom.raw_verts();
 
   double max_diff2 = 0;
   unsigned int cnt;
   for (cnt = 0; cnt < (unsigned int)num_iters;) {
-    vector<Vec3d> verts_last = verts;
+    metrics.save_verts();
 
     if (!planar_only) {
       for (auto &edge : edges) {
@@ -431,7 +383,7 @@ bool canonicalize_unit(Geometry &geom, const int num_iters, const double radius_
 
       // re-center for drift
       if (centering == 'e')
-        geom.transform(Trans3d::translate(-edge_nearpoints_centroid(geom, Vec3d(0, 0, 0))));
+        geom.transform(Trans3d::translate(-metrics.edge_nearpts_centroid(Vec3d(0, 0, 0))));
       else
       if (centering == 'v')
         geom.transform(Trans3d::translate(-centroid(geom.verts())));
@@ -470,13 +422,8 @@ bool canonicalize_unit(Geometry &geom, const int num_iters, const double radius_
                     face_normal;
     }
 
-    // len2() for difference value to minimize internal sqrt() calls
-    max_diff2 = 0;
-    for (unsigned int i = 0; i < verts.size(); i++) {
-      double diff2 = (verts[i] - verts_last[i]).len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+    metrics.update();
+    max_diff2 = metrics.get_max_diff2();
 
     // increment count here for reporting
     cnt++;
@@ -490,7 +437,7 @@ bool canonicalize_unit(Geometry &geom, const int num_iters, const double radius_
     }
 
     // if minimum and maximum radius are differing, the polyhedron is crumpling
-    if (radius_range_percent && canonical_radius_range_test(geom, radius_range_percent)) {
+    if (radius_range_percent && metrics.radius_range_test(radius_range_percent)) {
       fprintf(stderr, "\nbreaking out: radius range detected. try increasing -d\n");
       break;
     }
@@ -547,7 +494,7 @@ void midradius_info(Geometry &geom, const bool completed)
 
 void generate_points(const Geometry &base, const Geometry &dual, vector<Vec3d> &ips,
                     vector<Vec3d> &base_nearpts, vector<Vec3d> &dual_nearpts,
-                    const cn_opts &opts)
+                    const canon_opts &opts)
 {
   vector<vector<int>> base_edges;
   vector<vector<int>> dual_edges;
@@ -703,17 +650,20 @@ Geometry incircles(const Geometry &geom, const Color &incircle_color, bool fille
   return incircles;
 }
 
-void construct_model(Geometry &base, const cn_opts &opts) {
+void construct_model(Geometry &base, const canon_opts &opts) {
+  // the edges are found once and used for each radius measurement
+  GeometryMetrics metrics(base);
+  double min = 0;
+  double max = 0;
+  Vec3d center;
+
   // RK - set radius to 1 for get_dual call, if necessary
-  double radius = edge_nearpoints_radius(base);
+  double radius = metrics.edge_nearpts_radius(min, max, center);
   if (double_ne(radius, 1.0, opts.epsilon))
-    unitize_nearpoints_radius(base);
+    base.transform(Trans3d::scale(1 / radius));
 
   // get statistics before model is changed
-  double min = 0;
-  double max = 0;
-  Vec3d center;
-  edge_nearpoints_radius(base, min, max, center);
+  metrics.edge_nearpts_radius(min, max, center);
 
   Geometry dual;
   get_dual(dual, base, 1, Vec3d(0, 0, 0));
@@ -822,7 +772,7 @@ void construct_model(Geometry &base, const cn_opts &opts) {
     base.append(dual_incircles);
 }
 
-void check_model(const Geometry &geom, string s, const cn_opts &opts)
+void check_model(const Geometry &geom, string s, const canon_opts &opts)
 {
   double epsilon_local1 = 1e-4;         // coincident elements
   double epsilon_local2 = opts.epsilon; // face area (default is 1e-12)
@@ -847,7 +797,7 @@ void check_model(const Geometry &geom, string s, const cn_opts &opts)
   }
 }
 
-void check_coincidence(const Geometry &geom, const cn_opts &opts)
+void check_coincidence(const Geometry &geom, const canon_opts &opts)
 {
   string s = "base";
   check_model(geom, s, opts);
@@ -858,133 +808,127 @@ void check_coincidence(const Geometry &geom, const cn_opts &opts)
   check_model(dual, s, opts);
 }
 
-int main(int argc, char *argv[])
+Status canon_opts::process_geom(Geometry &geom)
 {
-  cn_opts opts;
-  opts.process_command_line(argc, argv);
-
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
-
-  if (opts.edge_distribution) {
+  if (edge_distribution) {
     fprintf(stderr, "edge distribution: project onto sphere\n");
-    if (opts.edge_distribution == 's')
+    if (edge_distribution == 's')
       project_onto_sphere(geom);
   }
 
   fprintf(stderr,"\n");
   fprintf(stderr,"starting radius: ");
-  if (opts.initial_radius == 'e') {
+  if (initial_radius == 'e') {
     fprintf(stderr, "average edge near points\n");
     unitize_nearpoints_radius(geom);
   }
   else
-  if (opts.centering == 'v') {
+  if (centering == 'v') {
     fprintf(stderr, "average vertex\n");
     unitize_vertex_radius(geom);
   }
   else
-  if (opts.centering == 'x')
+  if (centering == 'x')
     fprintf(stderr, "radius not changed\n");
 
   fprintf(stderr,"centering: ");
-  if (opts.centering == 'e') {
+  if (centering == 'e') {
     fprintf(stderr, "edge near points centroid to origin\n");
     geom.transform(Trans3d::translate(-edge_nearpoints_centroid(geom, Vec3d(0, 0, 0))));
   }
   else
-  if (opts.centering == 'v') {
+  if (centering == 'v') {
     fprintf(stderr, "vertex centroid to origin\n");
     geom.transform(Trans3d::translate(-centroid(geom.verts())));
   }
   else
-  if (opts.centering == 'x')
+  if (centering == 'x')
     fprintf(stderr, "model not moved\n");
 
   fprintf(stderr,"normals: ");
-  if (opts.normal_type == 'n')
+  if (normal_type == 'n')
     fprintf(stderr,"Newell's method\n");
   else
-  if (opts.normal_type == 't')
+  if (normal_type == 't')
     fprintf(stderr,"Triangles method\n");
   else
-  if (opts.normal_type == 'q')
+  if (normal_type == 'q')
     fprintf(stderr,"Quads method\n");
 
   bool completed = false;
-  if (opts.planarize_method) {
+  if (planarize_method) {
     string planarize_str;
-    if (opts.planarize_method == 'p')
+    if (planarize_method == 'p')
       planarize_str = "face centroids magnitude squared";
     else
-    if (opts.planarize_method == 'q')
+    if (planarize_method == 'q')
       planarize_str = "face centroids magnitude";
     else
-    if (opts.planarize_method == 'f')
+    if (planarize_method == 'f')
       planarize_str = "face centroids";
     else
-    if (opts.planarize_method == 'm')
+    if (planarize_method == 'm')
       planarize_str = "mathematica";
     else
-    if (opts.planarize_method == 'a')
+    if (planarize_method == 'a')
       planarize_str = "sand and fill";
     else
-    if (opts.planarize_method == 'u')
+    if (planarize_method == 'u')
       planarize_str = "minmax -a u";
     fprintf(stderr, "planarize: %s method\n",planarize_str.c_str());
 
-    if (opts.planarize_method == 'm') {
+    if (planarize_method == 'm') {
       bool planarize_only = true;
-      completed = canonicalize_mm(geom, opts.mm_edge_factor / 100, opts.mm_plane_factor / 100,
-                                 opts.num_iters_planar, opts.radius_range_percent / 100, opts.rep_count,
-                                 opts.alternate_algorithm, planarize_only, opts.normal_type, opts.epsilon);
+      completed = canonicalize_mm(geom, mm_edge_factor / 100, mm_plane_factor / 100,
+                                 num_iters_planar, radius_range_percent / 100, rep_count,
+                                 alternate_algorithm, planarize_only, normal_type, epsilon);
     }
     else
-    if (opts.planarize_method == 'a') {
+    if (planarize_method == 'a') {
       bool planarize_only = true;
-      completed = canonicalize_unit(geom, opts.num_iters_planar, opts.radius_range_percent / 100,
-                                    opts.rep_count, opts.centering, opts.normal_type, planarize_only, opts.epsilon);
+      completed = canonicalize_unit(geom, num_iters_planar, radius_range_percent / 100,
+                                    rep_count, centering, normal_type, planarize_only, epsilon);
     }
     // case u
     else
-    if (opts.planarize_method == 'u')
-      completed = minmax_unit_planar(geom, opts.num_iters_planar, opts.radius_range_percent / 100, opts.rep_count, opts.normal_type, opts.epsilon);
+    if (planarize_method == 'u')
+      completed = minmax_unit_planar(geom, num_iters_planar, radius_range_percent / 100, rep_count, normal_type, epsilon);
     // cases p, q, f
     else
-      completed = canonicalize_bd(geom, opts.num_iters_planar, opts.planarize_method,
-                                 opts.radius_range_percent / 100, opts.rep_count, opts.centering, opts.normal_type, opts.epsilon);
+      completed = canonicalize_bd(geom, num_iters_planar, planarize_method,
+                                 radius_range_percent / 100, rep_count, centering, normal_type, epsilon);
 
     // RK - report planarity
     planarity_info(geom);
   }
 
-  if (opts.canonical_method && opts.canonical_method != 'x') {
+  if (canonical_method && canonical_method != 'x') {
     string canonicalize_str;
-    if (opts.canonical_method == 'm')
+    if (canonical_method == 'm')
       canonicalize_str = "mathematica";
     else
-    if (opts.canonical_method == 'b')
+    if (canonical_method == 'b')
       canonicalize_str = "base/dual";
     else
-    if (opts.canonical_method == 'a')
+    if (canonical_method == 'a')
       canonicalize_str = "moving edge";
     fprintf(stderr, "canonicalize: %s method\n",canonicalize_str.c_str());
-    if (opts.canonical_method == 'm') {
+    if (canonical_method == 'm') {
       bool planarize_only = false;
-      completed = canonicalize_mm(geom, opts.mm_edge_factor / 100, opts.mm_plane_factor / 100,
-                                 opts.num_iters_canonical, opts.radius_range_percent / 100, opts.rep_count,
-                                 opts.alternate_algorithm, planarize_only, opts.normal_type, opts.epsilon);
+      completed = canonicalize_mm(geom, mm_edge_factor / 100, mm_plane_factor / 100,
+                                 num_iters_canonical, radius_range_percent / 100, rep_count,
+                                 alternate_algorithm, planarize_only, normal_type, epsilon);
     }
     else
-    if (opts.canonical_method == 'b') {
-      completed = canonicalize_bd(geom, opts.num_iters_canonical, opts.canonical_method,
-                                 opts.radius_range_percent / 100, opts.rep_count, opts.centering, opts.normal_type, opts.epsilon);
+    if (canonical_method == 'b') {
+      completed = canonicalize_bd(geom, num_iters_canonical, canonical_method,
+                                 radius_range_percent / 100, rep_count, centering, normal_type, epsilon);
     }
     else
-    if (opts.canonical_method == 'a') {
+    if (canonical_method == 'a') {
       bool planarize_only = false;
-      completed = canonicalize_unit(geom, opts.num_iters_canonical, opts.radius_range_percent / 100,
-                                    opts.rep_count, opts.centering, opts.normal_type, planarize_only, opts.epsilon);
+      completed = canonicalize_unit(geom, num_iters_canonical, radius_range_percent / 100,
+                                    rep_count, centering, normal_type, planarize_only, epsilon);
     }
 
     // RK - report planarity
@@ -995,12 +939,10 @@ int main(int argc, char *argv[])
   }
 
   // RK - add coincidence checking the model
-  check_coincidence(geom, opts);
+  check_coincidence(geom, *this);
 
   // RK - parts to output
-  construct_model(geom, opts);
-
-  opts.write_or_error(geom, opts.ofile);
+  construct_model(geom, *this);
 
-  return 0;
+  return Status::ok();
 }
@@ -0,0 +1,93 @@
+/*
+   Copyright (c) 2003-2017, Adrian Rossiter, Roger Kaufman
+   Includes ideas and algorithms by George W. Hart, http://www.georgehart.com
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: canonical.h
+   Description: options for canonical, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <string>
+
+#include "../base/antiprism.h"
+
+class canon_opts : public anti::ProgramOpts {
+public:
+  std::string ifile;
+  std::string ofile;
+
+  char centering;
+  char initial_radius;
+  char edge_distribution;
+  char planarize_method;
+  int num_iters_planar;
+  char canonical_method;
+  int num_iters_canonical;
+  double mm_edge_factor;
+  double mm_plane_factor;
+  bool alternate_algorithm;
+  int rep_count;
+  double radius_range_percent;
+  std::string output_parts;
+  int face_opacity;
+  double offset;
+  int roundness;
+  char normal_type;
+
+  double epsilon;
+
+  anti::Color ipoints_col;
+  anti::Color base_nearpts_col;
+  anti::Color dual_nearpts_col;
+  anti::Color base_edge_col;
+  anti::Color dual_edge_col;
+  anti::Color sphere_col;
+
+  canon_opts()
+      : ProgramOpts("canonical"), centering('e'), initial_radius('e'),
+        edge_distribution('\0'), planarize_method('\0'), num_iters_planar(-1),
+        canonical_method('m'), num_iters_canonical(-1), mm_edge_factor(50),
+        mm_plane_factor(20), alternate_algorithm(false), rep_count(1000),
+        radius_range_percent(80), output_parts("b"), face_opacity(-1),
+        offset(0), roundness(8), normal_type('n'), epsilon(0),
+        ipoints_col(anti::Color(255, 255, 0)),
+        base_nearpts_col(anti::Color(255, 0, 0)),
+        dual_nearpts_col(anti::Color(0.0, 0.39216, 0.0)),
+        base_edge_col(anti::Color()), dual_edge_col(anti::Color()),
+        sphere_col(anti::Color(255, 255, 255))
+  {
+  }
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Canonicalize the model and build the selected output parts
+  anti::Status process_geom(anti::Geometry &geom);
+};
+
+#endif // CANONICAL_H
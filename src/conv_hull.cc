@@ -35,23 +35,12 @@
 #include <string>
 
 #include "../base/antiprism.h"
+#include "conv_hull.h"
 
 using std::string;
 
 using namespace anti;
 
-class ch_opts : public ProgramOpts {
-public:
-  bool append_flg;
-  string ifile;
-  string ofile;
-  string qh_args;
-
-  ch_opts() : ProgramOpts("conv_hull"), append_flg(false) {}
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void ch_opts::usage()
 {
@@ -59,7 +48,8 @@ void ch_opts::usage()
 "\n"
 "Usage: %s [options] [input_file]\n"
 "\n"
-"Read a file in OFF format and make a convex hull (using Qhull). If\n"
+"Read a file in OFF format and make a convex hull (using Qhull). If the\n"
+"faces already make a convex polyhedron they are kept as the hull. If\n"
 "input_file is not given the program reads from standard input.\n"
 "\n"
 "Options\n"
@@ -109,26 +99,19 @@ void ch_opts::process_command_line(int argc, char **argv)
     ifile = argv[optind];
 }
 
-int main(int argc, char *argv[])
+Status ch_opts::process_geom(Geometry &geom, int *dimension)
 {
-  ch_opts opts;
-  opts.process_command_line(argc, argv);
-
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
-
-  int dimension;
-  Status stat = (opts.append_flg) ? geom.add_hull(opts.qh_args, &dimension)
-                                  : geom.set_hull(opts.qh_args, &dimension);
-
+  int dim = 0;
+  Status stat = (append_flg) ? geom.add_hull(qh_args, &dim)
+                             : geom.set_hull_from_faces(qh_args, &dim);
+  if (dimension)
+    *dimension = dim;
   if (stat.is_error())
-    opts.error(stat.msg());
+    return stat;
 
   const char *dimension_desc[] = {"point", "line segment", "polygon"};
-  if (dimension < 3)
-    opts.warning(msg_str("result is a %s", dimension_desc[dimension]));
-
-  opts.write_or_error(geom, opts.ofile);
+  if (dim < 3)
+    return Status::warning(msg_str("result is a %s", dimension_desc[dim]));
 
-  return dimension;
+  return Status::ok();
 }
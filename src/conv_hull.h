@@ -0,0 +1,53 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: conv_hull.h
+   Description: options for conv_hull, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef CONV_HULL_H
+#define CONV_HULL_H
+
+#include <string>
+
+#include "../base/antiprism.h"
+
+class ch_opts : public anti::ProgramOpts {
+public:
+  bool append_flg;
+  std::string ifile;
+  std::string ofile;
+  std::string qh_args;
+
+  ch_opts() : ProgramOpts("conv_hull"), append_flg(false) {}
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Make the hull, or append it, in place of the model
+  anti::Status process_geom(anti::Geometry &geom, int *dimension = nullptr);
+};
+
+#endif // CONV_HULL_H
@@ -0,0 +1,50 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: conv_hull_main.cc
+   Description: convex hulls (wrapper for qhull)
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include "../base/antiprism.h"
+#include "conv_hull.h"
+
+using namespace anti;
+
+int main(int argc, char *argv[])
+{
+  ch_opts opts;
+  opts.process_command_line(argc, argv);
+
+  Geometry geom;
+  opts.read_or_error(geom, opts.ifile);
+
+  int dimension;
+  opts.print_status_or_exit(opts.process_geom(geom, &dimension));
+
+  opts.write_or_error(geom, opts.ofile);
+
+  return dimension;
+}
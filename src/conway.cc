@@ -38,12 +38,17 @@
 
 #include <ctype.h>
 
+#include <atomic>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "conway.h"
 
 using std::map;
 using std::pair;
@@ -474,62 +479,6 @@ string resolved_cn_string(const string &cn_string)
   return resolve_string;
 }
 
-class cn_opts : public ProgramOpts {
-public:
-  string ifile;
-  string ofile;
-
-  string cn_string;
-  bool resolve_ops;
-  bool hart_mode;
-  bool tile_mode;
-  bool reverse_ops;
-  char operand;
-  int poly_size;
-  char planarize_method;
-  bool planarize_method_set;
-  int num_iters_planar;
-  int rep_count;
-  bool unitize;
-  bool verbosity;
-  char face_coloring_method;
-  int face_opacity;
-  string face_pattern;
-  int seed_coloring_method;
-
-  double epsilon;
-
-  Color vert_col;
-  Color edge_col;
-
-  Tiling::ColoringType col_type;
-  bool color_by_value;
-
-  ColorMapMulti map;
-
-  vector<ops *> operations;
-
-  // for on the fly user operators
-  string alpha_user;
-  std::map<char, vector<ops *>> operations_user;
-
-  cn_opts()
-      : ProgramOpts("conway"), cn_string(""), resolve_ops(false),
-        hart_mode(false), tile_mode(false), reverse_ops(false), operand('\0'),
-        poly_size(0), planarize_method('p'), planarize_method_set(false),
-        num_iters_planar(1000), rep_count(-1), unitize(false), verbosity(false),
-        face_coloring_method('n'), face_opacity(-1), face_pattern("1"),
-        seed_coloring_method(1), epsilon(0),
-        vert_col(Color(255, 215, 0)),   // gold
-        edge_col(Color(211, 211, 211)), // lightgrey
-        col_type(Tiling::ColoringType::path_index), color_by_value(true)
-  {
-  }
-
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void extended_help()
 {
@@ -779,6 +728,7 @@ void cn_opts::usage()
    fprintf(stdout,
 "\n"
 "Usage: %s [options] [Conway Notation string] [input_file]\n"
+"       %s [options] -B <file> [input_file]\n"
 "\n"
 "Conway Notation uses algorithms by George W. Hart (http://www.georgehart.com)\n"
 "http://www.georgehart.com/virtual-polyhedra/conway_notation.html\n"
@@ -806,6 +756,16 @@ void cn_opts::usage()
 "  -v        verbose output\n"
 "  -o <file> write output to file (default: write to standard output)\n"
 "\n"
+"Batch options\n"
+"  -B <file> read Conway Notation strings from file, one per line, and write\n"
+"            a model for each. Strings with operations in common from the\n"
+"            same seed share the results of those operations. A summary is\n"
+"            printed to standard error. The output file name given with -o\n"
+"            must contain %%s, which is replaced by the notation string\n"
+"  -M <MB>   memory limit for stored intermediate models (default: 256)\n"
+"  -j <num>  number of threads (default: number of hardware threads, or\n"
+"            $ANTIPRISM_THREADS if set)\n"
+"\n"
 "Planarization options (use canonical program to canonicalize output)\n"
 "  -p <mthd> inter-step planarization method\n"
 "               p - face centroids (magnitude squared) (default)\n"
@@ -842,7 +802,7 @@ void cn_opts::usage()
 "               keyword m2: red,blue,green,yellow,brown,magenta,purple,grue,\n"
 "                           gray,orange (from George Hart\'s original applet)\n"
 "\n"
-"\n",prog_name(), help_ver_text, int(-log(::epsilon)/log(10) + 0.5), ::epsilon);
+"\n",prog_name(), prog_name(), help_ver_text, int(-log(::epsilon)/log(10) + 0.5), ::epsilon);
 }
 // clang-format on
 
@@ -857,11 +817,12 @@ void cn_opts::process_command_line(int argc, char **argv)
   int sig_compare = INT_MAX;
 
   string map_file;
+  string batch_file;
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hHsgtruvc:p:l:i:z:f:C:R:V:E:T:O:m:o:")) !=
-         -1) {
+  while ((c = getopt(argc, argv,
+                     ":hHsgtruvc:p:l:i:z:f:C:R:V:E:T:O:m:o:B:M:j:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -1080,50 +1041,86 @@ void cn_opts::process_command_line(int argc, char **argv)
       ofile = optarg;
       break;
 
+    case 'B':
+      batch_file = optarg;
+      break;
+
+    case 'M':
+      print_status_or_exit(read_double(optarg, &cache_mem), c);
+      if (cache_mem < 0)
+        error("memory limit cannot be negative", c);
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
     default:
       error("unknown command line error");
     }
   }
 
-  if (argc - optind > 2)
-    error("too many arguments");
+  if (batch_file != "") {
+    if (argc - optind > 1)
+      error("too many arguments");
+
+    if (argc - optind == 1)
+      ifile = argv[optind];
+
+    FILE *bfile = fopen(batch_file.c_str(), "r");
+    if (!bfile)
+      error(msg_str("could not open batch file '%s'", batch_file.c_str()),
+            'B');
+    char *line = nullptr;
+    int line_no = 0;
+    while (read_line(bfile, &line) == 0) {
+      line_no++;
+      clear_extra_whitespace(line);
+      if (*line) {
+        batch_strings.push_back(line);
+        batch_operations.push_back(vector<ops *>());
+        char opnd;
+        int psize;
+        string cn_str = line;
+        read_cn_string(cn_str, batch_operations.back(), opnd, psize,
+                       msg_str("batch file line %d: ", line_no));
+        batch_operands.push_back(pair<char, int>(opnd, psize));
+      }
+      free(line);
+      line = nullptr;
+    }
+    fclose(bfile);
 
-  if (argc - optind > 0)
-    cn_string = argv[optind];
-  else
-    error("no Conway Notation string given");
+    if (batch_strings.empty())
+      error("batch file contains no Conway Notation strings", 'B');
 
-  if (int pos = validate_cn_string(cn_string, operations, operand, poly_size,
-                                   alpha_user))
-    error(msg_str("Unexpected character in position %d: %c", pos,
-                  cn_string[pos - 1]));
+    if (ofile.find("%s") == string::npos)
+      error("in batch mode the output file name must contain %s", 'o');
+  }
+  else {
+    if (argc - optind > 2)
+      error("too many arguments");
 
-  if (resolve_ops) {
-    cn_string = resolved_cn_string(cn_string);
+    if (argc - optind > 0)
+      cn_string = argv[optind];
+    else
+      error("no Conway Notation string given");
 
-    // operations is a vector of objects
-    for (auto &operation : operations)
-      delete operation;
-    operations.clear();
+    read_cn_string(cn_string, operations, operand, poly_size, "");
 
-    // revalidate (should be valid) to rebuild operations table
-    if (int pos = validate_cn_string(cn_string, operations, operand, poly_size,
-                                     alpha_user))
-      error(msg_str("Unexpected character in position %d: %c", pos,
-                    cn_string[pos - 1]));
-  }
-
-  if (argc - optind == 2) {
-    ifile = argv[++optind];
-    if (operand)
-      error(
-          msg_str("operand '%c' was specified so input file '%s' is unexpected",
-                  operand, ifile.c_str()));
+    if (argc - optind == 2) {
+      ifile = argv[++optind];
+      if (operand)
+        error(msg_str(
+            "operand '%c' was specified so input file '%s' is unexpected",
+            operand, ifile.c_str()));
+    }
   }
 
-  // operations can be done in reverse order
+  // user operations can be done in reverse order
   if (!reverse_ops) {
-    sort(operations.begin(), operations.end(), cmp_ops);
     for (unsigned int i = 0; i < alpha_user.length(); i++)
       sort(operations_user[alpha_user[i]].begin(),
            operations_user[alpha_user[i]].end(), cmp_ops);
@@ -1202,6 +1199,33 @@ void cn_opts::process_command_line(int argc, char **argv)
   epsilon = (sig_compare != INT_MAX) ? pow(10, -sig_compare) : ::epsilon;
 }
 
+// Validate a Conway Notation string and set up its operations
+void cn_opts::read_cn_string(string &cn_str, vector<ops *> &opers, char &opnd,
+                             int &psize, const string &where)
+{
+  if (int pos = validate_cn_string(cn_str, opers, opnd, psize, alpha_user))
+    error(msg_str("%sUnexpected character in position %d: %c", where.c_str(),
+                  pos, cn_str[pos - 1]));
+
+  if (resolve_ops) {
+    cn_str = resolved_cn_string(cn_str);
+
+    // operations is a vector of objects
+    for (auto &operation : opers)
+      delete operation;
+    opers.clear();
+
+    // revalidate (should be valid) to rebuild operations table
+    if (int pos = validate_cn_string(cn_str, opers, opnd, psize, alpha_user))
+      error(msg_str("%sUnexpected character in position %d: %c",
+                    where.c_str(), pos, cn_str[pos - 1]));
+  }
+
+  // operations can be done in reverse order
+  if (!reverse_ops)
+    sort(opers.begin(), opers.end(), cmp_ops);
+}
+
 void verbose(char operation, int op_var, const cn_opts &opts)
 {
   if (opts.verbosity) {
@@ -1272,7 +1296,7 @@ void centroid_to_origin(Geometry &geom)
 
 /*
 // RK - average radius rather than maximum has more reliability than max
-void unitize_vertex_radius(Geometry &geom)
+static void unitize_vertex_radius(Geometry &geom)
 {
   GeometryInfo info(geom);
   info.set_center(geom.centroid());
@@ -1754,9 +1778,9 @@ void orient_planar(Geometry &geom, bool &is_orientable,
 }
 
 // is_orientable and orientation_positive can change
-void wythoff(Geometry &geom, char operation, int op_var, int &operation_number,
-             bool &is_orientable, bool &orientation_positive,
-             const cn_opts &opts)
+Status wythoff(Geometry &geom, char operation, int op_var,
+               int &operation_number, bool &is_orientable,
+               bool &orientation_positive, const cn_opts &opts)
 {
   operation_number++;
 
@@ -1813,7 +1837,7 @@ void wythoff(Geometry &geom, char operation, int op_var, int &operation_number,
       }
       // no faces to act on, loop
       else {
-        return;
+        return Status::ok();
       }
     }
 
@@ -1832,8 +1856,10 @@ void wythoff(Geometry &geom, char operation, int op_var, int &operation_number,
       wythoff_op = "[VE]0v0e,0V,0E";
 
     // fprintf(stderr, "wythoff_op = %s\n", wythoff_op.c_str());
-    opts.print_status_or_exit(wythoff_make_tiling(
-        geom, geom, wythoff_op, is_orientable, false, opts.col_type));
+    Status stat = wythoff_make_tiling(geom, geom, wythoff_op, is_orientable,
+                                      false, opts.col_type);
+    if (stat.is_error())
+      return stat;
 
     // remove digons
     dels.clear();
@@ -1888,15 +1914,78 @@ void wythoff(Geometry &geom, char operation, int op_var, int &operation_number,
   }
 
   orient_planar(geom, is_orientable, orientation_positive, opts);
+
+  return Status::ok();
 }
 
-void do_operations(Geometry &geom, cn_opts &opts)
+// is_orientable, orientation_positive and operation_number can change
+Status do_operation(Geometry &geom, const ops &operation, bool &is_orientable,
+                    bool &orientation_positive, int &operation_number,
+                    const cn_opts &opts)
 {
-  bool is_orientable = true;
-  bool orientation_positive = true;
-  int operation_number = 0;
+  verbose(operation.op, operation.op_var, opts);
+
+  bool hart_operation_done = false;
+
+  // reflection is done in wythoff
+  if (opts.hart_mode) {
+    hart_operation_done = true;
+
+    switch (operation.op) {
+    // ambo
+    case 'a':
+      hart_ambo(geom);
+      break;
+
+    // gyro
+    case 'g':
+      hart_gyro(geom);
+      break;
+
+    // kis
+    case 'k':
+      hart_kisN(geom, operation.op_var);
+      break;
+
+    // propellor
+    case 'p':
+      hart_propellor(geom);
+      break;
+
+    default:
+      hart_operation_done = false;
+    }
+  }
+
+  if (hart_operation_done) {
+    // these steps are needed for hart_mode
+    operation_number++;
+    orient_planar(geom, is_orientable, orientation_positive, opts);
+  }
+  else {
+    // wythoff mode
+    if (opts.alpha_user.find(operation.op) == string::npos)
+      return wythoff(geom, operation.op, operation.op_var, operation_number,
+                     is_orientable, orientation_positive, opts);
+    else {
+      for (auto operation_user : opts.operations_user.at(operation.op)) {
+        verbose(operation_user->op, operation_user->op_var, opts);
+        Status stat =
+            wythoff(geom, operation_user->op, operation_user->op_var,
+                    operation_number, is_orientable, orientation_positive,
+                    opts);
+        if (stat.is_error())
+          return stat;
+      }
+    }
+  }
+
+  return Status::ok();
+}
 
-  // the program works better with oriented input, centroid at the origin
+// the program works better with oriented input, centroid at the origin
+void prepare_seed(Geometry &geom, bool &is_orientable, const cn_opts &opts)
+{
   verbose('+', 1, opts);
   GeometryInfo info(geom);
   is_orientable = info.is_orientable();
@@ -1907,61 +1996,24 @@ void do_operations(Geometry &geom, cn_opts &opts)
     geom.orient(1); // 1=positive
 
   centroid_to_origin(geom);
+}
 
-  for (auto operation : opts.operations) {
-    verbose(operation->op, operation->op_var, opts);
-
-    bool hart_operation_done = false;
-
-    // reflection is done in wythoff
-    if (opts.hart_mode) {
-      hart_operation_done = true;
-
-      switch (operation->op) {
-      // ambo
-      case 'a':
-        hart_ambo(geom);
-        break;
-
-      // gyro
-      case 'g':
-        hart_gyro(geom);
-        break;
-
-      // kis
-      case 'k':
-        hart_kisN(geom, operation->op_var);
-        break;
-
-      // propellor
-      case 'p':
-        hart_propellor(geom);
-        break;
+Status do_operations(Geometry &geom, cn_opts &opts)
+{
+  bool is_orientable = true;
+  bool orientation_positive = true;
+  int operation_number = 0;
 
-      default:
-        hart_operation_done = false;
-      }
-    }
+  prepare_seed(geom, is_orientable, opts);
 
-    if (hart_operation_done) {
-      // these steps are needed for hart_mode
-      operation_number++;
-      orient_planar(geom, is_orientable, orientation_positive, opts);
-    }
-    else {
-      // wythoff mode
-      if (opts.alpha_user.find(operation->op) == string::npos)
-        wythoff(geom, operation->op, operation->op_var, operation_number,
-                is_orientable, orientation_positive, opts);
-      else {
-        for (auto operation_user : opts.operations_user[operation->op]) {
-          verbose(operation_user->op, operation_user->op_var, opts);
-          wythoff(geom, operation_user->op, operation_user->op_var,
-                  operation_number, is_orientable, orientation_positive, opts);
-        }
-      }
-    }
+  for (auto operation : opts.operations) {
+    Status stat = do_operation(geom, *operation, is_orientable,
+                               orientation_positive, operation_number, opts);
+    if (stat.is_error())
+      return stat;
   }
+
+  return Status::ok();
 }
 
 void cn_coloring(Geometry &geom, const cn_opts &opts)
@@ -2042,34 +2094,397 @@ void cn_coloring(Geometry &geom, const cn_opts &opts)
     Coloring(&geom).v_one_col(opts.vert_col);
 }
 
-int main(int argc, char *argv[])
-{
-  cn_opts opts;
-  opts.process_command_line(argc, argv);
+// Batch mode. The notation strings are held in a trie of operations, so
+// strings with the same seed and leading operations share the models made
+// by those operations. Models at branch points are kept in a cache with a
+// memory limit, and branches are processed in parallel.
 
+// model, and processing state, after an operation
+struct cn_state {
   Geometry geom;
-  if (opts.operand)
-    get_operand(geom, opts);
-  else
-    opts.read_or_error(geom, opts.ifile);
+  bool is_orientable;
+  bool orientation_positive;
+  int operation_number;
 
-  GeometryInfo info(geom);
-  if ((opts.planarize_method == 'p') && !info.is_closed()) {
-    opts.planarize_method = 'm';
-    opts.warning("input model is not closed. Planarization method p will not "
-                 "work. Switching to m");
+  cn_state()
+      : is_orientable(true), orientation_positive(true), operation_number(0)
+  {
   }
+};
+
+// approximate memory used by a state, in bytes
+size_t cn_state_size(const cn_state &state)
+{
+  const Geometry &geom = state.geom;
+  size_t sz = sizeof(cn_state) + geom.verts().size() * sizeof(Vec3d);
+  for (const auto &face : geom.faces())
+    sz += sizeof(face) + face.size() * sizeof(int);
+  for (const auto &edge : geom.edges())
+    sz += sizeof(edge) + edge.size() * sizeof(int);
+  // colours are held in maps, allow for the node overhead
+  for (int i = 0; i < 3; i++)
+    sz += geom.colors(i).get_properties().size() * (sizeof(Color) + 48);
+  return sz;
+}
 
-  do_operations(geom, opts);
+// Least recently used cache of states, by trie node
+class cn_state_cache {
+private:
+  typedef std::list<pair<int, std::shared_ptr<const cn_state>>> lru_list;
+  lru_list states; // most recently used first
+  map<int, std::pair<lru_list::iterator, size_t>> index;
+  size_t max_size;
+  size_t size;
+  std::mutex mtx;
 
-  if (opts.unitize)
-    unitize_edges(geom);
+public:
+  long hits;
+  long misses;
 
-  cn_coloring(geom, opts);
+  cn_state_cache(size_t max_sz)
+      : max_size(max_sz), size(0), hits(0), misses(0)
+  {
+  }
+
+  std::shared_ptr<const cn_state> get(int node)
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(node);
+    if (it == index.end()) {
+      misses++;
+      return nullptr;
+    }
+    hits++;
+    states.splice(states.begin(), states, it->second.first);
+    return it->second.first->second;
+  }
 
-  opts.write_or_error(geom, opts.ofile);
+  void put(int node, std::shared_ptr<const cn_state> state)
+  {
+    size_t sz = cn_state_size(*state);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (index.count(node) || sz > max_size)
+      return;
+    states.push_front(std::make_pair(node, state));
+    index[node] = std::make_pair(states.begin(), sz);
+    size += sz;
+    while (size > max_size) {
+      auto it = index.find(states.back().first);
+      size -= it->second.second;
+      index.erase(it);
+      states.pop_back();
+    }
+  }
+};
 
-  verbose('$', 0, opts);
+class cn_batch {
+private:
+  struct trie_node {
+    int parent;    // -1 for a seed
+    int seed;      // index of seed
+    ops operation; // operation that made this node from its parent
+    map<pair<char, int>, int> children;
+    vector<int> items; // batch strings that end at this node
+
+    trie_node(int par, int sd, char op, int op_var)
+        : parent(par), seed(sd), operation(0, op, op_var)
+    {
+    }
+  };
+
+  struct seed_data {
+    cn_opts opts; // settings for this seed
+    int node;     // trie node for the seed
+    std::shared_ptr<const cn_state> state;
+  };
+
+  struct op_stats {
+    int count;
+    double secs;
+    op_stats() : count(0), secs(0) {}
+  };
+
+  cn_opts &opts;
+  vector<trie_node> nodes;
+  vector<seed_data> seeds;
+  cn_state_cache cache;
+  ThreadPool pool;
+
+  std::mutex stats_mtx;
+  map<string, op_stats> stats;
+  long recomputed;
+
+  // A task can't exit the program while other tasks are running, so the
+  // results are kept and reported by run() after the tasks finish
+  struct item_result {
+    Status stat;
+    bool empty;
+    item_result() : empty(false) {}
+  };
+  std::atomic<bool> failed;
+  map<int, Status> node_stats; // operation messages, guarded by stats_mtx
+  vector<item_result> item_results;
+
+  bool apply(cn_state &state, int node);
+  std::shared_ptr<const cn_state> get_state(int node);
+  void process(int node);
+  void write_items(const cn_state &state, int node);
 
-  return 0;
+public:
+  cn_batch(cn_opts &bopts);
+  void run();
+  void print_summary(FILE *ofp);
+};
+
+cn_batch::cn_batch(cn_opts &bopts)
+    : opts(bopts), cache(size_t(bopts.cache_mem * 1024 * 1024)),
+      pool(bopts.num_threads), recomputed(0), failed(false),
+      item_results(bopts.batch_strings.size())
+{
+  map<pair<char, int>, int> seed_idxs;
+  for (unsigned int i = 0; i < opts.batch_strings.size(); i++) {
+    pair<char, int> opnd = opts.batch_operands[i];
+    if (opnd.first == '\0')
+      opnd.second = 0;
+    auto si = seed_idxs.find(opnd);
+    if (si == seed_idxs.end()) {
+      si = seed_idxs.insert(std::make_pair(opnd, (int)seeds.size())).first;
+      seeds.push_back(seed_data());
+      seeds.back().opts = opts;
+      seeds.back().opts.operand = opnd.first;
+      seeds.back().opts.poly_size = opnd.second;
+      seeds.back().node = nodes.size();
+      nodes.push_back(trie_node(-1, si->second, '\0', 0));
+    }
+
+    int node = seeds[si->second].node;
+    for (const auto *operation : opts.batch_operations[i]) {
+      auto key = std::make_pair(operation->op, operation->op_var);
+      auto ci = nodes[node].children.find(key);
+      if (ci == nodes[node].children.end()) {
+        int child = nodes.size();
+        nodes.push_back(trie_node(node, nodes[node].seed, operation->op,
+                                  operation->op_var));
+        ci = nodes[node].children.insert(std::make_pair(key, child)).first;
+      }
+      node = ci->second;
+    }
+    nodes[node].items.push_back(i);
+  }
+}
+
+// Apply the operation of a node, returning false if it failed
+bool cn_batch::apply(cn_state &state, int node)
+{
+  const ops &operation = nodes[node].operation;
+  Timer timer;
+  timer.set_timer(0.0);
+  Status stat = do_operation(state.geom, operation, state.is_orientable,
+                             state.orientation_positive,
+                             state.operation_number,
+                             seeds[nodes[node].seed].opts);
+  double secs = timer.elapsed();
+
+  string name(1, operation.op);
+  if (operation.op_var != 1)
+    name += std::to_string(operation.op_var);
+  std::lock_guard<std::mutex> lock(stats_mtx);
+  stats[name].count++;
+  stats[name].secs += secs;
+  if (stat.msg() != "")
+    node_stats.emplace(node, stat); // the first result, if remade
+  if (stat.is_error()) {
+    failed = true;
+    return false;
+  }
+  return true;
+}
+
+// Get the state at a node from the cache, or remake it from the nearest
+// state that is available. Returns null if an operation failed.
+std::shared_ptr<const cn_state> cn_batch::get_state(int node)
+{
+  vector<int> path;
+  std::shared_ptr<const cn_state> state;
+  while (nodes[node].parent != -1 && !(state = cache.get(node))) {
+    path.push_back(node);
+    node = nodes[node].parent;
+  }
+  if (!state)
+    state = seeds[nodes[node].seed].state;
+
+  for (auto pi = path.rbegin(); pi != path.rend(); ++pi) {
+    auto new_state = std::make_shared<cn_state>(*state);
+    if (!apply(*new_state, *pi))
+      return nullptr;
+    if (nodes[*pi].children.size() > 1)
+      cache.put(*pi, new_state);
+    state = new_state;
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mtx);
+  recomputed += path.size();
+  return state;
+}
+
+// Write the models for the batch strings that end at a node
+void cn_batch::write_items(const cn_state &state, int node)
+{
+  const cn_opts &seed_opts = seeds[nodes[node].seed].opts;
+  for (int item : nodes[node].items) {
+    Geometry geom = state.geom;
+    if (seed_opts.unitize)
+      unitize_edges(geom);
+    cn_coloring(geom, seed_opts);
+
+    string ofile = opts.ofile;
+    ofile.replace(ofile.find("%s"), 2, opts.batch_strings[item]);
+    item_results[item].stat = geom.write(ofile); // one task per item
+    item_results[item].empty = !geom.is_set();
+    if (item_results[item].stat.is_error())
+      failed = true;
+  }
+}
+
+// Process the subtree starting at a node. A single child continues in this
+// task, several children are processed as separate tasks.
+void cn_batch::process(int node)
+{
+  auto parent_state = get_state(nodes[node].parent);
+  if (!parent_state)
+    return;
+  while (!failed) {
+    auto state = std::make_shared<cn_state>(*parent_state);
+    if (!apply(*state, node))
+      break;
+    write_items(*state, node);
+
+    const trie_node &nd = nodes[node];
+    if (nd.children.size() == 1) {
+      parent_state = state;
+      node = nd.children.begin()->second;
+    }
+    else {
+      if (nd.children.size() > 1) {
+        cache.put(node, state);
+        for (const auto &child : nd.children) {
+          int child_node = child.second;
+          pool.add_task([this, child_node] { process(child_node); });
+        }
+      }
+      break;
+    }
+  }
+}
+
+void cn_batch::run()
+{
+  Geometry input;
+  bool input_read = false;
+  for (unsigned int s = 0; s < seeds.size(); s++) {
+    cn_opts &seed_opts = seeds[s].opts;
+    auto state = std::make_shared<cn_state>();
+    if (seed_opts.operand)
+      get_operand(state->geom, seed_opts);
+    else {
+      if (!input_read) {
+        opts.read_or_error(input, opts.ifile);
+        input_read = true;
+      }
+      state->geom = input;
+    }
+
+    // force tile mode if using polygon
+    if (seed_opts.operand == 'Z' && !seed_opts.tile_mode) {
+      seed_opts.tile_mode = true;
+      seed_opts.hart_mode = false;
+      if (!seed_opts.planarize_method_set)
+        seed_opts.planarize_method = 'u';
+    }
+
+    GeometryInfo info(state->geom);
+    if ((seed_opts.planarize_method == 'p') && !info.is_closed()) {
+      seed_opts.planarize_method = 'm';
+      opts.warning("seed model is not closed. Planarization method p will "
+                   "not work. Switching to m");
+    }
+
+    prepare_seed(state->geom, state->is_orientable, seed_opts);
+    seeds[s].state = state;
+  }
+
+  for (const auto &seed : seeds) {
+    write_items(*seed.state, seed.node); // strings that are only a seed
+    for (const auto &child : nodes[seed.node].children) {
+      int child_node = child.second;
+      pool.add_task([this, child_node] { process(child_node); });
+    }
+  }
+  pool.wait();
+
+  // report in node and item order, which does not depend on the threads
+  for (const auto &ns : node_stats)
+    opts.print_status_or_exit(ns.second);
+  for (const auto &res : item_results) {
+    opts.print_status_or_exit(res.stat);
+    if (res.empty)
+      opts.warning("output geometry has no vertices (empty geometry)");
+  }
+}
+void cn_batch::print_summary(FILE *ofp)
+{
+  size_t without_sharing = 0;
+  for (const auto &opers : opts.batch_operations)
+    without_sharing += opers.size();
+
+  size_t applied = 0;
+  for (const auto &st : stats)
+    applied += st.second.count;
+
+  fprintf(ofp, "batch: %lu notation strings, %lu seeds, %lu operations\n",
+          (unsigned long)opts.batch_strings.size(),
+          (unsigned long)seeds.size(),
+          (unsigned long)(nodes.size() - seeds.size()));
+  fprintf(ofp,
+          "operations applied: %lu (%lu without sharing, %ld to remake "
+          "states)\n",
+          (unsigned long)applied, (unsigned long)without_sharing, recomputed);
+  fprintf(ofp, "cache: %ld hits, %ld misses\n", cache.hits, cache.misses);
+  fprintf(ofp, "%-9s %8s %14s %14s\n", "operator", "count", "total time",
+          "average time");
+  for (const auto &st : stats)
+    fprintf(ofp, "%-9s %8d %13.6fs %13.6fs\n", st.first.c_str(),
+            st.second.count, st.second.secs,
+            st.second.secs / st.second.count);
+}
+
+void run_cn_batch(cn_opts &opts)
+{
+  cn_batch batch(opts);
+  batch.run();
+  batch.print_summary(stderr);
+}
+
+Status cn_opts::process_geom(Geometry &geom)
+{
+  if (operand)
+    get_operand(geom, *this);
+
+  GeometryInfo info(geom);
+  if ((planarize_method == 'p') && !info.is_closed()) {
+    planarize_method = 'm';
+    warning("input model is not closed. Planarization method p will not "
+            "work. Switching to m");
+  }
+
+  Status stat = do_operations(geom, *this);
+  if (stat.is_error())
+    return stat;
+
+  if (unitize)
+    unitize_edges(geom);
+
+  cn_coloring(geom, *this);
+
+  return Status::ok();
 }
@@ -0,0 +1,119 @@
+/*
+   Copyright (c) 2007-2016, Roger Kaufman
+   Includes ideas and algorithms by George W. Hart, http://www.georgehart.com
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: conway.h
+   Description: options for conway, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef CONWAY_H
+#define CONWAY_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+class ops;
+
+class cn_opts : public anti::ProgramOpts {
+public:
+  std::string ifile;
+  std::string ofile;
+
+  std::string cn_string;
+  bool resolve_ops;
+  bool hart_mode;
+  bool tile_mode;
+  bool reverse_ops;
+  char operand;
+  int poly_size;
+  char planarize_method;
+  bool planarize_method_set;
+  int num_iters_planar;
+  int rep_count;
+  bool unitize;
+  bool verbosity;
+  char face_coloring_method;
+  int face_opacity;
+  std::string face_pattern;
+  int seed_coloring_method;
+
+  double epsilon;
+
+  anti::Color vert_col;
+  anti::Color edge_col;
+
+  anti::Tiling::ColoringType col_type;
+  bool color_by_value;
+
+  anti::ColorMapMulti map;
+
+  std::vector<ops *> operations;
+
+  // for on the fly user operators
+  std::string alpha_user;
+  std::map<char, std::vector<ops *>> operations_user;
+
+  // batch mode
+  std::vector<std::string> batch_strings;
+  std::vector<std::vector<ops *>> batch_operations;
+  std::vector<std::pair<char, int>> batch_operands; // operand and poly_size
+  int num_threads;
+  double cache_mem; // megabytes
+
+  cn_opts()
+      : ProgramOpts("conway"), cn_string(""), resolve_ops(false),
+        hart_mode(false), tile_mode(false), reverse_ops(false), operand('\0'),
+        poly_size(0), planarize_method('p'), planarize_method_set(false),
+        num_iters_planar(1000), rep_count(-1), unitize(false), verbosity(false),
+        face_coloring_method('n'), face_opacity(-1), face_pattern("1"),
+        seed_coloring_method(1), epsilon(0),
+        vert_col(anti::Color(255, 215, 0)),   // gold
+        edge_col(anti::Color(211, 211, 211)), // lightgrey
+        col_type(anti::Tiling::ColoringType::path_index),
+        color_by_value(true), num_threads(0), cache_mem(256)
+  {
+  }
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+  void read_cn_string(std::string &cn_str, std::vector<ops *> &opers,
+                      char &opnd, int &psize, const std::string &where);
+
+  // Apply the operations to the model, or to the operand if one was given
+  anti::Status process_geom(anti::Geometry &geom);
+};
+
+// Print the name of an operation, if verbose output was requested
+void verbose(char operation, int op_var, const cn_opts &opts);
+
+// Make and write the models for the batch mode notation strings
+void run_cn_batch(cn_opts &opts);
+
+#endif // CONWAY_H
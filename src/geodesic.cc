@@ -35,34 +35,12 @@
 #include <string>
 
 #include "../base/antiprism.h"
+#include "geodesic.h"
 
 using std::string;
 
 using namespace anti;
 
-class geo_opts : public ProgramOpts {
-public:
-  Vec3d centre;
-  double radius;
-  int m;
-  int n;
-  int pat_freq;
-  bool use_step_freq;
-  char method;
-  bool keep_flat;
-  bool equal_len_div;
-  string ifile;
-  string ofile;
-
-  geo_opts()
-      : ProgramOpts("geodesic"), centre(Vec3d(0, 0, 0)), m(1), n(0),
-        pat_freq(1), use_step_freq(false), method('s')
-  {
-  }
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void geo_opts::usage()
 {
@@ -199,21 +177,14 @@ void geo_opts::process_command_line(int argc, char **argv)
   return;
 }
 
-int main(int argc, char **argv)
+Status geo_opts::process_geom(Geometry &geom)
 {
-  geo_opts opts;
-  opts.process_command_line(argc, argv);
-
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
-
   Geometry geo;
-  if (opts.method == 's')
-    make_geodesic_sphere(geo, geom, opts.m, opts.n, opts.centre);
-  else if (opts.method == 'p')
-    make_geodesic_planar(geo, geom, opts.m, opts.n);
-
-  opts.write_or_error(geo, opts.ofile);
+  if (method == 's')
+    make_geodesic_sphere(geo, geom, m, n, centre);
+  else if (method == 'p')
+    make_geodesic_planar(geo, geom, m, n);
 
-  return 0;
+  geom = geo;
+  return Status::ok();
 }
@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: geodesic.h
+   Description: options for geodesic, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef GEODESIC_H
+#define GEODESIC_H
+
+#include <string>
+
+#include "../base/antiprism.h"
+
+class geo_opts : public anti::ProgramOpts {
+public:
+  anti::Vec3d centre;
+  double radius;
+  int m;
+  int n;
+  int pat_freq;
+  bool use_step_freq;
+  char method;
+  bool keep_flat;
+  bool equal_len_div;
+  std::string ifile;
+  std::string ofile;
+
+  geo_opts()
+      : ProgramOpts("geodesic"), centre(anti::Vec3d(0, 0, 0)), m(1), n(0),
+        pat_freq(1), use_step_freq(false), method('s')
+  {
+  }
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Make the geodesic model in place of the base model
+  anti::Status process_geom(anti::Geometry &geom);
+};
+
+#endif // GEODESIC_H
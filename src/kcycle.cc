@@ -49,11 +49,17 @@ public:
   vector<int> edge_idxs;
   double angle;
   int num_prs;
+  int num_frames;
+  bool delta_frames;
 
   string ifile;
   string ofile;
 
-  kc_opts() : ProgramOpts("kcycle"), angle(0.0), num_prs(6) {}
+  kc_opts()
+      : ProgramOpts("kcycle"), angle(0.0), num_prs(6), num_frames(0),
+        delta_frames(true)
+  {
+  }
 
   void process_command_line(int argc, char **argv);
   void usage();
@@ -77,6 +83,10 @@ void kc_opts::usage()
 "  -n <num>  number of pairs of polyhedra in cycle (default: 6)\n"
 "  -i <file> input file in OFF format. If '-' then read file from stdin.\n"
 "            (default: a tetrahedron with hinge_vertex_idxs 0,1,2,3)\n" 
+"  -N <num>  write a frame file of num frames, with the first hinge angle\n"
+"            evenly spaced over a whole turn starting at the angle given\n"
+"            with -a, for antiview or off2pov\n"
+"  -D        do not delta encode the frame coordinates (larger file)\n"
 "  -o <file> write output to file (default: write to standard output)\n"
 "\n"
 "\n", prog_name(), help_ver_text);
@@ -90,7 +100,7 @@ void kc_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":ha:n:i:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":ha:n:i:N:Do:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -110,6 +120,16 @@ void kc_opts::process_command_line(int argc, char **argv)
       ifile = optarg;
       break;
 
+    case 'N':
+      print_status_or_exit(read_int(optarg, &num_frames), c);
+      if (num_frames <= 0)
+        error("number of frames must be a positive integer", c);
+      break;
+
+    case 'D':
+      delta_frames = false;
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -224,10 +244,19 @@ int main(int argc, char *argv[])
   else
     geom.read_resource("std_tet");
 
-  Geometry cycle;
-  kcycle(geom, cycle, opts.num_prs, opts.edge_idxs, opts.angle);
-
-  opts.write_or_error(cycle, opts.ofile);
+  if (opts.num_frames) {
+    auto make_frame = [&](unsigned long i, Geometry &cycle) {
+      double ang = opts.angle + 2 * M_PI * i / opts.num_frames;
+      kcycle(geom, cycle, opts.num_prs, opts.edge_idxs, ang);
+    };
+    opts.print_status_or_exit(write_frames(opts.ofile, opts.num_frames,
+                                           make_frame, opts.delta_frames));
+  }
+  else {
+    Geometry cycle;
+    kcycle(geom, cycle, opts.num_prs, opts.edge_idxs, opts.angle);
+    opts.write_or_error(cycle, opts.ofile);
+  }
 
   return 0;
 }
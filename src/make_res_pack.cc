@@ -0,0 +1,139 @@
+/*
+   Copyright (c) 2006-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*
+   Name: make_res_pack.cc
+   Description: write a pack of prebuilt resource models
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+class mrp_opts : public ProgramOpts {
+public:
+  bool list_only;
+  string ofile;
+
+  mrp_opts() : ProgramOpts("make_res_pack"), list_only(false) {}
+  void process_command_line(int argc, char **argv);
+  void usage();
+};
+
+// clang-format off
+void mrp_opts::usage()
+{
+   fprintf(stdout,
+"\n"
+"Usage: %s [options]\n"
+"\n"
+"Make the commonly used resource models (uniform polyhedra and their duals,\n"
+"Johnson solids, Wenninger models and geodesic spheres) and write them to\n"
+"a resource pack file, which is then read in place of making the models.\n"
+"The pack may only be used with this version of Antiprism.\n"
+"\n"
+"Options\n"
+"%s"
+"  -l        list the names of the models, and don't write a pack\n"
+"  -o <file> write output to file (default: %s)\n"
+"\n"
+"\n", prog_name(), help_ver_text, ResourcePack::file_name);
+}
+// clang-format on
+
+void mrp_opts::process_command_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hlo:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'l':
+      list_only = true;
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 0)
+    error("too many arguments");
+
+  if (ofile.empty())
+    ofile = ResourcePack::file_name;
+}
+
+// Add the names prefix1 to prefixN
+static void add_numbered(vector<string> &names, const string &prefix, int N)
+{
+  for (int i = 1; i <= N; i++)
+    names.push_back(prefix + std::to_string(i));
+}
+
+int main(int argc, char *argv[])
+{
+  mrp_opts opts;
+  opts.process_command_line(argc, argv);
+
+  vector<string> names = {"tet", "cube", "oct", "dod", "ico"};
+  add_numbered(names, "u", 80);
+  add_numbered(names, "ud", 80);
+  add_numbered(names, "j", 92);
+  add_numbered(names, "w", 119);
+  add_numbered(names, "geo_", 10);
+
+  if (opts.list_only) {
+    for (const auto &name : names)
+      fprintf(stdout, "%s\n", name.c_str());
+    return 0;
+  }
+
+  int num_written;
+  opts.print_status_or_exit(
+      ResourcePack::write(opts.ofile, names, &num_written));
+  if (num_written < (int)names.size())
+    opts.warning(msg_str("%d models could not be made, and were not written",
+                         (int)names.size() - num_written));
+
+  return 0;
+}
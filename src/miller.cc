@@ -32,6 +32,7 @@
 #include <stdlib.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -47,12 +48,15 @@ using namespace anti;
 class miller_opts : public ProgramOpts {
 public:
   string ifile;
+  vector<string> ifiles;
   string ofile;
 
   string output_parts;
   bool merge_faces;
   bool rebuild_compound_model;
   bool list_polys;
+  bool make_all;
+  int num_threads;
 
   char vertex_coloring_method;
   char edge_coloring_method;
@@ -69,8 +73,8 @@ public:
 
   miller_opts()
       : ProgramOpts("miller"), output_parts("s"), merge_faces(false),
-        rebuild_compound_model(false), list_polys(false),
-        vertex_coloring_method('\0'), edge_coloring_method('\0'),
+        rebuild_compound_model(false), list_polys(false), make_all(false),
+        num_threads(0), vertex_coloring_method('\0'), edge_coloring_method('\0'),
         face_coloring_method('\0'), vertex_color(Color::invisible),
         edge_color(Color::invisible), face_color(Color()),
         map_string("compound"), face_opacity(-1), epsilon(0)
@@ -85,17 +89,23 @@ void miller_opts::usage()
 {
    fprintf(stdout,
 "\n"
-"Usage: %s [options] input\n"
+"Usage: %s [options] input [input ...]\n"
 "\n"
 "Millers 59 Icosahedra Stellations. Plus additional stellations discovered since.\n"
 "input may be Miller list number from 1 to 75. Or m_string where string consists\n"
 "of one or more cell names: A,B,C,D,E,F,G,H,e1,f1,f1',g1,e2,f2,g2  e.g m_De1f1g1\n"
 "model string can be followed by I or Ih symmetry. e.g. ""m_e1f1',I""\n"
 "std_ may precede input string to output a raw model\n" 
+"If more than one input is given, the stellation diagrams are shared and\n"
+"the models are made in parallel. Then -o must be given, containing %%s,\n"
+"which is replaced by the input string\n"
 "\n"
 "Options\n"
 "%s"
 "  -L        list models only\n"
+"  -A        make all the models in the list (input is not given)\n"
+"  -j <num>  number of models to make at the same time (default: number\n"
+"            of hardware threads, or $ANTIPRISM_THREADS if set)\n"
 "  -M        merge stellation facelets\n"
 "  -r        rebuild compound model to separate vertices\n"
 "  -O <args> output s - stellation, d - diagram (default: s)\n"
@@ -128,7 +138,7 @@ void miller_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hLMrO:V:E:F:T:m:l:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hLAj:MrO:V:E:F:T:m:l:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -137,6 +147,16 @@ void miller_opts::process_command_line(int argc, char **argv)
       list_polys = true;
       break;
 
+    case 'A':
+      make_all = true;
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
     case 'M':
       merge_faces = true;
       break;
@@ -207,11 +227,18 @@ void miller_opts::process_command_line(int argc, char **argv)
     }
   }
 
-  if (argc - optind > 1)
-    error("too many arguments");
+  while (argc - optind > 0)
+    ifiles.push_back(argv[optind++]);
 
-  if (argc - optind == 1)
-    ifile = argv[optind];
+  if (make_all && ifiles.size())
+    error("input cannot be given with -A");
+
+  if (ifiles.size() == 1)
+    ifile = ifiles[0];
+  else if ((ifiles.size() > 1 || make_all) &&
+           ofile.find("%s") == string::npos)
+    error("with more than one model the output file name must contain %s",
+          'o');
 
   epsilon = (sig_compare != INT_MAX) ? pow(10, -sig_compare) : ::epsilon;
 }
@@ -373,6 +400,27 @@ struct MillerItem {
   bool remove_inline_verts;
 };
 
+// Stellation diagrams of the icosahedron, for each symmetry used. These
+// are shared by all the models that are made.
+class MillerSessions {
+private:
+  map<string, std::unique_ptr<StellationSession>> sessions;
+
+public:
+  MillerSessions(double eps)
+  {
+    Geometry ico;
+    ico.read_resource("ico");
+    for (const char *sym_str : {"Ih", "I"})
+      sessions[sym_str].reset(new StellationSession(ico, sym_str, 500, eps));
+  }
+
+  StellationSession &get(const string &sym_str)
+  {
+    return *sessions.at(sym_str);
+  }
+};
+
 class Miller {
 private:
   MillerItem *Miller_items;
@@ -381,7 +429,8 @@ private:
 public:
   Miller();
   int get_poly(anti::Geometry &geom, int sym, string cell_str, string sym_str,
-               map<int, Geometry> &diagrams, miller_opts &opts);
+               map<int, Geometry> &diagrams, MillerSessions &sessions,
+               miller_opts &opts);
   int get_last_M() { return last_M; }
   void list_polys();
 };
@@ -619,10 +668,8 @@ vector<string> decode_cell_string(string cell_str)
   return (diagram_list_strings);
 }
 
-int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str, map<int, Geometry> &diagrams, miller_opts &opts)
+int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str, map<int, Geometry> &diagrams, MillerSessions &sessions, miller_opts &opts)
 {
-  geom.read_resource("ico");
-
   // decode the cell string
   if (!cell_str.length()) {
     cell_str = Miller_items[sym].cell_string;
@@ -634,6 +681,9 @@ int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str, m
   }
   fprintf(stderr,"%s,%s\n", cell_str.c_str(), sym_str.c_str()); 
 
+  StellationSession &stel = sessions.get(sym_str);
+  geom = stel.get_geom();
+
   vector<string> diagram_list_strings = decode_cell_string(cell_str);
   // if list is empty, code string was invalid
   int sz = diagram_list_strings.size();
@@ -648,26 +698,23 @@ int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str, m
       continue;
 
     read_idx_list((char *)diagram_list_strings[i].c_str(), idx_lists[i], INT_MAX, false);
-
-    // stellation face index is in the first position
-    int stellation_face_idx = idx_lists[i][0];
-
-    // construct the diagrams
-    if (!diagrams[stellation_face_idx].verts().size())
-      diagrams[stellation_face_idx] = make_stellation_diagram(geom, stellation_face_idx, sym_str);
   }
 
+  // the diagrams are only made once, these are copies
+  diagrams = stel.get_diagrams(idx_lists);
+
   bool merge_faces = opts.merge_faces;
   bool remove_inline_verts = Miller_items[sym].remove_inline_verts;
   bool split_pinched = true;
   bool resolve_faces = true;
   bool remove_multiples = true;
 
-  geom = make_stellation(geom, diagrams, idx_lists, sym_str, merge_faces, remove_inline_verts,
-                         split_pinched, resolve_faces, remove_multiples, opts.map_string, opts.epsilon);
+  geom = stel.make_stellation(idx_lists, merge_faces, remove_inline_verts,
+                              split_pinched, resolve_faces, remove_multiples,
+                              opts.map_string);
 
   vector<vector<int>> idx_lists_full =
-      lists_full(diagrams, idx_lists, remove_multiples);
+      stel.lists_full(idx_lists, remove_multiples);
 
   if (opts.output_parts.find_first_of("d") != string::npos) {
     // color diagrams
@@ -700,7 +747,7 @@ int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str, m
 }
 
 int make_resource_miller(Geometry &geom, string name, bool is_std, miller_opts &opts,
-                         char *errmsg = nullptr)
+                         MillerSessions &sessions, char *errmsg = nullptr)
 {
   int sym_no = 0;
   // check if it is just the index number, if so format as m%d
@@ -745,7 +792,7 @@ int make_resource_miller(Geometry &geom, string name, bool is_std, miller_opts &
     return -1; // not a string of cell names
 
   map<int, Geometry> diagrams;
-  int ret = mill.get_poly(geom, sym_no, cell_str, sym_str, diagrams, opts);
+  int ret = mill.get_poly(geom, sym_no, cell_str, sym_str, diagrams, sessions, opts);
   if (ret < 1)
     return 1; // fail
 
@@ -805,14 +852,14 @@ int make_resource_miller(Geometry &geom, string name, bool is_std, miller_opts &
   return 0; // name found
 }
 
-int try_miller(Geometry &geom, miller_opts &opts)
+int try_miller(Geometry &geom, miller_opts &opts, MillerSessions &sessions)
 {
   string name = opts.ifile;
   bool is_std = (name.size() > 3 && name.substr(0, 4) == "std_");
   if (is_std)
     name = name.substr(4);
   char errmsg[MSG_SZ];
-  int idx = make_resource_miller(geom, name, is_std, opts, errmsg);
+  int idx = make_resource_miller(geom, name, is_std, opts, sessions, errmsg);
   return(idx);
 }
 
@@ -827,11 +874,46 @@ int main(int argc, char *argv[])
     exit(0);
   }
 
-  Geometry geom;
-  if (try_miller(geom, opts))
-    opts.error("model not found");
+  if (opts.make_all) {
+    Miller mill;
+    for (int i = 1; i <= mill.get_last_M(); i++)
+      opts.ifiles.push_back(std::to_string(i));
+  }
+
+  MillerSessions sessions(opts.epsilon);
 
-  opts.write_or_error(geom, opts.ofile);
+  if (opts.ifiles.size() <= 1) {
+    Geometry geom;
+    if (try_miller(geom, opts, sessions))
+      opts.error("model not found");
+
+    opts.write_or_error(geom, opts.ofile);
+    return 0;
+  }
+
+  // several models, the stellation diagrams are shared
+  vector<char> found(opts.ifiles.size(), false);
+  parallel_for(opts.ifiles.size(),
+               [&](size_t i) {
+                 miller_opts model_opts = opts;
+                 model_opts.ifile = opts.ifiles[i];
+                 Geometry geom;
+                 if (try_miller(geom, model_opts, sessions))
+                   return;
+                 found[i] = true;
+                 string ofile = opts.ofile;
+                 ofile.replace(ofile.find("%s"), 2, opts.ifiles[i]);
+                 model_opts.write_or_error(geom, ofile);
+               },
+               opts.num_threads, 1);
+
+  int ret = 0;
+  for (unsigned int i = 0; i < opts.ifiles.size(); i++) {
+    if (!found[i]) {
+      opts.warning(msg_str("model '%s' not found", opts.ifiles[i].c_str()));
+      ret = 1;
+    }
+  }
 
-  return 0;
+  return ret;
 }
@@ -81,13 +81,14 @@ public:
   double shorten_rad_by;
   double flatten_by;
   Vec4d ellipsoid;
+  int seed;
 
   string ifile;
   string ofile;
 
   mm_opts()
       : ProgramOpts("minmax"), algm('v'), placement('n'), shorten_by(1.0),
-        lengthen_by(NAN), shorten_rad_by(NAN), flatten_by(NAN)
+        lengthen_by(NAN), shorten_rad_by(NAN), flatten_by(NAN), seed(-1)
   {
   }
 
@@ -128,6 +129,8 @@ void mm_opts::usage()
 "              r - random placement\n"
 "              u - unscramble: place a small polygon on one side and the\n"
 "                  rest of the vertices at a point on the other side\n"
+"  -R <seed> seed for random placement, 0 or greater (default: seed from\n"
+"            the time)\n"
 "  -E <prms> use ellipsoid, three numbers separated by commas are the\n"
 "            axis lengths (for a superellipsoid an optional fourth number\n"
 "            gives the power)\n"
@@ -151,7 +154,7 @@ void mm_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hn:s:l:k:f:a:p:E:L:z:qo:")) != -1) {
+  while ((c = getopt(argc, argv, ":hn:s:l:k:f:a:p:R:E:L:z:qo:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -211,6 +214,12 @@ void mm_opts::process_command_line(int argc, char **argv)
       placement = *optarg;
       break;
 
+    case 'R':
+      print_status_or_exit(read_int(optarg, &seed), c);
+      if (seed < 0)
+        error("seed must be 0 or greater", c);
+      break;
+
     case 'E':
       print_status_or_exit(read_double_list(optarg, nums), c);
       if (nums.size() < 3 || nums.size() > 4)
@@ -257,6 +266,9 @@ void mm_opts::process_command_line(int argc, char **argv)
       warning("set, but not used for this algorithm", 'f');
   }
 
+  if (seed >= 0 && (placement != 'r' || algm == 'u'))
+    warning("set, but not used without random placement", 'R');
+
   if (argc - optind > 1)
     error("too many arguments");
 
@@ -276,7 +288,8 @@ void to_ellipsoid(Vec3d &v, Vec4d ellipsoid)
   }
 }
 
-void initial_placement(Geometry &geom, char placement, Vec4d ellipsoid)
+void initial_placement(Geometry &geom, char placement, Vec4d ellipsoid,
+                       int seed)
 {
   const vector<int> &face = geom.faces(0);
   switch (placement) {
@@ -296,12 +309,17 @@ void initial_placement(Geometry &geom, char placement, Vec4d ellipsoid)
     break;
 
   case 'r': {
-    Random rnd;
-    rnd.time_seed();
-    for (unsigned int i = 0; i < geom.verts().size(); i++) {
-      geom.verts(i) = Vec3d::random(rnd);
-      to_ellipsoid(geom.verts(i), ellipsoid);
-    }
+    CounterRandom rnd;
+    if (seed < 0)
+      rnd.time_seed();
+    else
+      rnd.seedi(seed);
+    vector<Vec3d> &verts = geom.raw_verts();
+    parallel_for(verts.size(), [&](size_t i) {
+      CounterRandom v_rnd = rnd.get_stream(i); // stream for this vertex
+      verts[i] = Vec3d::random(v_rnd);
+      to_ellipsoid(verts[i], ellipsoid);
+    });
     break;
   }
   }
@@ -438,13 +456,18 @@ void minmax_unit(Geometry &geom, iter_params it_params, double shorten_factor,
     // fprintf(stderr, "{%d/%d} rad=%g\n", N, D, rads[f]);
   }
 
+  GeometryMetrics metrics(geom);
+  const vector<vector<int>> &edges = metrics.get_impl_edges();
+  const vector<vector<int>> &face_edges = metrics.get_face_edges();
+
+  // Vertx offsets for the iteration.
+  vector<Vec3d> offsets(verts.size());
+
   bool diverging = false;
   int cnt = 0;
   for (cnt = 1; cnt <= it_params.num_iters; cnt++) {
-    vector<Vec3d> old_verts = verts;
-
-    // Vertx offsets for the iteration.
-    vector<Vec3d> offsets(verts.size(), Vec3d::zero);
+    for (auto &offset : offsets)
+      offset = Vec3d::zero;
     for (unsigned int ff = cnt; ff < faces.size() + cnt; ff++) {
       const unsigned int f = ff % faces.size();
       const vector<int> &face = faces[f];
@@ -457,7 +480,7 @@ void minmax_unit(Geometry &geom, iter_params it_params, double shorten_factor,
       for (unsigned int vv = cnt; vv < f_sz + cnt; vv++) {
         unsigned int v = vv % f_sz;
         // offset for unit edges
-        vector<int> edge = make_edge(face[v], face[(v + 1) % f_sz]);
+        const vector<int> &edge = edges[face_edges[f][v]];
         Vec3d offset =
             (1 - geom.edge_len(edge)) * shorten_factor * geom.edge_vec(edge);
         offsets[edge[0]] -= offset;
@@ -478,14 +501,10 @@ void minmax_unit(Geometry &geom, iter_params it_params, double shorten_factor,
       geom.raw_verts()[i] += offsets[i];
 
     if (it_params.check_status(cnt)) {
-      max_diff2 = 0;
-      for (auto &offset : offsets) {
-        double diff2 = offset.len2();
-        if (diff2 > max_diff2)
-          max_diff2 = diff2;
-      }
+      metrics.update(offsets);
+      max_diff2 = metrics.get_max_diff2();
 
-      double width = BoundBox(verts).max_width();
+      double width = metrics.get_max_width();
       if (sqrt(max_diff2) / width < test_val)
         break;
 
@@ -525,7 +544,7 @@ int main(int argc, char *argv[])
 
   if (geom.edges().size()) {
     if (opts.algm != 'u')
-      initial_placement(geom, opts.placement, opts.ellipsoid);
+      initial_placement(geom, opts.placement, opts.ellipsoid, opts.seed);
     if (opts.algm == 'a')
       minmax_a(geom, opts.it_params, opts.shorten_by / 200,
                opts.lengthen_by / 200, opts.ellipsoid);
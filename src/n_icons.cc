@@ -35,6 +35,7 @@
 #include <ctype.h>
 
 #include <algorithm>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -154,6 +155,9 @@ public:
   vector<int> ncon_range;
   bool long_form;
   bool filter_case2;
+  string survey_file;
+  bool survey_resume;
+  int num_threads;
   int flood_fill_stop;
   Color face_default_color;
   Color edge_default_color;
@@ -180,7 +184,8 @@ public:
         face_opacity(-1), face_pattern("1"), edge_coloring_method('\0'),
         edge_opacity(-1), edge_pattern("1"), edge_set_no_color(false),
         unused_edge_color(Color::invisible), symmetric_coloring(false),
-        long_form(false), filter_case2(false), flood_fill_stop(0),
+        long_form(false), filter_case2(false), survey_resume(false),
+        num_threads(0), flood_fill_stop(0),
         face_default_color(Color(192, 192, 192, 255)), // darkgrey
         edge_default_color(Color(192, 192, 192, 255)), // darkgrey
         epsilon(0), angle_is_side_cut(false), double_sweep(false),
@@ -270,6 +275,7 @@ void ncon_opts::usage()
 "  -W        add symmetry polygon (for -f S or -e S)\n"
 "\nSurface Count Reporting (options above igonored)\n"
 "  -L <type> list n-icons with more than one surface. Valid values for type\n"
+"            (more than one type may be given, the lists are in that order)\n"
 "               n = point cut even order n_icons\n"
 "               s = side cut even order n-icons (surfaces > 2)\n"
 "               o = odd order n_icons\n"
@@ -281,6 +287,12 @@ void ncon_opts::usage()
 "  -K <k,k2> range of n-icons to list for multiple surfaces\n"
 "  -J        long form report\n"
 "  -Z        filter out case 2 types\n"
+"  -C <file> write a survey to file in CSV format. There is a record for\n"
+"            each twist, and field 'listed' is 1 if it would be listed\n"
+"  -F        resume a survey, records already in the file given with -C\n"
+"            are kept, and the survey continues from the last order found\n"
+"  -j <num>  number of orders to survey at the same time (default: number\n"
+"            of hardware threads, or $ANTIPRISM_THREADS if set)\n"
 "\n"
 "\n",prog_name(), help_ver_text, int(-log(::epsilon)/log(10) + 0.5), ::epsilon);
 }
@@ -298,7 +310,7 @@ void ncon_opts::process_command_line(int argc, char **argv)
 
   while ((c = getopt(
               argc, argv,
-              ":hn:t:sHM:x:Ac:z:a:r:R:IL:K:JZm:f:ST:O:e:U:P:Q:YD:X:Wl:o:")) !=
+              ":hn:t:sHM:x:Ac:z:a:r:R:IL:K:JZC:Fj:m:f:ST:O:e:U:P:Q:YD:X:Wl:o:")) !=
          -1) {
     if (common_opts(c, optopt))
       continue;
@@ -396,8 +408,8 @@ void ncon_opts::process_command_line(int argc, char **argv)
       break;
 
     case 'L':
-      if (strspn(optarg, "nsohijkl") != strlen(optarg) || strlen(optarg) > 1)
-        error(msg_str("n-icon type is '%s', must be only one of n, s, "
+      if (strspn(optarg, "nsohijkl") != strlen(optarg))
+        error(msg_str("n-icon types are '%s', must be from n, s, "
                       "o, h, i, j, k, or l\n",
                       optarg),
               c);
@@ -423,6 +435,20 @@ void ncon_opts::process_command_line(int argc, char **argv)
       filter_case2 = true;
       break;
 
+    case 'C':
+      survey_file = optarg;
+      break;
+
+    case 'F':
+      survey_resume = true;
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
     case 'm':
       print_status_or_exit(read_colorings(clrngs, optarg), c);
       break;
@@ -575,6 +601,9 @@ void ncon_opts::process_command_line(int argc, char **argv)
 
   // surfaces subsystem
   if (ncon_surf.length() > 0) {
+    if (survey_resume && survey_file == "")
+      error("a survey file must be given with -C", 'F');
+
     if (ncon_range.size() == 0)
       error("for surfaces reporting -K must be specified", "J");
     else if (!is_even(ncon_range.front()) &&
@@ -721,6 +750,9 @@ void ncon_opts::process_command_line(int argc, char **argv)
     if (ncon_range.size() > 0)
       error("not valid without -J", "K");
 
+    if (survey_file != "")
+      error("not valid without -L", "C");
+
     if (long_form)
       error("not valid without -J", "L");
 
@@ -6156,146 +6188,312 @@ int ncon_subsystem(Geometry &geom, ncon_opts &opts)
   return ret;
 }
 
-void surface_subsystem(const ncon_opts &opts)
+// Surface count survey. Each order of each type of n-icon is a job, and
+// the jobs are processed in parallel. Results are written in job order.
+
+struct survey_job {
+  char type; // type letter given with -L
+  char form; // n, s, o or h
+  int ncon_order;
+  int inc; // order increment for the type
+
+  survey_job(char t, char f, int n, int i)
+      : type(t), form(f), ncon_order(n), inc(i)
+  {
+  }
+};
+
+vector<survey_job> get_survey_jobs(const ncon_opts &opts)
 {
-  vector<surfaceTable *> surface_table;
-  surfaceData sd;
+  vector<survey_job> jobs;
+  for (char type : opts.ncon_surf) {
+    char form = type;
+    vector<int> ncon_range = opts.ncon_range;
 
-  char form = opts.ncon_surf[0];
+    int inc = 2;
+    if (form == 'o') {
+      if (is_even(ncon_range.front()))
+        ncon_range.front()++;
+    }
+    else {
+      if (!is_even(ncon_range.front()))
+        ncon_range.front()++;
+    }
 
-  fprintf(stderr, "\n");
+    if ((form == 'i') || (form == 'j')) {
+      if (((form == 'i') && !is_even(ncon_range.front() / 2)) ||
+          ((form == 'j') && is_even(ncon_range.front() / 2)))
+        ncon_range.front() += 2;
 
-  if (!opts.filter_case2)
-    fprintf(stderr,
-            "Note: case 2 n-icons are depicted with {curly brackets}\n");
+      inc += 2;
+      form = 'h';
+    }
+    else if ((form == 'k') || (form == 'l')) {
+      if (((form == 'k') && !is_even(ncon_range.front() / 4)) ||
+          ((form == 'l') && is_even(ncon_range.front() / 4)))
+        ncon_range.front() += 4;
 
-  if ((form != 'o') && (form != 'i'))
-    fprintf(stderr,
-            "Note: non-chiral n-icons are depicted with [square brackets]\n");
-
-  if (form == 's')
-    fprintf(
-        stderr,
-        "Note: all even order side cut n-icons have at least two surfaces\n");
-  else if (form == 'i')
-    fprintf(stderr, "Note: only hybrids such that N/2 is even are shown\n");
-  else if (form == 'j')
-    fprintf(stderr, "Note: only hybrids such that N/2 is odd are shown\n");
-  else if (form == 'k')
-    fprintf(stderr, "Note: only hybrids such that N/4 is even are shown\n");
-  else if (form == 'l')
-    fprintf(stderr, "Note: only hybrids such that N/4 is odd are shown\n");
-
-  fprintf(stderr, "\n");
-
-  vector<int> ncon_range = opts.ncon_range;
-
-  int inc = 2;
-  if (form == 'o') {
-    if (is_even(ncon_range.front()))
-      ncon_range.front()++;
-  }
-  else {
-    if (!is_even(ncon_range.front()))
-      ncon_range.front()++;
+      inc += 6;
+      form = 'h';
+    }
+
+    for (int ncon_order = ncon_range.front(); ncon_order <= ncon_range.back();
+         ncon_order += inc)
+      jobs.push_back(survey_job(type, form, ncon_order, inc));
   }
 
-  if ((form == 'i') || (form == 'j')) {
-    if (((form == 'i') && !is_even(ncon_range.front() / 2)) ||
-        ((form == 'j') && is_even(ncon_range.front() / 2)))
-      ncon_range.front() += 2;
+  return jobs;
+}
 
-    inc += 2;
-    form = 'h';
-  }
-  else if ((form == 'k') || (form == 'l')) {
-    if (((form == 'k') && !is_even(ncon_range.front() / 4)) ||
-        ((form == 'l') && is_even(ncon_range.front() / 4)))
-      ncon_range.front() += 4;
+// notes printed before the listing of an n-icon type
+string survey_notes(const char type, const ncon_opts &opts)
+{
+  string notes = "\n";
 
-    inc += 6;
-    form = 'h';
-  }
+  if (!opts.filter_case2)
+    notes += "Note: case 2 n-icons are depicted with {curly brackets}\n";
+
+  if ((type != 'o') && (type != 'i'))
+    notes += "Note: non-chiral n-icons are depicted with [square brackets]\n";
+
+  if (type == 's')
+    notes +=
+        "Note: all even order side cut n-icons have at least two surfaces\n";
+  else if (type == 'i')
+    notes += "Note: only hybrids such that N/2 is even are shown\n";
+  else if (type == 'j')
+    notes += "Note: only hybrids such that N/2 is odd are shown\n";
+  else if (type == 'k')
+    notes += "Note: only hybrids such that N/4 is even are shown\n";
+  else if (type == 'l')
+    notes += "Note: only hybrids such that N/4 is odd are shown\n";
+
+  notes += "\n";
 
   if (opts.long_form) {
-    fprintf(stderr,
-            "                       Surfaces                       Edges\n");
-    fprintf(stderr, "                       ------------------------------ "
-                    "------------------------\n");
-    fprintf(stderr, "%s  %s          %s %s %s %s %s\n\n", "Order", "n-icon",
-            "Total", "Continuous", "Discontinuous", "Continuous",
-            "Discontinuous");
+    notes += "                       Surfaces                       Edges\n";
+    notes += "                       ------------------------------ "
+             "------------------------\n";
+    notes += msg_str("%s  %s          %s %s %s %s %s\n\n", "Order", "n-icon",
+                     "Total", "Continuous", "Discontinuous", "Continuous",
+                     "Discontinuous");
   }
 
+  return notes;
+}
+
+const char *survey_csv_header = "type,order,twist,total_surfaces,"
+                                "continuous_surfaces,discontinuous_surfaces,"
+                                "continuous_edges,discontinuous_edges,"
+                                "nonchiral,case2,listed";
+
+// Survey all twists of one order, the result is the text of the listing,
+// or CSV records with a record for every twist
+string survey_order(const survey_job &job, const ncon_opts &opts)
+{
+  const char form = job.form;
+  const int ncon_order = job.ncon_order;
+
   int last = 0;
-  for (int ncon_order = ncon_range.front(); ncon_order <= ncon_range.back();
-       ncon_order += inc) {
-    if (is_even(ncon_order)) {
-      if (form == 'h')
-        last = (int)floor((double)(ncon_order + 2) / 4);
-      else
-        last = (int)floor((double)ncon_order / 4);
-    }
+  if (is_even(ncon_order)) {
+    if (form == 'h')
+      last = (int)floor((double)(ncon_order + 2) / 4);
     else
-      last = (int)floor((double)ncon_order / 2);
+      last = (int)floor((double)ncon_order / 4);
+  }
+  else
+    last = (int)floor((double)ncon_order / 2);
 
-    bool point_cut = false;
-    bool hybrid = false;
-    bool info = false;
+  bool point_cut = false;
+  bool hybrid = false;
+  bool info = false;
 
-    if (form == 'n' || form == 'o')
-      point_cut = true;
-    else if (form == 's')
-      point_cut = false;
-    else if (form == 'h')
-      hybrid = true;
+  if (form == 'n' || form == 'o')
+    point_cut = true;
+  else if (form == 's')
+    point_cut = false;
+  else if (form == 'h')
+    hybrid = true;
 
-    bool none = true;
+  string out;
+  bool csv = (opts.survey_file != "");
+  bool none = true;
 
-    if (opts.long_form)
-      fprintf(stderr, "%-5d: ", ncon_order);
-    else
-      fprintf(stderr, "%d: ", ncon_order);
-
-    for (int twist = 2; twist <= last; twist++) {
-      ncon_info(ncon_order, point_cut, twist, hybrid, info, surface_table, sd);
-
-      if ((!is_even(ncon_order) && sd.total_surfaces > 1) ||
-          (form != 's' && sd.total_surfaces > 1) ||
-          (form == 's' && sd.total_surfaces > 2)) {
-        if (!sd.ncon_case2 || (sd.ncon_case2 && !opts.filter_case2)) {
-          if (!none) {
-            if (opts.long_form)
-              fprintf(stderr, "%-5d: ", ncon_order);
-            else
-              fprintf(stderr, ", ");
-          }
-          char buffer[MSG_SZ];
-          if (sd.nonchiral)
-            sprintf(buffer, "[%d+%d]", ncon_order, twist);
-          else if (sd.ncon_case2)
-            sprintf(buffer, "{%d+%d}", ncon_order, twist);
-          else
-            sprintf(buffer, "(%d+%d)", ncon_order, twist);
-          if (opts.long_form)
-            fprintf(stderr, "%-15s %5d %10d %13d %10d %13d\n", buffer,
-                    sd.total_surfaces, sd.c_surfaces, sd.d_surfaces, sd.c_edges,
-                    sd.d_edges);
-          else
-            fprintf(stderr, "%s", buffer);
-          none = false;
-        }
+  if (!csv)
+    out += msg_str((opts.long_form) ? "%-5d: " : "%d: ", ncon_order);
+
+  // the surface table is built on the first call of ncon_info, and is
+  // then used for all the twists of this order
+  vector<surfaceTable *> surface_table;
+  surfaceData sd;
+  for (int twist = 2; twist <= last; twist++) {
+    ncon_info(ncon_order, point_cut, twist, hybrid, info, surface_table, sd);
+
+    bool listed = false;
+    if ((!is_even(ncon_order) && sd.total_surfaces > 1) ||
+        (form != 's' && sd.total_surfaces > 1) ||
+        (form == 's' && sd.total_surfaces > 2))
+      listed = (!sd.ncon_case2 || (sd.ncon_case2 && !opts.filter_case2));
+
+    if (csv) {
+      out += msg_str("%c,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", job.type,
+                     ncon_order, twist, sd.total_surfaces, sd.c_surfaces,
+                     sd.d_surfaces, sd.c_edges, sd.d_edges, sd.nonchiral,
+                     sd.ncon_case2, listed);
+    }
+    else if (listed) {
+      if (!none) {
+        if (opts.long_form)
+          out += msg_str("%-5d: ", ncon_order);
+        else
+          out += ", ";
       }
+      char buffer[MSG_SZ];
+      if (sd.nonchiral)
+        sprintf(buffer, "[%d+%d]", ncon_order, twist);
+      else if (sd.ncon_case2)
+        sprintf(buffer, "{%d+%d}", ncon_order, twist);
+      else
+        sprintf(buffer, "(%d+%d)", ncon_order, twist);
+      if (opts.long_form)
+        out += msg_str("%-15s %5d %10d %13d %10d %13d\n", buffer,
+                       sd.total_surfaces, sd.c_surfaces, sd.d_surfaces,
+                       sd.c_edges, sd.d_edges);
+      else
+        out += buffer;
+      none = false;
     }
-    surface_table.clear();
+  }
+
+  for (auto &st : surface_table)
+    delete st;
 
+  if (!csv) {
     if (none) {
-      fprintf(stderr, "none");
+      out += "none";
       if (opts.long_form)
-        fprintf(stderr, "\n");
+        out += "\n";
     }
-    fprintf(stderr, "\n");
+    out += "\n";
   }
+
+  return out;
+}
+
+// Prepare a survey file for resuming. Records from the last job found may
+// be incomplete, these are removed and that job is run again.
+// return the index of the first job to run
+size_t prepare_survey_resume(const ncon_opts &opts,
+                             const vector<survey_job> &jobs)
+{
+  FILE *ifile = fopen(opts.survey_file.c_str(), "r");
+  if (!ifile)
+    return 0; // nothing to resume
+
+  map<pair<char, int>, size_t> job_idxs;
+  for (size_t i = 0; i < jobs.size(); i++)
+    job_idxs[make_pair(jobs[i].type, jobs[i].ncon_order)] = i;
+
+  vector<pair<string, size_t>> records;
+  char *line = nullptr;
+  bool header_ok = false;
+  bool bad_record = false;
+  while (read_line(ifile, &line) == 0) {
+    if (!header_ok) {
+      if (strcmp(line, survey_csv_header) != 0)
+        opts.error(msg_str("cannot resume, '%s' is not a survey file",
+                           opts.survey_file.c_str()),
+                   'F');
+      header_ok = true;
+    }
+    else {
+      // an unknown record is only allowed as the last, incomplete, line
+      if (bad_record)
+        opts.error(msg_str("cannot resume, survey file '%s' has records "
+                           "that are not part of this survey",
+                           opts.survey_file.c_str()),
+                   'F');
+      char type;
+      int ncon_order;
+      auto ji = job_idxs.end();
+      if (sscanf(line, "%c,%d,", &type, &ncon_order) == 2)
+        ji = job_idxs.find(make_pair(type, ncon_order));
+      if (ji != job_idxs.end())
+        records.push_back(make_pair(string(line), ji->second));
+      else
+        bad_record = true;
+    }
+    free(line);
+    line = nullptr;
+  }
+  fclose(ifile);
+
+  size_t first_job = (records.size()) ? records.back().second : 0;
+
+  FILE *ofile = fopen(opts.survey_file.c_str(), "w");
+  if (!ofile)
+    opts.error(msg_str("could not open survey file '%s' for writing",
+                       opts.survey_file.c_str()),
+               'C');
+  fprintf(ofile, "%s\n", survey_csv_header);
+  for (const auto &record : records)
+    if (record.second < first_job)
+      fprintf(ofile, "%s\n", record.first.c_str());
+  fclose(ofile);
+
+  return first_job;
+}
+
+void surface_subsystem(const ncon_opts &opts)
+{
+  vector<survey_job> jobs = get_survey_jobs(opts);
+
+  FILE *ofile = stderr;
+  size_t first_job = 0;
+  if (opts.survey_file != "") {
+    if (opts.survey_resume)
+      first_job = prepare_survey_resume(opts, jobs);
+    ofile = fopen(opts.survey_file.c_str(), (first_job) ? "a" : "w");
+    if (!ofile)
+      opts.error(msg_str("could not open survey file '%s' for writing",
+                         opts.survey_file.c_str()),
+                 'C');
+    if (!first_job)
+      fprintf(ofile, "%s\n", survey_csv_header);
+  }
+
+  // results are held until all earlier jobs have been written
+  size_t num_jobs = jobs.size() - first_job;
+  vector<string> results(num_jobs);
+  vector<char> done(num_jobs, false);
+  size_t next_out = 0;
+  std::mutex out_mutex;
+
+  parallel_for(
+      num_jobs,
+      [&](size_t i) {
+        const survey_job &job = jobs[first_job + i];
+        string out;
+        bool first_of_type = (first_job + i == 0 ||
+                              jobs[first_job + i - 1].type != job.type);
+        if (opts.survey_file == "" && first_of_type)
+          out = survey_notes(job.type, opts);
+        out += survey_order(job, opts);
+
+        std::lock_guard<std::mutex> lock(out_mutex);
+        results[i] = out;
+        done[i] = true;
+        while (next_out < num_jobs && done[next_out]) {
+          fputs(results[next_out].c_str(), ofile);
+          results[next_out].clear();
+          next_out++;
+        }
+        fflush(ofile);
+      },
+      opts.num_threads, 1);
+
+  if (ofile != stderr)
+    fclose(ofile);
 }
 
 int main(int argc, char *argv[])
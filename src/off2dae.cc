@@ -220,7 +220,7 @@ void Collada_writer::add_col2elems(DisplayPoly &disp,
     for (unsigned int i = 0; i < vs.size(); i++) {
       Color col = disp.get_disp_geom().colors(VERTS).get((int)i);
       if (col.is_index())
-        col = disp.clrng(VERTS).get_col(col.get_index());
+        col = disp.clrng(VERTS).lookup(col.get_index());
       if (!col.is_value())
         col = disp.def_col(VERTS); // use default
       if (col.is_value() && !col.is_invisible())
@@ -232,7 +232,7 @@ void Collada_writer::add_col2elems(DisplayPoly &disp,
     for (unsigned int i = 0; i < es.size(); i++) {
       Color col = disp.get_disp_geom().colors(EDGES).get((int)i);
       if (col.is_index())
-        col = disp.clrng(EDGES).get_col(col.get_index());
+        col = disp.clrng(EDGES).lookup(col.get_index());
       if (!col.is_value())
         col = disp.def_col(EDGES); // use default
       if (col.is_value() && !col.is_invisible())
@@ -246,7 +246,7 @@ void Collada_writer::add_col2elems(DisplayPoly &disp,
         continue;
       Color col = disp.get_disp_geom().colors(FACES).get((int)i);
       if (col.is_index())
-        col = disp.clrng(FACES).get_col(col.get_index());
+        col = disp.clrng(FACES).lookup(col.get_index());
       if (!col.is_value())
         col = disp.def_col(FACES); // use default
       if (col.is_value() && !col.is_invisible())
@@ -590,7 +590,7 @@ void Collada_writer::print_library_visual_scene_verts(DisplayPoly &disp,
   for (unsigned int i = 0; i < dgeom.verts().size(); i++) {
     Color col = disp.get_disp_geom().colors(VERTS).get((int)i);
     if (col.is_index())
-      col = disp.clrng(VERTS).get_col(col.get_index());
+      col = disp.clrng(VERTS).lookup(col.get_index());
     if (!col.is_value())
       col = disp.def_col(VERTS); // use default
     if (col.is_value() && !col.is_invisible()) {
@@ -623,7 +623,7 @@ void Collada_writer::print_library_visual_scene_edges(DisplayPoly &disp,
   for (unsigned int i = 0; i < dgeom.edges().size(); i++) {
     Color col = disp.get_disp_geom().colors(EDGES).get((int)i);
     if (col.is_index())
-      col = disp.clrng(EDGES).get_col(col.get_index());
+      col = disp.clrng(EDGES).lookup(col.get_index());
     if (!col.is_value())
       col = disp.def_col(EDGES); // use default
     if (col.is_value() && !col.is_invisible()) {
@@ -673,12 +673,28 @@ void Collada_writer::print_library_visual_scenes(const Scene &scen)
     for (dsp = geo->get_disps().begin(); dsp != geo->get_disps().end(); ++dsp) {
       if (DisplayPoly *disp_p = dynamic_cast<DisplayPoly *>(*dsp)) {
         string id = id_tag(geo->get_name(), g, d);
-        if (disp_p->elem(FACES).get_show())
-          print_library_visual_scene_faces(*disp_p, id);
-        if (disp_p->elem(VERTS).get_show())
-          print_library_visual_scene_verts(*disp_p, id);
-        if (disp_p->elem(EDGES).get_show())
-          print_library_visual_scene_edges(*disp_p, id);
+        // instances use the same face geometry, each in its own node
+        const vector<Trans3d> &insts = geo->get_instances();
+        const unsigned int num_insts = (insts.size()) ? insts.size() : 1;
+        for (unsigned int i = 0; i < num_insts; i++) {
+          string node_id = id;
+          if (insts.size()) {
+            node_id += "_inst" + itostr(i);
+            print_open(XML_elem("node").add_id("instance" + node_id));
+            string mat_str;
+            for (int j = 0; j < 16; j++)
+              mat_str += ((j) ? " " : "") + dtostr(insts[i][j], 8);
+            print_open_close("matrix", mat_str);
+          }
+          if (disp_p->elem(FACES).get_show())
+            print_library_visual_scene_faces(*disp_p, id);
+          if (disp_p->elem(VERTS).get_show())
+            print_library_visual_scene_verts(*disp_p, node_id);
+          if (disp_p->elem(EDGES).get_show())
+            print_library_visual_scene_edges(*disp_p, node_id);
+          if (insts.size())
+            print_close(); // node
+        }
       }
       d++;
     }
@@ -762,6 +778,9 @@ void o2d_opts::usage()
 "  -m <maps> a comma separated list of colour maps used to transform colour\n"
 "            indexes, a part consisting of letters from v, e, f, selects \n"
 "            the element types to apply the map list to (default 'vef').\n"
+"  -G <sym>  display the model repeated by the transformations of a\n"
+"            symmetry group, in Schoenflies notation (written once,\n"
+"            with a transformation for each repeat)\n"
 "  -K <lvl>  a positive integer to specify the level of smoothing (using more\n"
 "            polygons) of the vertex spheres and edge cylinders (default: %d)\n"
 "  -d <dgts> number of significant digits (default %d) or if negative\n"
@@ -780,7 +799,7 @@ void o2d_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hv:e:V:E:F:x:t:m:K:o:d:")) != -1) {
+  while ((c = getopt(argc, argv, ":hv:e:V:E:F:x:t:m:G:K:o:d:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
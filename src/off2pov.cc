@@ -27,6 +27,8 @@
 */
 
 #include "../base/antiprism.h"
+#include "off2pov.h"
+#include <algorithm>
 #include <ctype.h>
 #include <math.h>
 #include <string.h>
@@ -38,28 +40,6 @@ using std::vector;
 
 using namespace anti;
 
-class o2p_opts : public ViewOpts {
-public:
-  bool shadow;
-  int stereo_type;
-  int sig_dgts;
-  char o_type;
-  vector<string> scene_incs;
-  vector<string> obj_incs;
-  vector<string> geom_incs;
-
-  string ofile;
-
-  o2p_opts()
-      : ViewOpts("off2pov"), shadow(false), stereo_type(-1),
-        sig_dgts(DEF_SIG_DGTS), o_type('a')
-  {
-  }
-
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void o2p_opts::usage()
 {
@@ -68,7 +48,10 @@ void o2p_opts::usage()
 "Usage: %s [options] input_files\n"
 "\n"
 "Convert files in OFF format to POV format for display in POV-ray. If\n"
-"input_files are not given the program reads from standard input.\n"
+"input_files are not given the program reads from standard input. If an\n"
+"input file is a frame file (e.g. from jitterbug -N) a POV file is written\n"
+"for each frame, and the output file name must contain an integer format\n"
+"(e.g. frame_%%04d.pov) which is replaced by the frame number.\n"
 "\n"
 "Options\n"
 "%s"
@@ -106,8 +89,9 @@ void o2p_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv,
-                     ":hv:e:V:E:F:m:x:s:n:o:D:C:L:R:P:W:S:B:d:t:I:j:J:i:O:")) !=
+  while ((c = getopt(
+              argc, argv,
+              ":hv:e:V:E:F:m:G:x:s:n:o:D:C:L:R:P:W:S:B:d:t:I:j:J:i:O:")) !=
          -1) {
     if (common_opts(c, optopt))
       continue;
@@ -185,42 +169,61 @@ void set_geom_includes(Scene &scen, const vector<string> &includes)
   }
 }
 
-int main(int argc, char *argv[])
+bool is_frame_name_format(const string &fname)
 {
-  o2p_opts opts;
-  opts.process_command_line(argc, argv);
-  Scene scen = opts.scen_defs;
-  opts.set_view_vals(scen);
-  set_geom_includes(scen, opts.geom_incs);
-
-  PovWriter pov;
-  pov.set_o_type(opts.o_type);
+  size_t pos = fname.find('%');
+  if (pos == string::npos || fname.find('%', pos + 1) != string::npos)
+    return false;
+  size_t end = fname.find_first_not_of("0123456789", pos + 1);
+  return end != string::npos && fname[end] == 'd';
+}
 
-  if (opts.ofile != "")
-    pov.set_file_name(basename2(opts.ofile.c_str()));
+Status o2p_opts::write_pov(PovWriter &pov, const Scene &scen,
+                           const string &ofile_name) const
+{
+  if (ofile_name != "")
+    pov.set_file_name(basename2(ofile_name.c_str()));
   else
     pov.set_file_name("stdout");
 
-  pov.set_includes(opts.scene_incs);
-  pov.set_obj_includes(opts.obj_incs);
-
-  if (opts.stereo_type >= 0)
-    pov.set_stereo_type(opts.stereo_type);
-
-  if (opts.shadow)
-    pov.set_shadow(opts.shadow);
-
   FILE *ofile = stdout; // write to stdout by default
-  if (opts.ofile != "") {
-    ofile = fopen(opts.ofile.c_str(), "w");
+  if (ofile_name != "") {
+    ofile = fopen(ofile_name.c_str(), "w");
     if (ofile == nullptr)
-      opts.error("could not open output file \'" + opts.ofile + "\'");
+      return Status::error("could not open output file \'" + ofile_name +
+                           "\'");
   }
 
-  pov.write(ofile, scen, opts.sig_dgts);
+  pov.write(ofile, scen, sig_dgts);
 
-  if (opts.ofile != "")
+  if (ofile_name != "")
     fclose(ofile);
 
-  return 0;
+  return Status::ok();
+}
+
+void o2p_opts::set_writer(PovWriter &pov) const
+{
+  pov.set_o_type(o_type);
+
+  pov.set_includes(scene_incs);
+  pov.set_obj_includes(obj_incs);
+
+  if (stereo_type >= 0)
+    pov.set_stereo_type(stereo_type);
+
+  if (shadow)
+    pov.set_shadow(shadow);
+}
+
+Status o2p_opts::write_geom(const Geometry &geom, const string &name,
+                            const string &ofile_name)
+{
+  Scene scen;
+  set_view_vals(scen, vector<Geometry>(1, geom), vector<string>(1, name));
+  set_geom_includes(scen, geom_incs);
+
+  PovWriter pov;
+  set_writer(pov);
+  return write_pov(pov, scen, ofile_name);
 }
@@ -0,0 +1,77 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file off2pov.h
+   \brief Options for off2pov, shared with antiprism_pipe
+*/
+
+#ifndef OFF2POV_H
+#define OFF2POV_H
+
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+class o2p_opts : public anti::ViewOpts {
+public:
+  bool shadow;
+  int stereo_type;
+  int sig_dgts;
+  char o_type;
+  std::vector<std::string> scene_incs;
+  std::vector<std::string> obj_incs;
+  std::vector<std::string> geom_incs;
+
+  std::string ofile;
+
+  o2p_opts()
+      : ViewOpts("off2pov"), shadow(false), stereo_type(-1),
+        sig_dgts(anti::DEF_SIG_DGTS), o_type('a')
+  {
+  }
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Set up a writer with the output options
+  void set_writer(anti::PovWriter &pov) const;
+
+  // Write a scene to a POV file, or to standard output if the name is empty
+  anti::Status write_pov(anti::PovWriter &pov, const anti::Scene &scen,
+                         const std::string &ofile_name) const;
+
+  // Write a model held in memory, displayed with the view options
+  anti::Status write_geom(const anti::Geometry &geom, const std::string &name,
+                          const std::string &ofile_name);
+};
+
+// Set the geometry include files for the scene geometries
+void set_geom_includes(anti::Scene &scen,
+                       const std::vector<std::string> &includes);
+
+// Check for a single integer conversion, like %d or %04d
+bool is_frame_name_format(const std::string &fname);
+
+#endif // OFF2POV_H
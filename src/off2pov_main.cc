@@ -0,0 +1,72 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file off2pov_main.cc
+   \brief Convert an OFF file to POV format
+*/
+
+#include <algorithm>
+
+#include "../base/antiprism.h"
+#include "off2pov.h"
+
+using namespace anti;
+
+int main(int argc, char *argv[])
+{
+  o2p_opts opts;
+  opts.process_command_line(argc, argv);
+  Scene scen = opts.scen_defs;
+  opts.set_view_vals(scen);
+  set_geom_includes(scen, opts.geom_incs);
+
+  PovWriter pov;
+  opts.set_writer(pov);
+
+  // Frame files are streamed, one frame at a time, and shorter
+  // sequences are repeated to the length of the longest
+  unsigned long num_frames = 0;
+  for (const auto &sc_geom : scen.get_geoms())
+    if (sc_geom.get_frames())
+      num_frames = std::max(num_frames, sc_geom.get_frames()->size());
+
+  if (!num_frames)
+    opts.print_status_or_exit(opts.write_pov(pov, scen, opts.ofile));
+  else {
+    if (!is_frame_name_format(opts.ofile))
+      opts.error("output file name for frames must contain an integer "
+                 "format, e.g. frame_%04d.pov",
+                 'o');
+    for (unsigned long i = 0; i < num_frames; i++) {
+      if (i > 0)
+        for (auto &sc_geom : scen.get_geoms())
+          if (sc_geom.get_frames())
+            opts.print_status_or_exit(sc_geom.next_frame());
+      opts.print_status_or_exit(
+          opts.write_pov(pov, scen, msg_str(opts.ofile.c_str(), (int)i)));
+    }
+  }
+
+  return 0;
+}
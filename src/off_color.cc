@@ -42,6 +42,8 @@
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "batch.h"
+#include "off_color.h"
 
 using std::map;
 using std::pair;
@@ -102,47 +104,31 @@ void color_vals_to_idxs(Geometry &geom, char elems = ELEM_ALL,
 
 enum { CV_UNSET = 1, CV_INDEX = 2, CV_VALUE = 4, CV_INVISIBLE = 8 };
 
-class o_col_opts : public ProgramOpts {
-public:
-  char v_col_op;
-  string v_sub_sym;
-  vector<set<int>> v_equivs;
-  Color v_col;
-
-  char e_col_op;
-  string e_sub_sym;
-  vector<set<int>> e_equivs;
-  Color e_col;
-  double e_min_len_diff;
-
-  char f_col_op;
-  string f_sub_sym;
-  vector<set<int>> f_equivs;
-  Color f_col;
-
-  char edge_type;
-  unsigned int selection;
-
-  Coloring clrngs[3];
-
-  char range_elems;
-  ColorValuesToRangeHsva col_procs[3];
-  char v2i_elems;
-
-  string lfile;
-  string ifile;
-  string ofile;
-
-  o_col_opts()
-      : ProgramOpts("off_color"), v_col_op(0), e_col_op(0), f_col_op(0),
-        edge_type('x'), selection(0), range_elems(ELEM_NONE),
-        v2i_elems(ELEM_NONE)
-  {
+bool lights_read(const string &fname, Geometry *lights, char *errmsg)
+{
+  *errmsg = '\0';
+  FILE *lfile = open_sup_file(fname.c_str(), "/col_lights/");
+  if (lfile == nullptr) {
+    if (errmsg)
+      snprintf(errmsg, MSG_SZ, "could not open colour lights file \'%s\'",
+               fname.c_str());
+    return 0;
   }
 
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
+  if (!lights->read(lfile))
+    return false;
+  bool no_color = false;
+  for (unsigned int i = 0; i < lights->verts().size(); i++) {
+    if (!lights->colors(VERTS).get(i).is_value()) {
+      lights->colors(VERTS).set(i, Color(0.5, 0.5, 0.5));
+      no_color = true;
+    }
+  }
+  if (no_color)
+    strcpy_msg(errmsg, "one or more missing colours, set to grey");
+
+  return true;
+}
 
 // clang-format off
 void o_col_opts::usage()
@@ -326,9 +312,14 @@ void o_col_opts::process_command_line(int argc, char **argv)
       edge_type = *optarg;
       break;
 
-    case 'l':
-      lfile = optarg;
+    case 'l': {
+      char errmsg[MSG_SZ];
+      if (!lights_read(optarg, &lights, errmsg))
+        error(errmsg, c);
+      if (*errmsg)
+        warning(errmsg, c);
       break;
+    }
 
     case 'm':
       print_status_or_exit(read_colorings(clrngs, optarg), c);
@@ -418,32 +409,6 @@ void o_col_opts::process_command_line(int argc, char **argv)
     ifile = argv[optind];
 }
 
-bool lights_read(const string &fname, Geometry *lights, char *errmsg)
-{
-  *errmsg = '\0';
-  FILE *lfile = open_sup_file(fname.c_str(), "/col_lights/");
-  if (lfile == nullptr) {
-    if (errmsg)
-      snprintf(errmsg, MSG_SZ, "could not open colour lights file \'%s\'",
-               fname.c_str());
-    return 0;
-  }
-
-  if (!lights->read(lfile))
-    return false;
-  bool no_color = false;
-  for (unsigned int i = 0; i < lights->verts().size(); i++) {
-    if (!lights->colors(VERTS).get(i).is_value()) {
-      lights->colors(VERTS).set(i, Color(0.5, 0.5, 0.5));
-      no_color = true;
-    }
-  }
-  if (no_color)
-    strcpy_msg(errmsg, "one or more missing colours, set to grey");
-
-  return true;
-}
-
 inline unsigned int col_type(const Color &col)
 {
   return CV_UNSET * !col.is_set() + CV_INDEX * col.is_index() +
@@ -493,33 +458,16 @@ bool warn_if_not_subgroup(const ProgramOpts &opts, char opt,
   return true; // is subgroup
 }
 
-int main(int argc, char *argv[])
+Status o_col_opts::process_geom(Geometry &geom)
 {
-  o_col_opts opts;
-  opts.process_command_line(argc, argv);
-
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
-
-  // read lights
-  char errmsg[MSG_SZ];
-  Geometry lights;
-  if (opts.lfile != "") {
-    if (!lights_read(opts.lfile, &lights, errmsg))
-      opts.error(errmsg, 'l');
-    if (*errmsg)
-      opts.warning(errmsg, 'l');
-  }
-
   // store original edges
   unsigned int orig_edges_sz = geom.edges().size();
   map<vector<int>, Color> expl_edges;
-  if (opts.e_col_op && strchr("pP", opts.e_col_op) &&
-      !strchr("iI", opts.edge_type))
-    opts.edge_type = 'i';
-  if (opts.edge_type == 'a')
+  if (e_col_op && strchr("pP", e_col_op) && !strchr("iI", edge_type))
+    edge_type = 'i';
+  if (edge_type == 'a')
     geom.add_missing_impl_edges();
-  else if (strchr("iI", opts.edge_type)) {
+  else if (strchr("iI", edge_type)) {
     for (unsigned int i = 0; i < geom.edges().size(); i++)
       expl_edges[geom.edges(i)] = geom.colors(EDGES).get(i);
     geom.clear(EDGES);
@@ -527,42 +475,48 @@ int main(int argc, char *argv[])
   }
 
   Geometry store_geom;
-  if (opts.selection)
+  if (selection)
     store_geom = geom;
 
   // Get symmetry if necessary
   Symmetry sym;
   vector<vector<set<int>>> sym_equivs;
-  if ((opts.f_col_op && strchr("sS", opts.f_col_op)) ||
-      (opts.e_col_op && strchr("sS", opts.e_col_op)) ||
-      (opts.v_col_op && strchr("sS", opts.v_col_op))) {
+  if ((f_col_op && strchr("sS", f_col_op)) ||
+      (e_col_op && strchr("sS", e_col_op)) ||
+      (v_col_op && strchr("sS", v_col_op))) {
     sym.init(geom, &sym_equivs);
-    opts.v_equivs = sym_equivs[0];
-    opts.e_equivs = sym_equivs[1];
-    opts.f_equivs = sym_equivs[2];
+    v_equivs = sym_equivs[0];
+    e_equivs = sym_equivs[1];
+    f_equivs = sym_equivs[2];
 
     Symmetry sub;
-    if (opts.v_col_op && strchr("sS", opts.v_col_op)) {
-      opts.print_status_or_exit(sym.get_sub_sym(opts.v_sub_sym, &sub), 'v');
+    if (v_col_op && strchr("sS", v_col_op)) {
+      Status stat = sym.get_sub_sym(v_sub_sym, &sub);
+      if (stat.is_error())
+        return Status::error(opt_msg('v', stat.msg()));
       get_equiv_elems(geom, sub.get_trans(), &sym_equivs);
-      opts.v_equivs = sym_equivs[0];
+      v_equivs = sym_equivs[0];
     }
-    if (opts.e_col_op && strchr("sS", opts.e_col_op)) {
-      opts.print_status_or_exit(sym.get_sub_sym(opts.e_sub_sym, &sub), 'e');
+    if (e_col_op && strchr("sS", e_col_op)) {
+      Status stat = sym.get_sub_sym(e_sub_sym, &sub);
+      if (stat.is_error())
+        return Status::error(opt_msg('e', stat.msg()));
       get_equiv_elems(geom, sub.get_trans(), &sym_equivs);
-      opts.e_equivs = sym_equivs[1];
+      e_equivs = sym_equivs[1];
     }
-    if (opts.f_col_op && strchr("sS", opts.f_col_op)) {
-      opts.print_status_or_exit(sym.get_sub_sym(opts.f_sub_sym, &sub), 'f');
+    if (f_col_op && strchr("sS", f_col_op)) {
+      Status stat = sym.get_sub_sym(f_sub_sym, &sub);
+      if (stat.is_error())
+        return Status::error(opt_msg('f', stat.msg()));
       get_equiv_elems(geom, sub.get_trans(), &sym_equivs);
-      opts.f_equivs = sym_equivs[2];
+      f_equivs = sym_equivs[2];
     }
   }
 
-  Coloring &fc = opts.clrngs[FACES];
+  Coloring &fc = clrngs[FACES];
   fc.set_geom(&geom);
-  if (opts.f_col_op) {
-    char op = opts.f_col_op;
+  if (f_col_op) {
+    char op = f_col_op;
     ColorMap *cmap = nullptr;
     if (fc.get_cmaps().size() == 0) {
       if (strchr("GgCc", op))
@@ -573,7 +527,7 @@ int main(int argc, char *argv[])
     if (cmap)
       fc.add_cmap(cmap);
     if (op == 'o')
-      fc.f_one_col(opts.f_col);
+      fc.f_one_col(f_col);
     else if (strchr("uU", op))
       fc.f_unique(op == 'U');
     else if (strchr("pP", op))
@@ -598,10 +552,10 @@ int main(int argc, char *argv[])
       fc.f_apply_cmap();
   }
 
-  Coloring &ec = opts.clrngs[EDGES];
+  Coloring &ec = clrngs[EDGES];
   ec.set_geom(&geom);
-  if (opts.e_col_op) {
-    char op = opts.e_col_op;
+  if (e_col_op) {
+    char op = e_col_op;
     ColorMap *cmap = nullptr;
     if (ec.get_cmaps().size() == 0) {
       if (strchr("GgCc", op))
@@ -612,7 +566,7 @@ int main(int argc, char *argv[])
     if (cmap)
       ec.add_cmap(cmap);
     if (op == 'o')
-      ec.e_one_col(opts.e_col);
+      ec.e_one_col(e_col);
     else if (strchr("uU", op))
       ec.e_unique(op == 'U');
     else if (strchr("pP", op))
@@ -620,7 +574,7 @@ int main(int argc, char *argv[])
     else if (strchr("sS", op))
       ec.e_sets(sym_equivs[1], op == 'S');
     else if (strchr("jJ", op))
-      ec.e_lengths(opts.e_min_len_diff, op == 'J');
+      ec.e_lengths(e_min_len_diff, op == 'J');
     else if (strchr("kK", op))
       ec.e_parts(op == 'K');
     else if (strchr("Gg", op))
@@ -637,10 +591,10 @@ int main(int argc, char *argv[])
       ec.e_apply_cmap();
   }
 
-  Coloring &vc = opts.clrngs[VERTS];
+  Coloring &vc = clrngs[VERTS];
   vc.set_geom(&geom);
-  if (opts.v_col_op) {
-    char op = opts.v_col_op;
+  if (v_col_op) {
+    char op = v_col_op;
     ColorMap *cmap = nullptr;
     if (vc.get_cmaps().size() == 0) {
       if (strchr("Cc", op))
@@ -651,7 +605,7 @@ int main(int argc, char *argv[])
     if (cmap)
       vc.add_cmap(cmap);
     if (op == 'o')
-      vc.v_one_col(opts.v_col);
+      vc.v_one_col(v_col);
     else if (strchr("uU", op))
       vc.v_unique(op == 'U');
     else if (strchr("pP", op))
@@ -673,52 +627,50 @@ int main(int argc, char *argv[])
   /*
   // convert index numbers to values after other processing
   if(col_map.size()) {
-     if(strchr(opts.cmap_elems.c_str(), 'f'))
+     if(strchr(cmap_elems.c_str(), 'f'))
         fc.apply_cmap();
-     if(strchr(opts.cmap_elems.c_str(), 'e'))
+     if(strchr(cmap_elems.c_str(), 'e'))
         ec.apply_cmap();
-     if(strchr(opts.cmap_elems.c_str(), 'v'))
+     if(strchr(cmap_elems.c_str(), 'v'))
         vc.apply_cmap();
   }
   */
 
   // value to value mappings
-  if (opts.range_elems & (ELEM_VERTS))
-    opts.col_procs[0].apply(geom.colors(VERTS).get_properties());
-  if (opts.range_elems & (ELEM_EDGES))
-    opts.col_procs[1].apply(geom.colors(EDGES).get_properties());
-  if (opts.range_elems & (ELEM_FACES))
-    opts.col_procs[2].apply(geom.colors(FACES).get_properties());
+  if (range_elems & (ELEM_VERTS))
+    col_procs[0].apply(geom.colors(VERTS).get_properties());
+  if (range_elems & (ELEM_EDGES))
+    col_procs[1].apply(geom.colors(EDGES).get_properties());
+  if (range_elems & (ELEM_FACES))
+    col_procs[2].apply(geom.colors(FACES).get_properties());
 
   // Average colour values from adjoining elements after converting
   // index numbers
-  if (opts.e_col_op == 'F')
+  if (e_col_op == 'F')
     ec.e_face_color();
-  if (opts.v_col_op == 'F')
+  if (v_col_op == 'F')
     vc.v_face_color();
-  else if (opts.v_col_op == 'E')
+  else if (v_col_op == 'E')
     vc.v_edge_color();
 
   // Finally convert to index numbers
-  color_vals_to_idxs(geom, opts.v2i_elems);
+  color_vals_to_idxs(geom, v2i_elems);
 
-  if (opts.selection)
-    restore_orig_cols(geom, store_geom, opts.selection, orig_edges_sz);
+  if (selection)
+    restore_orig_cols(geom, store_geom, selection, orig_edges_sz);
 
   // restore original edges
   map<vector<int>, Color>::iterator ei;
-  if (opts.edge_type == 'I') {
+  if (edge_type == 'I') {
     for (ei = expl_edges.begin(); ei != expl_edges.end(); ++ei)
       geom.add_edge(ei->first, ei->second);
   }
-  else if (opts.edge_type == 'i') {
+  else if (edge_type == 'i') {
     for (ei = expl_edges.begin(); ei != expl_edges.end(); ++ei)
       if (find(geom.edges().begin(), geom.edges().end(), ei->first) ==
           geom.edges().end())
         geom.add_edge(ei->first, ei->second);
   }
 
-  opts.write_or_error(geom, opts.ofile);
-
-  return 0;
+  return Status::ok();
 }
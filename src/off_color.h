@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: off_color.h
+   Description: options for off_color, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef OFF_COLOR_H
+#define OFF_COLOR_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+class o_col_opts : public anti::ProgramOpts {
+public:
+  char v_col_op;
+  std::string v_sub_sym;
+  std::vector<std::set<int>> v_equivs;
+  anti::Color v_col;
+
+  char e_col_op;
+  std::string e_sub_sym;
+  std::vector<std::set<int>> e_equivs;
+  anti::Color e_col;
+  double e_min_len_diff;
+
+  char f_col_op;
+  std::string f_sub_sym;
+  std::vector<std::set<int>> f_equivs;
+  anti::Color f_col;
+
+  char edge_type;
+  unsigned int selection;
+
+  anti::Coloring clrngs[3];
+
+  char range_elems;
+  anti::ColorValuesToRangeHsva col_procs[3];
+  char v2i_elems;
+
+  anti::Geometry lights;
+  std::string ifile;
+  std::string ofile;
+
+  o_col_opts()
+      : ProgramOpts("off_color"), v_col_op(0), e_col_op(0), f_col_op(0),
+        edge_type('x'), selection(0), range_elems(anti::ELEM_NONE),
+        v2i_elems(anti::ELEM_NONE)
+  {
+  }
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Colour the model
+  anti::Status process_geom(anti::Geometry &geom);
+};
+
+#endif // OFF_COLOR_H
@@ -429,73 +429,31 @@ void find_fronts_from_axes(map<int, vector<int>> &fronts, const Geometry &axes,
 {
   const vector<Vec3d> &axes_verts = axes.verts();
 
-  const vector<vector<int>> &faces = geom.faces();
-  const vector<Vec3d> &verts = geom.verts();
+  // find elements near each axis, rather than testing every element
+  SegmentQuery query(geom, opts.epsilon);
 
   // fronts radiate from axes
   bool found = false;
   for (unsigned int i = 0; i < axes_verts.size(); i++) {
-    // search vertices first
-    for (unsigned int j = 0; j < verts.size(); j++) {
-      // check if vertex is on axis because face might not be planar
-      if (point_in_segment(verts[j], axes_verts[i], cent, opts.epsilon)
-              .is_set()) {
-        // intersection is a vertex. find all faces at vertex
-        fronts[i] = find_faces_with_vertex(faces, j);
-        break;
-      }
+    // search vertices first, because face might not be planar
+    int v_idx = query.find_vertex(axes_verts[i], cent);
+    if (v_idx >= 0) {
+      // intersection is a vertex. find all faces at vertex
+      fronts[i] = query.get_vertex_faces(v_idx);
     }
     // if not found, check edges
     if (!fronts[i].size()) {
-      // edges need to exist
-      vector<vector<int>> edges;
-      geom.get_impl_edges(edges);
-      for (unsigned int j = 0; j < edges.size(); j++) {
-        int v1 = edges[j][0];
-        int v2 = edges[j][1];
-        // if (lines_intersection(axes_verts[i], cent, verts[v1], verts[v2],
-        // opts.epsilon).is_set()) {
-        if (segments_intersection(axes_verts[i], cent, verts[v1], verts[v2],
-                                  opts.epsilon)
-                .is_set()) {
-          // intersection is an edge
-          fronts[i] = find_faces_with_edge(faces, make_edge(v1, v2));
-          break;
-        }
+      int e_idx = query.find_edge(axes_verts[i], cent);
+      if (e_idx >= 0) {
+        // intersection is an edge
+        fronts[i] = query.get_edge_faces(e_idx);
       }
     }
-    // if not found, find if axis passes through a face centroid
+    // if not found, find if axis passes through a face
     if (!fronts[i].size()) {
-      for (unsigned int j = 0; j < faces.size(); j++) {
-        // for (unsigned int j = 0; j < 1; j++) {
-        Vec3d face_normal = geom.face_norm(j).unit();
-        Vec3d face_centroid = geom.face_cent(j);
-        // make sure face_normal points outward
-        if (vdot(face_normal, face_centroid) < 0)
-          face_normal *= -1.0;
-
-        int where = 0;
-        int *w = &where;
-        Vec3d P = line_plane_intersect(face_centroid, face_normal,
-                                       axes_verts[i], cent, w, opts.epsilon);
-
-        // if point is on axis
-        if (point_in_segment(P, axes_verts[i], cent, opts.epsilon).is_set()) {
-          // get winding number, if not zero, point is on a polygon
-          vector<int> face_idxs;
-          face_idxs.push_back(j);
-          Geometry polygon = faces_to_geom(geom, face_idxs);
-          Normal normal(polygon, face_normal, 0, cent, opts.epsilon);
-          vector<Vec3d> one_point;
-          one_point.push_back(P);
-          int winding_number = get_winding_number_polygon(
-              polygon, one_point, normal, true, opts.epsilon);
-          if (winding_number) {
-            fronts[i].push_back(j);
-            break;
-          }
-        }
-      }
+      int f_idx = query.find_face(axes_verts[i], cent);
+      if (f_idx >= 0)
+        fronts[i].push_back(f_idx);
     }
 
     if (fronts[i].size())
@@ -567,6 +525,12 @@ void radial_coloring(Geometry &geom, map<int, vector<int>> &fronts)
   // clear all colors
   geom.colors(FACES).clear();
 
+  // faces at each vertex, found once rather than searching all faces
+  vector<vector<int>> vert_faces(geom.verts().size());
+  for (unsigned int i = 0; i < geom.faces().size(); i++)
+    for (int v_idx : geom.faces(i))
+      vert_faces[v_idx].push_back(i);
+
   int ridge = 0;
   bool found = true;
 
@@ -585,22 +549,10 @@ void radial_coloring(Geometry &geom, map<int, vector<int>> &fronts)
           geom.colors(FACES).set(front[i], ridge);
 
         // get faces connected to this face via edge or vertex
-        vector<int> face_idx;
-        vector<int> face = geom.faces()[front[i]];
-        int fsz = face.size();
-        for (int j = 0; j < fsz; j++) {
-          int v1 = face[j];
-          int v2 = face[(j + 1) % fsz];
-          // face_idx = find_faces_with_edge(geom.faces(), make_edge(v1, v2));
-          // adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-          //                      face_idx.end());
-          face_idx = find_faces_with_vertex(geom.faces(), v1);
-          adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-                                face_idx.end());
-          face_idx = find_faces_with_vertex(geom.faces(), v2);
-          adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-                                face_idx.end());
-        }
+        for (int v_idx : geom.faces(front[i]))
+          adjacent_faces.insert(adjacent_faces.end(),
+                                vert_faces[v_idx].begin(),
+                                vert_faces[v_idx].end());
       }
 
       // make list unique
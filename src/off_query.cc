@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "batch.h"
 #include "rep_print.h"
 
 using std::pair;
@@ -58,19 +59,25 @@ public:
   vector<int> idxs;
   int sig_digits;
   string query;
+  vector<void (rep_printer::*)(int)> query_items;
+  unsigned int query_props;
+  vector<pair<char, string>> elem_args;
   bool orient;
   char edge_type;
+  int num_threads;
+  BatchOpts batch;
   string ifile;
   string ofile;
 
   oq_opts()
       : ProgramOpts("off_query"), center(Vec3d(0, 0, 0)),
-        center_is_centroid(false), sig_digits(17), orient(true), edge_type('a')
+        center_is_centroid(false), sig_digits(17), query_props(0),
+        orient(true), edge_type('a'), num_threads(0)
   {
   }
 
   void process_command_line(int argc, char **argv);
-  void post_process_command_line(int argc, char **argv, Geometry &geom);
+  Status set_query_elems();
   void usage();
 };
 
@@ -79,9 +86,11 @@ void oq_opts::usage()
 {
    fprintf(stdout,
 "\n"
-"Usage: %s [options] query [input_file]\n"
+"Usage: %s [options] query [input_file ...]\n"
 "\n"
 "Read a file in OFF format and list element data for specified elements.\n"
+"In batch mode each input file is queried separately, and the element data\n"
+"is written as a record for each file, with a value for each element.\n"
 "Added elements of the query type are also added to the query list.\n"
 "Added elements are referred to by xN, where N is the order the element\n"
 "was added (starting with 0). Query is a list of letters, the first is the\n"
@@ -124,8 +133,12 @@ void oq_opts::usage()
 "  -o <file> write output to file (default: write to standard output)\n"
 "  -d <dgts> number of significant digits (default 17) or if negative\n"
 "            then the number of digits after the decimal point\n"
+"  -j <num>  number of values to calculate at the same time, or in batch\n"
+"            mode the number of files to process at the same time (default:\n"
+"            number of hardware threads, or $ANTIPRISM_THREADS if set)\n"
+"%s"
 "\n"
-"\n", prog_name(), help_ver_text);
+"\n", prog_name(), help_ver_text, batch_help_text);
 }
 // clang-format on
 
@@ -137,164 +150,11 @@ void add_to_list(vector<int> &list, vector<int> &to_add)
   list.erase(li, list.end());
 }
 
-void oq_opts::process_command_line(int argc, char **argv)
+// Set the query items and the values they need
+void vertex_query_items(oq_opts &opts)
 {
-  opterr = 0;
-  int c;
-  vector<pair<char, char *>> args;
-
-  handle_long_opts(argc, argv);
-
-  while ((c = getopt(argc, argv, ":hc:I:v:f:e:kE:o:d:")) != -1) {
-    if (common_opts(c, optopt))
-      continue;
-
-    switch (c) {
-    case 'E':
-      if (strlen(optarg) != 1 || !strchr("eia", *optarg))
-        error("reporting edge type must be e, i or a");
-      edge_type = *optarg;
-      break;
-
-    default:
-      args.push_back(pair<char, char *>(c, optarg));
-    }
-  }
-
-  if (argc - optind < 1)
-    error("must give a query");
-
-  if (!strchr("VEF", *argv[optind]))
-    error("the first letter of the query must be V, E or F");
-  query = argv[optind++];
-
-  if (argc - optind == 1)
-    ifile = argv[optind];
-
-  read_or_error(geom, ifile);
-
-  if (edge_type == 'a')
-    geom.add_missing_impl_edges();
-  else if (edge_type == 'i') {
-    geom.clear(EDGES);
-    geom.add_missing_impl_edges();
-  }
-
-  vector<int> idx_list;
-  vector<int> edge(2);
-  Vec3d vec;
-  int max_elem_sz;
-  if (query[0] == 'V')
-    max_elem_sz = geom.verts().size();
-  else if (query[0] == 'E')
-    max_elem_sz = geom.edges().size();
-  else
-    max_elem_sz = geom.faces().size();
-
-  for (auto &arg : args) {
-    c = arg.first;
-    char *optarg = arg.second;
-    switch (c) {
-    case 'c':
-      if (strcmp(optarg, "C") == 0)
-        center_is_centroid = true;
-      else
-        print_status_or_exit(center.read(optarg), c);
-      break;
-
-    case 'I':
-      print_status_or_exit(read_idx_list(optarg, idx_list, max_elem_sz, false),
-                           c);
-      if (!idx_list.size())
-        warning("file contains no elements of this query type", c);
-      add_to_list(idxs, idx_list);
-      break;
-
-    case 'v':
-      print_status_or_exit(vec.read(optarg), c);
-      extra_verts.push_back(vec);
-      break;
-
-    case 'f':
-      print_status_or_exit(
-          read_idx_list(optarg, idx_list, geom.verts().size(), true), c);
-      extra_faces.push_back(idx_list);
-      break;
-
-    case 'e':
-      print_status_or_exit(
-          read_idx_list(optarg, idx_list, geom.verts().size(), true), c);
-      if (!is_even(idx_list.size()))
-        error("odd number of vertex index numbers", c);
-      for (unsigned int i = 0; i < idx_list.size() / 2; i++) {
-        edge[0] = idx_list[2 * i];
-        edge[1] = idx_list[2 * i + 1];
-        extra_edges.push_back(edge);
-      }
-      break;
-
-    case 'k':
-      orient = false;
-      break;
-
-    case 'd':
-      print_status_or_exit(read_int(optarg, &sig_digits), c);
-      break;
-
-    case 'o':
-      ofile = optarg;
-      break;
-
-    default:
-      error("unknown command line error");
-    }
-  }
-
-  int query_elems_added;
-  if (query[0] == 'V')
-    query_elems_added = extra_verts.size();
-  else if (query[0] == 'E')
-    query_elems_added = extra_edges.size();
-  else
-    query_elems_added = extra_faces.size();
-
-  idx_list.resize(query_elems_added);
-  for (int i = 0; i < query_elems_added; i++)
-    idx_list[i] = max_elem_sz + i;
-  add_to_list(idxs, idx_list);
-
-  int total_verts = geom.verts().size() + extra_verts.size();
-  for (auto &extra_face : extra_faces)
-    for (int j : extra_face)
-      if (j > total_verts - 1)
-        error(msg_str("extra face vertex x%d out of range",
-                      j - (int)geom.verts().size()),
-              'f');
-
-  for (auto &extra_edge : extra_edges)
-    for (int j : extra_edge)
-      if (j > total_verts - 1)
-        error(msg_str("extra edge vertex x%d out of range",
-                      j - (int)geom.verts().size()),
-              'e');
-
-  int total_elems = max_elem_sz + query_elems_added;
-  for (int idx : idxs)
-    if (idx > total_elems - 1)
-      error(msg_str("index x%d out of range", idx - max_elem_sz), 'I');
-
-  if (!idxs.size()) { // default, process all if none specified
-    char all[MSG_SZ] = "-";
-    read_idx_list(all, idx_list, max_elem_sz, false);
-    add_to_list(idxs, idx_list);
-  }
-  if (!idxs.size()) // default, process all if none specified
-    error("no elements of the query type are in the geometry or were added");
-}
-
-void vertex_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
-{
-  vector<void (rep_printer::*)(int)> query_items;
+  unsigned int &props = opts.query_props;
+  vector<void (rep_printer::*)(int)> &query_items = opts.query_items;
   query_items.push_back(&rep_printer::v_index);
   for (unsigned int i = 1; i < opts.query.size(); i++) {
     switch (opts.query[i]) {
@@ -309,18 +169,23 @@ void vertex_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
       break;
     case 'a':
       query_items.push_back(&rep_printer::v_solid_angle);
+      props |= GeometryInfo::PROP_SOLID_ANGLES;
       break;
     case 'o':
       query_items.push_back(&rep_printer::v_order);
+      props |= GeometryInfo::PROP_VERT_FIGS;
       break;
     case 'F':
       query_items.push_back(&rep_printer::v_angles);
+      props |= GeometryInfo::PROP_PLANE_ANGLES;
       break;
     case 'n':
       query_items.push_back(&rep_printer::v_neighbours);
+      props |= GeometryInfo::PROP_VERT_FIGS;
       break;
     case 'g':
       query_items.push_back(&rep_printer::v_figure);
+      props |= GeometryInfo::PROP_VERT_FIGS;
       break;
     case 'K':
       query_items.push_back(&rep_printer::v_color);
@@ -330,20 +195,13 @@ void vertex_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
                  "V query");
     }
   }
-
-  for (int idx : opts.idxs) {
-    for (unsigned int j = 0; j < query_items.size(); j++) {
-      if (j)
-        fprintf(ofile, ",");
-      (rep.*query_items[j])(idx);
-    }
-    fprintf(ofile, "\n");
-  }
 }
 
-void edge_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
+// Set the query items and the values they need
+void edge_query_items(oq_opts &opts)
 {
-  vector<void (rep_printer::*)(int)> query_items;
+  unsigned int &props = opts.query_props;
+  vector<void (rep_printer::*)(int)> &query_items = opts.query_items;
   query_items.push_back(&rep_printer::e_index);
   for (unsigned int i = 1; i < opts.query.size(); i++) {
     switch (opts.query[i]) {
@@ -355,6 +213,7 @@ void edge_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
       break;
     case 'a':
       query_items.push_back(&rep_printer::e_dihedral_angle);
+      props |= GeometryInfo::PROP_DIHEDRAL_ANGLES;
       break;
     case 'c':
       query_items.push_back(&rep_printer::e_central_angle);
@@ -379,20 +238,13 @@ void edge_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
                  "E query");
     }
   }
-
-  for (int idx : opts.idxs) {
-    for (unsigned int j = 0; j < query_items.size(); j++) {
-      if (j)
-        fprintf(ofile, ",");
-      (rep.*query_items[j])(idx);
-    }
-    fprintf(ofile, "\n");
-  }
 }
 
-void face_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
+// Set the query items and the values they need
+void face_query_items(oq_opts &opts)
 {
-  vector<void (rep_printer::*)(int)> query_items;
+  unsigned int &props = opts.query_props;
+  vector<void (rep_printer::*)(int)> &query_items = opts.query_items;
   query_items.push_back(&rep_printer::f_index);
   for (unsigned int i = 1; i < opts.query.size(); i++) {
     switch (opts.query[i]) {
@@ -416,6 +268,7 @@ void face_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
       break;
     case 'A':
       query_items.push_back(&rep_printer::f_area);
+      props |= GeometryInfo::PROP_FACE_AREAS;
       break;
     case 'C':
       query_items.push_back(&rep_printer::f_centroid);
@@ -425,9 +278,11 @@ void face_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
       break;
     case 'p':
       query_items.push_back(&rep_printer::f_max_nonplanar);
+      props |= GeometryInfo::PROP_FACE_SHAPES;
       break;
     case 'P':
       query_items.push_back(&rep_printer::f_perimeter);
+      props |= GeometryInfo::PROP_FACE_SHAPES;
       break;
     case 'K':
       query_items.push_back(&rep_printer::f_color);
@@ -438,36 +293,220 @@ void face_query(FILE *ofile, rep_printer &rep, oq_opts &opts)
       opts.error(str, "F query");
     }
   }
+}
 
-  for (int idx : opts.idxs) {
-    for (unsigned int j = 0; j < query_items.size(); j++) {
-      if (j)
-        fprintf(ofile, ",");
-      (rep.*query_items[j])(idx);
+void oq_opts::process_command_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hc:I:v:f:e:kE:o:d:j:b:L:G:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'c':
+      if (strcmp(optarg, "C") == 0)
+        center_is_centroid = true;
+      else
+        print_status_or_exit(center.read(optarg), c);
+      break;
+
+    case 'E':
+      if (strlen(optarg) != 1 || !strchr("eia", *optarg))
+        error("reporting edge type must be e, i or a");
+      edge_type = *optarg;
+      break;
+
+    case 'k':
+      orient = false;
+      break;
+
+    case 'd':
+      print_status_or_exit(read_int(optarg, &sig_digits), c);
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    case 'b':
+      print_status_or_exit(batch.read_format(optarg), c);
+      break;
+
+    case 'L':
+      print_status_or_exit(batch.add_list(optarg), c);
+      break;
+
+    case 'G':
+      print_status_or_exit(batch.add_glob(optarg), c);
+      break;
+
+    case 'I':
+    case 'v':
+    case 'f':
+    case 'e':
+      // processed for each model, as they depend on its elements
+      elem_args.push_back(pair<char, string>(c, optarg));
+      break;
+
+    default:
+      error("unknown command line error");
     }
-    fprintf(ofile, "\n");
   }
+
+  if (argc - optind < 1)
+    error("must give a query");
+
+  if (!strchr("VEF", *argv[optind]))
+    error("the first letter of the query must be V, E or F");
+  query = argv[optind++];
+
+  if (query[0] == 'V')
+    vertex_query_items(*this);
+  else if (query[0] == 'E')
+    edge_query_items(*this);
+  else
+    face_query_items(*this);
+
+  if (batch.enabled) {
+    while (argc - optind)
+      batch.ifiles.push_back(argv[optind++]);
+    if (!batch.ifiles.size())
+      error("no input files for batch mode");
+    batch.num_threads = num_threads;
+  }
+  else if (argc - optind == 1)
+    ifile = argv[optind];
 }
 
-int main(int argc, char *argv[])
+// Set the elements to query and the elements to add, from the options
+// that refer to elements of the model
+Status oq_opts::set_query_elems()
 {
-  oq_opts opts;
-  opts.process_command_line(argc, argv);
-  Geometry &geom = opts.geom;
+  Status stat;
+  Status warn_stat;
+  if (edge_type == 'a')
+    geom.add_missing_impl_edges();
+  else if (edge_type == 'i') {
+    geom.clear(EDGES);
+    geom.add_missing_impl_edges();
+  }
 
-  if (opts.center_is_centroid)
-    opts.center = geom.centroid();
+  vector<int> idx_list;
+  vector<int> edge(2);
+  Vec3d vec;
+  int max_elem_sz;
+  if (query[0] == 'V')
+    max_elem_sz = geom.verts().size();
+  else if (query[0] == 'E')
+    max_elem_sz = geom.edges().size();
+  else
+    max_elem_sz = geom.faces().size();
 
-  FILE *ofile = stdout; // write to stdout by default
-  if (opts.ofile != "") {
-    ofile = fopen(opts.ofile.c_str(), "w");
-    if (ofile == nullptr)
-      opts.error("could not open output file '%s'", opts.ofile.c_str());
+  for (auto &arg : elem_args) {
+    char c = arg.first;
+    string arg_str = arg.second; // the argument may be modified
+    char *optarg = &arg_str[0];
+    switch (c) {
+    case 'I':
+      if (!(stat = read_idx_list(optarg, idx_list, max_elem_sz, false)))
+        return Status::error(opt_msg(c, stat.msg()));
+      if (!idx_list.size())
+        warn_stat.set_warning(
+            opt_msg(c, "file contains no elements of this query type"));
+      add_to_list(idxs, idx_list);
+      break;
+
+    case 'v':
+      if (!(stat = vec.read(optarg)))
+        return Status::error(opt_msg(c, stat.msg()));
+      extra_verts.push_back(vec);
+      break;
+
+    case 'f':
+      if (!(stat = read_idx_list(optarg, idx_list, geom.verts().size(), true)))
+        return Status::error(opt_msg(c, stat.msg()));
+      extra_faces.push_back(idx_list);
+      break;
+
+    case 'e':
+      if (!(stat = read_idx_list(optarg, idx_list, geom.verts().size(), true)))
+        return Status::error(opt_msg(c, stat.msg()));
+      if (!is_even(idx_list.size()))
+        return Status::error(opt_msg(c, "odd number of vertex index numbers"));
+      for (unsigned int i = 0; i < idx_list.size() / 2; i++) {
+        edge[0] = idx_list[2 * i];
+        edge[1] = idx_list[2 * i + 1];
+        extra_edges.push_back(edge);
+      }
+      break;
+    }
+  }
+
+  int query_elems_added;
+  if (query[0] == 'V')
+    query_elems_added = extra_verts.size();
+  else if (query[0] == 'E')
+    query_elems_added = extra_edges.size();
+  else
+    query_elems_added = extra_faces.size();
+
+  idx_list.resize(query_elems_added);
+  for (int i = 0; i < query_elems_added; i++)
+    idx_list[i] = max_elem_sz + i;
+  add_to_list(idxs, idx_list);
+
+  int total_verts = geom.verts().size() + extra_verts.size();
+  for (auto &extra_face : extra_faces)
+    for (int j : extra_face)
+      if (j > total_verts - 1)
+        return Status::error(
+            opt_msg('f', msg_str("extra face vertex x%d out of range",
+                                 j - (int)geom.verts().size())));
+
+  for (auto &extra_edge : extra_edges)
+    for (int j : extra_edge)
+      if (j > total_verts - 1)
+        return Status::error(
+            opt_msg('e', msg_str("extra edge vertex x%d out of range",
+                                 j - (int)geom.verts().size())));
+
+  int total_elems = max_elem_sz + query_elems_added;
+  for (int idx : idxs)
+    if (idx > total_elems - 1)
+      return Status::error(
+          opt_msg('I', msg_str("index x%d out of range", idx - max_elem_sz)));
+
+  if (!idxs.size()) { // default, process all if none specified
+    char all[MSG_SZ] = "-";
+    read_idx_list(all, idx_list, max_elem_sz, false);
+    add_to_list(idxs, idx_list);
   }
+  if (!idxs.size()) // default, process all if none specified
+    return Status::error(
+        "no elements of the query type are in the geometry or were added");
 
+  return warn_stat;
+}
+
+// Write the query values for each query element, or if vals is set then
+// add them to vals, keyed by the element letter and index number
+void write_query(FILE *ofile, oq_opts &opts, int num_threads,
+                 vector<pair<string, string>> *vals = nullptr)
+{
+  Geometry &geom = opts.geom;
   rep_printer rep(geom, ofile);
   rep.set_sig_dgts(opts.sig_digits);
-  rep.set_center(opts.center);
+  rep.set_center(opts.center_is_centroid ? geom.centroid() : opts.center);
   rep.is_oriented(); // set oriented value before orienting
   if (opts.orient) {
     geom.orient();
@@ -475,11 +514,8 @@ int main(int argc, char *argv[])
       geom.orient_reverse();
   }
 
-  // print_ranges(rep, opts);
-
   for (auto &extra_vert : opts.extra_verts)
     geom.add_vert(extra_vert);
-  vector<int> edge(2);
   for (auto &extra_edge : opts.extra_edges)
     geom.add_edge_raw(extra_edge);
   for (auto &extra_face : opts.extra_faces)
@@ -487,17 +523,85 @@ int main(int argc, char *argv[])
   rep.extra_elems_added(opts.extra_verts.size(), opts.extra_edges.size(),
                         opts.extra_faces.size());
 
-  switch (opts.query[0]) {
-  case 'V':
-    vertex_query(ofile, rep, opts);
-    break;
-  case 'E':
-    edge_query(ofile, rep, opts);
-    break;
-  case 'F':
-    face_query(ofile, rep, opts);
-    break;
+  rep.compute(opts.query_props, num_threads);
+
+  string line;
+  if (vals)
+    rep.set_item_value(&line);
+  for (int idx : opts.idxs) {
+    for (unsigned int j = 0; j < opts.query_items.size(); j++) {
+      if (j)
+        rep.put_item(",");
+      (rep.*opts.query_items[j])(idx);
+    }
+    if (vals) {
+      // the first item is the index number
+      size_t pos = line.find(',');
+      vals->push_back(std::make_pair(
+          opts.query.substr(0, 1) + line.substr(0, pos),
+          (pos != string::npos) ? line.substr(pos + 1) : string()));
+      line.clear();
+    }
+    else
+      fprintf(ofile, "\n");
   }
+}
+
+// Query one file of a batch, adding the values for each element to the
+// record, keyed by the element letter and index number
+void batch_query(const oq_opts &opts, const string &ifile, BatchRecord &rec)
+{
+  oq_opts file_opts = opts; // the query elements depend on the model
+  Status stat = file_opts.geom.read(ifile);
+  if (stat.is_error()) {
+    rec.stat = stat;
+    return;
+  }
+  else if (stat.is_warning())
+    rec.warnings.push_back(stat.msg());
+
+  stat = file_opts.set_query_elems();
+  if (stat.is_error()) {
+    rec.stat = stat;
+    return;
+  }
+  else if (stat.is_warning())
+    rec.warnings.push_back(stat.msg());
+
+  vector<pair<string, string>> vals;
+  write_query(nullptr, file_opts, 1, &vals);
+  for (const auto &val : vals)
+    rec.add(val.first, val.second);
+}
+
+int main(int argc, char *argv[])
+{
+  oq_opts opts;
+  opts.process_command_line(argc, argv);
+
+  if (!opts.batch.enabled) {
+    opts.read_or_error(opts.geom, opts.ifile);
+    opts.print_status_or_exit(opts.set_query_elems());
+  }
+
+  FILE *ofile = stdout; // write to stdout by default
+  if (opts.ofile != "") {
+    ofile = fopen(opts.ofile.c_str(), "w");
+    if (ofile == nullptr)
+      opts.error("could not open output file '%s'", opts.ofile.c_str());
+  }
+
+  if (opts.batch.enabled) {
+    int num_failed = run_batch(opts, opts.batch, ofile,
+                               [&](const string &ifile, BatchRecord &rec) {
+                                 batch_query(opts, ifile, rec);
+                               });
+    if (opts.ofile != "")
+      fclose(ofile);
+    return (num_failed > 0);
+  }
+
+  write_query(ofile, opts, opts.num_threads);
 
   if (opts.ofile == "")
     fclose(ofile);
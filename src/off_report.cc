@@ -37,8 +37,10 @@
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "batch.h"
 #include "rep_print.h"
 
+using std::pair;
 using std::set;
 using std::string;
 using std::vector;
@@ -56,13 +58,17 @@ public:
   bool detect_symmetry;
   string sub_sym;
   char edge_type;
+  int num_threads;
+  bool print_times;
+  BatchOpts batch;
   string ifile;
   string ofile;
 
   or_opts()
       : ProgramOpts("off_report"), center(Vec3d(0, 0, 0)),
         center_is_centroid(false), sig_digits(17), orient(true),
-        detect_symmetry(false), edge_type('a')
+        detect_symmetry(false), edge_type('a'), num_threads(0),
+        print_times(false)
   {
   }
 
@@ -75,9 +81,12 @@ void or_opts::usage()
 {
    fprintf(stdout,
 "\n"
-"Usage: %s [options] [input_file]\n"
+"Usage: %s [options] [input_file ...]\n"
 "\n"
-"Read a file in OFF format and generate a report\n"
+"Read a file in OFF format and generate a report. In batch mode each input\n"
+"file is reported separately, and the report values are written as a record\n"
+"for each file. In CSV records the entries of a count section, or of the\n"
+"symmetry axes and subgroups, are written together in a single column\n"
 "\n"
 "Options\n"
 "%s"
@@ -88,6 +97,7 @@ void or_opts::usage()
 "            F - faces                   E - edges\n"
 "            S - solid angles            a - plane angles\n"
 "            D - distances (min/max)     s - symmetry\n"
+"            I - intersecting faces\n"
 "  -C <vals> Print counts of values, given as a list of letters\n"
 "            A - all                     F - faces type by angles\n"
 "            E - edge lengths            w - windings\n"
@@ -103,8 +113,14 @@ void or_opts::usage()
 "  -o <file> write output to file (default: write to standard output)\n"
 "  -d <dgts> number of significant digits (default 17) or if negative\n"
 "            then the number of digits after the decimal point\n"
+"  -j <num>  number of values to calculate at the same time, or in batch\n"
+"            mode the number of files to process at the same time (default:\n"
+"            number of hardware threads, or $ANTIPRISM_THREADS if set)\n"
+"  -t        print the time taken to calculate each group of values (to\n"
+"            standard error)\n"
+"%s"
 "\n"
-"\n", prog_name(), help_ver_text);
+"\n", prog_name(), help_ver_text, batch_help_text);
 }
 // clang-format on
 
@@ -115,7 +131,7 @@ void or_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hc:S:C:kE:y:o:d:")) != -1) {
+  while ((c = getopt(argc, argv, ":hc:S:C:kE:y:o:d:j:tb:L:G:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -128,7 +144,7 @@ void or_opts::process_command_line(int argc, char **argv)
       break;
 
     case 'S': {
-      const char *all_section_letters = "AGFEaSsD";
+      const char *all_section_letters = "AGFEaSsDI";
       size_t len;
       if ((len = strspn(optarg, all_section_letters)) == strlen(optarg)) {
         if (strchr(optarg, 'A'))
@@ -190,6 +206,28 @@ void or_opts::process_command_line(int argc, char **argv)
       print_status_or_exit(read_int(optarg, &sig_digits), c);
       break;
 
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
+    case 't':
+      print_times = true;
+      break;
+
+    case 'b':
+      print_status_or_exit(batch.read_format(optarg), c);
+      break;
+
+    case 'L':
+      print_status_or_exit(batch.add_list(optarg), c);
+      break;
+
+    case 'G':
+      print_status_or_exit(batch.add_glob(optarg), c);
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -199,11 +237,22 @@ void or_opts::process_command_line(int argc, char **argv)
     }
   }
 
-  if (argc - optind > 1)
-    error("too many arguments");
+  if (batch.enabled) {
+    while (argc - optind)
+      batch.ifiles.push_back(argv[optind++]);
+    if (!batch.ifiles.size())
+      error("no input files for batch mode");
+    if (print_times)
+      warning("times are not printed in batch mode", 't');
+    batch.num_threads = num_threads;
+  }
+  else {
+    if (argc - optind > 1)
+      error("too many arguments");
 
-  if (argc - optind == 1)
-    ifile = argv[optind];
+    if (argc - optind == 1)
+      ifile = argv[optind];
+  }
 
   if (sections == "" && counts == "") {
     warning("no print options set, setting option -S G");
@@ -211,7 +260,67 @@ void or_opts::process_command_line(int argc, char **argv)
   }
 }
 
-void print_sections(rep_printer &rep, const char *sections)
+// groups of values needed to print the sections and counts
+unsigned int get_props(const char *sections, const char *counts)
+{
+  unsigned int props = 0;
+  for (const char *c = sections; *c; c++) {
+    switch (*c) {
+    case 'G':
+      props |= GeometryInfo::PROP_CONNECTIVITY | GeometryInfo::PROP_FACE_AREAS;
+      break;
+    case 'F':
+      props |= GeometryInfo::PROP_FACE_AREAS | GeometryInfo::PROP_FACE_SHAPES;
+      break;
+    case 'E':
+      props |= GeometryInfo::PROP_EDGE_LENGTHS;
+      break;
+    case 'a':
+      props |= GeometryInfo::PROP_PLANE_ANGLES;
+      break;
+    case 'S':
+      props |= GeometryInfo::PROP_DIHEDRAL_ANGLES |
+               GeometryInfo::PROP_SOLID_ANGLES;
+      break;
+    case 'D':
+      props |= GeometryInfo::PROP_DISTANCES;
+      break;
+    case 's':
+      props |= GeometryInfo::PROP_SYMMETRY;
+      break;
+    }
+  }
+
+  for (const char *c = counts; *c; c++) {
+    switch (*c) {
+    case 'F':
+      props |= GeometryInfo::PROP_PLANE_ANGLES;
+      break;
+    case 'w':
+      props |= GeometryInfo::PROP_FACE_WINDINGS | GeometryInfo::PROP_VERT_FIGS;
+      break;
+    case 'E':
+      props |= GeometryInfo::PROP_EDGE_LENGTHS;
+      break;
+    case 'D':
+      props |= GeometryInfo::PROP_DIHEDRAL_ANGLES;
+      break;
+    case 'S':
+      props |= GeometryInfo::PROP_SOLID_ANGLES;
+      break;
+    case 'o':
+      props |= GeometryInfo::PROP_VERT_FIGS;
+      break;
+    case 'O':
+      props |= GeometryInfo::PROP_SYMMETRY;
+      break;
+    }
+  }
+
+  return props;
+}
+
+void print_sections(rep_printer &rep, const char *sections, int num_threads)
 {
   for (const char *c = sections; *c; c++) {
     switch (*c) {
@@ -238,6 +347,9 @@ void print_sections(rep_printer &rep, const char *sections)
     case 's':
       rep.symmetry();
       break;
+    case 'I':
+      rep.intersections_sec(num_threads);
+      break;
     }
   }
 }
@@ -282,14 +394,107 @@ void print_counts(rep_printer &rep, const char *counts)
   }
 }
 
-int main(int argc, char *argv[])
+// CSV columns for the sections and counts, in the order they are reported.
+// The entries of a count section are joined, and have a single column.
+vector<string> get_csv_cols(const char *sections, const char *counts)
 {
-  or_opts opts;
-  opts.process_command_line(argc, argv);
+  vector<string> cols;
+  auto add_cols = [&](const string &sec, const vector<string> &names) {
+    for (const auto &name : names)
+      cols.push_back(sec + "." + name);
+  };
 
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
+  for (const char *c = sections; *c; c++) {
+    switch (*c) {
+    case 'G':
+      add_cols("general",
+               {"num_verts", "num_faces", "num_edges", "vertex_centroid",
+                "volume_centroid", "oriented", "orientable", "connectivity",
+                "num_parts", "genus", "area", "volume"});
+      break;
+    case 'F':
+      add_cols("faces", {"num_faces", "area", "face_area_max",
+                         "face_area_min", "face_area_avg", "volume",
+                         "isoperimetric_quotient", "maximum_nonplanarity",
+                         "average_nonplanarity"});
+      break;
+    case 'E':
+      add_cols("edges", {"num_edges", "perimeter", "edge_length_max",
+                         "edge_length_min", "edge_length_avg"});
+      break;
+    case 'a':
+      add_cols("angles",
+               {"angle_max", "angle_min", "angle_avg", "angle_defect"});
+      break;
+    case 'S':
+      add_cols("solid_angles",
+               {"dihed_angle_max", "dihed_angle_min", "dihed_angle_flattest",
+                "solid_angle_max", "solid_angle_min"});
+      break;
+    case 'D':
+      add_cols("distances",
+               {"given_center", "vert_min", "vert_max", "vert_avg",
+                "face_min", "face_max", "face_avg", "edge_min", "edge_max",
+                "edge_avg"});
+      break;
+    case 's':
+      add_cols("symmetry", {"type", "realignments", "alignment_to_std"});
+      cols.push_back("symmetry_axes");
+      cols.push_back("symmetry_subgroups_nonconjugate");
+      break;
+    case 'I':
+      add_cols("intersections", {"num_intersecting_pairs",
+                                 "intersecting_faces", "first_pair"});
+      break;
+    }
+  }
+
+  for (const char *c = counts; *c; c++) {
+    switch (*c) {
+    case 'F':
+      cols.push_back("face_angles_cnts");
+      break;
+    case 'w':
+      cols.push_back("face_windings_cnts unsigned");
+      cols.push_back("face_windings_cnts signed");
+      cols.push_back("vertex_figure_windings_cnts signed");
+      break;
+    case 'E':
+      cols.push_back("edge_lengths_cnts");
+      break;
+    case 'D':
+      cols.push_back("dihedral_angles_cnts");
+      break;
+    case 'e':
+      cols.push_back("edge_faces_cnts");
+      break;
+    case 'S':
+      cols.push_back("solid_angles_cnts");
+      break;
+    case 's':
+      cols.push_back("face_sides_cnts");
+      break;
+    case 'o':
+      cols.push_back("vert_order_cnts");
+      break;
+    case 'h':
+      cols.push_back("vert_heights_cnts");
+      break;
+    case 'O':
+      cols.push_back("sym_orbit_cnts");
+      break;
+    }
+  }
+
+  return cols;
+}
 
+// Write the report for a model, the only error is an invalid subsymmetry.
+// If vals is set the report values are added to it instead.
+Status write_report(const or_opts &opts, Geometry &geom, FILE *ofile,
+                    int num_threads,
+                    vector<pair<string, string>> *vals = nullptr)
+{
   if (opts.edge_type == 'a')
     geom.add_missing_impl_edges();
   else if (opts.edge_type == 'i') {
@@ -297,22 +502,13 @@ int main(int argc, char *argv[])
     geom.add_missing_impl_edges();
   }
 
-  if (opts.center_is_centroid)
-    opts.center = geom.centroid();
-
-  FILE *ofile = stdout; // write to stdout by default
-  if (opts.ofile != "") {
-    ofile = fopen(opts.ofile.c_str(), "w");
-    if (ofile == nullptr)
-      opts.error("could not open output file '" + opts.ofile + "'");
-  }
-
   rep_printer rep(geom, ofile);
   rep.set_sig_dgts(opts.sig_digits);
-  rep.set_center(opts.center);
+  rep.set_values(vals, opts.batch.format == 'c');
+  rep.set_center(opts.center_is_centroid ? geom.centroid() : opts.center);
 
   if (opts.detect_symmetry && !rep.set_sub_symmetry(opts.sub_sym))
-    opts.error(("could not set subsymmetry: " + opts.sub_sym).c_str(), 'y');
+    return Status::error("could not set subsymmetry: " + opts.sub_sym);
 
   rep.is_oriented(); // set oriented value before orienting
   if (opts.orient) {
@@ -321,9 +517,67 @@ int main(int argc, char *argv[])
       geom.orient_reverse();
   }
 
-  print_sections(rep, opts.sections.c_str());
+  // find the values before printing, the groups are found concurrently
+  rep.compute(get_props(opts.sections.c_str(), opts.counts.c_str()),
+              num_threads);
+  if (opts.print_times && !opts.batch.enabled)
+    for (const auto &kp : rep.get_compute_times())
+      fprintf(stderr, "%s: %.3fs\n", GeometryInfo::get_prop_name(kp.first),
+              kp.second);
+
+  print_sections(rep, opts.sections.c_str(), num_threads);
   print_counts(rep, opts.counts.c_str());
 
+  return Status::ok();
+}
+
+// Report on one file of a batch, the report values are added to the record
+void batch_report(const or_opts &opts, const string &ifile,
+                  BatchRecord &rec)
+{
+  Geometry geom;
+  Status stat = geom.read(ifile);
+  if (stat.is_error()) {
+    rec.stat = stat;
+    return;
+  }
+  else if (stat.is_warning())
+    rec.warnings.push_back(stat.msg());
+
+  rec.stat = write_report(opts, geom, nullptr, 1, &rec.values);
+}
+
+int main(int argc, char *argv[])
+{
+  or_opts opts;
+  opts.process_command_line(argc, argv);
+
+  Geometry geom;
+  if (!opts.batch.enabled)
+    opts.read_or_error(geom, opts.ifile);
+
+  FILE *ofile = stdout; // write to stdout by default
+  if (opts.ofile != "") {
+    ofile = fopen(opts.ofile.c_str(), "w");
+    if (ofile == nullptr)
+      opts.error("could not open output file '" + opts.ofile + "'");
+  }
+
+  if (opts.batch.enabled) {
+    opts.batch.csv_cols =
+        get_csv_cols(opts.sections.c_str(), opts.counts.c_str());
+    int num_failed = run_batch(opts, opts.batch, ofile,
+                               [&](const string &ifile, BatchRecord &rec) {
+                                 batch_report(opts, ifile, rec);
+                               });
+    if (opts.ofile != "")
+      fclose(ofile);
+    return (num_failed > 0);
+  }
+
+  opts.print_status_or_exit(
+      write_report(opts, geom, ofile, opts.num_threads), 'y');
+
   if (opts.ofile == "")
     fclose(ofile);
 
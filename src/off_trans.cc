@@ -28,6 +28,7 @@
    Project: Antiprism - http://www.antiprism.com
 */
 
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -37,6 +38,8 @@
 #include <vector>
 
 #include "../base/antiprism.h"
+#include "batch.h"
+#include "off_trans.h"
 
 using std::map;
 using std::pair;
@@ -45,19 +48,6 @@ using std::vector;
 
 using namespace anti;
 
-class trans_opts : public ProgramOpts {
-public:
-  Trans3d trans_m;
-  Geometry geom;
-
-  string ifile;
-  string ofile;
-
-  trans_opts() : ProgramOpts("off_trans") {}
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void trans_opts::usage()
 {
@@ -113,7 +103,20 @@ void trans_opts::usage()
 "            E - perimeter (sum of edges)   e - average edge length\n"
 "            V - volume                     r - radius, from centroid\n"
 "                                               to furthest vertex\n"
+"  -F <exps> map the vertex coordinates, three expressions separated by\n"
+"            commas give the new x, y and z coordinates. Expressions may use\n"
+"            x, y and z for the current coordinates and i for the vertex\n"
+"            index number, use ';' to separate function arguments, and take\n"
+"            angles in degrees (e.g. 'x*cos(10*z)-y*sin(10*z),x*sin(10*z)+\n"
+"            y*cos(10*z),z'). Applies to the result of the preceding options\n"
+"  -c <col>  colour elements with index numbers from an expression, in the\n"
+"            form elements,expression. Elements may include v, e and f, and\n"
+"            the expression may use x, y and z for the element centre and i\n"
+"            for the element index number. Results are rounded to the\n"
+"            nearest integer, and must not be negative. The centres are\n"
+"            those after the preceding options\n"
 "  -i        replace the current combined transformation by its inverse\n"
+"            (the combination starts after the last -F)\n"
 "  -o <file> write output to file (default: write to standard output)\n"
 "\n"
 "\n", prog_name(), help_ver_text);
@@ -172,40 +175,90 @@ bool rel_scale_val(Geometry &geom, char rel_scale, double *scale, char *errmsg)
   return true;
 }
 
+// Evaluate an expression in x, y, z and i for each of a set of points
+Status eval_points_expr(const char *expr, const vector<Vec3d> &pts,
+                        vector<double> &vals)
+{
+  size_t num = pts.size();
+  vector<double> crds[3];
+  for (auto &crd : crds)
+    crd.resize(num);
+  vector<double> idxs(num);
+  for (size_t i = 0; i < num; i++) {
+    for (int j = 0; j < 3; j++)
+      crds[j][i] = pts[i][j];
+    idxs[i] = i;
+  }
+
+  vals.resize(num);
+  return eval_expression_bulk(
+      expr, {"x", "y", "z", "i"},
+      {crds[0].data(), crds[1].data(), crds[2].data(), idxs.data()}, num,
+      vals.data());
+}
+
+Status map_coords(Geometry &geom, const vector<char *> &exprs)
+{
+  vector<double> new_crds[3];
+  for (int j = 0; j < 3; j++) {
+    Status stat = eval_points_expr(exprs[j], geom.verts(), new_crds[j]);
+    if (stat.is_error())
+      return Status::error(msg_str("%c coordinate: %s", 'x' + j, stat.c_msg()));
+  }
+
+  vector<Vec3d> &verts = geom.raw_verts();
+  for (size_t i = 0; i < verts.size(); i++)
+    verts[i] = Vec3d(new_crds[0][i], new_crds[1][i], new_crds[2][i]);
+  return Status::ok();
+}
+
+Status color_by_expr(Geometry &geom, const Trans3d &trans,
+                     const string &elems, const char *expr)
+{
+  for (char elem : elems) {
+    int type = (elem == 'v') ? VERTS : (elem == 'e') ? EDGES : FACES;
+    vector<Vec3d> cents;
+    if (type == VERTS)
+      cents = geom.verts();
+    else if (type == EDGES)
+      for (int i = 0; i < (int)geom.edges().size(); i++)
+        cents.push_back(geom.edge_cent(i));
+    else
+      geom.face_cents(cents);
+    transform(cents, trans);
+
+    vector<double> vals;
+    Status stat = eval_points_expr(expr, cents, vals);
+    if (stat.is_error())
+      return stat;
+
+    for (size_t i = 0; i < vals.size(); i++) {
+      long idx = lround(vals[i]);
+      if (idx < 0 || idx > INT_MAX)
+        return Status::error(
+            msg_str("result for element %lu is not a valid index number: %g",
+                    (unsigned long)i, vals[i]));
+      geom.colors(type).set(i, Color(int(idx)));
+    }
+  }
+  return Status::ok();
+}
+
 void trans_opts::process_command_line(int argc, char **argv)
 {
-  char errmsg[MSG_SZ];
   Status stat;
   opterr = 0;
   int c;
-  vector<pair<char, char *>> args;
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hT:R:M:S:IX:A:a:CY:y:s:io:")) != -1) {
+  while ((c = getopt(argc, argv, ":hT:R:M:S:IX:A:a:CY:y:s:F:c:io:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
-    switch (c) { // Keep switch for consistency/maintainability
-    default:
-      args.push_back(pair<char, char *>(c, optarg));
-    }
-  }
-
-  if (argc - optind > 1)
-    error("too many arguments");
-
-  if (argc - optind == 1)
-    ifile = argv[optind];
-
-  read_or_error(geom, ifile);
-
-  vector<double> nums;
-  Trans3d trans_m2;
+    vector<double> nums;
+    Trans3d trans_m2;
 
-  for (auto &arg : args) {
-    c = arg.first;
-    char *optarg = arg.second;
     switch (c) {
     case 'R':
       print_status_or_exit(read_double_list(optarg, nums), c);
@@ -227,7 +280,6 @@ void trans_opts::process_command_line(int argc, char **argv)
         error(msg_str("must give 3, 4, 6 of 12 numbers (%lu were given)",
                       (unsigned long)nums.size()),
               c);
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'S':
@@ -242,8 +294,6 @@ void trans_opts::process_command_line(int argc, char **argv)
         error(msg_str("must give 1, 3 or 4 numbers (%lu were given)",
                       (unsigned long)nums.size()),
               c);
-
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'T':
@@ -254,7 +304,6 @@ void trans_opts::process_command_line(int argc, char **argv)
                       (unsigned long)nums.size()),
               c);
       trans_m2 = Trans3d::translate(Vec3d(nums[0], nums[1], nums[2]));
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'M':
@@ -266,11 +315,10 @@ void trans_opts::process_command_line(int argc, char **argv)
               c);
 
       trans_m2 = Trans3d::reflection(Vec3d(nums[0], nums[1], nums[2]));
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'I':
-      trans_m = Trans3d::inversion() * trans_m;
+      trans_m2 = Trans3d::inversion();
       break;
 
     case 'A':
@@ -286,7 +334,6 @@ void trans_opts::process_command_line(int argc, char **argv)
         error(msg_str("must give 18 numbers (%lu were given)",
                       (unsigned long)nums.size()),
               c);
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'a':
@@ -301,8 +348,6 @@ void trans_opts::process_command_line(int argc, char **argv)
           deg2rad(nums[0]), deg2rad(nums[1]), deg2rad(nums[2]), &valid);
       if (!valid)
         error("the sum of any two angles must be greater than the third", c);
-
-      trans_m = trans_m2 * trans_m;
       break;
 
     case 'X':
@@ -327,12 +372,6 @@ void trans_opts::process_command_line(int argc, char **argv)
         error(msg_str("must give 9 or 12 numbers (%lu were given)",
                       (unsigned long)nums.size()),
               c);
-
-      trans_m = trans_m2 * trans_m;
-      break;
-
-    case 'C':
-      trans_m = Trans3d::translate(-(trans_m * geom.centroid())) * trans_m;
       break;
 
     case 'Y': {
@@ -366,84 +405,176 @@ void trans_opts::process_command_line(int argc, char **argv)
           !(stat = final_sym.get_autos().set_realignment(parts[3])))
         error(msg_str("sub-symmetry realignment: %s", stat.c_msg()), c);
 
-      trans_m =
+      trans_m2 =
           (final_sym.get_autos().get_realignment() * final_sym.get_to_std())
-              .inverse() *
-          trans_m;
+              .inverse();
       break;
     }
 
-    case 'y': {
-      Geometry geom_cur = geom;
-      geom_cur.transform(trans_m);
-      Symmetry full_sym(geom_cur);
+    // The remaining options depend on the model, and are applied when the
+    // model is processed. Their arguments are checked here.
+    case 'C':
+    case 'i':
+      break;
 
+    case 'y': {
+      string arg = optarg;
       vector<char *> parts;
       split_line(optarg, parts, ",");
       if (parts.size() == 0 || parts.size() > 3)
         error("argument should have 1-3 comma separated parts", c);
 
       Symmetry sub_sym;
-      if (strncmp(parts[0], "full", strlen(optarg)) == 0)
-        sub_sym = full_sym;
-      else if (!(stat = sub_sym.init(parts[0], Trans3d())))
+      if (strncmp(parts[0], "full", strlen(parts[0])) != 0 &&
+          !(stat = sub_sym.init(parts[0], Trans3d())))
         error(msg_str("sub-symmetry type: %s", stat.c_msg()), c);
 
       int sub_sym_conj = 0;
       if (parts.size() > 1 && !(stat = read_int(parts[1], &sub_sym_conj)))
         error(msg_str("sub-symmetry conjugation number: %s", stat.c_msg()), c);
 
+      args.push_back({char(c), arg, Trans3d()});
+      continue;
+    }
+
+    case 's':
+      if (!(strlen(optarg) == 1 && strchr("VAaEer", *optarg)))
+        error("relative scale must be V,A,a,E,e or r", c);
+      break;
+
+    case 'F': {
+      string arg = optarg;
+      vector<char *> parts;
+      split_line(optarg, parts, ",", true);
+      if (parts.size() != 3)
+        error(msg_str("must give exactly three expressions (%lu were "
+                      "given)",
+                      (unsigned long)parts.size()),
+              c);
+      args.push_back({char(c), arg, Trans3d()});
+      continue;
+    }
+
+    case 'c': {
+      char *comma = strchr(optarg, ',');
+      if (!comma)
+        error("argument should be elements,expression", c);
+      string elems(optarg, comma - optarg);
+      if (elems.empty() || strspn(elems.c_str(), "vef") != elems.size())
+        error(msg_str("elements '%s' must include only v, e and f",
+                      elems.c_str()),
+              c);
+      break;
+    }
+
+    case 'o':
+      ofile = optarg;
+      continue;
+
+    default:
+      error("unknown command line error");
+    }
+
+    args.push_back({char(c), (optarg) ? optarg : "", trans_m2});
+  }
+
+  if (argc - optind > 1)
+    error("too many arguments");
+
+  if (argc - optind == 1)
+    ifile = argv[optind];
+}
+
+Status trans_opts::process_geom(Geometry &geom)
+{
+  Status stat;
+  char errmsg[MSG_SZ];
+  Trans3d trans_m;
+
+  for (const auto &arg : args) {
+    const char c = arg.opt;
+    switch (c) {
+    case 'C':
+      trans_m = Trans3d::translate(-(trans_m * geom.centroid())) * trans_m;
+      break;
+
+    case 'y': {
+      Geometry geom_cur = geom;
+      geom_cur.set_face_storage(Geometry::FACES_NESTED); // for Symmetry
+      geom_cur.transform(trans_m);
+      Symmetry full_sym(geom_cur);
+
+      vector<char> arg_str(arg.val.begin(), arg.val.end());
+      arg_str.push_back('\0');
+      vector<char *> parts;
+      split_line(arg_str.data(), parts, ",");
+
+      Symmetry sub_sym;
+      if (strncmp(parts[0], "full", strlen(parts[0])) == 0)
+        sub_sym = full_sym;
+      else
+        sub_sym.init(parts[0], Trans3d()); // checked when options were read
+
+      int sub_sym_conj = 0;
+      if (parts.size() > 1)
+        read_int(parts[1], &sub_sym_conj);
+
       Symmetry sym;
       if (!(stat = full_sym.get_sub_sym(sub_sym, &sym, sub_sym_conj)))
-        error(msg_str("sub-symmetry: %s", stat.c_msg()), c);
+        return Status::error(
+            opt_msg(c, msg_str("sub-symmetry: %s", stat.c_msg())));
 
       if (parts.size() > 2 &&
           !(stat = sym.get_autos().set_realignment(parts[2])))
-        error(msg_str("sub-symmetry realignment: %s", stat.c_msg()), c);
+        return Status::error(
+            opt_msg(c, msg_str("sub-symmetry realignment: %s", stat.c_msg())));
 
       trans_m = sym.get_autos().get_realignment() * sym.get_to_std() * trans_m;
       break;
     }
 
     case 's': {
-      char rel_scale = '\0';
-      if (strlen(optarg) == 1 && strchr("VAaEer", *optarg))
-        rel_scale = *optarg;
-      else
-        error("relative scale must be V,A,a,E,e or r", c);
       Geometry geom_cur = geom;
+      geom_cur.set_face_storage(Geometry::FACES_NESTED); // for GeometryInfo
       geom_cur.transform(trans_m);
       double scale;
-      if (!rel_scale_val(geom_cur, rel_scale, &scale, errmsg))
-        error(errmsg, 's');
+      if (!rel_scale_val(geom_cur, arg.val[0], &scale, errmsg))
+        return Status::error(opt_msg(c, errmsg));
       if (*errmsg)
-        warning(errmsg, 's');
+        warning(errmsg, c);
       trans_m = Trans3d::scale(1 / scale) * trans_m;
       break;
     }
 
-    case 'i':
-      trans_m = trans_m.inverse();
+    case 'F': {
+      vector<char> arg_str(arg.val.begin(), arg.val.end());
+      arg_str.push_back('\0');
+      vector<char *> parts;
+      split_line(arg_str.data(), parts, ",", true);
+      geom.transform(trans_m);
+      trans_m = Trans3d::unit();
+      if (!(stat = map_coords(geom, parts)))
+        return Status::error(opt_msg(c, stat.msg()));
       break;
+    }
 
-    case 'o':
-      ofile = optarg;
+    case 'c': {
+      size_t comma = arg.val.find(',');
+      if (!(stat = color_by_expr(geom, trans_m, arg.val.substr(0, comma),
+                                 arg.val.c_str() + comma + 1)))
+        return Status::error(opt_msg(c, stat.msg()));
+      break;
+    }
+
+    case 'i':
+      trans_m = trans_m.inverse();
       break;
 
     default:
-      error("unknown command line error");
+      trans_m = arg.trans * trans_m;
     }
   }
-}
-
-int main(int argc, char *argv[])
-{
-  trans_opts opts;
-  opts.process_command_line(argc, argv);
-
-  opts.geom.transform(opts.trans_m);
-
-  opts.write_or_error(opts.geom, opts.ofile);
 
-  return 0;
+  geom.transform(trans_m);
+  return Status::ok();
 }
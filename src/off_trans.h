@@ -0,0 +1,62 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: off_trans.h
+   Description: options for off_trans, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef OFF_TRANS_H
+#define OFF_TRANS_H
+
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+
+class trans_opts : public anti::ProgramOpts {
+public:
+  // An option, and the transformation it makes if it does not depend on
+  // the model
+  struct trans_arg {
+    char opt;
+    std::string val;
+    anti::Trans3d trans;
+  };
+
+  std::vector<trans_arg> args;
+
+  std::string ifile;
+  std::string ofile;
+
+  trans_opts() : ProgramOpts("off_trans") {}
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  // Apply the transformations, in the order they were given
+  anti::Status process_geom(anti::Geometry &geom);
+};
+
+#endif // OFF_TRANS_H
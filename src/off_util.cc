@@ -29,10 +29,12 @@
 */
 
 #include <algorithm>
+#include <atomic>
 #include <ctype.h>
 #include <map>
 #include <math.h>
 #include <memory>
+#include <queue>
 #include <set>
 #include <stack>
 #include <string.h>
@@ -41,7 +43,9 @@
 
 #include "../base/antiprism.h"
 
+#include "batch.h"
 #include "help.h"
+#include "off_util.h"
 
 using std::map;
 using std::pair;
@@ -55,7 +59,8 @@ using namespace anti;
 
 // Defined at end of file
 int unzip_poly(Geometry &geom, int root, double fract, char centring,
-               bool unzip_z_align, char *errmsg);
+               bool unzip_z_align, char metric, int num_tries, int seed,
+               int num_threads, vector<string> &warnings, char *errmsg);
 
 void triangulate_faces(Geometry &geom, unsigned int winding_rule)
 {
@@ -1172,18 +1177,6 @@ bool add_elements(Geometry &geom, vector<string> add_elems, char *errmsg)
   return true;
 }
 
-class pr_opts : public ProgramOpts {
-public:
-  Geometry geom;
-  int sig_digits;
-
-  string ofile;
-
-  pr_opts() : ProgramOpts("off_util"), sig_digits(DEF_SIG_DGTS) {}
-  void process_command_line(int argc, char **argv);
-  void usage();
-};
-
 // clang-format off
 void pr_opts::usage()
 {
@@ -1199,7 +1192,9 @@ void pr_opts::usage()
 "vertices, and converting edges to quadrilaterals. Operations are performeded\n"
 "in the order they are given on the command line. input_files is the list of\n"
 "files to process, which may include 'null' as an empty geometry, or if not\n"
-"given the program reads from standard input.\n"
+"given the program reads from standard input. In batch mode each input file\n"
+"is processed separately and written to its own output file, and a record\n"
+"of the output is written for each file to standard output.\n"
 "\n"
 "Options\n"
 "%s"
@@ -1261,15 +1256,26 @@ void pr_opts::usage()
 "  -c <col>  close polyhedron, each hole converted to a face with colour col,\n"
 "            holes having a vertex with more than two open edges are not filled\n"
 "  -S        project onto unit sphere centred at origin\n"
-"  -u <args> unfold a polyhedron into a net, takes up to three comma separated\n"
+"  -u <args> unfold a polyhedron into a net, takes up to five comma separated\n"
 "            values for base face index, dihedral fraction (normally 1.0 to\n"
-"            -1.0, default: 0.0 flat), and final option letters: 'f' centre\n"
-"            on centroid of face centres, 'z' align base face normal to z_axis.\n"
+"            -1.0, default: 0.0 flat), option letters: 'f' centre on\n"
+"            centroid of face centres, 'z' align base face normal to z_axis,\n"
+"            and to search for a flat net without overlaps: 'n' use the\n"
+"            first net found, 'a' the net with the smallest convex hull area,\n"
+"            'c' the net with the shortest length of cut edges, then the\n"
+"            number of spanning trees to try (default: 1000) and the random\n"
+"            number seed (default: 0).\n"
 "  -d <dgts> number of significant digits (default %d) or if negative\n"
 "            then the number of digits after the decimal point\n"
-"  -o <file> write output to file (default: write to standard output)\n"
+"  -o <file> write output to file (default: write to standard output). In\n"
+"            batch mode this must contain %%s, which is replaced by the\n"
+"            input file name without its extension\n"
+"%s"
+"  -j <num>  in batch mode, the number of files to process at the same time\n"
+"            (default: number of hardware threads, or $ANTIPRISM_THREADS\n"
+"            if set)\n"
 "\n"
-"\n", prog_name(), help_ver_text, int(-log(::epsilon)/log(10) + 0.5), ::epsilon, DEF_SIG_DGTS);
+"\n", prog_name(), help_ver_text, int(-log(::epsilon)/log(10) + 0.5), ::epsilon, DEF_SIG_DGTS, batch_help_text);
 }
 // clang-format on
 
@@ -1318,31 +1324,20 @@ const char *get_help(const char *name)
 
 void pr_opts::process_command_line(int argc, char **argv)
 {
-  char errmsg[MSG_SZ];
   opterr = 0;
   int c;
-  vector<char *> parts;
-  Geometry adding;
   Color close_col;
-  string arg_id;
-
-  vector<pair<char, char *>> args;
 
   handle_long_opts(argc, argv);
 
   bool trailing_option_l = false; // to warn if there is an -l after a -M
-  while ((c = getopt(argc, argv, ":hH:st:O:d:x:eD:K:A:c:gT:SM:l:u:o:")) != -1) {
+  while ((c = getopt(argc, argv,
+                     ":hH:st:O:d:x:eD:K:A:c:gT:SM:l:u:o:j:b:L:G:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
-    // Check colour parameter is valid on first pass in case it is omitted
-    if (c == 'c')
-      print_status_or_exit(close_col.read(optarg), c);
-    else if (c == 'l')
-      trailing_option_l = true;
-    else if (c == 'M')
-      trailing_option_l = false;
-    else if (c == 'H') {
+    switch (c) {
+    case 'H': {
       const char *help_text = get_help(optarg);
       if (help_text) {
         fprintf(stdout, "\n%s\n", help_text);
@@ -1350,57 +1345,112 @@ void pr_opts::process_command_line(int argc, char **argv)
       }
       else
         error(msg_str("no help for '%s' (try 'off_util -H help')", optarg), c);
+      break;
     }
 
-    args.push_back(pair<char, char *>(c, optarg));
+    case 'd':
+      print_status_or_exit(read_int(optarg, &sig_digits), c);
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
+    case 'b':
+      print_status_or_exit(batch.read_format(optarg), c);
+      break;
+
+    case 'L':
+      print_status_or_exit(batch.add_list(optarg), c);
+      break;
+
+    case 'G':
+      print_status_or_exit(batch.add_glob(optarg), c);
+      break;
+
+    default:
+      // Check colour parameter is valid on first pass in case it is omitted
+      if (c == 'c')
+        print_status_or_exit(close_col.read(optarg), c);
+      else if (c == 'l')
+        trailing_option_l = true;
+      else if (c == 'M')
+        trailing_option_l = false;
+
+      // Operations are applied to the model in order after it is read
+      args.push_back(pair<char, string>(c, (optarg) ? optarg : ""));
+    }
   }
   if (trailing_option_l)
     warning("limit ignored as not followed by a merge operation (-M)", 'l');
 
-  vector<string> ifiles;
   while (argc - optind)
     ifiles.push_back(string(argv[optind++]));
 
-  if (!ifiles.size())
+  if (batch.enabled) {
+    batch.ifiles.insert(batch.ifiles.end(), ifiles.begin(), ifiles.end());
+    if (!batch.ifiles.size())
+      error("no input files for batch mode");
+    if (ofile.find("%s") == string::npos)
+      error("in batch mode the output file name must contain %s", 'o');
+    batch.num_threads = num_threads;
+  }
+  else if (!ifiles.size())
     ifiles.push_back("");
+}
 
-  // Append all input files
-  for (auto &ifile : ifiles) {
-    Geometry geom_arg;
-    if (ifile != "null")
-      read_or_error(geom_arg, ifile);
-    geom.append(geom_arg);
-  }
+// Apply the operations to the model, in the order they were given
+Status pr_opts::process_geom(Geometry &geom, vector<string> &warnings)
+{
+  Status stat;
+  char errmsg[MSG_SZ];
+  vector<char *> parts;
+  Color close_col;
+  string arg_id;
 
   int sig_compare = INT_MAX;
   vector<string> add_elems;
 
   for (auto &arg : args) {
-    c = arg.first;
-    char *optarg = arg.second;
+    char c = arg.first;
+    string arg_str = arg.second; // the argument may be modified
+    char *optarg = &arg_str[0];
     switch (c) {
     case 'O':
-      print_status_or_exit(get_arg_id(optarg, &arg_id,
-                                      "positive=1|negative=2|reverse=3|flip=4",
-                                      argmatch_add_id_maps),
-                           c);
-      print_status_or_exit(geom.orient(atoi(arg_id.c_str())), c);
+      if (!(stat = get_arg_id(optarg, &arg_id,
+                              "positive=1|negative=2|reverse=3|flip=4",
+                              argmatch_add_id_maps)))
+        return Status::error(opt_msg(c, stat.msg()));
+      stat = geom.orient(atoi(arg_id.c_str()));
+      if (stat.is_error())
+        return Status::error(opt_msg(c, stat.msg()));
+      else if (stat.is_warning())
+        warnings.push_back(opt_msg(c, stat.msg()));
       break;
 
     case 'T': {
       vector<char *> parts;
       int parts_sz = split_line(optarg, parts, ",");
       if (parts_sz > 2)
-        error("truncation must be 'ratio' or 'ratio,vert_order'", c);
+        return Status::error(
+            opt_msg(c, "truncation must be 'ratio' or 'ratio,vert_order'"));
       double trunc_ratio;
       if (!read_double(parts[0], &trunc_ratio))
-        error("truncation ratio is not a number", c);
+        return Status::error(opt_msg(c, "truncation ratio is not a number"));
 
       int trunc_v_ord = 0; // truncate all vertices
       if (parts_sz > 1 && !read_int(parts[1], &trunc_v_ord)) {
-        error("truncation vertex order is not an integer", c);
+        return Status::error(
+            opt_msg(c, "truncation vertex order is not an integer"));
         if (trunc_v_ord < 1)
-          error("truncation vertex order is not positive", c);
+          return Status::error(
+              opt_msg(c, "truncation vertex order is not positive"));
       }
 
       truncate_verts(geom, trunc_ratio, trunc_v_ord);
@@ -1414,21 +1464,18 @@ void pr_opts::process_command_line(int argc, char **argv)
     case 't':
       if (!get_arg_id(optarg, &arg_id,
                       "odd|nonzero|positive|negative|triangulate=1"))
-        error(msg_str("invalid winding rule '%s'", optarg).c_str(), c);
+        return Status::error(
+            opt_msg(c, msg_str("invalid winding rule '%s'", optarg)));
 
       triangulate_faces(geom, TESS_WINDING_ODD + atoi(arg_id.c_str()));
       break;
 
-    case 'd':
-      print_status_or_exit(read_int(optarg, &sig_digits), c);
-      break;
-
     case 'x':
       if (strspn(optarg, "vefVEFD") != strlen(optarg))
-        error(msg_str("elements to hide are %s, can only include "
-                      "vefVEFD\n",
-                      optarg),
-              c);
+        return Status::error(
+            opt_msg(c, msg_str("elements to hide are %s, can only include "
+                               "vefVEFD\n",
+                               optarg)));
       filter(geom, optarg);
       break;
 
@@ -1444,9 +1491,9 @@ void pr_opts::process_command_line(int argc, char **argv)
       vector<char *> entries;
       split_line(optarg, entries, "%");
       if (!entries.size())
-        error("invalid argument", c);
+        return Status::error(opt_msg(c, "invalid argument"));
       if (entries.size() > 1 || forward_error)
-        error("extra characters found after %", c);
+        return Status::error(opt_msg(c, "extra characters found after %"));
       vector<string> del_elems;
       del_elems.push_back(entries[0]);
       string invert_del;
@@ -1459,9 +1506,9 @@ void pr_opts::process_command_line(int argc, char **argv)
           invert_del = 'v';
       }
       if (!delete_elements(geom, del_elems, false, invert_del, false, errmsg))
-        error(errmsg, c);
+        return Status::error(opt_msg(c, errmsg));
       if (*errmsg)
-        warning(errmsg);
+        warnings.push_back(errmsg);
       break;
     }
 
@@ -1473,9 +1520,9 @@ void pr_opts::process_command_line(int argc, char **argv)
       vector<char *> entries;
       split_line(optarg, entries, "%");
       if (!entries.size())
-        error("invalid argument", c);
+        return Status::error(opt_msg(c, "invalid argument"));
       if (entries.size() > 1 || forward_error)
-        error("extra characters found after %", c);
+        return Status::error(opt_msg(c, "extra characters found after %"));
       vector<string> del_elems;
       del_elems.push_back(entries[0]);
       string invert_del;
@@ -1488,7 +1535,7 @@ void pr_opts::process_command_line(int argc, char **argv)
           invert_del = 'v';
       }
       if (!delete_elements(geom, del_elems, true, invert_del, false, errmsg))
-        error(errmsg, c);
+        return Status::error(opt_msg(c, errmsg));
       break;
     }
 
@@ -1496,7 +1543,7 @@ void pr_opts::process_command_line(int argc, char **argv)
       add_elems.clear();
       add_elems.push_back(optarg);
       if (!add_elements(geom, add_elems, errmsg))
-        error(errmsg, c);
+        return Status::error(opt_msg(c, errmsg));
       break;
 
     case 'g':
@@ -1504,7 +1551,7 @@ void pr_opts::process_command_line(int argc, char **argv)
       break;
 
     case 'c':
-      print_status_or_exit(close_col.read(optarg), c);
+      close_col.read(optarg); // checked when the options were read
       close_poly_basic(geom, close_col);
       break;
 
@@ -1519,22 +1566,26 @@ void pr_opts::process_command_line(int argc, char **argv)
       char elems[MSG_SZ];
       strcpy_msg(elems, parts[0]);
       if (strspn(elems, "svefab") != strlen(elems))
-        error(msg_str("elements to merge are %s must be v, e, f, a, b "
-                      "or s\n",
-                      elems),
-              c);
+        return Status::error(
+            opt_msg(c, msg_str("elements to merge are %s must be v, e, f, "
+                               "a, b or s\n",
+                               elems)));
 
       if (strchr(elems, 's') && strlen(elems) > 1)
-        error("s is for sorting only, cannot be used with v, e, or f", c);
+        return Status::error(opt_msg(
+            c, "s is for sorting only, cannot be used with v, e, or f"));
 
       if (strchr(elems, 'a') && strlen(elems) > 1)
-        error("a includes vef, and must be used alone", c);
+        return Status::error(
+            opt_msg(c, "a includes vef, and must be used alone"));
 
       if (strchr(elems, 'b') && strlen(elems) > 1)
-        error("b includes vef, and must be used alone", c);
+        return Status::error(
+            opt_msg(c, "b includes vef, and must be used alone"));
 
       if (strspn(elems, "ef") && !strchr(elems, 'v'))
-        warning("without v, some orphan vertices may result", c);
+        warnings.push_back(
+            opt_msg(c, "without v, some orphan vertices may result"));
 
       if (*elems == 'a')
         strcpy_msg(elems, "vef");
@@ -1542,10 +1593,10 @@ void pr_opts::process_command_line(int argc, char **argv)
       // Get blend type
       int blend_type = 3;
       if (parts.size() > 1) {
-        print_status_or_exit(get_arg_id(parts[1], &arg_id,
-                                        "first=1|last=2|rgb=3|ryb=4",
-                                        argmatch_add_id_maps),
-                             c);
+        if (!(stat = get_arg_id(parts[1], &arg_id,
+                                "first=1|last=2|rgb=3|ryb=4",
+                                argmatch_add_id_maps)))
+          return Status::error(opt_msg(c, stat.msg()));
         blend_type = atoi(arg_id.c_str());
       }
 
@@ -1577,64 +1628,122 @@ void pr_opts::process_command_line(int argc, char **argv)
     }
 
     case 'l':
-      print_status_or_exit(read_int(optarg, &sig_compare), c);
+      if (!(stat = read_int(optarg, &sig_compare)))
+        return Status::error(opt_msg(c, stat.msg()));
       if (sig_compare < 0) {
-        warning("limit is negative, and so ignored", c);
+        warnings.push_back(opt_msg(c, "limit is negative, and so ignored"));
       }
       if (sig_compare > DEF_SIG_DGTS) {
-        warning("limit is very small, may not be attainable", c);
+        warnings.push_back(
+            opt_msg(c, "limit is very small, may not be attainable"));
       }
       break;
 
     case 'u': {
       int unzip_root;
       split_line(optarg, parts, ",");
-      print_status_or_exit(read_int(parts[0], &unzip_root), c);
+      if (!(stat = read_int(parts[0], &unzip_root)))
+        return Status::error(opt_msg(c, stat.msg()));
 
       double unzip_frac = 0.0;
-      if (parts.size() > 1)
-        print_status_or_exit(read_double(parts[1], &unzip_frac), c);
+      if (parts.size() > 1 && !(stat = read_double(parts[1], &unzip_frac)))
+        return Status::error(opt_msg(c, stat.msg()));
 
       char unzip_centre = 'x';
       char unzip_z_align = false;
+      char unzip_metric = '\0';
       if (parts.size() > 2) {
-        if (strspn(parts[2], "zf") != strlen(parts[2]))
-          error(msg_str("unzip options are '%s' must include "
-                        "only f, u\n",
-                        parts[2]),
-                c);
+        if (strspn(parts[2], "zfnac") != strlen(parts[2]))
+          return Status::error(
+              opt_msg(c, msg_str("unzip options are '%s' must include "
+                                 "only f, z, n, a, c",
+                                 parts[2])));
+        const char *metric = strpbrk(parts[2], "nac");
+        if (metric && strpbrk(metric + 1, "nac"))
+          return Status::error(
+              opt_msg(c, msg_str("unzip options are '%s' must include "
+                                 "only one of n, a, c",
+                                 parts[2])));
 
         if (strchr(parts[2], 'f'))
           unzip_centre = 'f';
         if (strchr(parts[2], 'z'))
           unzip_z_align = true;
+        if (metric)
+          unzip_metric = *metric;
+      }
+
+      int unzip_tries = 1000;
+      if (parts.size() > 3) {
+        if (!(stat = read_int(parts[3], &unzip_tries)))
+          return Status::error(opt_msg(c, stat.msg()));
+        if (unzip_tries < 1)
+          return Status::error(
+              opt_msg(c, "number of spanning trees must be 1 or greater"));
+      }
+
+      int unzip_seed = 0;
+      if (parts.size() > 4) {
+        if (!(stat = read_int(parts[4], &unzip_seed)))
+          return Status::error(opt_msg(c, stat.msg()));
+        if (unzip_seed < 0)
+          return Status::error(
+              opt_msg(c, "random number seed must be 0 or greater"));
       }
 
+      if (parts.size() > 5)
+        return Status::error(opt_msg(c, "more than five comma separated "
+                                        "values"));
+
+      if (parts.size() > 3 && !unzip_metric)
+        warnings.push_back(opt_msg(c, "number of spanning trees and seed "
+                                      "ignored without a search option "
+                                      "(n, a or c)"));
+
+      // In batch mode the files are already processed on several threads
+      int unzip_threads = batch.enabled ? 1 : 0;
       if (!unzip_poly(geom, unzip_root, unzip_frac, unzip_centre, unzip_z_align,
-                      errmsg))
-        error(errmsg, 'u');
+                      unzip_metric, unzip_tries, unzip_seed, unzip_threads,
+                      warnings, errmsg))
+        return Status::error(opt_msg(c, errmsg));
 
       break;
     }
 
-    case 'o':
-      ofile = optarg;
-      break;
-
     default:
-      error("unknown command line error");
+      return Status::error("unknown command line error");
     }
   }
+
+  return Status::ok();
 }
 
-int main(int argc, char *argv[])
+void batch_process(pr_opts &opts, const string &ifile, BatchRecord &rec)
 {
-  pr_opts opts;
-  opts.process_command_line(argc, argv);
+  Geometry geom;
+  if (ifile != "null") {
+    Status stat = geom.read(ifile);
+    if (stat.is_error()) {
+      rec.stat = stat;
+      return;
+    }
+    else if (stat.is_warning())
+      rec.warnings.push_back(stat.msg());
+  }
+
+  rec.stat = opts.process_geom(geom, rec.warnings);
+  if (rec.stat.is_error())
+    return;
 
-  opts.write_or_error(opts.geom, opts.ofile, opts.sig_digits);
+  string ofile = batch_output_name(opts.ofile, ifile);
+  rec.stat = geom.write(ofile, opts.sig_digits);
+  if (rec.stat.is_error())
+    return;
 
-  return 0;
+  rec.add("output", ofile);
+  rec.add("num_verts", std::to_string(geom.verts().size()));
+  rec.add("num_edges", std::to_string(geom.edges().size()));
+  rec.add("num_faces", std::to_string(geom.faces().size()));
 }
 
 //------------------------------------------------------------------
@@ -1671,6 +1780,28 @@ int tree_face::get_next_idx()
     return orig_cons[++cur % orig_cons.size()]; // wrap at end of cons list
 }
 
+// Get, for each edge of each face, the face connected across the edge,
+// or -1 if there is none. Returns false if more than two faces meet at an
+// edge.
+static bool get_unzip_face_cons(const Geometry &geom,
+                                vector<vector<int>> &f_cons)
+{
+  GeometryInfo info(geom);
+  const auto &f_cons_all = info.get_face_cons();
+  f_cons.resize(f_cons_all.size());
+  for (unsigned int f = 0; f < f_cons_all.size(); f++) {
+    f_cons[f].resize(f_cons_all[f].size());
+    for (unsigned int v = 0; v < f_cons_all[f].size(); v++) {
+      // Don't handle more than 2 faces meeting at an edge
+      if (f_cons_all[f][v].size() > 1)
+        return false;
+
+      f_cons[f][v] = (f_cons_all[f][v].size()) ? f_cons_all[f][v][0] : -1;
+    }
+  }
+  return true;
+}
+
 class unzip_tree {
 private:
   int root;
@@ -1678,28 +1809,23 @@ private:
 
 public:
   unzip_tree() : root(-1) {}
-  int init_basic(Geometry &geom, int first_face);
+  int init_basic(const Geometry &geom, int first_face);
+  int init_weighted(int first_face, const vector<vector<int>> &f_cons,
+                    const vector<vector<int>> &f_edges,
+                    const vector<double> &edge_wts);
   int flatten(const Geometry &geom, Geometry &net_geom, double fract);
+  double get_cut_length(const Geometry &geom,
+                        const vector<vector<int>> &f_cons) const;
 };
 
-int unzip_tree::init_basic(Geometry &geom, int first_face)
+int unzip_tree::init_basic(const Geometry &geom, int first_face)
 {
   tree.clear();
   root = first_face;
 
-  GeometryInfo info(geom);
-  const auto &f_cons_all = info.get_face_cons();
-  vector<vector<int>> f_cons(f_cons_all.size());
-  for (unsigned int f = 0; f < f_cons_all.size(); f++) {
-    f_cons[f].resize(f_cons_all[f].size());
-    for (unsigned int v = 0; v < f_cons_all[f].size(); v++) {
-      // Don't handle more than 2 faces meeting at an edge
-      if (f_cons_all[f][v].size() > 1)
-        return -1;
-
-      f_cons[f][v] = (f_cons_all[f][v].size()) ? f_cons_all[f][v][0] : -1;
-    }
-  }
+  vector<vector<int>> f_cons;
+  if (!get_unzip_face_cons(geom, f_cons))
+    return -1;
 
   vector<tree_face> face_list;
   vector<bool> seen(geom.faces().size(), false);
@@ -1732,6 +1858,63 @@ int unzip_tree::init_basic(Geometry &geom, int first_face)
   return 1;
 }
 
+// Build a spanning tree of the faces by adding, at each step, the
+// connection with the greatest weight from a face in the tree to a face
+// not yet in the tree. f_edges gives the edge index number of each face
+// edge, and edge_wts the weight of each edge.
+int unzip_tree::init_weighted(int first_face, const vector<vector<int>> &f_cons,
+                              const vector<vector<int>> &f_edges,
+                              const vector<double> &edge_wts)
+{
+  tree.clear();
+  root = first_face;
+
+  // entries are (weight, (tree face, new face)), ties go to higher indexes
+  std::priority_queue<pair<double, pair<int, int>>> cons;
+  vector<bool> seen(f_cons.size(), false);
+  auto add_face = [&](int f) {
+    seen[f] = true;
+    for (unsigned int v = 0; v < f_cons[f].size(); v++) {
+      int next = f_cons[f][v];
+      if (next >= 0 && !seen[next])
+        cons.push({edge_wts[f_edges[f][v]], {f, next}});
+    }
+  };
+
+  add_face(root);
+  while (!cons.empty()) {
+    pair<int, int> con = cons.top().second;
+    cons.pop();
+    if (!seen[con.second]) {
+      tree[con.first].push_back(con.second);
+      add_face(con.second);
+    }
+  }
+
+  return 1;
+}
+
+// The total length of the edges that are cut, that is, the edges between
+// faces that are not joined in the tree
+double unzip_tree::get_cut_length(const Geometry &geom,
+                                  const vector<vector<int>> &f_cons) const
+{
+  set<pair<int, int>> joins;
+  for (const auto &kp : tree)
+    for (int child : kp.second)
+      joins.insert(std::minmax(kp.first, child));
+
+  double len = 0;
+  for (unsigned int f = 0; f < f_cons.size(); f++)
+    for (unsigned int v = 0; v < f_cons[f].size(); v++) {
+      int other = f_cons[f][v];
+      if ((int)f < other && !joins.count(pair<int, int>(f, other)))
+        len += geom.edge_len({geom.faces(f, v), geom.faces_mod(f, v + 1)});
+    }
+
+  return len;
+}
+
 int unzip_tree::flatten(const Geometry &geom, Geometry &net_geom,
                         double fract = 0.0)
 {
@@ -1862,8 +2045,153 @@ int unzip_tree::flatten(const Geometry &geom, Geometry &net_geom,
   return 1;
 }
 
+// Area of the convex hull of the net, which lies in the plane of the base
+// face
+static double get_net_hull_area(const Geometry &net_geom, int root)
+{
+  Trans3d trans = Trans3d::rotate(net_geom.face_norm(root), Vec3d::Z);
+  vector<Vec3d> pts;
+  for (const auto &v : net_geom.verts())
+    pts.push_back(trans * v);
+  std::sort(pts.begin(), pts.end(), [](const Vec3d &P0, const Vec3d &P1) {
+    return P0[0] < P1[0] || (P0[0] == P1[0] && P0[1] < P1[1]);
+  });
+
+  // Monotone chain, lower hull then upper hull
+  vector<Vec3d> hull(2 * pts.size());
+  int sz = 0;
+  for (int i = 0; i < (int)pts.size(); i++) {
+    while (sz >= 2 && orient2d(hull[sz - 2], hull[sz - 1], pts[i]) <= 0)
+      sz--;
+    hull[sz++] = pts[i];
+  }
+  for (int i = (int)pts.size() - 2, lower_sz = sz + 1; i >= 0; i--) {
+    while (sz >= lower_sz && orient2d(hull[sz - 2], hull[sz - 1], pts[i]) <= 0)
+      sz--;
+    hull[sz++] = pts[i];
+  }
+
+  double area = 0;
+  for (int i = 0; i < sz - 1; i++)
+    area += hull[i][0] * hull[i + 1][1] - hull[i + 1][0] * hull[i][1];
+  return area / 2;
+}
+
+// Search spanning trees for one that unfolds to a flat net without
+// overlapping faces. The first tree tried is the basic tree, and later
+// trees alternate between random edge weights and, for a random
+// direction, cutting the steepest edge up from each vertex. Trees are
+// tried on several threads, and the tree chosen only depends on the seed.
+// The metric is n - the first net found, a - the net with the smallest
+// convex hull area, c - the net with the shortest length of cut edges.
+// Returns the number of the tree used, or -1 if none gave a net.
+static int unzip_search(const Geometry &geom, int root, char metric,
+                        int num_tries, int seed, int num_threads,
+                        unzip_tree &tree)
+{
+  vector<vector<int>> f_cons;
+  if (!get_unzip_face_cons(geom, f_cons))
+    return -1;
+
+  // Give each face edge an edge index number
+  vector<vector<int>> edges;
+  vector<vector<int>> f_edges(geom.faces().size());
+  map<vector<int>, int> edge_idxs;
+  for (unsigned int f = 0; f < geom.faces().size(); f++)
+    for (unsigned int v = 0; v < geom.faces(f).size(); v++) {
+      auto edge = make_edge(geom.faces(f, v), geom.faces_mod(f, v + 1));
+      auto ei = edge_idxs.insert({edge, (int)edges.size()});
+      if (ei.second)
+        edges.push_back(edge);
+      f_edges[f].push_back(ei.first->second);
+    }
+
+  // A separate seed for each tree, so the trees do not depend on the
+  // order they are made in
+  Random rnd(seed);
+  vector<long unsigned int> seeds(num_tries);
+  for (auto &tree_seed : seeds)
+    tree_seed = rnd.ranlui();
+
+  auto make_tree = [&](int try_no, unzip_tree &try_tree) {
+    if (try_no == 0) {
+      try_tree.init_basic(geom, root);
+      return;
+    }
+
+    Random try_rnd(seeds[try_no]);
+    vector<double> edge_wts(edges.size());
+    for (auto &wt : edge_wts)
+      wt = 1 + try_rnd.ranf();
+
+    if (try_no % 2 == 0) {
+      Vec3d dir;
+      do
+        dir = Vec3d::random(try_rnd);
+      while (dir.len() < 0.1);
+      dir.to_unit();
+
+      const auto &verts = geom.verts();
+      vector<int> steepest(verts.size(), -1);
+      vector<double> slopes(verts.size(), 0.0);
+      for (unsigned int e = 0; e < edges.size(); e++) {
+        double slope = vdot(geom.edge_vec(edges[e]).unit(), dir);
+        int v_idx = (slope > 0) ? edges[e][0] : edges[e][1];
+        if (fabs(slope) > slopes[v_idx]) {
+          slopes[v_idx] = fabs(slope);
+          steepest[v_idx] = e;
+        }
+      }
+      for (int e : steepest)
+        if (e >= 0)
+          edge_wts[e] -= 1; // cut this edge if possible
+    }
+
+    try_tree.init_weighted(root, f_cons, f_edges, edge_wts);
+  };
+
+  // Score of each tree with a net without overlaps, lower is better
+  vector<double> scores(num_tries, -1);
+  std::atomic<int> first_found(num_tries);
+  parallel_for(
+      num_tries,
+      [&](size_t i) {
+        int try_no = i;
+        if (metric == 'n' && try_no > first_found)
+          return;
+        unzip_tree try_tree;
+        make_tree(try_no, try_tree);
+        Geometry net_geom;
+        try_tree.flatten(geom, net_geom, 0.0);
+        if (has_face_intersections(net_geom, epsilon, 1))
+          return;
+
+        if (metric == 'a')
+          scores[i] = get_net_hull_area(net_geom, root);
+        else if (metric == 'c')
+          scores[i] = try_tree.get_cut_length(geom, f_cons);
+        else
+          scores[i] = 0;
+
+        int cur = first_found;
+        while (try_no < cur && !first_found.compare_exchange_weak(cur, try_no))
+          ;
+      },
+      num_threads, 1);
+
+  int best = -1;
+  for (int i = 0; i < num_tries; i++)
+    if (scores[i] >= 0 && (best < 0 || scores[i] < scores[best]))
+      best = i;
+
+  if (best >= 0)
+    make_tree(best, tree);
+  return best;
+}
+
 int unzip_poly(Geometry &geom, int root, double fract, char centring,
-               bool unzip_z_align, char *errmsg)
+               bool unzip_z_align, char metric, int num_tries, int seed,
+               int num_threads, vector<string> &warnings, char *errmsg)
 {
   GeometryInfo info(geom);
   if (!info.is_polyhedron())
@@ -1886,7 +2214,19 @@ int unzip_poly(Geometry &geom, int root, double fract, char centring,
     geom.transform(Trans3d::rotate(geom.face_norm(root), Vec3d::Z));
 
   unzip_tree tree;
-  tree.init_basic(geom, root);
+  if (metric) {
+    int try_no =
+        unzip_search(geom, root, metric, num_tries, seed, num_threads, tree);
+    if (try_no < 0) {
+      warnings.push_back(msg_str("no net without overlaps found in %d "
+                                 "spanning trees, using the basic tree",
+                                 num_tries));
+      tree.init_basic(geom, root);
+    }
+  }
+  else
+    tree.init_basic(geom, root);
+
   Geometry net_geom;
   tree.flatten(geom, net_geom, fract);
 
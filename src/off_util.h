@@ -0,0 +1,66 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: off_util.h
+   Description: options for off_util, shared with antiprism_pipe
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef OFF_UTIL_H
+#define OFF_UTIL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../base/antiprism.h"
+#include "batch.h"
+
+class pr_opts : public anti::ProgramOpts {
+public:
+  std::vector<std::pair<char, std::string>> args;
+  std::vector<std::string> ifiles;
+  BatchOpts batch;
+  int num_threads;
+  int sig_digits;
+
+  std::string ofile;
+
+  pr_opts()
+      : ProgramOpts("off_util"), num_threads(0),
+        sig_digits(anti::DEF_SIG_DGTS)
+  {
+  }
+  void process_command_line(int argc, char **argv);
+  anti::Status process_geom(anti::Geometry &geom,
+                            std::vector<std::string> &warnings);
+  void usage();
+};
+
+// Process one file of a batch, and write the model to its own file
+void batch_process(pr_opts &opts, const std::string &ifile,
+                   BatchRecord &rec);
+
+#endif // OFF_UTIL_H
@@ -0,0 +1,75 @@
+/*
+   Copyright (c) 2003-2016, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: off_util_main.cc
+   Description: utility processing for OFF file, e.g. merge, orient
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include <string>
+#include <vector>
+
+#include "../base/antiprism.h"
+#include "batch.h"
+#include "off_util.h"
+
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+int main(int argc, char *argv[])
+{
+  pr_opts opts;
+  opts.process_command_line(argc, argv);
+
+  if (opts.batch.enabled) {
+    int num_failed = run_batch(opts, opts.batch, stdout,
+                               [&](const string &ifile, BatchRecord &rec) {
+                                 pr_opts file_opts = opts;
+                                 batch_process(file_opts, ifile, rec);
+                               });
+    return (num_failed > 0);
+  }
+
+  // Append all input files
+  Geometry geom;
+  for (auto &ifile : opts.ifiles) {
+    Geometry geom_arg;
+    if (ifile != "null")
+      opts.read_or_error(geom_arg, ifile);
+    geom.append(geom_arg);
+  }
+
+  vector<string> warnings;
+  Status stat = opts.process_geom(geom, warnings);
+  for (const auto &warning : warnings)
+    opts.warning(warning);
+  opts.print_status_or_exit(stat);
+
+  opts.write_or_error(geom, opts.ofile, opts.sig_digits);
+
+  return 0;
+}
@@ -37,6 +37,7 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../base/antiprism.h"
@@ -65,6 +66,7 @@ public:
   bool winding_div2; // not implemented
   bool find_direction;
   bool verbose;
+  int num_threads;
   int orient;
   bool hole_detection;
   Vec3d center;
@@ -97,8 +99,8 @@ public:
       : ProgramOpts("planar"), face_color_method('\0'), planar_merge_type(0),
         polygon_fill_type(0), winding_rule(INT_MAX), winding_rule_mode(INT_MAX),
         color_by_winding_number('\0'), winding_div2(false), // not implemented
-        find_direction(false), verbose(false), orient(0), hole_detection(true),
-        stitch_faces(false), split_pinched(false),
+        find_direction(false), verbose(false), num_threads(0), orient(0),
+        hole_detection(true), stitch_faces(false), split_pinched(false),
         rebuild_compound_model(false), simplify_face_edges(false),
         delete_invisible_faces(false), edge_blending('\0'),
         special_edge_processing('\0'), zero_density_color(Color::invisible),
@@ -155,6 +157,8 @@ void planar_opts::usage()
 "  -C <xyz>  center of model, in form 'X,Y,Z' (default: centroid)\n"
 "  -l <lim>  minimum distance for unique vertex locations as negative exponent\n"
 "               (default: %d giving %.0e)\n"
+"  -j <num>  number of planes to blend at the same time (default: number of\n"
+"               hardware threads, or $ANTIPRISM_THREADS if set)\n"
 "  -o <file> write output to file (default: write to standard output)\n"
 "\nColor Blending Options (for option -d)\n"
 "  -M <mode> color blending mode. HSV=1, HSL=2, RGB=3 (default: 3)\n"
@@ -211,7 +215,7 @@ void planar_opts::process_command_line(int argc, char **argv)
 
   while ((c = getopt(
               argc, argv,
-              ":hd:p:w:zVO:HC:SRrIe:E:Db:M:s:t:v:u:a:cyf:T:m:Z:W:n:l:o:")) !=
+              ":hd:p:w:zVO:HC:SRrIe:E:Db:M:s:t:v:u:a:cyf:T:m:Z:W:n:l:j:o:")) !=
          -1) {
     if (common_opts(c, optopt))
       continue;
@@ -397,6 +401,12 @@ void planar_opts::process_command_line(int argc, char **argv)
       ryb_mode = true;
       break;
 
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
     case 'f':
       if (strlen(optarg) != 1 || !strchr("npo", *optarg))
         error("color method must be n, p or o", c);
@@ -519,49 +529,156 @@ public:
   }
 };
 
-// second check: if polygons are not actually on the same plane, split them up
-// RK - this can only happen when the normals are not forced outward
-vector<vector<int>> on_same_plane_filter(const Geometry &geom,
-                                         const Vec3d &normal,
-                                         const vector<int> &coplanar_faces,
-                                         const bool filtered, const double eps)
-{
-  const vector<vector<int>> &faces = geom.faces();
-  const vector<Vec3d> &verts = geom.verts();
+// key of a cell in the plane hash
+struct plane_cell {
+  long long k[3];
+  bool operator==(const plane_cell &c) const
+  {
+    return k[0] == c.k[0] && k[1] == c.k[1] && k[2] == c.k[2];
+  }
+};
+
+struct plane_cell_hash {
+  size_t operator()(const plane_cell &c) const
+  {
+    size_t h = std::hash<long long>()(c.k[0]);
+    h = h * 1000003 ^ std::hash<long long>()(c.k[1]);
+    return h * 1000003 ^ std::hash<long long>()(c.k[2]);
+  }
+};
 
-  vector<vector<int>> coplanar_faces_filtered;
+// Groups values (normals, or plane offsets in x) which are within eps of the
+// first value in the group. Values are quantised into cells no smaller than
+// eps, so matches are found by probing the neighbouring cells.
+class PlaneHash {
+private:
+  int dim;
+  double cell_sz;
+  vector<Vec3d> reps; // first value in each group
+  std::unordered_map<plane_cell, vector<int>, plane_cell_hash> cells;
+
+  plane_cell get_cell(const Vec3d &val) const
+  {
+    plane_cell cell = {{0, 0, 0}};
+    for (int i = 0; i < dim; i++)
+      cell.k[i] = (long long)floor(val[i] / cell_sz);
+    return cell;
+  }
+
+public:
+  // dim is 3 for normals, or 1 for offsets. scale is the largest magnitude
+  // of a value, which limits the number of cells
+  PlaneHash(int dim, double scale, double eps)
+      : dim(dim), cell_sz(max(eps, max(scale, 1.0) * 1e-12))
+  {
+  }
 
-  if (!filtered) {
-    coplanar_faces_filtered.push_back(coplanar_faces);
-    return coplanar_faces_filtered;
+  // index of the earliest group matching val, or -1 if there is none
+  int find(const Vec3d &val, double eps) const
+  {
+    plane_cell base = get_cell(val);
+    int lim[3] = {1, dim > 1, dim > 2};
+    int found = -1;
+    plane_cell cell;
+    for (int i = -lim[0]; i <= lim[0]; i++)
+      for (int j = -lim[1]; j <= lim[1]; j++)
+        for (int k = -lim[2]; k <= lim[2]; k++) {
+          cell.k[0] = base.k[0] + i;
+          cell.k[1] = base.k[1] + j;
+          cell.k[2] = base.k[2] + k;
+          auto it = cells.find(cell);
+          if (it != cells.end())
+            for (int g : it->second)
+              if ((found == -1 || g < found) && !compare(reps[g], val, eps))
+                found = g;
+        }
+    return found;
   }
 
-  vector<int> coplanar_faces_actual;
-  vector<int> written;
+  // index of the group for val, a new group is added if there is no match
+  int get_group(const Vec3d &val, double eps)
+  {
+    int group = find(val, eps);
+    if (group == -1) {
+      group = reps.size();
+      reps.push_back(val);
+      cells[get_cell(val)].push_back(group);
+    }
+    return group;
+  }
 
-  int sz = coplanar_faces.size();
-  for (int i = 0; i < sz; i++) {
-    int face_idx1 = coplanar_faces[i];
-    if (find(written.begin(), written.end(), face_idx1) != written.end())
+  // the first value added to a group
+  const Vec3d &get_rep(int group) const { return reps[group]; }
+};
+
+// group faces with the same normal, and if filtered split them up into
+// faces on the same plane. RK - planes with the same normal can only happen
+// when the normals are not forced outward
+void add_coplanar_faces(const Geometry &geom,
+                        vector<pair<Vec3d, int>> &face_normal_table,
+                        vector<vector<int>> &coplanar_faces_list,
+                        vector<Normal> &coplanar_normals,
+                        const FaceNormals &FaceNormals, const bool fold_normals,
+                        const bool filtered, const double eps)
+{
+  const vector<vector<int>> &faces = geom.faces();
+  const vector<Vec3d> &verts = geom.verts();
+
+  // a normal opposite to an earlier normal is reversed when folding
+  PlaneHash normals(3, 1.0, eps);
+  vector<vector<int>> groups; // indexes into face_normal_table
+  for (unsigned int i = 0; i < face_normal_table.size(); i++) {
+    Vec3d &normal = face_normal_table[i].first;
+    if (fold_normals && normals.find(-normal, eps) != -1)
+      normal = -normal;
+    int group = normals.get_group(normal, eps);
+    if (group == (int)groups.size())
+      groups.push_back(vector<int>());
+    groups[group].push_back(i);
+  }
+
+  // keep the order given by sorting the normals
+  vector<int> order(groups.size());
+  for (unsigned int i = 0; i < order.size(); i++)
+    order[i] = i;
+  stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return compare(normals.get_rep(a), normals.get_rep(b), eps) < 0;
+  });
+
+  for (int g : order) {
+    // the normal of the last face in the group is used for the group
+    const pair<Vec3d, int> &last = face_normal_table[groups[g].back()];
+    if (!filtered) {
+      vector<int> coplanar_faces;
+      for (int i : groups[g])
+        coplanar_faces.push_back(face_normal_table[i].second);
+      coplanar_faces_list.push_back(coplanar_faces);
+      coplanar_normals.push_back(FaceNormals[last.second]);
       continue;
-    coplanar_faces_actual.push_back(face_idx1);
-    for (int j = i + 1; j < sz; j++) {
-      if (i == j)
-        continue;
-      int face_idx2 = coplanar_faces[j];
-      Vec3d v0 = verts[faces[face_idx1][0]];
-      Vec3d P = verts[faces[face_idx2][0]];
-      if (double_eq(vdot(v0 - P, normal), 0.0, eps)) {
-        coplanar_faces_actual.push_back(face_idx2);
-        written.push_back(face_idx2);
-      }
     }
 
-    coplanar_faces_filtered.push_back(coplanar_faces_actual);
-    coplanar_faces_actual.clear();
-  }
+    vector<double> offsets;
+    double scale = 0.0;
+    for (int i : groups[g]) {
+      int f_idx = face_normal_table[i].second;
+      offsets.push_back(vdot(verts[faces[f_idx][0]], last.first));
+      scale = max(scale, fabs(offsets.back()));
+    }
 
-  return coplanar_faces_filtered;
+    PlaneHash planes(1, scale, eps);
+    vector<vector<int>> coplanar_faces_filtered;
+    for (unsigned int i = 0; i < offsets.size(); i++) {
+      int plane = planes.get_group(Vec3d(offsets[i], 0, 0), eps);
+      if (plane == (int)coplanar_faces_filtered.size())
+        coplanar_faces_filtered.push_back(vector<int>());
+      coplanar_faces_filtered[plane].push_back(
+          face_normal_table[groups[g][i]].second);
+    }
+    for (auto &coplanar_faces : coplanar_faces_filtered) {
+      coplanar_faces_list.push_back(coplanar_faces);
+      coplanar_normals.push_back(FaceNormals[last.second]);
+    }
+  }
 }
 
 void build_coplanar_faces_list(const Geometry &geom,
@@ -596,102 +713,16 @@ void build_coplanar_faces_list(const Geometry &geom,
       face_normal_table.push_back(face_normal_pair);
   }
 
-  vector<int> coplanar_faces;
-
   // hemispherical normals are folded only with specific option
   // if folded, this is what associates them on the same plane
-  int sz = hemispherical_table.size();
-  if (fold_normals_hemispherical && (sz > 1)) {
-    for (int i = 0; i < sz - 1; i++) {
-      for (int j = i + 1; j < sz; j++) {
-        if (!compare(hemispherical_table[i].first,
-                     -hemispherical_table[j].first, eps)) {
-          hemispherical_table[j].first = -hemispherical_table[j].first;
-        }
-      }
-    }
-  }
-
-  // collect hemispherical which are coplanar
-  if (sz) {
-    stable_sort(hemispherical_table.begin(), hemispherical_table.end(),
-                vert_cmp(eps));
-
-    // at least one face is on a plane
-    coplanar_faces.push_back(hemispherical_table[0].second);
-    // find faces on same plane and group them together
-    for (int i = 1; i < sz; i++) {
-      if (compare(hemispherical_table[i].first,
-                  hemispherical_table[i - 1].first, eps)) {
-        vector<vector<int>> coplanar_faces_filtered =
-            on_same_plane_filter(geom, hemispherical_table[i - 1].first,
-                                 coplanar_faces, filtered, eps);
-        for (auto &j : coplanar_faces_filtered) {
-          coplanar_faces_list.push_back(j);
-          coplanar_normals.push_back(
-              FaceNormals[hemispherical_table[i - 1].second]);
-        }
-        coplanar_faces.clear();
-      }
-      coplanar_faces.push_back(hemispherical_table[i].second);
-    }
-    vector<vector<int>> coplanar_faces_filtered = on_same_plane_filter(
-        geom, hemispherical_table[sz - 1].first, coplanar_faces, filtered, eps);
-    for (auto &j : coplanar_faces_filtered) {
-      coplanar_faces_list.push_back(j);
-      coplanar_normals.push_back(
-          FaceNormals[hemispherical_table[sz - 1].second]);
-    }
-    coplanar_faces.clear();
-  }
+  add_coplanar_faces(geom, hemispherical_table, coplanar_faces_list,
+                     coplanar_normals, FaceNormals, fold_normals_hemispherical,
+                     filtered, eps);
 
   // non-hemispherical normals are folded only with specific option
-  sz = face_normal_table.size();
-  if (fold_normals && (sz > 1)) {
-    for (int i = 0; i < sz - 1; i++) {
-      for (int j = i + 1; j < sz; j++) {
-        if (!compare(face_normal_table[i].first, -face_normal_table[j].first,
-                     eps)) {
-          face_normal_table[j].first = -face_normal_table[j].first;
-        }
-      }
-    }
-  }
-
-  // collect non-hemispherical which are coplanar
-  if (sz) {
-    stable_sort(face_normal_table.begin(), face_normal_table.end(),
-                vert_cmp(eps));
-
-    // at least one face is on a plane
-    coplanar_faces.push_back(face_normal_table[0].second);
-    // find faces on same plane and group them together
-    for (int i = 1; i < sz; i++) {
-      if (compare(face_normal_table[i].first, face_normal_table[i - 1].first,
-                  eps)) {
-        vector<vector<int>> coplanar_faces_filtered =
-            on_same_plane_filter(geom, face_normal_table[i - 1].first,
-                                 coplanar_faces, filtered, eps);
-        for (auto &j : coplanar_faces_filtered) {
-          coplanar_faces_list.push_back(j);
-          coplanar_normals.push_back(
-              FaceNormals[face_normal_table[i - 1].second]);
-        }
-        coplanar_faces.clear();
-      }
-      coplanar_faces.push_back(face_normal_table[i].second);
-    }
-    vector<vector<int>> coplanar_faces_filtered = on_same_plane_filter(
-        geom, face_normal_table[sz - 1].first, coplanar_faces, filtered, eps);
-    for (auto &j : coplanar_faces_filtered) {
-      coplanar_faces_list.push_back(j);
-      coplanar_normals.push_back(FaceNormals[face_normal_table[sz - 1].second]);
-    }
-    coplanar_faces.clear();
-  }
-
-  hemispherical_table.clear();
-  face_normal_table.clear();
+  add_coplanar_faces(geom, face_normal_table, coplanar_faces_list,
+                     coplanar_normals, FaceNormals, fold_normals, filtered,
+                     eps);
 }
 
 // save free edges into a geom
@@ -1272,15 +1303,15 @@ void check_for_holes(Geometry &geom, vector<pair<int, int>> &polygon_hierarchy,
   if (faces.size() < 2)
     return;
 
-  for (unsigned int i = 0; i < faces.size(); i++) {
-    for (unsigned int j = 0; j < faces.size(); j++) {
-      if (i == j)
-        continue;
-      if (is_face_inside_face(geom, i, j, eps)) {
-        // store as child/parent
-        polygon_hierarchy.push_back(make_pair(j, i));
-      }
-    }
+  // a face can only be inside another if their boxes overlap
+  vector<pair<int, int>> pairs;
+  FaceBVH(geom, eps).get_overlapping_pairs(pairs);
+  for (const auto &pr : pairs) {
+    // store as child/parent
+    if (is_face_inside_face(geom, pr.first, pr.second, eps))
+      polygon_hierarchy.push_back(make_pair(pr.second, pr.first));
+    if (is_face_inside_face(geom, pr.second, pr.first, eps))
+      polygon_hierarchy.push_back(make_pair(pr.first, pr.second));
   }
 
   sort(polygon_hierarchy.begin(), polygon_hierarchy.end());
@@ -1478,12 +1509,15 @@ void sample_colors(Geometry &sgeom, const Geometry &cgeom,
   if (opts.zero_density_force_blend)
     zero_density_col = average_color_all_faces;
 
+  vector<bool> nonconvex(sfaces.size(), false);
+  for (int f_idx : nonconvex_faces)
+    nonconvex[f_idx] = true;
+
   for (unsigned int i = 0; i < sfaces.size(); i++) {
     vector<Vec3d> points;
 
     // if the sampling face is convex
-    if (find(nonconvex_faces.begin(), nonconvex_faces.end(), (int)i) ==
-        nonconvex_faces.end())
+    if (!nonconvex[i])
       points.push_back(sgeom.face_cent(i));
     else {
       // else non-convex. need to triangulate the non-convex sample polygon to
@@ -1642,79 +1676,101 @@ void collect_original_normals(vector<Normal> &original_normals,
     original_normals.push_back(FaceNormals[i]);
 }
 
-void blend_overlapping_faces(Geometry &geom,
-                             const vector<vector<int>> &coplanar_faces_list,
-                             const vector<Normal> &coplanar_normals,
-                             const FaceNormals &FaceNormals,
-                             const planar_opts &opts)
+// blend the faces on one plane, winding_total_min, winding_total_max are
+// changed
+Geometry blend_plane(const Geometry &geom, const vector<int> &coplanar_faces,
+                     const Normal &coplanar_normal,
+                     const FaceNormals &FaceNormals, int &winding_total_min,
+                     int &winding_total_max, const planar_opts &opts)
 {
-  Geometry bgeom;
-  vector<int> deleted_faces;
+  // load a geom with color faces. keep it and copy it.
+  Geometry cgeom = faces_to_geom(geom, coplanar_faces);
+  Geometry sgeom = cgeom;
 
-  int winding_number_min = INT_MAX;
-  int winding_number_max = INT_MIN;
+  // check here for polygons within polygons
+  vector<vector<int>> connectors;
+  vector<pair<Vec3d, Vec3d>> connectors_verts;
+  if (opts.hole_detection) {
+    vector<pair<int, int>> polygon_hierarchy;
+    check_for_holes(sgeom, polygon_hierarchy, opts.epsilon);
+    if (polygon_hierarchy.size())
+      make_hole_connectors(sgeom, connectors, connectors_verts,
+                           polygon_hierarchy);
+  }
 
-  for (unsigned int i = 0; i < coplanar_faces_list.size(); i++) {
-    // load a geom with color faces. keep it and copy it.
-    Geometry cgeom = faces_to_geom(geom, coplanar_faces_list[i]);
-    Geometry sgeom = cgeom;
-
-    // check here for polygons within polygons
-    vector<vector<int>> connectors;
-    vector<pair<Vec3d, Vec3d>> connectors_verts;
-    if (opts.hole_detection) {
-      vector<pair<int, int>> polygon_hierarchy;
-      check_for_holes(sgeom, polygon_hierarchy, opts.epsilon);
-      if (polygon_hierarchy.size())
-        make_hole_connectors(sgeom, connectors, connectors_verts,
-                             polygon_hierarchy);
-    }
+  make_skeleton(sgeom);
 
-    make_skeleton(sgeom);
+  if (connectors.size())
+    add_hole_connectors(sgeom, connectors);
+  connectors.clear();
 
-    // edges with duplicate indexes can happen if faces have duplicate
-    // sequential indexes
-    delete_duplicate_index_edges(geom);
+  // duplicate vertices and edges can cause problems
+  merge_coincident_elements(sgeom, "ve", 0, opts.epsilon);
 
-    if (connectors.size())
-      add_hole_connectors(sgeom, connectors);
-    connectors.clear();
+  // sort merge can destill more duplicate indexes
+  delete_duplicate_index_edges(sgeom);
 
-    // duplicate vertices and edges can cause problems
-    merge_coincident_elements(sgeom, "ve", 0, opts.epsilon);
+  mesh_verts(sgeom, opts.epsilon);
+  mesh_edges(sgeom, opts.epsilon);
 
-    // sort merge can destill more duplicate indexes
-    delete_duplicate_index_edges(sgeom);
+  // have to use vertex location for marking because indexes have been
+  // scrambled
+  if (connectors_verts.size())
+    mark_hole_connectors(sgeom, connectors_verts, opts.epsilon);
+  connectors_verts.clear();
 
-    mesh_verts(sgeom, opts.epsilon);
-    mesh_edges(sgeom, opts.epsilon);
+  vector<int> nonconvex_faces;
+  fill_in_faces(sgeom, opts.planar_merge_type, nonconvex_faces,
+                coplanar_normal.outward().unit(), opts.epsilon);
 
-    // have to use vertex location for marking because indexes have been
-    // scrambled
-    if (connectors_verts.size())
-      mark_hole_connectors(sgeom, connectors_verts, opts.epsilon);
-    connectors_verts.clear();
+  // original normals are needed for sampling colors
+  vector<Normal> original_normals;
+  collect_original_normals(original_normals, coplanar_faces, FaceNormals);
 
-    vector<int> nonconvex_faces;
-    fill_in_faces(sgeom, opts.planar_merge_type, nonconvex_faces,
-                  coplanar_normals[i].outward().unit(), opts.epsilon);
+  sample_colors(sgeom, cgeom, original_normals, nonconvex_faces,
+                winding_total_min, winding_total_max, opts);
 
-    // original normals are needed for sampling colors
-    vector<Normal> original_normals;
-    collect_original_normals(original_normals, coplanar_faces_list[i],
-                             FaceNormals);
+  return sgeom;
+}
 
-    int winding_total_min = INT_MAX;
-    int winding_total_max = INT_MIN;
-    sample_colors(sgeom, cgeom, original_normals, nonconvex_faces,
-                  winding_total_min, winding_total_max, opts);
+void blend_overlapping_faces(Geometry &geom,
+                             const vector<vector<int>> &coplanar_faces_list,
+                             const vector<Normal> &coplanar_normals,
+                             const FaceNormals &FaceNormals,
+                             const planar_opts &opts)
+{
+  // edges with duplicate indexes can happen if faces have duplicate
+  // sequential indexes
+  if (coplanar_faces_list.size())
+    delete_duplicate_index_edges(geom);
+
+  // the planes are independent, so they are blended in parallel
+  size_t num_planes = coplanar_faces_list.size();
+  vector<Geometry> sgeoms(num_planes);
+  vector<int> winding_totals_min(num_planes, INT_MAX);
+  vector<int> winding_totals_max(num_planes, INT_MIN);
+  parallel_for(num_planes,
+               [&](size_t i) {
+                 sgeoms[i] = blend_plane(
+                     geom, coplanar_faces_list[i], coplanar_normals[i],
+                     FaceNormals, winding_totals_min[i], winding_totals_max[i],
+                     opts);
+               },
+               opts.num_threads, 1);
+
+  Geometry bgeom;
+  vector<int> deleted_faces;
+
+  int winding_number_min = INT_MAX;
+  int winding_number_max = INT_MIN;
 
-    if (winding_total_min < winding_number_min)
-      winding_number_min = winding_total_min;
-    if (winding_total_max > winding_number_max)
-      winding_number_max = winding_total_max;
+  for (unsigned int i = 0; i < num_planes; i++) {
+    if (winding_totals_min[i] < winding_number_min)
+      winding_number_min = winding_totals_min[i];
+    if (winding_totals_max[i] > winding_number_max)
+      winding_number_max = winding_totals_max[i];
 
-    bgeom.append(sgeom);
+    bgeom.append(sgeoms[i]);
 
     // mark the faces in the cluster for deletion at the end
     deleted_faces.insert(deleted_faces.end(), coplanar_faces_list[i].begin(),
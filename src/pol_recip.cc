@@ -254,11 +254,14 @@ int find_mid_centre(Geometry &geom, double &rad, Vec3d &cent, int n,
   double cur_rad = rad;
   double cent_test = -1, rad_test = -1;
   int cnt;
+  vector<Vec3d> g_near(e_sz);
   for (cnt = 0; cnt < n; cnt++) {
     Vec3d c_diff(0, 0, 0);
     double rad_sum_g = 0;
+    batch_edge_nearest_points(geom.verts().data(), g_edges, cur_cent,
+                              g_near.data());
     for (int e = 0; e < e_sz; ++e) {
-      Vec3d Pg = nearest_point(cur_cent, geom.verts(), g_edges[e]);
+      const Vec3d &Pg = g_near[e];
       double r = (Pg - cur_cent).len();
       rad_sum_g += r;
       c_diff += (1 - r / cur_rad) * (Pg - cur_cent);
@@ -315,6 +318,7 @@ int find_can_centre(Geometry &geom, char type, double &rad, Vec3d &cent,
     dual.transform(Trans3d::translate(cent) * Trans3d::inversion() *
                    Trans3d::translate(-cent));
   dual.get_impl_edges(d_edges);
+  vector<Vec3d> g_near(e_sz), d_near(d_edges.size());
   Vec3d cur_cent = cent;
   double cur_rad = rad;
   double cent_test = -1, rad_test = -1;
@@ -326,11 +330,15 @@ int find_can_centre(Geometry &geom, char type, double &rad, Vec3d &cent,
       Vec3d e_sum_g(0, 0, 0);
       Vec3d e_sum_d(0, 0, 0);
       double rad_sum_g = 0, rad_sum_d = 0;
+      batch_edge_nearest_points(geom.verts().data(), g_edges, cur_cent,
+                                g_near.data());
+      batch_edge_nearest_points(dual.verts().data(), d_edges, cur_cent,
+                                d_near.data());
       for (int e = 0; e < e_sz; ++e) {
-        Vec3d Pg = nearest_point(cur_cent, geom.verts(), g_edges[e]);
+        const Vec3d &Pg = g_near[e];
         rad_sum_g += (Pg - cur_cent).len();
         e_sum_g += Pg;
-        Vec3d Pd = nearest_point(cur_cent, dual.verts(), d_edges[e]);
+        const Vec3d &Pd = d_near[e];
         rad_sum_d += (Pd - cur_cent).len();
         e_sum_d += Pd;
       }
@@ -413,10 +413,13 @@ int main(int argc, char *argv[])
   if (opts.print_report)
     print_report(stderr, opts.sym, part_sym, min_ts.size());
 
-  Geometry comp_geom;
-  sym_repeat(comp_geom, geom, min_ts, opts.col_elems, opts.clrngs);
+  // The compound is written from the instances, without expanding it
+  InstancedGeometry comp_geom;
+  comp_geom.init(geom, min_ts, opts.col_elems, opts.clrngs);
 
-  opts.write_or_error(comp_geom, opts.ofile);
+  opts.print_status_or_exit(comp_geom.write(opts.ofile));
+  if (!comp_geom.num_verts())
+    opts.warning("output geometry has no vertices (empty geometry)");
 
   return 0;
 }
@@ -31,12 +31,14 @@
 #include "rep_print.h"
 #include <map>
 #include <set>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <string>
 #include <utility>
 #include <vector>
 
+using std::make_pair;
 using std::map;
 using std::pair;
 using std::set;
@@ -87,65 +89,85 @@ char *rep_printer::col2s(char *buf, Color col)
   return buf;
 }
 
+void rep_printer::sec_start(const string &name, bool is_list)
+{
+  if (vals) {
+    sec_name = name;
+    in_list = is_list && join_lists;
+    list_val.clear();
+  }
+  else
+    fprintf(ofile, "[%s]\n", name.c_str());
+}
+
+void rep_printer::put(const string &key, const string &val, const char *sep)
+{
+  if (!vals)
+    fprintf(ofile, "%s%s%s\n", key.c_str(), sep, val.c_str());
+  else if (in_list)
+    list_val += (list_val.empty() ? "" : "; ") + key + "=" + val;
+  else
+    vals->push_back(make_pair(sec_name + "." + key, val));
+}
+
+void rep_printer::sec_end()
+{
+  if (!vals)
+    fprintf(ofile, "\n");
+  else if (in_list)
+    vals->push_back(make_pair(sec_name, list_val));
+}
+
 void rep_printer::general_sec()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[general]\n");
-  fprintf(ofile, "num_verts = %d\n", num_verts());
-  fprintf(ofile, "num_faces = %d\n", num_faces());
-  fprintf(ofile, "num_edges = %d\n", num_edges());
-  fprintf(ofile, "vertex_centroid = (%s)\n", v2s(s1, geom.centroid()));
-  fprintf(ofile, "volume_centroid = ");
+  sec_start("general");
+  put("num_verts", msg_str("%d", num_verts()));
+  put("num_faces", msg_str("%d", num_faces()));
+  put("num_edges", msg_str("%d", num_edges()));
+  put("vertex_centroid", msg_str("(%s)", v2s(s1, geom.centroid())));
   if (geom.is_oriented() && is_polyhedron())
-    fprintf(ofile, "(%s)", v2s(s1, volume_centroid()));
+    put("volume_centroid", msg_str("(%s)", v2s(s1, volume_centroid())));
   else
-    fprintf(ofile, "n/a (calculated value: (%s))", v2s(s1, volume_centroid()));
-  fprintf(ofile, "\n");
+    put("volume_centroid", msg_str("n/a (calculated value: (%s))",
+                                   v2s(s1, volume_centroid())));
 
-  fprintf(ofile, "oriented = ");
+  const char *yes_no = is_oriented() ? "yes" : "no";
   if (is_known_connectivity())
-    fprintf(ofile, "%s", is_oriented() ? "yes" : "no");
+    put("oriented", yes_no);
   else
-    fprintf(ofile, "n/a (calculated value: %s)", is_oriented() ? "yes" : "no");
-  fprintf(ofile, "\n");
+    put("oriented", msg_str("n/a (calculated value: %s)", yes_no));
 
-  fprintf(ofile, "orientable = ");
+  yes_no = is_orientable() ? "yes" : "no";
   if (is_known_connectivity())
-    fprintf(ofile, "%s", is_orientable() ? "yes" : "no");
+    put("orientable", yes_no);
   else
-    fprintf(ofile, "n/a (calculated value: %s)",
-            is_orientable() ? "yes" : "no");
-  fprintf(ofile, "\n");
+    put("orientable", msg_str("n/a (calculated value: %s)", yes_no));
 
-  fprintf(ofile, "connectivity = %spolyhedron, %sclosed, %seven, %sknown\n",
-          is_polyhedron() ? "" : "not ", is_closed() ? "" : "not ",
-          is_even_connectivity() ? "" : "not ",
-          is_known_connectivity() ? "" : "not ");
+  put("connectivity",
+      msg_str("%spolyhedron, %sclosed, %seven, %sknown",
+              is_polyhedron() ? "" : "not ", is_closed() ? "" : "not ",
+              is_even_connectivity() ? "" : "not ",
+              is_known_connectivity() ? "" : "not "));
 
-  fprintf(ofile, "num_parts = ");
   if (is_known_connectivity())
-    fprintf(ofile, "%d", num_parts());
+    put("num_parts", msg_str("%d", num_parts()));
   else
-    fprintf(ofile, "n/a (calculated value: %d)", num_parts());
-  fprintf(ofile, "\n");
+    put("num_parts", msg_str("n/a (calculated value: %d)", num_parts()));
 
-  fprintf(ofile, "genus = ");
   if (is_known_genus())
-    fprintf(ofile, "%d", genus());
+    put("genus", msg_str("%d", genus()));
   else
-    fprintf(ofile, "n/a");
-  fprintf(ofile, "\n");
+    put("genus", "n/a");
 
-  fprintf(ofile, "area = %s\n", d2s(s1, face_areas().sum));
+  put("area", d2s(s1, face_areas().sum));
 
-  fprintf(ofile, "volume = ");
   if (geom.is_oriented() && is_polyhedron())
-    fprintf(ofile, "%s", d2s(s1, volume()));
+    put("volume", d2s(s1, volume()));
   else
-    fprintf(ofile, "n/a (calculated value: %s)", d2s(s1, volume()));
-  fprintf(ofile, "\n");
+    put("volume", msg_str("n/a (calculated value: %s)", d2s(s1, volume())));
 
-  fprintf(ofile, "\n");
+  sec_end();
 }
 
 void rep_printer::faces_sec()
@@ -153,27 +175,26 @@ void rep_printer::faces_sec()
   char s1[MSG_SZ];
   char s2[MSG_SZ];
   int sz = num_faces();
-  fprintf(ofile, "[faces]\n");
-  fprintf(ofile, "num_faces = %d\n", sz);
-  fprintf(ofile, "area = %s\n", d2s(s1, (sz) ? face_areas().sum : 0.0));
-  fprintf(ofile, "face_area_max = %s (%s)\n",
-          d2s(s1, (sz) ? face_areas().max : 0.0),
-          (sz) ? d2s(s2, face_areas().idx[ElementLimits::IDX_MAX]) : "n/a");
-  fprintf(ofile, "face_area_min = %s (%s)\n",
-          d2s(s1, (sz) ? face_areas().min : 0.0),
-          (sz) ? d2s(s2, face_areas().idx[ElementLimits::IDX_MIN]) : "n/a");
-  fprintf(ofile, "face_area_avg = %s\n",
-          d2s(s1, (sz) ? face_areas().sum / sz : 0.0));
-  fprintf(ofile, "volume = ");
-  if (sz && is_closed())
-    fprintf(ofile, "%s\n", d2s(s1, volume()));
-  else
-    fprintf(ofile, "n/a (not closed)\n");
-  fprintf(ofile, "isoperimetric_quotient = ");
-  if (sz && is_closed())
-    fprintf(ofile, "%s\n", d2s(s1, isoperimetric_quotient()));
-  else
-    fprintf(ofile, "n/a (not closed)\n");
+  sec_start("faces");
+  put("num_faces", msg_str("%d", sz));
+  put("area", d2s(s1, (sz) ? face_areas().sum : 0.0));
+  put("face_area_max",
+      msg_str("%s (%s)", d2s(s1, (sz) ? face_areas().max : 0.0),
+              (sz) ? d2s(s2, face_areas().idx[ElementLimits::IDX_MAX])
+                   : "n/a"));
+  put("face_area_min",
+      msg_str("%s (%s)", d2s(s1, (sz) ? face_areas().min : 0.0),
+              (sz) ? d2s(s2, face_areas().idx[ElementLimits::IDX_MIN])
+                   : "n/a"));
+  put("face_area_avg", d2s(s1, (sz) ? face_areas().sum / sz : 0.0));
+  if (sz && is_closed()) {
+    put("volume", d2s(s1, volume()));
+    put("isoperimetric_quotient", d2s(s1, isoperimetric_quotient()));
+  }
+  else {
+    put("volume", "n/a (not closed)");
+    put("isoperimetric_quotient", "n/a (not closed)");
+  }
 
   double max_nonplanar = 0.0;
   double sum_nonplanar = 0.0;
@@ -183,127 +204,142 @@ void rep_printer::faces_sec()
     if (nonplanar > max_nonplanar)
       max_nonplanar = nonplanar;
   }
-  fprintf(ofile, "maximum_nonplanarity = %s\n", d2s(s1, max_nonplanar));
-  fprintf(ofile, "average_nonplanarity = %s\n",
-          d2s(s1, (sz) ? sum_nonplanar / sz : 0.0));
-  fprintf(ofile, "\n");
+  put("maximum_nonplanarity", d2s(s1, max_nonplanar));
+  put("average_nonplanarity", d2s(s1, (sz) ? sum_nonplanar / sz : 0.0));
+  sec_end();
 }
 
 void rep_printer::angles_sec()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[angles]\n");
-  fprintf(ofile, "angle_max = %s\n", d2s(s1, rad2deg(angle_lims().max)));
-  fprintf(ofile, "angle_min = %s\n", d2s(s1, rad2deg(angle_lims().min)));
-  fprintf(ofile, "angle_avg = %s\n",
-          d2s(s1, rad2deg(angle_lims().sum / num_angles())));
-  fprintf(ofile, "angle_defect = %s\n", d2s(s1, rad2deg(angle_defect())));
-  fprintf(ofile, "\n");
+  sec_start("angles");
+  put("angle_max", d2s(s1, rad2deg(angle_lims().max)));
+  put("angle_min", d2s(s1, rad2deg(angle_lims().min)));
+  put("angle_avg", d2s(s1, rad2deg(angle_lims().sum / num_angles())));
+  put("angle_defect", d2s(s1, rad2deg(angle_defect())));
+  sec_end();
 }
 
 void rep_printer::solid_angles_sec()
 {
   char s1[MSG_SZ], s2[MSG_SZ];
-  fprintf(ofile, "[solid_angles]\n");
-  fprintf(ofile, "dihed_angle_max = %s (%d, %d)\n",
-          d2s(s1, rad2deg(dihed_angle_lims().max)),
-          dihed_angle_lims().idx[ElementLimits::IDX_MAX],
-          dihed_angle_lims().idx[ElementLimits::IDX_MAX2]);
-  fprintf(ofile, "dihed_angle_min = %s (%d, %d)\n",
-          d2s(s1, rad2deg(dihed_angle_lims().min)),
-          dihed_angle_lims().idx[ElementLimits::IDX_MIN],
-          dihed_angle_lims().idx[ElementLimits::IDX_MIN2]);
-  fprintf(ofile, "dihed_angle_flattest = %s (%d, %d)\n",
-          d2s(s1, rad2deg(dihed_angle_lims().zero)),
-          dihed_angle_lims().idx[ElementLimits::IDX_ZERO],
-          dihed_angle_lims().idx[ElementLimits::IDX_ZERO2]);
-  fprintf(ofile, "solid_angle_max = %s [%sx4PI] (%d)\n",
-          d2s(s1, solid_angle_lims().max),
-          d2s(s2, solid_angle_lims().max / (4 * M_PI)),
-          solid_angle_lims().idx[ElementLimits::IDX_MAX]);
-  fprintf(ofile, "solid_angle_min = %s [%sx4PI] (%d)\n",
-          d2s(s1, solid_angle_lims().min),
-          d2s(s2, solid_angle_lims().min / (4 * M_PI)),
-          solid_angle_lims().idx[ElementLimits::IDX_MIN]);
-  fprintf(ofile, "\n");
+  sec_start("solid_angles");
+  put("dihed_angle_max",
+      msg_str("%s (%d, %d)", d2s(s1, rad2deg(dihed_angle_lims().max)),
+              dihed_angle_lims().idx[ElementLimits::IDX_MAX],
+              dihed_angle_lims().idx[ElementLimits::IDX_MAX2]));
+  put("dihed_angle_min",
+      msg_str("%s (%d, %d)", d2s(s1, rad2deg(dihed_angle_lims().min)),
+              dihed_angle_lims().idx[ElementLimits::IDX_MIN],
+              dihed_angle_lims().idx[ElementLimits::IDX_MIN2]));
+  put("dihed_angle_flattest",
+      msg_str("%s (%d, %d)", d2s(s1, rad2deg(dihed_angle_lims().zero)),
+              dihed_angle_lims().idx[ElementLimits::IDX_ZERO],
+              dihed_angle_lims().idx[ElementLimits::IDX_ZERO2]));
+  put("solid_angle_max",
+      msg_str("%s [%sx4PI] (%d)", d2s(s1, solid_angle_lims().max),
+              d2s(s2, solid_angle_lims().max / (4 * M_PI)),
+              solid_angle_lims().idx[ElementLimits::IDX_MAX]));
+  put("solid_angle_min",
+      msg_str("%s [%sx4PI] (%d)", d2s(s1, solid_angle_lims().min),
+              d2s(s2, solid_angle_lims().min / (4 * M_PI)),
+              solid_angle_lims().idx[ElementLimits::IDX_MIN]));
+  sec_end();
 }
 
 void rep_printer::edges_sec()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[edges]\n");
-  fprintf(ofile, "num_edges = %d\n", num_edges());
-  fprintf(ofile, "perimeter = %s\n", d2s(s1, edge_length_lims().sum));
-  fprintf(ofile, "edge_length_max = %s (%d,%d)\n",
-          d2s(s1, edge_length_lims().max),
-          edge_length_lims().idx[ElementLimits::IDX_MAX],
-          edge_length_lims().idx[ElementLimits::IDX_MAX2]);
-  fprintf(ofile, "edge_length_min = %s (%d,%d)\n",
-          d2s(s1, edge_length_lims().min),
-          edge_length_lims().idx[ElementLimits::IDX_MIN],
-          edge_length_lims().idx[ElementLimits::IDX_MIN2]);
-  fprintf(ofile, "edge_length_avg = %s\n",
-          d2s(s1, edge_length_lims().sum / num_edges()));
-  fprintf(ofile, "\n");
+  sec_start("edges");
+  put("num_edges", msg_str("%d", num_edges()));
+  put("perimeter", d2s(s1, edge_length_lims().sum));
+  put("edge_length_max",
+      msg_str("%s (%d,%d)", d2s(s1, edge_length_lims().max),
+              edge_length_lims().idx[ElementLimits::IDX_MAX],
+              edge_length_lims().idx[ElementLimits::IDX_MAX2]));
+  put("edge_length_min",
+      msg_str("%s (%d,%d)", d2s(s1, edge_length_lims().min),
+              edge_length_lims().idx[ElementLimits::IDX_MIN],
+              edge_length_lims().idx[ElementLimits::IDX_MIN2]));
+  put("edge_length_avg", d2s(s1, edge_length_lims().sum / num_edges()));
+  sec_end();
 }
 
 void rep_printer::distances_sec()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[distances]\n");
-  fprintf(ofile, "given_center = (%s)\n", v2s(s1, get_center()));
-  fprintf(ofile, "vert_min = %s (%d)\n", d2s(s1, vert_dist_lims().min),
-          vert_dist_lims().idx[ElementLimits::IDX_MIN]);
-  fprintf(ofile, "vert_max = %s (%d)\n", d2s(s1, vert_dist_lims().max),
-          vert_dist_lims().idx[ElementLimits::IDX_MAX]);
-  fprintf(ofile, "vert_avg = %s\n",
-          d2s(s1, vert_dist_lims().sum / num_verts()));
-  fprintf(ofile, "face_min = %s (%d)\n", d2s(s1, face_dist_lims().min),
-          face_dist_lims().idx[ElementLimits::IDX_MIN]);
-  fprintf(ofile, "face_max = %s (%d)\n", d2s(s1, face_dist_lims().max),
-          face_dist_lims().idx[ElementLimits::IDX_MAX]);
-  fprintf(ofile, "face_avg = %s\n",
-          d2s(s1, face_dist_lims().sum / num_faces()));
-  fprintf(ofile, "edge_min = %s (%d,%d)\n", d2s(s1, edge_dist_lims().min),
-          edge_dist_lims().idx[ElementLimits::IDX_MIN],
-          edge_dist_lims().idx[ElementLimits::IDX_MIN2]);
-  fprintf(ofile, "edge_max = %s (%d,%d)\n", d2s(s1, edge_dist_lims().max),
-          edge_dist_lims().idx[ElementLimits::IDX_MAX],
-          edge_dist_lims().idx[ElementLimits::IDX_MAX2]);
-  fprintf(ofile, "edge_avg = %s\n",
-          d2s(s1, edge_dist_lims().sum / num_edges()));
-  fprintf(ofile, "\n");
+  sec_start("distances");
+  put("given_center", msg_str("(%s)", v2s(s1, get_center())));
+  put("vert_min", msg_str("%s (%d)", d2s(s1, vert_dist_lims().min),
+                          vert_dist_lims().idx[ElementLimits::IDX_MIN]));
+  put("vert_max", msg_str("%s (%d)", d2s(s1, vert_dist_lims().max),
+                          vert_dist_lims().idx[ElementLimits::IDX_MAX]));
+  put("vert_avg", d2s(s1, vert_dist_lims().sum / num_verts()));
+  put("face_min", msg_str("%s (%d)", d2s(s1, face_dist_lims().min),
+                          face_dist_lims().idx[ElementLimits::IDX_MIN]));
+  put("face_max", msg_str("%s (%d)", d2s(s1, face_dist_lims().max),
+                          face_dist_lims().idx[ElementLimits::IDX_MAX]));
+  put("face_avg", d2s(s1, face_dist_lims().sum / num_faces()));
+  put("edge_min", msg_str("%s (%d,%d)", d2s(s1, edge_dist_lims().min),
+                          edge_dist_lims().idx[ElementLimits::IDX_MIN],
+                          edge_dist_lims().idx[ElementLimits::IDX_MIN2]));
+  put("edge_max", msg_str("%s (%d,%d)", d2s(s1, edge_dist_lims().max),
+                          edge_dist_lims().idx[ElementLimits::IDX_MAX],
+                          edge_dist_lims().idx[ElementLimits::IDX_MAX2]));
+  put("edge_avg", d2s(s1, edge_dist_lims().sum / num_edges()));
+  sec_end();
+}
+
+void rep_printer::intersections_sec(int num_threads)
+{
+  vector<pair<int, int>> pairs;
+  find_face_intersections(get_geom(), pairs, epsilon, num_threads);
+  set<int> faces;
+  for (const auto &pr : pairs) {
+    faces.insert(pr.first);
+    faces.insert(pr.second);
+  }
+
+  sec_start("intersections");
+  put("num_intersecting_pairs", msg_str("%lu", (unsigned long)pairs.size()));
+  put("intersecting_faces", msg_str("%lu", (unsigned long)faces.size()));
+  if (pairs.size())
+    put("first_pair", msg_str("(%d,%d)", pairs[0].first, pairs[0].second));
+  else
+    put("first_pair", "none");
+  sec_end();
 }
 
 void rep_printer::symmetry()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[symmetry]\n");
-  fprintf(ofile, "type = %s\n", get_symmetry_type_name().c_str());
+  sec_start("symmetry");
+  put("type", get_symmetry_type_name());
 
-  fprintf(ofile, "realignments = %u fixed",
-          (unsigned int)get_symmetry_autos().get_fixed().size());
+  string realign = msg_str(
+      "%u fixed", (unsigned int)get_symmetry_autos().get_fixed().size());
   int free_rots = get_symmetry_autos().num_free_rots();
   if (free_rots == 1)
-    fprintf(ofile, " x axial rotation");
+    realign += " x axial rotation";
   else if (free_rots == 3)
-    fprintf(ofile, " x full rotation");
+    realign += " x full rotation";
   int free_transls = get_symmetry_autos().num_free_transls();
   if (free_transls == 1)
-    fprintf(ofile, " x axial translation");
+    realign += " x axial translation";
   else if (free_transls == 2)
-    fprintf(ofile, " x plane translation");
+    realign += " x plane translation";
   else if (free_transls == 3)
-    fprintf(ofile, " x space translation");
-  fprintf(ofile, "\n");
+    realign += " x space translation";
+  put("realignments", realign);
 
-  fprintf(ofile, "alignment_to_std =");
   Trans3d m = get_symmetry_alignment_to_std();
-
+  string align;
   for (int i = 0; i < 12; i++)
-    fprintf(ofile, "%c%s", (i == 0) ? ' ' : ',', d2s(s1, m[i]));
-  fprintf(ofile, "\n\n");
-  fprintf(ofile, "[symmetry_axes]\n");
+    align += string((i == 0) ? "" : ",") + d2s(s1, m[i]);
+  put("alignment_to_std", align);
+  sec_end();
+
+  sec_start("symmetry_axes", true);
   map<string, int> ax_cnts;
   const set<SymmetryAxis> &axes = get_symmetry_axes(); // get_symmetry_axes();
   set<SymmetryAxis>::const_iterator ai;
@@ -312,10 +348,10 @@ void rep_printer::symmetry()
 
   map<string, int>::const_iterator mi;
   for (mi = ax_cnts.begin(); mi != ax_cnts.end(); ++mi)
-    fprintf(ofile, "%s,%d\n", mi->first.c_str(), mi->second);
-  fprintf(ofile, "\n");
+    put(mi->first, msg_str("%d", mi->second), ",");
+  sec_end();
 
-  fprintf(ofile, "[symmetry_subgroups_nonconjugate]\n");
+  sec_start("symmetry_subgroups_nonconjugate", true);
   const set<Symmetry> &subs = get_symmetry_subgroups();
   set<Symmetry>::const_iterator si;
   map<string, int> subsym_cnts;
@@ -323,15 +359,15 @@ void rep_printer::symmetry()
     subsym_cnts[si->get_symbol()]++;
 
   for (mi = subsym_cnts.begin(); mi != subsym_cnts.end(); ++mi)
-    fprintf(ofile, "%s,%d\n", mi->first.c_str(), mi->second);
-  fprintf(ofile, "\n");
+    put(mi->first, msg_str("%d", mi->second), ",");
+  sec_end();
 }
 
 void rep_printer::vert_heights_cnts()
 {
   char s1[MSG_SZ];
   char s2[MSG_SZ];
-  fprintf(ofile, "[vert_heights_cnts]\n");
+  sec_start("vert_heights_cnts", true);
   map<double, double_range_cnt, AngleLess>::iterator mi;
   map<double, double_range_cnt, AngleLess> v_heights;
   const vector<Vec3d> &verts = geom.verts();
@@ -346,43 +382,45 @@ void rep_printer::vert_heights_cnts()
   }
 
   for (mi = v_heights.begin(); mi != v_heights.end(); ++mi)
-    fprintf(ofile, "%s = %d\t(range +/- %s)\n", d2s(s1, mi->second.mid()),
-            mi->second.cnt, d2s(s2, mi->second.rad()));
-  fprintf(ofile, "\n");
+    put(d2s(s1, mi->second.mid()),
+        msg_str("%d\t(range +/- %s)", mi->second.cnt,
+                d2s(s2, mi->second.rad())));
+  sec_end();
 }
 
 void rep_printer::edge_lengths_cnts()
 {
   char s1[MSG_SZ];
   char s2[MSG_SZ];
-  fprintf(ofile, "[edge_lengths_cnts]\n");
+  sec_start("edge_lengths_cnts", true);
   const map<double, double_range_cnt, AngleLess> &edge_lengths =
       get_edge_lengths_by_size();
   map<double, double_range_cnt, AngleLess>::const_iterator ei;
   for (ei = edge_lengths.begin(); ei != edge_lengths.end(); ++ei)
-    fprintf(ofile, "%s = %d\t(range +/- %s)\n", d2s(s1, ei->second.mid()),
-            ei->second.cnt, d2s(s2, ei->second.rad()));
-  fprintf(ofile, "\n");
+    put(d2s(s1, ei->second.mid()),
+        msg_str("%d\t(range +/- %s)", ei->second.cnt,
+                d2s(s2, ei->second.rad())));
+  sec_end();
 }
 
 void rep_printer::dihedral_angles_cnts()
 {
   char s1[MSG_SZ];
   char s2[MSG_SZ];
-  fprintf(ofile, "[dihedral_angles_cnts]\n");
+  sec_start("dihedral_angles_cnts", true);
   const map<double, double_range_cnt, AngleLess> &dihedrals =
       get_dihedral_angles_by_size();
   map<double, double_range_cnt, AngleLess>::const_iterator di;
   for (di = dihedrals.begin(); di != dihedrals.end(); ++di)
-    fprintf(ofile, "%s = %d\t(range +/- %s)\n",
-            d2s(s1, rad2deg(di->second.mid())), di->second.cnt,
-            d2s(s2, rad2deg(di->second.rad())));
-  fprintf(ofile, "\n");
+    put(d2s(s1, rad2deg(di->second.mid())),
+        msg_str("%d\t(range +/- %s)", di->second.cnt,
+                d2s(s2, rad2deg(di->second.rad()))));
+  sec_end();
 }
 
 void rep_printer::edge_faces_cnts()
 {
-  fprintf(ofile, "[edge_faces_cnts]\n");
+  sec_start("edge_faces_cnts", true);
 
   auto ef_prs = geom.get_edge_face_pairs(false);
   map<int, int> edge_faces_cnts;
@@ -393,27 +431,28 @@ void rep_printer::edge_faces_cnts()
   }
 
   for (auto sz2cnt : edge_faces_cnts)
-    fprintf(ofile, "%d = %d\n", sz2cnt.first, sz2cnt.second);
-  fprintf(ofile, "\n");
+    put(msg_str("%d", sz2cnt.first), msg_str("%d", sz2cnt.second));
+  sec_end();
 }
 
 void rep_printer::solid_angles_cnts()
 {
   char s1[MSG_SZ];
   char s2[MSG_SZ];
-  fprintf(ofile, "[solid_angles_cnts]\n");
+  sec_start("solid_angles_cnts", true);
   const map<double, double_range_cnt, AngleLess> &solid_angs =
       get_solid_angles_by_size();
   map<double, double_range_cnt, AngleLess>::const_iterator si;
   for (si = solid_angs.begin(); si != solid_angs.end(); ++si)
-    fprintf(ofile, "%s = %d\t(range +/- %s)\n", d2s(s1, si->second.mid()),
-            si->second.cnt, d2s(s2, si->second.rad()));
-  fprintf(ofile, "\n");
+    put(d2s(s1, si->second.mid()),
+        msg_str("%d\t(range +/- %s)", si->second.cnt,
+                d2s(s2, si->second.rad())));
+  sec_end();
 }
 
 void rep_printer::vert_order_cnts()
 {
-  fprintf(ofile, "[vert_order_cnts]\n");
+  sec_start("vert_order_cnts", true);
   map<int, int>::iterator mi;
   map<int, int> cnts;
   const vector<vector<int>> &v_cons = get_vert_cons();
@@ -425,13 +464,13 @@ void rep_printer::vert_order_cnts()
       mi->second += 1;
   }
   for (mi = cnts.begin(); mi != cnts.end(); ++mi)
-    fprintf(ofile, "%d = %d\n", mi->first, mi->second);
-  fprintf(ofile, "\n");
+    put(msg_str("%d", mi->first), msg_str("%d", mi->second));
+  sec_end();
 }
 
 void rep_printer::face_sides_cnts()
 {
-  fprintf(ofile, "[face_sides_cnts]\n");
+  sec_start("face_sides_cnts", true);
   map<int, int>::iterator mi;
   map<int, int> cnts;
   for (unsigned int i = 0; i < geom.faces().size(); i++) {
@@ -442,24 +481,25 @@ void rep_printer::face_sides_cnts()
       mi->second += 1;
   }
   for (mi = cnts.begin(); mi != cnts.end(); ++mi)
-    fprintf(ofile, "%d = %d\n", mi->first, mi->second);
-  fprintf(ofile, "\n");
+    put(msg_str("%d", mi->first), msg_str("%d", mi->second));
+  sec_end();
 }
 
 void rep_printer::face_angles_cnts()
 {
   char s1[MSG_SZ];
-  fprintf(ofile, "[face_angles_cnts]\n");
+  sec_start("face_angles_cnts", true);
   const map<vector<double>, int, AngleVectLess> &face_angs =
       get_plane_angles_by_size();
   map<vector<double>, int, AngleVectLess>::const_iterator fi;
   for (fi = face_angs.begin(); fi != face_angs.end(); ++fi) {
+    string angs;
     for (unsigned int i = 0; i < fi->first.size(); i++)
-      fprintf(ofile, "%s%s", d2s(s1, rad2deg(fi->first[i])),
-              (i < fi->first.size() - 1) ? "," : "");
-    fprintf(ofile, " = %d\n", fi->second);
+      angs += string(d2s(s1, rad2deg(fi->first[i]))) +
+              ((i < fi->first.size() - 1) ? "," : "");
+    put(angs, msg_str("%d", fi->second));
   }
-  fprintf(ofile, "\n");
+  sec_end();
 }
 
 void rep_printer::face_winding_cnts(const vector<int> winding_numbers,
@@ -481,14 +521,14 @@ void rep_printer::face_winding_cnts(const vector<int> winding_numbers,
       mi->second += 1;
   }
 
-  fprintf(ofile, "[face_windings_cnts %s]\n",
-          (signing ? "signed" : "unsigned"));
+  sec_start(string("face_windings_cnts ") + (signing ? "signed" : "unsigned"),
+            true);
 
   for (mi = cnts.begin(); mi != cnts.end(); ++mi) {
     pair<int, int> key = mi->first;
-    fprintf(ofile, "%d/%d = %d\n", key.first, key.second, mi->second);
+    put(msg_str("%d/%d", key.first, key.second), msg_str("%d", mi->second));
   }
-  fprintf(ofile, "\n");
+  sec_end();
 }
 
 void rep_printer::vertex_figure_winding_cnts()
@@ -534,22 +574,19 @@ void rep_printer::vertex_figure_winding_cnts()
       mi->second += 1;
   }
 
-  fprintf(ofile, "[vertex_figure_windings_cnts signed]\n");
+  sec_start("vertex_figure_windings_cnts signed", true);
 
   for (mi = cnts.begin(); mi != cnts.end(); ++mi) {
     pair<int, int> key = mi->first;
-    fprintf(ofile, "%d/%d = %d\n", key.first, key.second, mi->second);
+    put(msg_str("%d/%d", key.first, key.second), msg_str("%d", mi->second));
   }
-  fprintf(ofile, "\n");
+  sec_end();
 }
 
 void rep_printer::windings()
 {
   // get signed winding number
-  vector<int> winding_numbers;
-  for (unsigned int i = 0; i < geom.faces().size(); i++)
-    winding_numbers.push_back(
-        find_polygon_denominator_signed(geom, i, epsilon));
+  const vector<int> &winding_numbers = get_f_windings();
 
   face_winding_cnts(winding_numbers, false);
   face_winding_cnts(winding_numbers, true);
@@ -559,7 +596,7 @@ void rep_printer::windings()
 
 void rep_printer::sym_orbit_cnts()
 {
-  fprintf(ofile, "[sym_orbit_cnts]\n");
+  sec_start("sym_orbit_cnts", true);
   // Get symmetry if necessary
   Symmetry sym;
   if (sub_sym_str == "") { // use full symmetry
@@ -568,8 +605,8 @@ void rep_printer::sym_orbit_cnts()
   else { // use subsymmetry
     Status stat = get_symmetry().get_sub_sym(sub_sym_str, &sym);
     if (stat.is_error()) {
-      fprintf(ofile, "invalid subsymmetry '%s': %s\n\n", sub_sym_str.c_str(),
-              stat.c_msg());
+      put("invalid subsymmetry '" + sub_sym_str + "'", stat.msg(), ": ");
+      sec_end();
       return;
     }
   }
@@ -582,24 +619,38 @@ void rep_printer::sym_orbit_cnts()
     vector<set<int>>::const_iterator vi;
     for (vi = sym_equivs[i].begin(); vi != sym_equivs[i].end(); ++vi)
       cnt_list += msg_str("%d, ", vi->size());
-    fprintf(ofile, "%s: %u ", elems[i], (unsigned int)sym_equivs[i].size());
+    string val = msg_str("%u ", (unsigned int)sym_equivs[i].size());
     if (cnt_list.size())
-      fprintf(ofile, " (%s)", cnt_list.substr(0, cnt_list.size() - 2).c_str());
-    fprintf(ofile, "\n");
+      val += " (" + cnt_list.substr(0, cnt_list.size() - 2) + ")";
+    put(elems[i], val, ": ");
   }
-  fprintf(ofile, "\n");
+  sec_end();
+}
+
+void rep_printer::put_item(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  if (item_val) {
+    char buf[MSG_SZ];
+    vsnprintf(buf, MSG_SZ, fmt, args);
+    *item_val += buf;
+  }
+  else
+    vfprintf(ofile, fmt, args);
+  va_end(args);
 }
 
 void rep_printer::v_index(int v_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", vidx2s(str, v_idx));
+  put_item("%s", vidx2s(str, v_idx));
 }
 
 void rep_printer::v_coords(int v_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", v2s(str, geom.verts(v_idx)));
+  put_item("%s", v2s(str, geom.verts(v_idx)));
 }
 
 void rep_printer::v_neighbours(int v_idx)
@@ -607,8 +658,8 @@ void rep_printer::v_neighbours(int v_idx)
   char str[MSG_SZ];
   const vector<int> &vcons = get_vert_cons()[v_idx];
   for (unsigned int i = 0; i < vcons.size(); i++)
-    fprintf(ofile, "%s%s", vidx2s(str, vcons[i]),
-            (i < vcons.size() - 1) ? " " : "");
+    put_item("%s%s", vidx2s(str, vcons[i]),
+             (i < vcons.size() - 1) ? " " : "");
 }
 
 void rep_printer::v_figure(int v_idx)
@@ -617,10 +668,10 @@ void rep_printer::v_figure(int v_idx)
   const vector<vector<int>> &vfigs = get_vert_figs()[v_idx];
   for (unsigned int i = 0; i < vfigs.size(); i++) {
     if (i > 0) // print circuit separator
-      fprintf(ofile, ":");
+      put_item(":");
     for (unsigned int j = 0; j < vfigs[i].size(); j++)
-      fprintf(ofile, "%s%s", vidx2s(str, vfigs[i][j]),
-              (j < vfigs[i].size() - 1) ? " " : "");
+      put_item("%s%s", vidx2s(str, vfigs[i][j]),
+               (j < vfigs[i].size() - 1) ? " " : "");
   }
 }
 
@@ -630,25 +681,25 @@ void rep_printer::v_face_idxs(int v_idx)
   const Geometry &dual = get_dual();
   const vector<int> &fcons = dual.faces(v_idx);
   for (unsigned int i = 0; i < fcons.size(); i++)
-    fprintf(ofile, "%s%s", fidx2s(str, fcons[i]),
-            (i < fcons.size() - 1) ? " " : "");
+    put_item("%s%s", fidx2s(str, fcons[i]),
+             (i < fcons.size() - 1) ? " " : "");
 }
 
 void rep_printer::v_solid_angle(int v_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, get_vert_solid_angles()[v_idx]));
+  put_item("%s", d2s(str, get_vert_solid_angles()[v_idx]));
 }
 
 void rep_printer::v_order(int v_idx)
 {
-  fprintf(ofile, "%lu", (unsigned long)get_vert_cons()[v_idx].size());
+  put_item("%lu", (unsigned long)get_vert_cons()[v_idx].size());
 }
 
 void rep_printer::v_distance(int v_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, (geom.verts(v_idx) - get_center()).len()));
+  put_item("%s", d2s(str, (geom.verts(v_idx) - get_center()).len()));
 }
 
 void rep_printer::v_angles(int v_idx)
@@ -658,28 +709,28 @@ void rep_printer::v_angles(int v_idx)
   const vector<int> &fcons = dual.faces(v_idx);
   for (unsigned int i = 0; i < fcons.size(); i++) {
     pair<int, int> vf_pr(v_idx, fcons[i]);
-    fprintf(ofile, "%s%s", d2s(str, rad2deg(get_plane_angles().at(vf_pr))),
-            (i < fcons.size() - 1) ? " " : "");
+    put_item("%s%s", d2s(str, rad2deg(get_plane_angles().at(vf_pr))),
+             (i < fcons.size() - 1) ? " " : "");
   }
 }
 
 void rep_printer::v_color(int v_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", col2s(str, geom.colors(VERTS).get(v_idx)));
+  put_item("%s", col2s(str, geom.colors(VERTS).get(v_idx)));
 }
 
 void rep_printer::e_index(int e_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", eidx2s(str, e_idx));
+  put_item("%s", eidx2s(str, e_idx));
 }
 
 void rep_printer::e_vert_idxs(int e_idx)
 {
   char str[MSG_SZ], str2[MSG_SZ];
   vector<int> edge = geom.edges(e_idx);
-  fprintf(ofile, "%s %s", vidx2s(str, edge[0]), vidx2s(str2, edge[1]));
+  put_item("%s %s", vidx2s(str, edge[0]), vidx2s(str2, edge[1]));
 }
 
 void rep_printer::e_face_idxs(int e_idx)
@@ -691,8 +742,8 @@ void rep_printer::e_face_idxs(int e_idx)
     auto fidxs = ei->second;
     for (unsigned int i = 0; i < fidxs.size(); i++) {
       if (fidxs[i] >= 0)
-        fprintf(ofile, "%s%s", fidx2s(str, fidxs[i]),
-                (i < fidxs.size() - 1) ? " " : "");
+        put_item("%s%s", fidx2s(str, fidxs[i]),
+                 (i < fidxs.size() - 1) ? " " : "");
     }
   }
 }
@@ -700,7 +751,7 @@ void rep_printer::e_face_idxs(int e_idx)
 void rep_printer::e_dihedral_angle(int e_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, rad2deg(get_edge_dihedrals()[e_idx])));
+  put_item("%s", d2s(str, rad2deg(get_edge_dihedrals()[e_idx])));
 }
 
 void rep_printer::e_central_angle(int e_idx)
@@ -708,8 +759,8 @@ void rep_printer::e_central_angle(int e_idx)
   Vec3d v0 = geom.verts(geom.edges(e_idx, 0)) - get_center();
   Vec3d v1 = geom.verts(geom.edges(e_idx, 1)) - get_center();
   char str[MSG_SZ];
-  fprintf(ofile, "%s",
-          d2s(str, rad2deg(acos(safe_for_trig(vdot(v0.unit(), v1.unit()))))));
+  put_item("%s",
+           d2s(str, rad2deg(acos(safe_for_trig(vdot(v0.unit(), v1.unit()))))));
 }
 
 void rep_printer::e_distance(int e_idx)
@@ -718,13 +769,13 @@ void rep_printer::e_distance(int e_idx)
   Vec3d v1 = geom.verts(geom.edges(e_idx, 1)) - get_center();
   double dist = (nearest_point(get_center(), v0, v1) - get_center()).len();
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, dist));
+  put_item("%s", d2s(str, dist));
 }
 
 void rep_printer::e_centroid(int e_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", v2s(str, geom.edge_cent(e_idx)));
+  put_item("%s", v2s(str, geom.edge_cent(e_idx)));
 }
 
 void rep_printer::e_direction(int e_idx)
@@ -732,7 +783,7 @@ void rep_printer::e_direction(int e_idx)
   Vec3d v0 = geom.verts(geom.edges(e_idx, 0));
   Vec3d v1 = geom.verts(geom.edges(e_idx, 1));
   char str[MSG_SZ];
-  fprintf(ofile, "%s", v2s(str, (v1 - v0).unit()));
+  put_item("%s", v2s(str, (v1 - v0).unit()));
 }
 
 void rep_printer::e_length(int e_idx)
@@ -740,19 +791,19 @@ void rep_printer::e_length(int e_idx)
   Vec3d v0 = geom.verts(geom.edges(e_idx, 0));
   Vec3d v1 = geom.verts(geom.edges(e_idx, 1));
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, (v1 - v0).len()));
+  put_item("%s", d2s(str, (v1 - v0).len()));
 }
 
 void rep_printer::e_color(int e_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", col2s(str, geom.colors(EDGES).get(e_idx)));
+  put_item("%s", col2s(str, geom.colors(EDGES).get(e_idx)));
 }
 
 void rep_printer::f_index(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", fidx2s(str, f_idx));
+  put_item("%s", fidx2s(str, f_idx));
 }
 
 void rep_printer::f_vert_idxs(int f_idx)
@@ -760,8 +811,8 @@ void rep_printer::f_vert_idxs(int f_idx)
   char str[MSG_SZ];
   const vector<int> &face = geom.faces(f_idx);
   for (unsigned int i = 0; i < face.size(); i++)
-    fprintf(ofile, "%s%s", vidx2s(str, face[i]),
-            (i < face.size() - 1) ? " " : "");
+    put_item("%s%s", vidx2s(str, face[i]),
+             (i < face.size() - 1) ? " " : "");
 }
 
 void rep_printer::f_neighbours(int f_idx)
@@ -774,14 +825,14 @@ void rep_printer::f_neighbours(int f_idx)
   for (unsigned int i = 0; i < sz; i++) {
     ei = get_edge_face_pairs().find(make_edge(face[i], face[(i + 1) % sz]));
     int neigh = (ei->second[0] != f_idx) ? ei->second[0] : ei->second[1];
-    fprintf(ofile, "%s%s", fidx2s(str, neigh), (i < sz - 1) ? " " : "");
+    put_item("%s%s", fidx2s(str, neigh), (i < sz - 1) ? " " : "");
   }
 }
 
 void rep_printer::f_normal(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", v2s(str, geom.face_norm(f_idx).unit()));
+  put_item("%s", v2s(str, geom.face_norm(f_idx).unit()));
 }
 
 void rep_printer::f_angles(int f_idx)
@@ -790,13 +841,13 @@ void rep_printer::f_angles(int f_idx)
   geom.face_angles_lengths(f_idx, &angs);
   char str[MSG_SZ];
   for (unsigned int i = 0; i < angs.size(); i++)
-    fprintf(ofile, "%s%s", d2s(str, rad2deg(angs[i])),
-            (i < angs.size() - 1) ? " " : "");
+    put_item("%s%s", d2s(str, rad2deg(angs[i])),
+             (i < angs.size() - 1) ? " " : "");
 }
 
 void rep_printer::f_sides(int f_idx)
 {
-  fprintf(ofile, "%lu", (unsigned long)geom.faces(f_idx).size());
+  put_item("%lu", (unsigned long)geom.faces(f_idx).size());
 }
 
 void rep_printer::f_distance(int f_idx)
@@ -805,25 +856,25 @@ void rep_printer::f_distance(int f_idx)
                  get_center())
                     .len();
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, dist));
+  put_item("%s", d2s(str, dist));
 }
 
 void rep_printer::f_area(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, get_f_areas()[f_idx]));
+  put_item("%s", d2s(str, get_f_areas()[f_idx]));
 }
 
 void rep_printer::f_perimeter(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, get_f_perimeters()[f_idx]));
+  put_item("%s", d2s(str, get_f_perimeters()[f_idx]));
 }
 
 void rep_printer::f_centroid(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", v2s(str, geom.face_cent(f_idx)));
+  put_item("%s", v2s(str, geom.face_cent(f_idx)));
 }
 
 void rep_printer::f_lengths(int f_idx)
@@ -833,19 +884,19 @@ void rep_printer::f_lengths(int f_idx)
   const vector<int> &face = geom.faces(f_idx);
   unsigned int sz = face.size();
   for (unsigned int i = 0; i < sz; i++)
-    fprintf(ofile, "%s%s",
-            d2s(str, (verts[face[i]] - verts[face[(i + 1) % sz]]).len()),
-            (i < face.size() - 1) ? " " : "");
+    put_item("%s%s",
+             d2s(str, (verts[face[i]] - verts[face[(i + 1) % sz]]).len()),
+             (i < face.size() - 1) ? " " : "");
 }
 
 void rep_printer::f_max_nonplanar(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", d2s(str, get_f_max_nonplanars()[f_idx]));
+  put_item("%s", d2s(str, get_f_max_nonplanars()[f_idx]));
 }
 
 void rep_printer::f_color(int f_idx)
 {
   char str[MSG_SZ];
-  fprintf(ofile, "%s", col2s(str, geom.colors(FACES).get(f_idx)));
+  put_item("%s", col2s(str, geom.colors(FACES).get(f_idx)));
 }
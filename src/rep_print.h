@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../base/antiprism.h"
@@ -64,6 +65,21 @@ private:
   int extra_f_sz;
   FILE *ofile;
 
+  // The report values are written to ofile, or added to vals if it is set
+  std::vector<std::pair<std::string, std::string>> *vals;
+  bool join_lists;      // add the entries of a list section as one value
+  std::string sec_name; // the current section, when adding to vals
+  bool in_list;         // the current section is joined into list_val
+  std::string list_val;
+
+  // The query values are written to ofile, or added to item_val if it is set
+  std::string *item_val;
+
+  void sec_start(const std::string &name, bool is_list = false);
+  void put(const std::string &key, const std::string &val,
+           const char *sep = " = ");
+  void sec_end();
+
   void face_winding_cnts(const std::vector<int> winding_numbers,
                          const bool signing);
   void vertex_figure_winding_cnts();
@@ -71,12 +87,30 @@ private:
 public:
   rep_printer(anti::Geometry &geom, FILE *outfile = stdout)
       : anti::GeometryInfo(geom), extra_v_sz(0), extra_e_sz(0), extra_f_sz(0),
-        ofile(outfile)
+        ofile(outfile), vals(nullptr), join_lists(false), in_list(false),
+        item_val(nullptr)
   {
     set_sig_dgts();
   }
 
   void set_sig_dgts(int dgts = 8) { sig_dgts = dgts; }
+
+  // Add the section and count values to values, keyed "section.name",
+  // instead of writing them. If join is set then the entries of a section
+  // whose names depend on the model, like the counts, are added as one
+  // value keyed by the section name.
+  void set_values(std::vector<std::pair<std::string, std::string>> *values,
+                  bool join = false)
+  {
+    vals = values;
+    join_lists = join;
+  }
+
+  // Add the values of the element queries to value, instead of writing them
+  void set_item_value(std::string *value) { item_val = value; }
+
+  // Write part of a query value, with printf style formatting
+  void put_item(const char *fmt, ...);
   anti::Status set_sub_symmetry(const std::string &sub_sym);
 
   void extra_elems_added(int v_sz, int e_sz, int f_sz)
@@ -92,6 +126,7 @@ public:
   void angles_sec();
   void solid_angles_sec();
   void distances_sec();
+  void intersections_sec(int num_threads = 0);
   void symmetry();
 
   void face_sides_cnts();
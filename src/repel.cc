@@ -50,13 +50,14 @@ public:
   int rep_form;
   double shorten_by;
   double epsilon;
+  int seed;
 
   string ifile;
   string ofile;
 
   rep_opts()
       : ProgramOpts("repel"), num_iters(-1), num_pts(-1), rep_form(2),
-        shorten_by(-1), epsilon(0)
+        shorten_by(-1), epsilon(0), seed(-1)
   {
   }
 
@@ -78,6 +79,8 @@ void rep_opts::usage()
 "Options\n"
 "%s"
 "  -N <num>  initialise with a number of randomly placed points\n"
+"  -R <seed> seed for the random placement, 0 or greater (default: seed\n"
+"            from the time)\n"
 "  -n <itrs> maximum number of iterations (default: no limit)\n" 
 "  -s <perc> percentage to shorten the travel distance (default: adaptive)\n" 
 "  -l <lim>  minimum distance change to terminate, as negative exponent\n"
@@ -102,7 +105,7 @@ void rep_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hn:N:s:l:r:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hn:N:R:s:l:r:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -119,6 +122,12 @@ void rep_opts::process_command_line(int argc, char **argv)
         error("number of points must be 2 or more", c);
       break;
 
+    case 'R':
+      print_status_or_exit(read_int(optarg, &seed), c);
+      if (seed < 0)
+        error("seed must be 0 or greater", c);
+      break;
+
     case 's':
       print_status_or_exit(read_double(optarg, &shorten_by), c);
       if (shorten_by <= 0 || shorten_by >= 100)
@@ -162,6 +171,9 @@ void rep_opts::process_command_line(int argc, char **argv)
       ifile = argv[optind];
   }
 
+  if (seed >= 0 && num_pts <= 0)
+    warning("set, but not used without random placement", 'R');
+
   epsilon = (sig_compare != INT_MAX) ? pow(10, -sig_compare) : ::epsilon;
 }
 
@@ -191,13 +203,21 @@ Vec3d rep_inv_dist05(Vec3d v1, Vec3d v2)
   return (v2 - v1).with_len(len);
 }
 
-void random_placement(Geometry &geom, int n)
+void random_placement(Geometry &geom, int n, int seed)
 {
   geom.clear_all();
-  Random rnd;
-  rnd.time_seed();
-  for (int i = 0; i < n; i++)
-    geom.add_vert(Vec3d::random(rnd).unit());
+  CounterRandom rnd;
+  if (seed < 0)
+    rnd.time_seed();
+  else
+    rnd.seedi(seed);
+
+  vector<Vec3d> &verts = geom.raw_verts();
+  verts.resize(n);
+  parallel_for(n, [&](size_t i) {
+    CounterRandom pt_rnd = rnd.get_stream(i); // stream for this point
+    verts[i] = Vec3d::random(pt_rnd).unit();
+  });
 }
 
 void repel(Geometry &geom, REPEL_FN rep_fn, double shorten_factor, double limit,
@@ -308,7 +328,7 @@ int main(int argc, char *argv[])
 
   Geometry geom;
   if (opts.num_pts > 0)
-    random_placement(geom, opts.num_pts);
+    random_placement(geom, opts.num_pts, opts.seed);
   else
     opts.read_or_error(geom, opts.ifile);
 
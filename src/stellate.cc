@@ -50,6 +50,8 @@ public:
   string ofile;
 
   vector<string> diagram_list_strings;
+  vector<vector<string>> batch_lists;
+  int num_threads;
   string sym_str;
   bool merge_faces;
   bool remove_inline_vertices;
@@ -76,7 +78,7 @@ public:
   double epsilon;
 
   stellate_opts()
-      : ProgramOpts("stellate"), merge_faces(true),
+      : ProgramOpts("stellate"), num_threads(0), merge_faces(true),
         remove_inline_vertices(true), split_pinched(true), resolve_faces(false),
         remove_multiples(false), rebuild_compound_model(false),
         output_parts("s"), move_to_front(false), projection_width(500),
@@ -105,6 +107,13 @@ void stellate_opts::usage()
 "            followed by face numbers of stellation diagram for stellation\n"
 "            model seperated by commas. multiple -n parameters as needed\n"
 "  -s <sym>  symmetry subgroup (Schoenflies notation)\n"
+"  -B <file> make a model for each line of file. A line has the face lists\n"
+"            for one model, separated by spaces, in the form used by -f.\n"
+"            The stellation diagrams are shared, and the models are made\n"
+"            in parallel. Blank lines are skipped. -o must be given,\n"
+"            containing %%s, which is replaced by the model number\n"
+"  -j <num>  number of models to make at the same time (default: number\n"
+"            of hardware threads, or $ANTIPRISM_THREADS if set)\n"
 "  -M        do not merge stellation facelets\n"
 "  -I        do not remove inline vertices (if not -M)\n"
 "  -S        do not split pinched faces (if not -M)\n"
@@ -146,7 +155,7 @@ void stellate_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hf:s:MISRDrzw:O:V:E:F:T:m:l:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hf:s:B:j:MISRDrzw:O:V:E:F:T:m:l:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -160,6 +169,31 @@ void stellate_opts::process_command_line(int argc, char **argv)
       sym_str = optarg;
       break;
 
+    case 'B': {
+      FILE *bfile = fopen(optarg, "r");
+      if (!bfile)
+        error(msg_str("could not open batch file '%s'", optarg), c);
+      char *line = nullptr;
+      while (read_line(bfile, &line) == 0) {
+        vector<char *> parts;
+        split_line(line, parts);
+        if (parts.size())
+          batch_lists.push_back(vector<string>(parts.begin(), parts.end()));
+        free(line);
+        line = nullptr;
+      }
+      fclose(bfile);
+      if (batch_lists.empty())
+        error("batch file contains no face lists", c);
+      break;
+    }
+
+    case 'j':
+      print_status_or_exit(read_int(optarg, &num_threads), c);
+      if (num_threads < 1)
+        error("number of threads must be a positive integer", c);
+      break;
+
     case 'M':
       merge_faces = false;
       break;
@@ -263,6 +297,13 @@ void stellate_opts::process_command_line(int argc, char **argv)
   if (argc - optind == 1)
     ifile = argv[optind];
 
+  if (batch_lists.size()) {
+    if (diagram_list_strings.size())
+      error("face lists cannot be given with -B", 'f');
+    if (ofile.find("%s") == string::npos)
+      error("with -B the output file name must contain %s", 'o');
+  }
+
   epsilon = (sig_compare != INT_MAX) ? pow(10, -sig_compare) : ::epsilon;
 }
 
@@ -416,7 +457,8 @@ void color_stellation(Geometry &stellation, const stellate_opts &opts)
 }
 
 // idx_lists still contains stellation face number in position 0
-Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
+Geometry construct_model(StellationSession &stel, Geometry &geom,
+                         map<int, Geometry> &diagrams,
                          vector<vector<int>> &idx_lists,
                          const stellate_opts &opts)
 {
@@ -433,10 +475,10 @@ Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
       geom_sym_symbol = geom_full_sym.get_symbol().c_str();
     }
 
-    stellation = make_stellation(
-        geom, diagrams, idx_lists, geom_sym_symbol, opts.merge_faces,
-        opts.remove_inline_vertices, opts.split_pinched, opts.resolve_faces,
-        opts.remove_multiples, opts.map_string, opts.epsilon);
+    stellation = stel.make_stellation(
+        idx_lists, opts.merge_faces, opts.remove_inline_vertices,
+        opts.split_pinched, opts.resolve_faces, opts.remove_multiples,
+        opts.map_string);
 
     if (opts.rebuild_compound_model) {
       rebuild_compound(stellation);
@@ -447,10 +489,9 @@ Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
   // need to execute before coloring diagrams
   // these functions need diagrams to have color indexes
   vector<vector<int>> idx_lists_full =
-      lists_full(diagrams, idx_lists, opts.remove_multiples);
+      stel.lists_full(idx_lists, opts.remove_multiples);
   vector<vector<int>> idx_lists_resolved =
-      lists_resolved(geom, geom_sym_symbol, diagrams, idx_lists, idx_lists_full,
-                     opts.remove_multiples);
+      stel.lists_resolved(idx_lists, idx_lists_full, opts.remove_multiples);
 
   // color diagrams
   for (auto const &key1 : diagrams) {
@@ -564,63 +605,40 @@ Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
   return model;
 }
 
-int main(int argc, char *argv[])
+// read the face lists for a stellation, making any diagrams that are needed
+void read_stellation_lists(const vector<string> &list_strings,
+                           vector<vector<int>> &idx_lists,
+                           bool &display_diagrams_only,
+                           StellationSession &stel, const stellate_opts &opts,
+                           const string &where = "")
 {
-  stellate_opts opts;
-  opts.process_command_line(argc, argv);
+  int fsz = stel.get_geom().faces().size() - 1;
 
-  Geometry geom;
-  opts.read_or_error(geom, opts.ifile);
+  int sz = list_strings.size();
+  idx_lists.resize(sz);
 
-  // process symmetry symbol
-  Symmetry sym(geom);
-  if (!opts.sym_str.length())
-    opts.sym_str = sym.get_symbol().c_str();
-  else {
-    // if specified, check validity
-    sym.init(geom);
-    Symmetry full_sym = sym;
-    Status stat = full_sym.get_sub_sym(opts.sym_str, &sym);
-    if (stat.is_error())
-      opts.error(msg_str("invalid subsymmetry '%s': %s", opts.sym_str.c_str(),
-                         stat.c_msg()),
-                 's');
-  }
-
-  int fsz = geom.faces().size() - 1;
-
-  map<int, Geometry> diagrams;
-
-  int sz = opts.diagram_list_strings.size();
-  vector<vector<int>> idx_lists(sz);
-
-  bool display_diagrams_only = true;
+  display_diagrams_only = true;
   for (int i = 0; i < sz; i++) {
-    opts.print_status_or_exit(
-        read_idx_list((char *)opts.diagram_list_strings[i].c_str(),
-                      idx_lists[i], INT_MAX, false),
-        'f');
+    vector<char> list_str(list_strings[i].begin(), list_strings[i].end());
+    list_str.push_back('\0');
+    Status stat = read_idx_list(list_str.data(), idx_lists[i], INT_MAX, false);
+    if (stat.is_error())
+      opts.error(where + stat.msg(), 'f');
     if (!idx_lists[i].size())
-      opts.error("no face number are input", 'f');
+      opts.error(where + "no face number are input", 'f');
 
     // stellation face index is in the first position
     int stellation_face_idx = idx_lists[i][0];
     if (stellation_face_idx > fsz)
-      opts.error(msg_str("stellation face(%d) number given: %d is larger than "
-                         "maximum model face number: %d",
-                         i + 1, stellation_face_idx, fsz),
+      opts.error(where + msg_str("stellation face(%d) number given: %d is "
+                                 "larger than maximum model face number: %d",
+                                 i + 1, stellation_face_idx, fsz),
                  'f');
 
     // will hold just 1 if it is just the stellation face
     if (idx_lists[i].size() > 1)
       display_diagrams_only = false;
 
-    // construct the diagrams
-    if (!diagrams[stellation_face_idx].verts().size())
-      diagrams[stellation_face_idx] =
-          make_stellation_diagram(geom, stellation_face_idx, opts.sym_str,
-                                  opts.projection_width, opts.epsilon);
-
     // check face index range. start from 1 since 0 is a placeholder for
     // stellation face
     int max_idx = -1;
@@ -629,14 +647,19 @@ int main(int argc, char *argv[])
         max_idx = idx_lists[i][j];
     }
 
-    int dsz = (int)diagrams[stellation_face_idx].faces().size() - 1;
+    int dsz = (int)stel.get_diagram(stellation_face_idx).faces().size() - 1;
     if (max_idx > dsz)
-      opts.error(msg_str("diagram(%d) number given: %d is larger than maximum "
-                         "face number: %d",
-                         i + 1, max_idx, dsz),
+      opts.error(where + msg_str("diagram(%d) number given: %d is larger "
+                                 "than maximum face number: %d",
+                                 i + 1, max_idx, dsz),
                  'f');
   }
+}
 
+// make the output model for one stellation
+Geometry make_model(StellationSession &stel, vector<vector<int>> &idx_lists,
+                    bool display_diagrams_only, stellate_opts opts)
+{
   // if not enough information for the stellation, just show the diagrams
   if (display_diagrams_only && opts.output_parts != "i") {
     size_t found = opts.output_parts.find_first_of("s");
@@ -645,10 +668,74 @@ int main(int argc, char *argv[])
     opts.output_parts = "d" + opts.output_parts;
   }
 
-  geom = construct_model(geom, diagrams, idx_lists, opts);
-  // color_by_edge_usage(geom);
+  // the diagrams are changed, so these are copies
+  map<int, Geometry> diagrams = stel.get_diagrams(idx_lists);
+  Geometry geom = stel.get_geom();
+  return construct_model(stel, geom, diagrams, idx_lists, opts);
+}
+
+int main(int argc, char *argv[])
+{
+  stellate_opts opts;
+  opts.process_command_line(argc, argv);
+
+  Geometry geom;
+  opts.read_or_error(geom, opts.ifile);
+
+  // process symmetry symbol
+  Symmetry sym(geom);
+  if (!opts.sym_str.length())
+    opts.sym_str = sym.get_symbol().c_str();
+  else {
+    // if specified, check validity
+    sym.init(geom);
+    Symmetry full_sym = sym;
+    Status stat = full_sym.get_sub_sym(opts.sym_str, &sym);
+    if (stat.is_error())
+      opts.error(msg_str("invalid subsymmetry '%s': %s", opts.sym_str.c_str(),
+                         stat.c_msg()),
+                 's');
+  }
+
+  // the diagrams are made once, and shared by all the stellations
+  StellationSession stel(geom, opts.sym_str, opts.projection_width,
+                         opts.epsilon);
+
+  if (opts.batch_lists.empty()) {
+    vector<vector<int>> idx_lists;
+    bool display_diagrams_only;
+    read_stellation_lists(opts.diagram_list_strings, idx_lists,
+                          display_diagrams_only, stel, opts);
+
+    geom = make_model(stel, idx_lists, display_diagrams_only, opts);
+    // color_by_edge_usage(geom);
+
+    opts.write_or_error(geom, opts.ofile);
+    return 0;
+  }
+
+  // batch, check all the lists before making any models
+  size_t num_models = opts.batch_lists.size();
+  vector<vector<vector<int>>> idx_lists(num_models);
+  vector<char> display_diagrams_only(num_models);
+  for (size_t i = 0; i < num_models; i++) {
+    bool diagrams_only;
+    read_stellation_lists(opts.batch_lists[i], idx_lists[i], diagrams_only,
+                          stel, opts,
+                          msg_str("batch model %lu: ", (unsigned long)i + 1));
+    display_diagrams_only[i] = diagrams_only;
+  }
 
-  opts.write_or_error(geom, opts.ofile);
+  parallel_for(num_models,
+               [&](size_t i) {
+                 Geometry model = make_model(
+                     stel, idx_lists[i], display_diagrams_only[i], opts);
+                 string ofile = opts.ofile;
+                 ofile.replace(ofile.find("%s"), 2, std::to_string(i + 1));
+                 stellate_opts model_opts = opts;
+                 model_opts.write_or_error(model, ofile);
+               },
+               opts.num_threads, 1);
 
   return 0;
 }
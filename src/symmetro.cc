@@ -1554,69 +1554,9 @@ vector<Geometry> symmetro::calc_polygons(
   return pgeom;
 }
 
-bool is_point_on_polygon_edges(const Geometry &polygon, const Vec3d &P,
-                               const double eps)
-{
-  const vector<int> &face = polygon.faces()[0];
-  const vector<Vec3d> &verts = polygon.verts();
-
-  bool answer = false;
-
-  int fsz = face.size();
-  for (int i = 0; i < fsz; i++) {
-    Vec3d v1 = verts[face[i]];
-    Vec3d v2 = verts[face[(i + 1) % fsz]];
-    if ((point_in_segment(P, v1, v2, eps)).is_set()) {
-      answer = true;
-      break;
-    }
-  }
-
-  return answer;
-}
-
 bool detect_collision(const Geometry &geom, const symmetro_opts &opts)
 {
-  const vector<vector<int>> &faces = geom.faces();
-  const vector<Vec3d> &verts = geom.verts();
-
-  // don't test digons
-  for (int i = 0; i < (int)faces.size(); i++) {
-    vector<int> face0 = faces[i];
-    // digons won't work in plane intersection
-    if (face0.size() < 3)
-      continue;
-    for (int j = i + 1; j < (int)faces.size(); j++) {
-      vector<int> face1 = faces[j];
-      if (face1.size() < 3)
-        continue;
-
-      Vec3d P, dir;
-      if (two_plane_intersect(centroid(verts, face0), face_norm(verts, face0),
-                              centroid(verts, face1), face_norm(verts, face1),
-                              P, dir, opts.epsilon)) {
-        if (!P.is_set())
-          continue;
-        // if two polygons intersect, see if intersection point is inside
-        // polygon
-        vector<int> face_idxs;
-        face_idxs.push_back(i);
-        Geometry polygon = faces_to_geom(geom, face_idxs);
-        // get winding number, if not zero, point is on a polygon
-        int winding_number = get_winding_number(polygon, P, opts.epsilon);
-        // if point in on an edge set winding number back to zero
-        if (winding_number) {
-          if (is_point_on_polygon_edges(polygon, P, opts.epsilon))
-            winding_number = 0;
-        }
-        if (winding_number) {
-          return true;
-        }
-      }
-    }
-  }
-
-  return false;
+  return has_face_intersections(geom, opts.epsilon);
 }
 
 void delete_free_faces(Geometry &geom)
@@ -56,13 +56,15 @@ public:
   bool tri_fix;
   bool tri_top;
   bool fix_connect;
+  int num_frames;
+  bool delta_frames;
 
   string ofile;
 
   jb_opts()
       : ProgramOpts("jitterbug"), stage(0.0), faces(f_equ | f_oth),
         cycle_type('f'), lat_size(1), tri_fix(false), tri_top(false),
-        fix_connect(false)
+        fix_connect(false), num_frames(0), delta_frames(true)
   {
   }
 
@@ -101,6 +103,9 @@ void jb_opts::usage()
 "            jitterbug neighbours\n"
 "  -t        fix an opposing pair of triangles, stopping them from rotating\n"
 "  -T        rotate so equilateral triangle is on top (suports -t)\n"
+"  -N <num>  write a frame file of num frames, evenly spaced over a whole\n"
+"            cycle starting at cycle_stage, for antiview or off2pov\n"
+"  -D        do not delta encode the frame coordinates (larger file)\n"
 "  -o <file> write output to file (default: write to standard output)\n"
 "\n"
 "\n", prog_name(), help_ver_text);
@@ -114,7 +119,7 @@ void jb_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hf:c:l:tTro:")) != -1) {
+  while ((c = getopt(argc, argv, ":hf:c:l:tTrN:Do:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -167,6 +172,16 @@ void jb_opts::process_command_line(int argc, char **argv)
       fix_connect = true;
       break;
 
+    case 'N':
+      print_status_or_exit(read_int(optarg, &num_frames), c);
+      if (num_frames <= 0)
+        error("number of frames must be a positive integer", c);
+      break;
+
+    case 'D':
+      delta_frames = false;
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -384,18 +399,33 @@ void lattice_trans(Geometry &lat_jb, double cyc_val, bool tri_fix, bool tri_top)
   lat_jb.transform(trans);
 }
 
-int main(int argc, char *argv[])
+void jitterbug_make(Geometry &lat_jb, double stage, const jb_opts &opts)
 {
-  jb_opts opts;
-  opts.process_command_line(argc, argv);
-
-  double cyc_val = cycle_value(opts.stage, opts.cycle_type);
-  Geometry jb, lat_jb;
+  double cyc_val = cycle_value(stage, opts.cycle_type);
+  Geometry jb;
   double scale = jb_make(jb, cyc_val, opts.faces);
   lattice_make(lat_jb, jb, cyc_val, scale, opts.lat_size, opts.fix_connect);
   lattice_trans(lat_jb, cyc_val, opts.tri_fix, opts.tri_top);
+}
 
-  opts.write_or_error(lat_jb, opts.ofile);
+int main(int argc, char *argv[])
+{
+  jb_opts opts;
+  opts.process_command_line(argc, argv);
+
+  if (opts.num_frames) {
+    auto make_frame = [&](unsigned long i, Geometry &geom) {
+      double stage = opts.stage + (double)i / opts.num_frames;
+      jitterbug_make(geom, stage - floor(stage), opts);
+    };
+    opts.print_status_or_exit(write_frames(opts.ofile, opts.num_frames,
+                                           make_frame, opts.delta_frames));
+  }
+  else {
+    Geometry lat_jb;
+    jitterbug_make(lat_jb, opts.stage, opts);
+    opts.write_or_error(lat_jb, opts.ofile);
+  }
 
   return 0;
 }